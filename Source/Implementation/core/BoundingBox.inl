@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <limits>
+
+namespace midnight
+{
+
+template<typename T>
+inline BoundingBox<T>::BoundingBox() noexcept
+{
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        minimum[i] = std::numeric_limits<T>::max();
+        maximum[i] = std::numeric_limits<T>::lowest();
+    }
+}
+
+template<typename T>
+inline BoundingBox<T>::BoundingBox(const Point<T, 3>& minimum, const Point<T, 3>& maximum) noexcept
+{
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        this->minimum[i] = minimum[i];
+        this->maximum[i] = maximum[i];
+    }
+}
+
+template<typename T>
+inline bool BoundingBox<T>::isEmpty() const noexcept
+{
+    return minimum[0] > maximum[0] || minimum[1] > maximum[1] || minimum[2] > maximum[2];
+}
+
+template<typename T>
+inline T BoundingBox<T>::getMinimum(std::size_t axis) const noexcept
+{
+    return minimum[axis];
+}
+
+template<typename T>
+inline T BoundingBox<T>::getMaximum(std::size_t axis) const noexcept
+{
+    return maximum[axis];
+}
+
+template<typename T>
+inline Point<T, 3> BoundingBox<T>::getMinimum() const noexcept
+{
+    return Point<T, 3>(minimum[0], minimum[1], minimum[2]);
+}
+
+template<typename T>
+inline Point<T, 3> BoundingBox<T>::getMaximum() const noexcept
+{
+    return Point<T, 3>(maximum[0], maximum[1], maximum[2]);
+}
+
+template<typename T>
+inline Point<T, 3> BoundingBox<T>::getCenter() const noexcept
+{
+    return Point<T, 3>((minimum[0] + maximum[0]) / 2, (minimum[1] + maximum[1]) / 2, (minimum[2] + maximum[2]) / 2);
+}
+
+template<typename T>
+inline Vector<T, 3> BoundingBox<T>::getExtents() const noexcept
+{
+    return Vector<T, 3>((maximum[0] - minimum[0]) / 2, (maximum[1] - minimum[1]) / 2, (maximum[2] - minimum[2]) / 2);
+}
+
+template<typename T>
+inline void BoundingBox<T>::merge(const BoundingBox& box) noexcept
+{
+    /// An empty box holds the identities of min and max, so it needs no special case
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        minimum[i] = std::min(minimum[i], box.minimum[i]);
+        maximum[i] = std::max(maximum[i], box.maximum[i]);
+    }
+}
+
+template<typename T>
+inline void BoundingBox<T>::merge(const Point<T, 3>& point) noexcept
+{
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        minimum[i] = std::min(minimum[i], point[i]);
+        maximum[i] = std::max(maximum[i], point[i]);
+    }
+}
+
+template<typename T>
+inline bool BoundingBox<T>::contains(const Point<T, 3>& point) const noexcept
+{
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        if(point[i] < minimum[i] || point[i] > maximum[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+inline bool BoundingBox<T>::intersects(const BoundingBox& box) const noexcept
+{
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        if(box.maximum[i] < minimum[i] || box.minimum[i] > maximum[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+inline BoundingBox<T> BoundingBox<T>::transform(const Matrix<T, 4, 4>& transform) const noexcept
+{
+    if(isEmpty())
+    {
+        return BoundingBox();
+    }
+    /// Arvo's method: every output axis starts at the translation, and takes the smaller and
+    /// larger product of each input axis
+    BoundingBox rv;
+    for(std::size_t column = 0; column < 3; ++column)
+    {
+        rv.minimum[column] = rv.maximum[column] = transform(3, column);
+        for(std::size_t row = 0; row < 3; ++row)
+        {
+            const T a = transform(row, column) * minimum[row];
+            const T b = transform(row, column) * maximum[row];
+            rv.minimum[column] += std::min(a, b);
+            rv.maximum[column] += std::max(a, b);
+        }
+    }
+    return rv;
+}
+
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <string>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    /// Marks a minimum block that does not start an allocated block
+    constexpr std::uint8_t UNALLOCATED_BLOCK = 0xFF;
+
+    inline bool isPowerOfTwo(std::size_t value) noexcept
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+}
+
+inline BuddyAllocator::BuddyAllocator(std::size_t capacity, std::size_t minimumBlock) :
+    minimumBlock(minimumBlock),
+    maximumOrder(0),
+    allocatedSize(0),
+    allocationCount(0)
+{
+    if(!detail::isPowerOfTwo(capacity) || !detail::isPowerOfTwo(minimumBlock) || minimumBlock > capacity)
+    {
+        throw IllegalArgumentException(std::string("A BuddyAllocator requires power of two sizes, but a capacity of ") +
+                std::to_string(capacity) + " and a minimum block of " + std::to_string(minimumBlock) + " were provided");
+    }
+    while((minimumBlock << maximumOrder) < capacity)
+    {
+        ++maximumOrder;
+    }
+    freeBlocks.resize(maximumOrder + 1);
+    freeBlocks[maximumOrder].insert(0);
+    allocatedOrders.assign(capacity / minimumBlock, detail::UNALLOCATED_BLOCK);
+}
+
+inline std::size_t BuddyAllocator::allocate(std::size_t size)
+{
+    if(size == 0)
+    {
+        throw IllegalArgumentException("Unable to allocate an empty block");
+    }
+    const std::size_t order = orderOf(size);
+    std::size_t available = order;
+    while(available <= maximumOrder && freeBlocks[available].empty())
+    {
+        ++available;
+    }
+    if(available > maximumOrder)
+    {
+        throw ResourceException(std::string("Unable to allocate a block of ") + std::to_string(size) +
+                " (the largest free block holds " + std::to_string(getLargestFreeBlock()) + ")");
+    }
+
+    std::size_t offset = *freeBlocks[available].begin();
+    freeBlocks[available].erase(freeBlocks[available].begin());
+
+    /// Split the block, keeping the lower half and freeing the upper one, until it fits snugly
+    while(available > order)
+    {
+        --available;
+        freeBlocks[available].insert(offset + (minimumBlock << available));
+    }
+
+    allocatedOrders[offset / minimumBlock] = static_cast<std::uint8_t>(order);
+    allocatedSize += minimumBlock << order;
+    ++allocationCount;
+    return offset;
+}
+
+inline void BuddyAllocator::release(std::size_t offset)
+{
+    if(offset % minimumBlock != 0 || offset / minimumBlock >= allocatedOrders.size() ||
+       allocatedOrders[offset / minimumBlock] == detail::UNALLOCATED_BLOCK)
+    {
+        throw IllegalArgumentException(std::string("No block is allocated at offset ") + std::to_string(offset));
+    }
+    std::size_t order = allocatedOrders[offset / minimumBlock];
+    allocatedOrders[offset / minimumBlock] = detail::UNALLOCATED_BLOCK;
+    allocatedSize -= minimumBlock << order;
+    --allocationCount;
+
+    /// Coalesce with the buddy for as long as it is free as well
+    while(order < maximumOrder)
+    {
+        std::size_t buddy = offset ^ (minimumBlock << order);
+        if(freeBlocks[order].erase(buddy) == 0)
+        {
+            break;
+        }
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+    freeBlocks[order].insert(offset);
+}
+
+inline bool BuddyAllocator::canAllocate(std::size_t size) const noexcept
+{
+    return size != 0 && getBlockSize(size) <= getLargestFreeBlock();
+}
+
+inline std::size_t BuddyAllocator::getBlockSize(std::size_t size) const noexcept
+{
+    return minimumBlock << orderOf(size);
+}
+
+inline std::size_t BuddyAllocator::getCapacity() const noexcept
+{
+    return minimumBlock << maximumOrder;
+}
+
+inline std::size_t BuddyAllocator::getAllocatedSize() const noexcept
+{
+    return allocatedSize;
+}
+
+inline std::size_t BuddyAllocator::getAllocationCount() const noexcept
+{
+    return allocationCount;
+}
+
+inline std::size_t BuddyAllocator::getLargestFreeBlock() const noexcept
+{
+    for(std::size_t order = maximumOrder + 1; order-- > 0;)
+    {
+        if(!freeBlocks[order].empty())
+        {
+            return minimumBlock << order;
+        }
+    }
+    return 0;
+}
+
+inline std::size_t BuddyAllocator::orderOf(std::size_t size) const noexcept
+{
+    std::size_t order = 0;
+    while((minimumBlock << order) < size && order <= maximumOrder)
+    {
+        ++order;
+    }
+    return order;
+}
+
+}
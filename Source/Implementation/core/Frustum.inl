@@ -0,0 +1,101 @@
+#include <cmath>
+
+namespace midnight
+{
+
+inline Frustum::Frustum() noexcept
+{
+    for(std::size_t i = 0; i < 8; ++i)
+    {
+        a[i] = b[i] = c[i] = 0.0f;
+        d[i] = 1.0f;
+    }
+}
+
+inline Frustum::Frustum(const Matrix4x4F& clip) noexcept :
+    Frustum()
+{
+    /// Gribb and Hartmann: with row vectors, clip coordinate j is the dot product with column j,
+    /// and each plane is w plus or minus one of x, y and z
+    for(std::size_t i = 0; i < 6; ++i)
+    {
+        const std::size_t column = i / 2;
+        const float sign = i % 2 == 0 ? 1.0f : -1.0f;
+        a[i] = clip(0, 3) + sign * clip(0, column);
+        b[i] = clip(1, 3) + sign * clip(1, column);
+        c[i] = clip(2, 3) + sign * clip(2, column);
+        d[i] = clip(3, 3) + sign * clip(3, column);
+    }
+}
+
+inline bool Frustum::intersects(const BoundingBoxF& box, std::uint32_t& mask) const noexcept
+{
+    if(box.isEmpty())
+    {
+        return false;
+    }
+    if(mask == 0)
+    {
+        return true;
+    }
+    const float center[3] =
+    {
+        (box.getMinimum(0) + box.getMaximum(0)) * 0.5f,
+        (box.getMinimum(1) + box.getMaximum(1)) * 0.5f,
+        (box.getMinimum(2) + box.getMaximum(2)) * 0.5f
+    };
+    const float extents[3] =
+    {
+        (box.getMaximum(0) - box.getMinimum(0)) * 0.5f,
+        (box.getMaximum(1) - box.getMinimum(1)) * 0.5f,
+        (box.getMaximum(2) - box.getMinimum(2)) * 0.5f
+    };
+
+    /// The box is outside of a plane if its center is farther behind it than the projection of
+    /// its extents onto the normal, and inside if it is that far in front
+    std::uint32_t outside = 0;
+    std::uint32_t inside = 0;
+#if defined(MIDNIGHT_FRUSTUM_SSE)
+    const __m128 signs = _mm_set1_ps(-0.0f);
+    const __m128 cx = _mm_set1_ps(center[0]);
+    const __m128 cy = _mm_set1_ps(center[1]);
+    const __m128 cz = _mm_set1_ps(center[2]);
+    const __m128 ex = _mm_set1_ps(extents[0]);
+    const __m128 ey = _mm_set1_ps(extents[1]);
+    const __m128 ez = _mm_set1_ps(extents[2]);
+    for(std::size_t i = 0; i < 8; i += 4)
+    {
+        const __m128 pa = _mm_load_ps(a + i);
+        const __m128 pb = _mm_load_ps(b + i);
+        const __m128 pc = _mm_load_ps(c + i);
+        const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pa, cx), _mm_mul_ps(pb, cy)),
+                _mm_add_ps(_mm_mul_ps(pc, cz), _mm_load_ps(d + i)));
+        const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signs, pa), ex),
+                _mm_mul_ps(_mm_andnot_ps(signs, pb), ey)), _mm_mul_ps(_mm_andnot_ps(signs, pc), ez));
+        outside |= static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()))) << i;
+        inside |= static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmpge_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()))) << i;
+    }
+#else
+    for(std::size_t i = 0; i < 6; ++i)
+    {
+        const float distance = a[i] * center[0] + b[i] * center[1] + c[i] * center[2] + d[i];
+        const float radius = std::fabs(a[i]) * extents[0] + std::fabs(b[i]) * extents[1] + std::fabs(c[i]) * extents[2];
+        outside |= static_cast<std::uint32_t>(distance + radius < 0.0f) << i;
+        inside |= static_cast<std::uint32_t>(distance - radius >= 0.0f) << i;
+    }
+#endif
+    if((outside & mask) != 0)
+    {
+        return false;
+    }
+    mask &= ~inside;
+    return true;
+}
+
+inline bool Frustum::intersects(const BoundingBoxF& box) const noexcept
+{
+    std::uint32_t mask = ALL_PLANES;
+    return intersects(box, mask);
+}
+
+}
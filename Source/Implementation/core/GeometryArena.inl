@@ -0,0 +1,427 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "BindException.hpp"
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    /// The granularity of arena allocations, in vertices or indices
+    constexpr std::size_t ARENA_MINIMUM_BLOCK = 64;
+
+    inline std::size_t arenaCapacity(std::size_t requested) noexcept
+    {
+        std::size_t capacity = ARENA_MINIMUM_BLOCK;
+        while(capacity < requested)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    inline const GLvoid* bufferOffset(std::size_t bytes) noexcept
+    {
+        return reinterpret_cast<const GLvoid*>(bytes);
+    }
+}
+
+inline GeometryArena::GeometryArena(std::size_t vertexCapacity, std::size_t indexCapacity) :
+    vertexBuffer(0),
+    indexBuffer(0),
+    vertexAllocator(detail::arenaCapacity(vertexCapacity), detail::ARENA_MINIMUM_BLOCK),
+    indexAllocator(detail::arenaCapacity(indexCapacity), detail::ARENA_MINIMUM_BLOCK),
+    defragmentations(0),
+    bytesCopied(0)
+{
+    vertexBuffer = createBuffer(vertexAllocator.getCapacity() * VERTEX_COMPONENTS * sizeof(GLfloat));
+    try
+    {
+        indexBuffer = createBuffer(indexAllocator.getCapacity() * sizeof(GLuint));
+    }
+    catch(...)
+    {
+        glDeleteBuffers(1, &vertexBuffer);
+        throw;
+    }
+    getArenas().push_back(this);
+}
+
+inline GeometryArena::~GeometryArena()
+{
+    std::vector<GeometryArena*>& arenas = getArenas();
+    arenas.erase(std::find(arenas.begin(), arenas.end(), this));
+    clearVertexArrays();
+    /// Call should never fail
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+}
+
+inline GeometryArena::Handle GeometryArena::allocate(const std::vector<Vertex32F>& vertices, const std::vector<std::size_t>& indices)
+{
+    return allocate(vertices, std::vector<std::vector<std::size_t>>(1, indices)).front();
+}
+
+inline std::vector<GeometryArena::Handle> GeometryArena::allocate(const std::vector<Vertex32F>& vertices,
+        const std::vector<std::vector<std::size_t>>& indices)
+{
+    if(vertices.empty() || indices.empty())
+    {
+        throw IllegalArgumentException("Unable to allocate an empty mesh");
+    }
+    std::vector<std::vector<GLuint>> data(indices.size());
+    bool fits = vertexAllocator.canAllocate(vertices.size());
+    std::size_t indexBlocks = 0;
+    for(std::size_t i = 0; i < indices.size(); ++i)
+    {
+        if(indices[i].empty())
+        {
+            throw IllegalArgumentException("Unable to allocate an empty mesh");
+        }
+        data[i].reserve(indices[i].size());
+        for(std::size_t index : indices[i])
+        {
+            if(index >= vertices.size())
+            {
+                throw IllegalArgumentException(std::string("Index ") + std::to_string(index) + " references one of only " +
+                        std::to_string(vertices.size()) + " vertices");
+            }
+            data[i].push_back(static_cast<GLuint>(index));
+        }
+        fits = fits && indexAllocator.canAllocate(indices[i].size());
+        indexBlocks += indexAllocator.getBlockSize(indices[i].size());
+    }
+
+    if(!fits)
+    {
+        /// The space may merely be fragmented -- compact once before giving up
+        if(vertexAllocator.getAllocatedSize() + vertexAllocator.getBlockSize(vertices.size()) <= vertexAllocator.getCapacity() &&
+           indexAllocator.getAllocatedSize() + indexBlocks <= indexAllocator.getCapacity())
+        {
+            defragment();
+        }
+    }
+    /// Any call may throw ResourceException, which is exactly what the caller should see
+    std::size_t firstVertex = vertexAllocator.allocate(vertices.size());
+    std::vector<std::size_t> firstIndices;
+    try
+    {
+        for(const std::vector<std::size_t>& range : indices)
+        {
+            firstIndices.push_back(indexAllocator.allocate(range.size()));
+        }
+    }
+    catch(...)
+    {
+        for(std::size_t firstIndex : firstIndices)
+        {
+            indexAllocator.release(firstIndex);
+        }
+        vertexAllocator.release(firstVertex);
+        throw;
+    }
+
+    std::vector<GLfloat> interleaved;
+    interleaved.reserve(vertices.size() * VERTEX_COMPONENTS);
+    for(const Vertex32F& vertex : vertices)
+    {
+        interleaved.insert(interleaved.end(), {
+            vertex.getPosition()[0], vertex.getPosition()[1], vertex.getPosition()[2],
+            vertex.getNormal()[0], vertex.getNormal()[1], vertex.getNormal()[2],
+            vertex.getTexCoord()[0], vertex.getTexCoord()[1]
+        });
+    }
+
+    /// The copy targets are used so that neither the array nor the element binding is disturbed
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstVertex * VERTEX_COMPONENTS * sizeof(GLfloat), interleaved.size() * sizeof(GLfloat), &interleaved[0]);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    for(std::size_t i = 0; i < data.size(); ++i)
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndices[i] * sizeof(GLuint), data[i].size() * sizeof(GLuint), &data[i][0]);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    VertexBlock block;
+    block.vertexCount = vertices.size();
+    block.references = indices.size();
+    vertexBlocks[firstVertex] = block;
+
+    std::vector<Handle> handles;
+    handles.reserve(indices.size());
+    for(std::size_t i = 0; i < indices.size(); ++i)
+    {
+        Allocation allocation;
+        allocation.range.baseVertex = static_cast<GLint>(firstVertex);
+        allocation.range.vertexCount = vertices.size();
+        allocation.range.firstIndex = firstIndices[i];
+        allocation.range.indexCount = static_cast<GLsizei>(indices[i].size());
+        allocation.live = true;
+
+        if(releasedHandles.empty())
+        {
+            allocations.push_back(allocation);
+            handles.push_back(allocations.size() - 1);
+        }
+        else
+        {
+            handles.push_back(releasedHandles.back());
+            releasedHandles.pop_back();
+            allocations[handles.back()] = allocation;
+        }
+    }
+    return handles;
+}
+
+inline void GeometryArena::release(Handle handle)
+{
+    /// Validates the handle
+    const Range& range = getRange(handle);
+    const std::size_t firstVertex = static_cast<std::size_t>(range.baseVertex);
+    std::map<std::size_t, VertexBlock>::iterator block = vertexBlocks.find(firstVertex);
+    if(--block->second.references == 0)
+    {
+        vertexAllocator.release(firstVertex);
+        vertexBlocks.erase(block);
+    }
+    indexAllocator.release(range.firstIndex);
+    allocations[handle].live = false;
+    releasedHandles.push_back(handle);
+}
+
+inline const GeometryArena::Range& GeometryArena::getRange(Handle handle) const
+{
+    if(handle >= allocations.size() || !allocations[handle].live)
+    {
+        throw IllegalArgumentException(std::string("No mesh is allocated for handle ") + std::to_string(handle));
+    }
+    return allocations[handle].range;
+}
+
+inline void GeometryArena::bind()
+{
+    GLint program;
+    /// Call should never fail
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    if(program == 0)
+    {
+        throw midnight::glsl::BindException("A program must first be bound before binding a GeometryArena");
+    }
+
+    std::map<GLint, GLuint>::iterator vertexArray = vertexArrays.find(program);
+    if(vertexArray != vertexArrays.end())
+    {
+        glBindVertexArray(vertexArray->second);
+        return;
+    }
+
+    GLuint handle;
+    glGenVertexArrays(1, &handle);
+    glBindVertexArray(handle);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    /// The element binding is part of the vertex array state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+    const char* names[] = {"position", "normal", "uv_in"};
+    const GLint sizes[] = {3, 3, 2};
+    std::size_t offset = 0;
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        GLint location = glGetAttribLocation(static_cast<GLuint>(program), names[i]);
+        if(location != -1)
+        {
+            glEnableVertexAttribArray(static_cast<GLuint>(location));
+            glVertexAttribPointer(static_cast<GLuint>(location), sizes[i], GL_FLOAT, GL_FALSE,
+                    static_cast<GLsizei>(VERTEX_COMPONENTS * sizeof(GLfloat)), detail::bufferOffset(offset));
+        }
+        offset += static_cast<std::size_t>(sizes[i]) * sizeof(GLfloat);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    vertexArrays[program] = handle;
+}
+
+inline void GeometryArena::unbind() noexcept
+{
+    /// Call should never fail
+    glBindVertexArray(0);
+}
+
+inline void GeometryArena::draw(Handle handle) const
+{
+    const Range& range = getRange(handle);
+    glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+            const_cast<GLvoid*>(detail::bufferOffset(range.firstIndex * sizeof(GLuint))), range.baseVertex);
+}
+
+inline void GeometryArena::draw(Handle handle, std::size_t firstIndex, GLsizei indexCount) const
+{
+    const Range& range = getRange(handle);
+    glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+            const_cast<GLvoid*>(detail::bufferOffset((range.firstIndex + firstIndex) * sizeof(GLuint))), range.baseVertex);
+}
+
+inline void GeometryArena::defragment()
+{
+    const std::size_t vertexBytes = VERTEX_COMPONENTS * sizeof(GLfloat);
+    GLuint vertices = createBuffer(vertexAllocator.getCapacity() * vertexBytes);
+    GLuint indices;
+    try
+    {
+        indices = createBuffer(indexAllocator.getCapacity() * sizeof(GLuint));
+    }
+    catch(...)
+    {
+        glDeleteBuffers(1, &vertices);
+        throw;
+    }
+
+    /// Re-allocating from largest to smallest packs buddy blocks without any holes
+    std::vector<Handle> live;
+    for(Handle handle = 0; handle < allocations.size(); ++handle)
+    {
+        if(allocations[handle].live)
+        {
+            live.push_back(handle);
+        }
+    }
+    BuddyAllocator packedVertices(vertexAllocator.getCapacity(), detail::ARENA_MINIMUM_BLOCK);
+    BuddyAllocator packedIndices(indexAllocator.getCapacity(), detail::ARENA_MINIMUM_BLOCK);
+
+    /// Shared vertices are moved once, and every mesh that uses them follows
+    std::vector<std::pair<std::size_t, VertexBlock>> blocks(vertexBlocks.begin(), vertexBlocks.end());
+    std::stable_sort(blocks.begin(), blocks.end(), [](const std::pair<std::size_t, VertexBlock>& a, const std::pair<std::size_t, VertexBlock>& b)
+    {
+        return a.second.vertexCount > b.second.vertexCount;
+    });
+    std::map<std::size_t, std::size_t> movedVertices;
+    std::map<std::size_t, VertexBlock> packedBlocks;
+    glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertices);
+    for(const std::pair<std::size_t, VertexBlock>& block : blocks)
+    {
+        std::size_t target = packedVertices.allocate(block.second.vertexCount);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, block.first * vertexBytes,
+                target * vertexBytes, block.second.vertexCount * vertexBytes);
+        bytesCopied += block.second.vertexCount * vertexBytes;
+        movedVertices[block.first] = target;
+        packedBlocks[target] = block.second;
+    }
+    for(Handle handle : live)
+    {
+        Range& range = allocations[handle].range;
+        range.baseVertex = static_cast<GLint>(movedVertices[static_cast<std::size_t>(range.baseVertex)]);
+    }
+
+    std::stable_sort(live.begin(), live.end(), [&](Handle a, Handle b)
+    {
+        return allocations[a].range.indexCount > allocations[b].range.indexCount;
+    });
+    glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indices);
+    for(Handle handle : live)
+    {
+        Range& range = allocations[handle].range;
+        std::size_t count = static_cast<std::size_t>(range.indexCount);
+        std::size_t target = packedIndices.allocate(count);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range.firstIndex * sizeof(GLuint),
+                target * sizeof(GLuint), count * sizeof(GLuint));
+        bytesCopied += count * sizeof(GLuint);
+        range.firstIndex = target;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    vertexBuffer = vertices;
+    indexBuffer = indices;
+    vertexAllocator = packedVertices;
+    indexAllocator = packedIndices;
+    vertexBlocks.swap(packedBlocks);
+
+    /// The cached vertex arrays still reference the old storage
+    clearVertexArrays();
+    ++defragmentations;
+}
+
+inline GeometryArena::Statistics GeometryArena::getStatistics() const noexcept
+{
+    Statistics statistics;
+    statistics.vertexCapacity = vertexAllocator.getCapacity();
+    statistics.verticesReserved = vertexAllocator.getAllocatedSize();
+    statistics.verticesStored = 0;
+    statistics.largestFreeVertexRange = vertexAllocator.getLargestFreeBlock();
+    statistics.indexCapacity = indexAllocator.getCapacity();
+    statistics.indicesReserved = indexAllocator.getAllocatedSize();
+    statistics.indicesStored = 0;
+    statistics.largestFreeIndexRange = indexAllocator.getLargestFreeBlock();
+    statistics.allocations = 0;
+    statistics.defragmentations = defragmentations;
+    statistics.bytesCopied = bytesCopied;
+    for(const Allocation& allocation : allocations)
+    {
+        if(allocation.live)
+        {
+            statistics.indicesStored += static_cast<std::size_t>(allocation.range.indexCount);
+            ++statistics.allocations;
+        }
+    }
+    for(const std::pair<const std::size_t, VertexBlock>& block : vertexBlocks)
+    {
+        statistics.verticesStored += block.second.vertexCount;
+    }
+    return statistics;
+}
+
+inline GLuint GeometryArena::createBuffer(std::size_t bytes)
+{
+    GLuint handle;
+    glGenBuffers(1, &handle);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+    /// Can set GL_OUT_OF_MEMORY
+    /// https://www.opengl.org/sdk/docs/man4/xhtml/glBufferData.xml
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if(glGetError() == GL_OUT_OF_MEMORY)
+    {
+        glDeleteBuffers(1, &handle);
+        throw ResourceException("Unable to allocate GPU memory for GeometryArena");
+    }
+    return handle;
+}
+
+inline void GeometryArena::forgetProgram(GLuint program) noexcept
+{
+    for(GeometryArena* arena : getArenas())
+    {
+        std::map<GLint, GLuint>::iterator vertexArray = arena->vertexArrays.find(static_cast<GLint>(program));
+        if(vertexArray != arena->vertexArrays.end())
+        {
+            /// Call should never fail
+            glDeleteVertexArrays(1, &vertexArray->second);
+            arena->vertexArrays.erase(vertexArray);
+        }
+    }
+}
+
+inline std::vector<GeometryArena*>& GeometryArena::getArenas()
+{
+    /// Never destroyed, so that Programs with static storage may still be deleted at exit
+    static std::vector<GeometryArena*>* arenas = new std::vector<GeometryArena*>();
+    return *arenas;
+}
+
+inline void GeometryArena::clearVertexArrays() noexcept
+{
+    for(const std::pair<const GLint, GLuint>& vertexArray : vertexArrays)
+    {
+        glDeleteVertexArrays(1, &vertexArray.second);
+    }
+    vertexArrays.clear();
+}
+
+}
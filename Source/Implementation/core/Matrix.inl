@@ -96,6 +96,25 @@ midnight::Matrix<T, Rows, Columns> operator-(const midnight::Matrix<T, Rows, Col
     }
     return rv;
 }
+
+template<typename T, std::size_t Rows, std::size_t Inner, std::size_t Columns>
+midnight::Matrix<T, Rows, Columns> operator*(const midnight::Matrix<T, Rows, Inner>& lhs, const midnight::Matrix<T, Inner, Columns>& rhs) noexcept
+{
+    midnight::Matrix<T, Rows, Columns> rv;
+    for(std::size_t column = 0; column < Columns; ++column)
+    {
+        for(std::size_t i = 0; i < Inner; ++i)
+        {
+            /// Column-major storage, so walk down the columns of the result
+            const T factor = rhs(i, column);
+            for(std::size_t row = 0; row < Rows; ++row)
+            {
+                rv(row, column) += lhs(row, i) * factor;
+            }
+        }
+    }
+    return rv;
+}
 namespace midnight
 {
 
@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "IllegalArgumentException.hpp"
+#include "parallel_for.hpp"
+
+namespace midnight
+{
+
+namespace occlusion
+{
+
+/// The smallest clip space w that is rasterized, so that the reciprocal stays finite
+constexpr float MINIMUM_W = 1e-5f;
+
+/// The relative depth an occluder must be nearer by to hide an object, absorbing rounding
+constexpr float DEPTH_BIAS = 1e-5f;
+
+/**
+ * Clips a convex polygon in clip space against a plane
+ *
+ * @param input the x, y, z and w of each vertex
+ *
+ * @param count the number of vertices
+ *
+ * @param output receives the clipped polygon (at most one vertex more)
+ *
+ * @param plane the signed distance to the plane of a vertex, non-negative inside of it
+ *
+ * @return the number of vertices of the clipped polygon
+ *
+ */
+template<typename Plane>
+inline std::size_t clip(const float (*input)[4], std::size_t count, float (*output)[4], Plane plane) noexcept
+{
+    std::size_t rv = 0;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        const float* current = input[i];
+        const float* next = input[(i + 1) % count];
+        const float currentDistance = plane(current);
+        const float nextDistance = plane(next);
+        if(currentDistance >= 0.0f)
+        {
+            std::copy(current, current + 4, output[rv++]);
+        }
+        if((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+        {
+            const float t = currentDistance / (currentDistance - nextDistance);
+            for(std::size_t j = 0; j < 4; ++j)
+            {
+                output[rv][j] = current[j] + (next[j] - current[j]) * t;
+            }
+            ++rv;
+        }
+    }
+    return rv;
+}
+
+}
+
+inline OcclusionBuffer::OcclusionBuffer(std::size_t width, std::size_t height) :
+    width(width),
+    height(height)
+{
+    if(width == 0 || height == 0 || width % TILE_WIDTH != 0 || height % TILE_HEIGHT != 0)
+    {
+        throw IllegalArgumentException("An OcclusionBuffer of " + std::to_string(width) + "x" + std::to_string(height) +
+                " pixels is not a whole number of " + std::to_string(TILE_WIDTH) + "x" + std::to_string(TILE_HEIGHT) + " tiles");
+    }
+    depths.resize(width * height);
+    tileMinimums.resize(width / TILE_WIDTH * (height / TILE_HEIGHT));
+    tileMaximums.resize(tileMinimums.size());
+    bins.resize(height / TILE_HEIGHT);
+    clear();
+}
+
+inline void OcclusionBuffer::clear() noexcept
+{
+    std::fill(depths.begin(), depths.end(), 0.0f);
+    std::fill(tileMinimums.begin(), tileMinimums.end(), 0.0f);
+    std::fill(tileMaximums.begin(), tileMaximums.end(), 0.0f);
+    triangles.clear();
+    for(std::vector<std::uint32_t>& bin : bins)
+    {
+        bin.clear();
+    }
+}
+
+inline void OcclusionBuffer::addOccluder(const std::vector<Point3F>& positions, const std::vector<std::uint32_t>& indices,
+        const Matrix4x4F& clip)
+{
+    clipVertices.resize(positions.size() * 4);
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+        /// Row vectors: clip coordinate j is the dot product with column j
+        for(std::size_t j = 0; j < 4; ++j)
+        {
+            clipVertices[i * 4 + j] = positions[i][0] * clip(0, j) + positions[i][1] * clip(1, j) +
+                    positions[i][2] * clip(2, j) + clip(3, j);
+        }
+    }
+
+    for(std::size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        float polygon[5][4];
+        std::uint32_t outsideAll = 0x3F;
+        std::uint32_t outsideAny = 0;
+        for(std::size_t k = 0; k < 3; ++k)
+        {
+            if(indices[i + k] >= positions.size())
+            {
+                throw IllegalArgumentException("Occluder index " + std::to_string(indices[i + k]) + " is out of range (" +
+                        std::to_string(positions.size()) + " positions)");
+            }
+            std::copy(&clipVertices[indices[i + k] * 4], &clipVertices[indices[i + k] * 4] + 4, polygon[k]);
+            const float* v = polygon[k];
+            const std::uint32_t outside = static_cast<std::uint32_t>(v[0] < -v[3]) |
+                    static_cast<std::uint32_t>(v[0] > v[3]) << 1 |
+                    static_cast<std::uint32_t>(v[1] < -v[3]) << 2 |
+                    static_cast<std::uint32_t>(v[1] > v[3]) << 3 |
+                    static_cast<std::uint32_t>(v[2] < -v[3] || v[3] < occlusion::MINIMUM_W) << 4;
+            outsideAll &= outside;
+            outsideAny |= outside;
+        }
+
+        /// Entirely off the screen or behind the near plane
+        if(outsideAll != 0)
+        {
+            continue;
+        }
+        std::size_t count = 3;
+        if((outsideAny & 0x10) != 0)
+        {
+            float clipped[5][4];
+            count = occlusion::clip(polygon, count, clipped, [](const float* v)
+            {
+                return v[2] + v[3];
+            });
+            count = occlusion::clip(clipped, count, polygon, [](const float* v)
+            {
+                return v[3] - occlusion::MINIMUM_W;
+            });
+        }
+        for(std::size_t k = 2; k < count; ++k)
+        {
+            const float vertices[3][3] =
+            {
+                {polygon[0][0], polygon[0][1], polygon[0][3]},
+                {polygon[k - 1][0], polygon[k - 1][1], polygon[k - 1][3]},
+                {polygon[k][0], polygon[k][1], polygon[k][3]}
+            };
+            addTriangle(vertices);
+        }
+    }
+}
+
+inline void OcclusionBuffer::rasterize()
+{
+    parallel_for(0, bins.size(), [this](std::size_t band)
+    {
+        rasterizeBand(band);
+    });
+}
+
+inline bool OcclusionBuffer::isVisible(const BoundingBoxF& box, const Matrix4x4F& clip) const noexcept
+{
+    if(box.isEmpty())
+    {
+        return false;
+    }
+    if(triangles.empty())
+    {
+        return true;
+    }
+
+    float minimumX = static_cast<float>(width);
+    float maximumX = 0.0f;
+    float minimumY = static_cast<float>(height);
+    float maximumY = 0.0f;
+    float nearest = 0.0f;
+    for(std::size_t corner = 0; corner < 8; ++corner)
+    {
+        const float p[3] =
+        {
+            (corner & 1) != 0 ? box.getMaximum(0) : box.getMinimum(0),
+            (corner & 2) != 0 ? box.getMaximum(1) : box.getMinimum(1),
+            (corner & 4) != 0 ? box.getMaximum(2) : box.getMinimum(2)
+        };
+        float v[4];
+        for(std::size_t j = 0; j < 4; ++j)
+        {
+            v[j] = p[0] * clip(0, j) + p[1] * clip(1, j) + p[2] * clip(2, j) + clip(3, j);
+        }
+
+        /// Nothing can be said of a box that reaches past the near plane
+        if(v[2] < -v[3] || v[3] < occlusion::MINIMUM_W)
+        {
+            return true;
+        }
+        const float reciprocal = 1.0f / v[3];
+        const float x = (v[0] * reciprocal * 0.5f + 0.5f) * static_cast<float>(width);
+        const float y = (v[1] * reciprocal * 0.5f + 0.5f) * static_cast<float>(height);
+        minimumX = std::min(minimumX, x);
+        maximumX = std::max(maximumX, x);
+        minimumY = std::min(minimumY, y);
+        maximumY = std::max(maximumY, y);
+        nearest = std::max(nearest, reciprocal);
+    }
+
+    /// Every pixel the box touches, even partially.  A box off the screen is left to the Frustum.
+    const std::size_t x0 = static_cast<std::size_t>(std::max(0.0f, std::floor(minimumX)));
+    const std::size_t x1 = static_cast<std::size_t>(std::min(static_cast<float>(width), std::ceil(maximumX)));
+    const std::size_t y0 = static_cast<std::size_t>(std::max(0.0f, std::floor(minimumY)));
+    const std::size_t y1 = static_cast<std::size_t>(std::min(static_cast<float>(height), std::ceil(maximumY)));
+    if(x0 >= x1 || y0 >= y1)
+    {
+        return true;
+    }
+
+    /// A pixel hides the box if its occluder is nearer than the nearest corner
+    const float threshold = nearest * (1.0f + occlusion::DEPTH_BIAS);
+    const std::size_t tilesX = width / TILE_WIDTH;
+    for(std::size_t tileY = y0 / TILE_HEIGHT; tileY <= (y1 - 1) / TILE_HEIGHT; ++tileY)
+    {
+        for(std::size_t tileX = x0 / TILE_WIDTH; tileX <= (x1 - 1) / TILE_WIDTH; ++tileX)
+        {
+            const std::size_t tile = tileY * tilesX + tileX;
+            if(tileMinimums[tile] > threshold)
+            {
+                continue;
+            }
+            if(tileMaximums[tile] <= threshold)
+            {
+                return true;
+            }
+            const std::size_t left = std::max(x0, tileX * TILE_WIDTH);
+            const std::size_t right = std::min(x1, (tileX + 1) * TILE_WIDTH);
+            const std::size_t bottom = std::max(y0, tileY * TILE_HEIGHT);
+            const std::size_t top = std::min(y1, (tileY + 1) * TILE_HEIGHT);
+
+            /// The farthest pixel of the tile lies within the box
+            if(right - left == TILE_WIDTH && top - bottom == TILE_HEIGHT)
+            {
+                return true;
+            }
+            for(std::size_t y = bottom; y < top; ++y)
+            {
+                for(std::size_t x = left; x < right; ++x)
+                {
+                    if(depths[y * width + x] <= threshold)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+inline float OcclusionBuffer::getDepth(std::size_t x, std::size_t y) const noexcept
+{
+    return depths[y * width + x];
+}
+
+inline std::size_t OcclusionBuffer::getWidth() const noexcept
+{
+    return width;
+}
+
+inline std::size_t OcclusionBuffer::getHeight() const noexcept
+{
+    return height;
+}
+
+inline std::size_t OcclusionBuffer::getTriangleCount() const noexcept
+{
+    return triangles.size();
+}
+
+inline void OcclusionBuffer::addTriangle(const float (&vertices)[3][3])
+{
+    /// Set up in double precision, as vertices near the viewer may project far off the screen
+    double x[3];
+    double y[3];
+    double z[3];
+    for(std::size_t k = 0; k < 3; ++k)
+    {
+        const double reciprocal = 1.0 / vertices[k][2];
+        x[k] = (vertices[k][0] * reciprocal * 0.5 + 0.5) * static_cast<double>(width);
+        y[k] = (vertices[k][1] * reciprocal * 0.5 + 0.5) * static_cast<double>(height);
+        z[k] = reciprocal;
+    }
+
+    /// Twice the signed area
+    const double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if(std::fabs(area) < 1e-9)
+    {
+        return;
+    }
+
+    Triangle triangle;
+    const double minimumX = std::max(0.0, std::floor(std::min(x[0], std::min(x[1], x[2]))));
+    const double maximumX = std::min(static_cast<double>(width), std::ceil(std::max(x[0], std::max(x[1], x[2]))));
+    const double minimumY = std::max(0.0, std::floor(std::min(y[0], std::min(y[1], y[2]))));
+    const double maximumY = std::min(static_cast<double>(height), std::ceil(std::max(y[0], std::max(y[1], y[2]))));
+    if(minimumX >= maximumX || minimumY >= maximumY)
+    {
+        return;
+    }
+    triangle.minimumX = static_cast<std::uint32_t>(minimumX);
+    triangle.maximumX = static_cast<std::uint32_t>(maximumX);
+    triangle.minimumY = static_cast<std::uint32_t>(minimumY);
+    triangle.maximumY = static_cast<std::uint32_t>(maximumY);
+
+    /// Each edge function is positive on the inside of a counter-clockwise triangle.  Pixel
+    /// centers on an edge are covered by both triangles sharing it, leaving no cracks.
+    const double orientation = area > 0.0 ? 1.0 : -1.0;
+    for(std::size_t k = 0; k < 3; ++k)
+    {
+        const std::size_t next = (k + 1) % 3;
+        const double a = -(y[next] - y[k]) * orientation;
+        const double b = (x[next] - x[k]) * orientation;
+        const double c = -(a * x[k] + b * y[k]);
+        triangle.a[k] = static_cast<float>(a);
+        triangle.b[k] = static_cast<float>(b);
+        triangle.c[k] = static_cast<float>(c);
+    }
+
+    /// The depth plane, lowered to its farthest value within a pixel so that rounding and
+    /// partially covered pixels never move an occluder nearer
+    const double depthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    const double depthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    triangle.depthX = static_cast<float>(depthX);
+    triangle.depthY = static_cast<float>(depthY);
+    triangle.depth = static_cast<float>(z[0] - depthX * x[0] - depthY * y[0] - 0.5 * (std::fabs(depthX) + std::fabs(depthY)));
+
+    const std::uint32_t index = static_cast<std::uint32_t>(triangles.size());
+    triangles.push_back(triangle);
+    for(std::size_t band = triangle.minimumY / TILE_HEIGHT; band <= (triangle.maximumY - 1) / TILE_HEIGHT; ++band)
+    {
+        bins[band].push_back(index);
+    }
+}
+
+inline void OcclusionBuffer::rasterizeBand(std::size_t band) noexcept
+{
+#if defined(MIDNIGHT_OCCLUSION_AVX2)
+    const std::size_t lanes = 8;
+    const __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+#elif defined(MIDNIGHT_OCCLUSION_SSE)
+    const std::size_t lanes = 4;
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+#else
+    const std::size_t lanes = 1;
+#endif
+    const std::size_t bandBottom = band * TILE_HEIGHT;
+    const std::size_t bandTop = bandBottom + TILE_HEIGHT;
+    for(std::uint32_t index : bins[band])
+    {
+        const Triangle& t = triangles[index];
+        const std::size_t left = t.minimumX / lanes * lanes;
+        const std::size_t right = std::min(width, (t.maximumX + lanes - 1) / lanes * lanes);
+        const std::size_t bottom = std::max<std::size_t>(bandBottom, t.minimumY);
+        const std::size_t top = std::min<std::size_t>(bandTop, t.maximumY);
+        for(std::size_t y = bottom; y < top; ++y)
+        {
+            const float centerY = static_cast<float>(y) + 0.5f;
+            const float row0 = t.b[0] * centerY + t.c[0];
+            const float row1 = t.b[1] * centerY + t.c[1];
+            const float row2 = t.b[2] * centerY + t.c[2];
+            const float rowDepth = t.depthY * centerY + t.depth;
+            float* pixels = &depths[y * width];
+#if defined(MIDNIGHT_OCCLUSION_AVX2)
+            for(std::size_t x = left; x < right; x += lanes)
+            {
+                const __m256 centerX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), offsets);
+                const __m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.a[0]), centerX), _mm256_set1_ps(row0));
+                const __m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.a[1]), centerX), _mm256_set1_ps(row1));
+                const __m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.a[2]), centerX), _mm256_set1_ps(row2));
+                const __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ),
+                        _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)), _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+                if(_mm256_movemask_ps(inside) == 0)
+                {
+                    continue;
+                }
+                const __m256 depth = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.depthX), centerX), _mm256_set1_ps(rowDepth));
+                const __m256 current = _mm256_loadu_ps(pixels + x);
+                _mm256_storeu_ps(pixels + x, _mm256_blendv_ps(current, _mm256_max_ps(current, depth), inside));
+            }
+#elif defined(MIDNIGHT_OCCLUSION_SSE)
+            for(std::size_t x = left; x < right; x += lanes)
+            {
+                const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                const __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[0]), centerX), _mm_set1_ps(row0));
+                const __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[1]), centerX), _mm_set1_ps(row1));
+                const __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[2]), centerX), _mm_set1_ps(row2));
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                        _mm_cmpge_ps(e2, zero));
+                if(_mm_movemask_ps(inside) == 0)
+                {
+                    continue;
+                }
+                const __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.depthX), centerX), _mm_set1_ps(rowDepth));
+                const __m128 current = _mm_loadu_ps(pixels + x);
+                const __m128 nearer = _mm_max_ps(current, depth);
+                _mm_storeu_ps(pixels + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for(std::size_t x = left; x < right; ++x)
+            {
+                const float centerX = static_cast<float>(x) + 0.5f;
+                if(t.a[0] * centerX + row0 >= 0.0f && t.a[1] * centerX + row1 >= 0.0f && t.a[2] * centerX + row2 >= 0.0f)
+                {
+                    pixels[x] = std::max(pixels[x], t.depthX * centerX + rowDepth);
+                }
+            }
+#endif
+        }
+    }
+
+    /// Refresh the depth bounds of the band's tiles
+    const std::size_t tilesX = width / TILE_WIDTH;
+    for(std::size_t tileX = 0; tileX < tilesX; ++tileX)
+    {
+        float minimum = depths[bandBottom * width + tileX * TILE_WIDTH];
+        float maximum = minimum;
+        for(std::size_t y = bandBottom; y < bandTop; ++y)
+        {
+            const float* pixels = &depths[y * width + tileX * TILE_WIDTH];
+            for(std::size_t x = 0; x < TILE_WIDTH; ++x)
+            {
+                minimum = std::min(minimum, pixels[x]);
+                maximum = std::max(maximum, pixels[x]);
+            }
+        }
+        tileMinimums[band * tilesX + tileX] = minimum;
+        tileMaximums[band * tilesX + tileX] = maximum;
+    }
+}
+
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+
+namespace midnight
+{
+
+inline Ray::Ray(const Point3F& origin, const Vector3F& direction) noexcept :
+    origin(origin),
+    direction(direction)
+{
+    /// A zero component becomes an infinite reciprocal, which the slab test handles
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        inverse[i] = 1.0f / direction[i];
+    }
+}
+
+inline const Point3F& Ray::getOrigin() const noexcept
+{
+    return origin;
+}
+
+inline const Vector3F& Ray::getDirection() const noexcept
+{
+    return direction;
+}
+
+inline Point3F Ray::getPoint(float distance) const noexcept
+{
+    return Point3F(origin[0] + direction[0] * distance, origin[1] + direction[1] * distance,
+            origin[2] + direction[2] * distance);
+}
+
+inline bool Ray::intersects(const BoundingBoxF& box, float& distance, float maximum) const noexcept
+{
+    if(box.isEmpty())
+    {
+        return false;
+    }
+    float near = 0.0f;
+    float far = maximum;
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        const float t0 = (box.getMinimum(i) - origin[i]) * inverse[i];
+        const float t1 = (box.getMaximum(i) - origin[i]) * inverse[i];
+        near = std::max(near, std::min(t0, t1));
+        far = std::min(far, std::max(t0, t1));
+    }
+    distance = near;
+    return near <= far;
+}
+
+inline bool Ray::intersects(const Point3F& a, const Point3F& b, const Point3F& c, float& distance, float maximum) const noexcept
+{
+    const float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    const float p[3] = {direction[1] * ac[2] - direction[2] * ac[1], direction[2] * ac[0] - direction[0] * ac[2],
+            direction[0] * ac[1] - direction[1] * ac[0]};
+    const float determinant = ab[0] * p[0] + ab[1] * p[1] + ab[2] * p[2];
+
+    /// The Ray runs parallel to the plane of the triangle (or the triangle is degenerate)
+    if(determinant == 0.0f)
+    {
+        return false;
+    }
+    const float inverseDeterminant = 1.0f / determinant;
+    const float s[3] = {origin[0] - a[0], origin[1] - a[1], origin[2] - a[2]};
+    const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverseDeterminant;
+    if(u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+    const float q[3] = {s[1] * ab[2] - s[2] * ab[1], s[2] * ab[0] - s[0] * ab[2], s[0] * ab[1] - s[1] * ab[0]};
+    const float v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseDeterminant;
+    if(v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+    const float t = (ac[0] * q[0] + ac[1] * q[1] + ac[2] * q[2]) * inverseDeterminant;
+    if(t < 0.0f || t > maximum)
+    {
+        return false;
+    }
+    distance = t;
+    return true;
+}
+
+}
@@ -0,0 +1,127 @@
+#include <cstring>
+#include <type_traits>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+inline UniformRing::UniformRing(std::size_t frameCapacity, std::size_t framesInFlight) :
+    buffer(0),
+    mapping(nullptr),
+    segmentSize(0),
+    alignment(0),
+    segment(0),
+    head(0),
+    fences(framesInFlight, nullptr)
+{
+    if(frameCapacity == 0 || framesInFlight == 0)
+    {
+        throw IllegalArgumentException("The frame capacity and number of frames in flight of a UniformRing must not be zero");
+    }
+    GLint queried;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &queried);
+    alignment = static_cast<std::size_t>(queried > 0 ? queried : 256);
+    /// Every segment starts on an aligned offset
+    segmentSize = (frameCapacity + alignment - 1) / alignment * alignment;
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(segmentSize * framesInFlight);
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+    mapping = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if(mapping == nullptr)
+    {
+        glDeleteBuffers(1, &buffer);
+        throw ResourceException("Unable to allocate the buffer of a UniformRing");
+    }
+}
+
+inline UniformRing::~UniformRing()
+{
+    for(GLsync fence : fences)
+    {
+        if(fence != nullptr)
+        {
+            glDeleteSync(fence);
+        }
+    }
+    /// Call should never fail
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+}
+
+inline void UniformRing::beginFrame()
+{
+    segment = (segment + 1) % fences.size();
+    head = 0;
+    GLsync& fence = fences[segment];
+    if(fence != nullptr)
+    {
+        /// Only stalls when the CPU runs more than framesInFlight frames ahead
+        while(true)
+        {
+            GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            if(status != GL_TIMEOUT_EXPIRED)
+            {
+                break;
+            }
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+inline void UniformRing::endFrame()
+{
+    GLsync& fence = fences[segment];
+    if(fence != nullptr)
+    {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+template<typename T>
+inline void UniformRing::bind(GLuint binding, const T& block)
+{
+    bind(binding, write(block), sizeof(T));
+}
+
+template<typename T>
+inline std::size_t UniformRing::write(const T& block)
+{
+    static_assert(std::is_standard_layout<T>::value, "Uniform blocks must be standard-layout types");
+    const std::size_t offset = allocate(sizeof(T));
+    /// The mapping is coherent, so the copy is visible to any draw issued later
+    std::memcpy(mapping + offset, &block, sizeof(T));
+    return offset;
+}
+
+inline void UniformRing::bind(GLuint binding, std::size_t offset, std::size_t size) noexcept
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+}
+
+inline std::size_t UniformRing::getFrameUsage() const noexcept
+{
+    return head;
+}
+
+inline std::size_t UniformRing::allocate(std::size_t size)
+{
+    if(head + size > segmentSize)
+    {
+        throw ResourceException("The per-frame capacity of a UniformRing has been exhausted");
+    }
+    const std::size_t offset = segment * segmentSize + head;
+    head = (head + size + alignment - 1) / alignment * alignment;
+    return offset;
+}
+
+}
@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <utility>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    /// Staging allocations are aligned so that every chunk is a valid unpack offset
+    constexpr std::size_t STAGING_ALIGNMENT = 256;
+}
+
+inline UploadService::Resource::Resource(GLenum target, std::size_t width, std::size_t height) :
+    target(target),
+    name(0),
+    width(width),
+    height(height),
+    size(0),
+    remaining(0),
+    state(State::PENDING)
+{
+
+}
+
+inline UploadService::Resource::~Resource()
+{
+    if(name == 0)
+    {
+        return;
+    }
+    /// Call should never fail
+    if(target == GL_TEXTURE_2D)
+    {
+        glDeleteTextures(1, &name);
+    }
+    else
+    {
+        glDeleteBuffers(1, &name);
+    }
+}
+
+inline UploadService::Resource::State UploadService::Resource::getState() const noexcept
+{
+    return state.load(std::memory_order_acquire);
+}
+
+inline bool UploadService::Resource::isResident() const noexcept
+{
+    return getState() == State::RESIDENT;
+}
+
+inline GLuint UploadService::Resource::getName() const noexcept
+{
+    return name;
+}
+
+inline std::string UploadService::Resource::getError() const
+{
+    return getState() == State::FAILED ? error : std::string();
+}
+
+inline UploadService::UploadService(std::size_t stagingCapacity, std::size_t frameBudget) :
+    ring(0),
+    mapping(nullptr),
+    ringCapacity(stagingCapacity),
+    frameBudget(frameBudget),
+    chunkSize(0),
+    ringHead(0),
+    ringTail(0),
+    ringUsed(0),
+    stopping(false),
+    pending(0)
+{
+    /// Every chunk takes at least this much of the ring and of the budget, so less could never be issued
+    if(stagingCapacity < detail::STAGING_ALIGNMENT || frameBudget < detail::STAGING_ALIGNMENT)
+    {
+        throw IllegalArgumentException("The staging capacity and frame budget of an UploadService must hold at least " +
+                std::to_string(detail::STAGING_ALIGNMENT) + " bytes");
+    }
+    /// A chunk never exceeds the budget, and a quarter of the ring keeps several chunks in flight
+    chunkSize = std::max(detail::STAGING_ALIGNMENT, std::min(frameBudget, stagingCapacity / 4) / detail::STAGING_ALIGNMENT * detail::STAGING_ALIGNMENT);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &ring);
+    glBindBuffer(GL_COPY_READ_BUFFER, ring);
+    glBufferStorage(GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(ringCapacity), nullptr, flags);
+    mapping = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(ringCapacity), flags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if(mapping == nullptr)
+    {
+        glDeleteBuffers(1, &ring);
+        throw ResourceException("Unable to allocate the staging ring of an UploadService");
+    }
+
+    worker = std::thread(&UploadService::run, this);
+}
+
+inline UploadService::~UploadService()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wakeWorker.notify_all();
+    worker.join();
+
+    for(Flight& flight : flights)
+    {
+        glDeleteSync(flight.fence);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, ring);
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glDeleteBuffers(1, &ring);
+}
+
+inline std::shared_ptr<UploadService::Resource> UploadService::uploadBuffer(Producer producer)
+{
+    std::shared_ptr<Resource> resource(new Resource(GL_COPY_WRITE_BUFFER, 0, 0));
+    ++pending;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(Job{resource, std::move(producer)});
+    }
+    wakeWorker.notify_all();
+    return resource;
+}
+
+inline std::shared_ptr<UploadService::Resource> UploadService::uploadTexture(std::size_t width, std::size_t height, Producer producer)
+{
+    if(width == 0 || height == 0)
+    {
+        throw IllegalArgumentException("Unable to upload an empty texture");
+    }
+    std::shared_ptr<Resource> resource(new Resource(GL_TEXTURE_2D, width, height));
+    ++pending;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(Job{resource, std::move(producer)});
+    }
+    wakeWorker.notify_all();
+    return resource;
+}
+
+inline const UploadService::Statistics& UploadService::pump()
+{
+    statistics = Statistics();
+    retire(0);
+
+    std::vector<Chunk> ready;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::size_t budget = frameBudget;
+        while(!staged.empty() && staged.front().size <= budget)
+        {
+            budget -= staged.front().size;
+            ready.push_back(std::move(staged.front()));
+            staged.pop_front();
+        }
+    }
+
+    if(!ready.empty())
+    {
+        for(const Chunk& chunk : ready)
+        {
+            issue(chunk);
+            statistics.bytesIssued += chunk.size;
+            ++statistics.chunksIssued;
+        }
+        Flight flight;
+        flight.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        flight.chunks = std::move(ready);
+        flights.push_back(std::move(flight));
+    }
+    statistics.resourcesPending = pending.load();
+    return statistics;
+}
+
+inline void UploadService::finish()
+{
+    while(pending.load() != 0)
+    {
+        pump();
+        if(!flights.empty())
+        {
+            /// Block on the oldest copies rather than spinning
+            retire(1000000);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void UploadService::run()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wakeWorker.wait(guard, [&]
+            {
+                return stopping || !jobs.empty();
+            });
+            if(stopping)
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        /// A Resource that fails here never had a GL object, so the worker may release it
+        std::vector<unsigned char> data;
+        try
+        {
+            data = job.producer();
+        }
+        catch(const std::exception& exception)
+        {
+            fail(job.resource, exception.what());
+            continue;
+        }
+        catch(...)
+        {
+            fail(job.resource, "The producer threw an unknown exception");
+            continue;
+        }
+
+        const Resource& resource = *job.resource;
+        if(data.empty())
+        {
+            fail(job.resource, "The producer did not produce any data");
+        }
+        else if(resource.target == GL_TEXTURE_2D && data.size() != resource.width * resource.height * 4)
+        {
+            fail(job.resource, "The producer did not produce width * height RGBA8 texels");
+        }
+        else if(resource.target == GL_TEXTURE_2D && resource.width * 4 > chunkSize)
+        {
+            fail(job.resource, "A single texture row does not fit into a staging chunk");
+        }
+        else
+        {
+            stage(std::move(job.resource), data);
+        }
+    }
+}
+
+inline void UploadService::stage(std::shared_ptr<Resource> resource, const std::vector<unsigned char>& data)
+{
+    /// Published to the render thread along with the first chunk
+    resource->size = data.size();
+    resource->remaining = data.size();
+
+    /// Texture chunks hold whole rows
+    std::size_t step = chunkSize;
+    if(resource->target == GL_TEXTURE_2D)
+    {
+        const std::size_t row = resource->width * 4;
+        step = chunkSize / row * row;
+    }
+
+    for(std::size_t offset = 0; offset < data.size(); offset += step)
+    {
+        Chunk chunk;
+        chunk.resource = offset + step < data.size() ? resource : std::move(resource);
+        chunk.targetOffset = offset;
+        chunk.size = std::min(step, data.size() - offset);
+        const std::size_t aligned = (chunk.size + detail::STAGING_ALIGNMENT - 1) / detail::STAGING_ALIGNMENT * detail::STAGING_ALIGNMENT;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            /// Never split a chunk across the end of the ring -- skip the tail instead
+            auto padding = [&]
+            {
+                return ringHead + aligned > ringCapacity ? ringCapacity - ringHead : 0;
+            };
+            wakeWorker.wait(guard, [&]
+            {
+                return stopping || ringUsed + padding() + aligned <= ringCapacity;
+            });
+            if(stopping)
+            {
+                /// Never issued, only released by the render thread along with this UploadService
+                staged.push_back(std::move(chunk));
+                return;
+            }
+            chunk.reserved = padding() + aligned;
+            chunk.ringOffset = padding() == 0 ? ringHead : 0;
+            ringHead = (chunk.ringOffset + aligned) % ringCapacity;
+            ringUsed += chunk.reserved;
+        }
+
+        /// The ring is coherently mapped, so a plain copy is visible to the copies issued later
+        std::memcpy(mapping + chunk.ringOffset, &data[offset], chunk.size);
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            staged.push_back(std::move(chunk));
+        }
+    }
+}
+
+inline void UploadService::fail(const std::shared_ptr<Resource>& resource, const std::string& error)
+{
+    resource->error = error;
+    resource->state.store(Resource::State::FAILED, std::memory_order_release);
+    --pending;
+}
+
+inline void UploadService::retire(GLuint64 timeout)
+{
+    std::size_t released = 0;
+    while(!flights.empty())
+    {
+        GLenum status = glClientWaitSync(flights.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        /// Only the first fence may be waited upon
+        timeout = 0;
+        glDeleteSync(flights.front().fence);
+        for(Chunk& chunk : flights.front().chunks)
+        {
+            released += chunk.reserved;
+            Resource& resource = *chunk.resource;
+            resource.remaining -= chunk.size;
+            if(resource.remaining == 0)
+            {
+                resource.state.store(Resource::State::RESIDENT, std::memory_order_release);
+                ++statistics.resourcesCompleted;
+                --pending;
+            }
+        }
+        flights.pop_front();
+    }
+
+    if(released != 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ringTail = (ringTail + released) % ringCapacity;
+            ringUsed -= released;
+        }
+        wakeWorker.notify_all();
+    }
+}
+
+inline void UploadService::issue(const Chunk& chunk)
+{
+    Resource& resource = *chunk.resource;
+    if(resource.target == GL_TEXTURE_2D)
+    {
+        /// Restore the binding of the active unit, which the TextureUnits shadow
+        GLint preserved = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &preserved);
+        if(resource.name == 0)
+        {
+            glGenTextures(1, &resource.name);
+            glBindTexture(GL_TEXTURE_2D, resource.name);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, static_cast<GLsizei>(resource.width), static_cast<GLsizei>(resource.height));
+        }
+        const std::size_t row = resource.width * 4;
+        glBindTexture(GL_TEXTURE_2D, resource.name);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(chunk.targetOffset / row), static_cast<GLsizei>(resource.width),
+                static_cast<GLsizei>(chunk.size / row), GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const GLvoid*>(chunk.ringOffset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(preserved));
+    }
+    else
+    {
+        if(resource.name == 0)
+        {
+            glGenBuffers(1, &resource.name);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, resource.name);
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(resource.size), nullptr, GL_STATIC_DRAW);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, ring);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, resource.name);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(chunk.ringOffset),
+                static_cast<GLintptr>(chunk.targetOffset), static_cast<GLsizeiptr>(chunk.size));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+}
+
+}
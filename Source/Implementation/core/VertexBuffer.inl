@@ -43,7 +43,7 @@ namespace detail
      * @throw AttributeNotFoundException if no such attribute exists
      * 
      */
-    GLint getAttribLocation(GLuint handle, const std::string& name)
+    inline GLint getAttribLocation(GLuint handle, const std::string& name)
     {
         dynamic_assert(handle != 0, "No program is currently bound, and as such attribute lookup has failed");
         /// Call should never fail
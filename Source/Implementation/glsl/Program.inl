@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <initializer_list>
 #include <functional>
 #include <tuple>
+#include <vector>
 
 #include "BindException.hpp"
 #include "dynamic_warn.hpp"
+#include "GeometryArena.hpp"
 #include "LinkingError.hpp"
 #include "ResourceException.hpp"
 #include "Tuple.hpp"
@@ -58,7 +63,7 @@ namespace detail
         static_assert(TypeChecker<ConversionChecker, Args...>::value, "Type mismatch detected");
     };
 
-    GLint getUniformLocation(GLuint handle, const std::string& uniformID)
+    inline GLint getUniformLocation(GLuint handle, const std::string& uniformID)
     {
         GLint location = glGetUniformLocation(handle,
                 static_cast<const GLchar*>(uniformID.c_str()));
@@ -258,28 +263,85 @@ namespace detail
         }
     };
 
-    /// A helper class that binds the requested program object at 
-    /// construction and likewise restores the previously bound program 
-    /// upon destruction.
+    /// A helper class that binds the requested program object on the 
+    /// first call to bind() and likewise restores the previously bound 
+    /// program upon destruction.  Uniform updates that are skipped thus 
+    /// never touch the binding.
 
     class BindHelper
     {
+        GLuint handle;
         GLint preserved;
+        bool bound;
 
       public:
 
-        BindHelper(GLuint handle)
+        BindHelper(GLuint handle) : handle(handle), preserved(0), bound(false)
         {
-            glGetIntegerv(GL_CURRENT_PROGRAM, &preserved);
-            glUseProgram(handle);
+
+        }
+
+        void bind()
+        {
+            if(!bound)
+            {
+                glGetIntegerv(GL_CURRENT_PROGRAM, &preserved);
+                glUseProgram(handle);
+                bound = true;
+            }
         }
 
         ~BindHelper()
         {
-            glUseProgram(preserved);
+            if(bound)
+            {
+                glUseProgram(preserved);
+            }
         }
     };
 
+    /// Distinguishes the Matrix values of Program::setUniforms from Tuples
+    template<typename T>
+    struct IsMatrix : std::false_type
+    {
+    };
+
+    template<typename T, std::size_t Rows, std::size_t Columns>
+    struct IsMatrix<midnight::Matrix<T, Rows, Columns>> : std::true_type
+    {
+    };
+
+    /// The GL type of a glUniform update with the provided scalar type and component count
+    template<typename T, std::size_t Components>
+    struct UniformType
+    {
+        static constexpr GLenum value = GL_NONE;
+    };
+
+    template<> struct UniformType<GLfloat, 1> { static constexpr GLenum value = GL_FLOAT; };
+    template<> struct UniformType<GLfloat, 2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+    template<> struct UniformType<GLfloat, 3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+    template<> struct UniformType<GLfloat, 4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+    template<> struct UniformType<GLint, 1> { static constexpr GLenum value = GL_INT; };
+    template<> struct UniformType<GLint, 2> { static constexpr GLenum value = GL_INT_VEC2; };
+    template<> struct UniformType<GLint, 3> { static constexpr GLenum value = GL_INT_VEC3; };
+    template<> struct UniformType<GLint, 4> { static constexpr GLenum value = GL_INT_VEC4; };
+    template<> struct UniformType<GLuint, 1> { static constexpr GLenum value = GL_UNSIGNED_INT; };
+    template<> struct UniformType<GLuint, 2> { static constexpr GLenum value = GL_UNSIGNED_INT_VEC2; };
+    template<> struct UniformType<GLuint, 3> { static constexpr GLenum value = GL_UNSIGNED_INT_VEC3; };
+    template<> struct UniformType<GLuint, 4> { static constexpr GLenum value = GL_UNSIGNED_INT_VEC4; };
+
+    /// The GL type of a glUniformMatrix update with the provided dimensions
+    template<std::size_t Rows, std::size_t Columns>
+    struct MatrixUniformType
+    {
+        static constexpr GLenum value = GL_NONE;
+    };
+
+    template<> struct MatrixUniformType<2, 2> { static constexpr GLenum value = GL_FLOAT_MAT2; };
+    template<> struct MatrixUniformType<3, 3> { static constexpr GLenum value = GL_FLOAT_MAT3; };
+    template<> struct MatrixUniformType<4, 4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
     /// A helper class that attaches the provided shaders at construction, 
     /// and likewise detaches them at destruction, ensuring proper resource 
     /// cleanup even in exceptional circumstances.
@@ -287,11 +349,11 @@ namespace detail
     class LinkHelper
     {
         GLuint handle;
-        const std::initializer_list<Shader*>& shaders;
+        const std::vector<Shader*>& shaders;
 
       public:
 
-        LinkHelper(GLuint handle, const std::initializer_list<Shader*>& shaders) :
+        LinkHelper(GLuint handle, const std::vector<Shader*>& shaders) :
         handle(handle),
         shaders(shaders)
         {
@@ -322,7 +384,13 @@ namespace detail
     };
 }
 
-Program::Program(const std::initializer_list<Shader*>& shaders) :
+inline Program::Program(const std::initializer_list<Shader*>& shaders) :
+Program(std::vector<Shader*>(shaders))
+{
+
+}
+
+inline Program::Program(const std::vector<Shader*>& shaders) :
 handle(glCreateProgram())
 {
     /// Implementation must return '0' on error
@@ -360,6 +428,34 @@ handle(glCreateProgram())
     }
 }
 
+inline Program::Program(GLenum binaryFormat, const std::vector<unsigned char>& binary) :
+handle(glCreateProgram())
+{
+    if(handle == 0)
+    {
+        throw midnight::ResourceException("implementation failed to create program");
+    }
+    glProgramBinary(handle, binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    /// Sets GL_INVALID_ENUM for unknown formats, which is as good as a rejection
+    glGetError();
+
+    GLint result;
+    glGetProgramiv(handle, GL_LINK_STATUS, &result);
+    if(result == GL_FALSE)
+    {
+        /// Unlike a failed link, nothing here is worth keeping around for inspection
+        glDeleteProgram(handle);
+        handle = 0;
+        throw midnight::glsl::LinkingError("The implementation rejected the program binary");
+    }
+}
+
+inline Program::Program(GLuint handle) noexcept :
+handle(handle)
+{
+
+}
+
 template<typename ...E>
 inline Program::Program(std::shared_ptr<Shader> first, E&&... shaders) :
 Program({first.get(), shaders.get()...})
@@ -380,7 +476,11 @@ inline Program::Program(Shader& first, E&... shaders) : Program({&first, &shader
 
 }
 
-Program::Program(Program&& other) : handle(other.handle)
+inline Program::Program(Program&& other) :
+handle(other.handle),
+shadows(std::move(other.shadows)),
+uniformStatistics(other.uniformStatistics),
+reflection(std::move(other.reflection))
 {
     /// Copy-constructing from self would create a resource leak!
     if(&other != this)
@@ -393,11 +493,17 @@ Program::Program(Program&& other) : handle(other.handle)
     }
 }
 
-Program& Program::operator=(Program&& other)
+inline Program& Program::operator=(Program&& other)
 {
     if(&other != this)
     {
+        /// Call should never fail
+        glDeleteProgram(this->handle);
+        midnight::GeometryArena::forgetProgram(this->handle);
         this->handle = other.handle;
+        this->shadows = std::move(other.shadows);
+        this->uniformStatistics = other.uniformStatistics;
+        this->reflection = std::move(other.reflection);
         other.handle = 0;
     }
     else
@@ -407,7 +513,15 @@ Program& Program::operator=(Program&& other)
     return *this;
 }
 
-void Program::bind()
+inline Program::~Program()
+{
+    /// Silently ignores the zero handle of moved-from Programs
+    glDeleteProgram(handle);
+    /// The implementation may give the name to the next program
+    midnight::GeometryArena::forgetProgram(handle);
+}
+
+inline void Program::bind()
 {
     /// It's a bit...ambiguous why this might fail...
     /// Spec designers dropped the ball on this one.
@@ -419,7 +533,7 @@ void Program::bind()
     }
 }
 
-void Program::unbind()
+inline void Program::unbind()
 {
     GLint current;
     glGetIntegerv(GL_CURRENT_PROGRAM, &current);
@@ -442,6 +556,14 @@ void Program::unbind()
 
 template<typename... E>
 void Program::setUniform(const std::string& uniformID, E&&... tuples)
+{
+    /// Use RAII to temporarily bind this program, if anything must be sent
+    detail::BindHelper binder(handle);
+    applyUniform(binder, uniformID, std::forward<E>(tuples)...);
+}
+
+template<typename... E>
+void Program::applyUniform(detail::BindHelper& binder, const std::string& uniformID, E&&... tuples)
 {
     /// Compile-time assertion that the tuples aren't mixed and matched...
     detail::TypeCheckAssertion < E...>();
@@ -453,27 +575,25 @@ void Program::setUniform(const std::string& uniformID, E&&... tuples)
     static_assert((N / sizeof...(E)) > 0 && (N / sizeof...(E)) < 5, "Invalid uniform array element type");
 
     /// Can fail with an exception, so try this before copying the provided tuples
-    GLint uniformLocation = detail::getUniformLocation(handle, uniformID);
+    UniformShadow& shadow = shadowOf(uniformID);
+#if defined(MIDNIGHT_UNIFORM_VALIDATION)
+    validate(shadow, uniformID, detail::UniformType<T, N / sizeof...(E)>::value, sizeof...(E));
+#endif
 
     /// Copy the provided tuples into a monolithic array to pass to the GPU
     std::array<T, N> array;
     detail::copyTupleToArray(detail::tuple_cat(std::forward<E>(tuples)...), array);
 
-    /// Use RAII to temporarily bind this program
-    detail::BindHelper binder(handle);
+    if(!update(shadow, &array[0], sizeof(array)))
+    {
+        return;
+    }
+    binder.bind();
     
     /// <N, I>
     /// Invoke the correct call to the implementation
-    detail::UniformArrayHelper<T, N, N / sizeof...(tuples), sizeof...(tuples)>::glUniformXXX(uniformLocation, array);
-        
-    /// Apparently, a shitload of things can go wrong...
-    /// http://www.opengl.org/sdk/docs/man4/xhtml/glUniform.xml
-    GLenum error = glGetError();
-    if(error == GL_INVALID_OPERATION)
-    {
-        throw midnight::glsl::UniformMismatchException(std::string("The provided uniform type \"") + uniformID +
-                "\" is incompatible with the type declared in the program");
-    }
+    detail::UniformArrayHelper<T, N, N / sizeof...(tuples), sizeof...(tuples)>::glUniformXXX(shadow.location, array);
+
 }
 
 namespace detail
@@ -509,7 +629,182 @@ namespace detail
 template<typename T, std::size_t Rows, std::size_t Columns>
 void Program::setMatrixUniform(const std::string& uniformID, const midnight::Matrix<T, Rows, Columns>& matrix)
 {
-    GLint uniformLocation = detail::getUniformLocation(handle, uniformID);
     detail::BindHelper binder(handle);
-    detail::MatrixUniformHelper<T, Rows, Columns>::setUniform(uniformLocation, matrix);
+    applyMatrixUniform(binder, uniformID, matrix);
+}
+
+template<typename T, std::size_t Rows, std::size_t Columns>
+void Program::applyMatrixUniform(detail::BindHelper& binder, const std::string& uniformID, const midnight::Matrix<T, Rows, Columns>& matrix)
+{
+    UniformShadow& shadow = shadowOf(uniformID);
+#if defined(MIDNIGHT_UNIFORM_VALIDATION)
+    validate(shadow, uniformID, detail::MatrixUniformType<Rows, Columns>::value, 1);
+#endif
+    if(update(shadow, &matrix, Rows * Columns * sizeof(T)))
+    {
+        binder.bind();
+        detail::MatrixUniformHelper<T, Rows, Columns>::setUniform(shadow.location, matrix);
+    }
+}
+
+template<typename... E>
+void Program::setUniforms(E&&... uniforms)
+{
+    static_assert(sizeof...(E) % 2 == 0, "Uniform names and values must be provided in pairs");
+    /// A single binding serves every update of the batch
+    detail::BindHelper binder(handle);
+    applyUniforms(binder, std::forward<E>(uniforms)...);
+}
+
+inline void Program::applyUniforms(detail::BindHelper&)
+{
+    /// Recursion's End
+}
+
+template<typename V, typename... E>
+void Program::applyUniforms(detail::BindHelper& binder, const std::string& uniformID, V&& value, E&&... remaining)
+{
+    applyAny(binder, uniformID, value, detail::IsMatrix<typename std::decay<V>::type>());
+    applyUniforms(binder, std::forward<E>(remaining)...);
+}
+
+template<typename V>
+void Program::applyAny(detail::BindHelper& binder, const std::string& uniformID, const V& matrix, std::true_type)
+{
+    applyMatrixUniform(binder, uniformID, matrix);
+}
+
+template<typename V>
+void Program::applyAny(detail::BindHelper& binder, const std::string& uniformID, const V& value, std::false_type)
+{
+    applyUniform(binder, uniformID, value);
+}
+
+inline std::vector<unsigned char> Program::getBinary(GLenum& binaryFormat) const
+{
+    GLint length = 0;
+    glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+    std::vector<unsigned char> binary(static_cast<std::size_t>(std::max(length, 0)));
+    if(!binary.empty())
+    {
+        GLsizei written = 0;
+        glGetProgramBinary(handle, length, &written, &binaryFormat, binary.data());
+        binary.resize(static_cast<std::size_t>(written));
+    }
+    if(binary.empty())
+    {
+        throw midnight::ResourceException("The implementation did not provide a binary for the program");
+    }
+    return binary;
+}
+
+inline const midnight::ProgramReflection& Program::getReflection() const
+{
+    if(!reflection)
+    {
+        reflection.reset(new midnight::ProgramReflection(handle));
+    }
+    return *reflection;
+}
+
+inline void Program::validate(const UniformShadow& shadow, const std::string& uniformID, GLenum type, std::size_t count) const
+{
+    /// Unknown declarations (which the implementation located anyway) are left alone
+    if(shadow.type == GL_NONE)
+    {
+        return;
+    }
+    if(!midnight::ProgramReflection::isCompatible(shadow.type, type) || count > static_cast<std::size_t>(shadow.size))
+    {
+        throw midnight::glsl::UniformMismatchException(std::string("The uniform \"") + uniformID + "\" is declared as " +
+                midnight::ProgramReflection::getTypeName(shadow.type) + "[" + std::to_string(shadow.size) + "], but was set to " +
+                std::to_string(count) + " " + midnight::ProgramReflection::getTypeName(type));
+    }
+}
+
+inline bool Program::bindUniformBlock(const std::string& blockID, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(handle, static_cast<const GLchar*>(blockID.c_str()));
+    /// Blocks that are not declared (or were optimized away) have no index
+    if(index == GL_INVALID_INDEX)
+    {
+        return false;
+    }
+    glUniformBlockBinding(handle, index, binding);
+    return true;
+}
+
+inline const Program::UniformStatistics& Program::getUniformStatistics() const noexcept
+{
+    return uniformStatistics;
+}
+
+inline void Program::resetUniformStatistics() noexcept
+{
+    uniformStatistics = UniformStatistics();
+}
+
+inline const Program::UniformStatistics& Program::getTotalUniformStatistics() noexcept
+{
+    return totalUniformStatistics();
+}
+
+inline void Program::resetTotalUniformStatistics() noexcept
+{
+    totalUniformStatistics() = UniformStatistics();
+}
+
+inline Program::UniformStatistics& Program::totalUniformStatistics() noexcept
+{
+    static UniformStatistics statistics;
+    return statistics;
+}
+
+inline Program::UniformShadow& Program::shadowOf(const std::string& uniformID)
+{
+    auto found = shadows.find(uniformID);
+    if(found != shadows.end())
+    {
+        return found->second;
+    }
+    /// Locations are fixed at link time, so the query is only ever made once per uniform
+    UniformShadow shadow;
+    shadow.location = detail::getUniformLocation(handle, uniformID);
+    shadow.type = GL_NONE;
+    shadow.size = 0;
+#if defined(MIDNIGHT_UNIFORM_VALIDATION)
+    const midnight::ProgramReflection::Uniform* declared = getReflection().findUniform(uniformID);
+    std::size_t bracket = uniformID.rfind('[');
+    if(declared == nullptr && bracket != std::string::npos)
+    {
+        /// An element of an array, e.g. "lights[2]", spans the remainder of the array
+        declared = getReflection().findUniform(uniformID.substr(0, bracket));
+        if(declared != nullptr)
+        {
+            shadow.type = declared->type;
+            shadow.size = declared->size - std::atoi(uniformID.c_str() + bracket + 1);
+        }
+    }
+    else if(declared != nullptr)
+    {
+        shadow.type = declared->type;
+        shadow.size = declared->size;
+    }
+#endif
+    return shadows.emplace(uniformID, std::move(shadow)).first->second;
+}
+
+inline bool Program::update(UniformShadow& shadow, const void* value, std::size_t size)
+{
+    if(shadow.value.size() == size && std::memcmp(&shadow.value[0], value, size) == 0)
+    {
+        ++uniformStatistics.skipped;
+        ++totalUniformStatistics().skipped;
+        return false;
+    }
+    const unsigned char* bytes = static_cast<const unsigned char*>(value);
+    shadow.value.assign(bytes, bytes + size);
+    ++uniformStatistics.issued;
+    ++totalUniformStatistics().issued;
+    return true;
 }
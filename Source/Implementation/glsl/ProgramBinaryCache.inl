@@ -0,0 +1,255 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+#if defined(MIDNIGHT_WINDOWS)
+#    include <direct.h>
+#else
+#    include <sys/stat.h>
+#endif
+
+#include "IllegalArgumentException.hpp"
+#include "LinkingError.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    /// Identifies (and versions) the files of a ProgramBinaryCache
+    constexpr std::uint32_t PROGRAM_BINARY_MAGIC = 0x3142504D;
+
+    inline std::uint64_t fnv1a(const void* data, std::size_t size, std::uint64_t hash) noexcept
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+inline ProgramBinaryCache::ProgramBinaryCache(const std::string& directory) :
+    directory(directory),
+    supported(false)
+{
+    if(!this->directory.empty() && this->directory.back() != '/' && this->directory.back() != '\\')
+    {
+        this->directory += '/';
+    }
+    /// Fails harmlessly if the directory exists; if it cannot be created, writes fail later
+#if defined(MIDNIGHT_WINDOWS)
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+inline Program ProgramBinaryCache::load(const std::vector<Stage>& stages, const std::vector<std::string>& defines)
+{
+    std::unique_ptr<Program> cached = find(stages, defines);
+    if(cached)
+    {
+        return std::move(*cached);
+    }
+    std::vector<Stage> defined(stages);
+    for(Stage& stage : defined)
+    {
+        stage.source = detail::injectDefines(stage.source, defines);
+    }
+    Program program = compile(defined);
+    store(stages, defines, program);
+    return program;
+}
+
+inline std::unique_ptr<Program> ProgramBinaryCache::find(const std::vector<Stage>& stages, const std::vector<std::string>& defines)
+{
+    queryImplementation();
+    GLenum format;
+    std::vector<unsigned char> binary;
+    if(!supported || !read(computeKey(stages, defines), format, binary))
+    {
+        ++statistics.misses;
+        return nullptr;
+    }
+    try
+    {
+        std::unique_ptr<Program> program(new Program(format, binary));
+        ++statistics.hits;
+        return program;
+    }
+    catch(const glsl::LinkingError&)
+    {
+        /// Typically a driver update that kept its version string; store replaces the entry
+        ++statistics.rejected;
+        return nullptr;
+    }
+}
+
+inline void ProgramBinaryCache::store(const std::vector<Stage>& stages, const std::vector<std::string>& defines, const Program& program)
+{
+    queryImplementation();
+    if(!supported)
+    {
+        return;
+    }
+    try
+    {
+        GLenum format;
+        std::vector<unsigned char> binary = program.getBinary(format);
+        write(computeKey(stages, defines), format, binary);
+    }
+    catch(const ResourceException&)
+    {
+        /// The Program is perfectly usable, it just will not be cached
+    }
+}
+
+inline Program ProgramBinaryCache::load(const std::string& vertexSource, const std::string& fragmentSource, const std::vector<std::string>& defines)
+{
+    return load(std::vector<Stage>{Stage{GL_VERTEX_SHADER, vertexSource}, Stage{GL_FRAGMENT_SHADER, fragmentSource}}, defines);
+}
+
+inline const ProgramBinaryCache::Statistics& ProgramBinaryCache::getStatistics() const noexcept
+{
+    return statistics;
+}
+
+inline void ProgramBinaryCache::queryImplementation()
+{
+    if(!implementation.empty())
+    {
+        return;
+    }
+    for(GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const GLubyte* string = glGetString(name);
+        implementation += string != nullptr ? reinterpret_cast<const char*>(string) : "";
+        implementation += '\n';
+    }
+    /// Implementations without ARB_get_program_binary reject the query and leave the count at zero
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetError();
+    supported = formats > 0;
+}
+
+inline std::uint64_t ProgramBinaryCache::computeKey(const std::vector<Stage>& stages, const std::vector<std::string>& defines) const
+{
+    /// Every field is followed by a separator, so that no two inputs concatenate to the same bytes
+    const char separator = '\0';
+    std::uint64_t hash = detail::fnv1a(implementation.data(), implementation.size());
+    for(const Stage& stage : stages)
+    {
+        hash = detail::fnv1a(&stage.type, sizeof(stage.type), hash);
+        hash = detail::fnv1a(stage.source.data(), stage.source.size(), hash);
+        hash = detail::fnv1a(&separator, 1, hash);
+    }
+    for(const std::string& define : defines)
+    {
+        hash = detail::fnv1a(define.data(), define.size(), hash);
+        hash = detail::fnv1a(&separator, 1, hash);
+    }
+    return hash;
+}
+
+inline std::string ProgramBinaryCache::pathOf(std::uint64_t key) const
+{
+    std::ostringstream path;
+    path << directory << std::hex << key << ".bin";
+    return path.str();
+}
+
+inline bool ProgramBinaryCache::read(std::uint64_t key, GLenum& format, std::vector<unsigned char>& binary) const
+{
+    std::ifstream stream(pathOf(key), std::ios::binary);
+    if(!stream)
+    {
+        return false;
+    }
+    std::uint32_t magic = 0;
+    std::uint64_t storedKey = 0;
+    std::uint32_t storedFormat = 0;
+    std::uint64_t length = 0;
+    stream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    stream.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+    stream.read(reinterpret_cast<char*>(&storedFormat), sizeof(storedFormat));
+    stream.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if(!stream || magic != detail::PROGRAM_BINARY_MAGIC || storedKey != key || length == 0 || length > (1ULL << 30))
+    {
+        return false;
+    }
+    binary.resize(static_cast<std::size_t>(length));
+    stream.read(reinterpret_cast<char*>(binary.data()), static_cast<std::streamsize>(length));
+    format = static_cast<GLenum>(storedFormat);
+    /// A truncated file is treated as missing
+    return static_cast<bool>(stream);
+}
+
+inline void ProgramBinaryCache::write(std::uint64_t key, GLenum format, const std::vector<unsigned char>& binary) const
+{
+    const std::string path = pathOf(key);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        const std::uint32_t magic = detail::PROGRAM_BINARY_MAGIC;
+        const std::uint32_t storedFormat = static_cast<std::uint32_t>(format);
+        const std::uint64_t length = binary.size();
+        stream.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        stream.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        stream.write(reinterpret_cast<const char*>(&storedFormat), sizeof(storedFormat));
+        stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        stream.write(reinterpret_cast<const char*>(binary.data()), static_cast<std::streamsize>(binary.size()));
+        if(!stream)
+        {
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    /// rename does not replace existing files everywhere
+    std::remove(path.c_str());
+    if(std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+    }
+}
+
+inline Program ProgramBinaryCache::compile(const std::vector<Stage>& stages)
+{
+    std::vector<std::unique_ptr<Shader>> shaders;
+    for(const Stage& stage : stages)
+    {
+        switch(stage.type)
+        {
+            case GL_VERTEX_SHADER:
+                shaders.emplace_back(new VertexShader(stage.source));
+                break;
+            case GL_TESS_CONTROL_SHADER:
+                shaders.emplace_back(new TessControlShader(stage.source));
+                break;
+            case GL_TESS_EVALUATION_SHADER:
+                shaders.emplace_back(new TessEvaluationShader(stage.source));
+                break;
+            case GL_GEOMETRY_SHADER:
+                shaders.emplace_back(new GeometryShader(stage.source));
+                break;
+            case GL_FRAGMENT_SHADER:
+                shaders.emplace_back(new FragmentShader(stage.source));
+                break;
+            default:
+                throw IllegalArgumentException("Unsupported shader stage type");
+        }
+    }
+    std::vector<Shader*> pointers;
+    for(const std::unique_ptr<Shader>& shader : shaders)
+    {
+        pointers.push_back(shader.get());
+    }
+    return Program(pointers);
+}
+
+}
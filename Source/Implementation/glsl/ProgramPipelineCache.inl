@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cstring>
+
+#include "IllegalArgumentException.hpp"
+#include "LinkingError.hpp"
+#include "ResourceException.hpp"
+#include "dynamic_warn.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    /// The glUseProgramStages bit of a shader type (zero for types that are no pipeline stage)
+    inline GLbitfield stageBit(GLenum type) noexcept
+    {
+        switch(type)
+        {
+            case GL_VERTEX_SHADER:
+                return GL_VERTEX_SHADER_BIT;
+            case GL_TESS_CONTROL_SHADER:
+                return GL_TESS_CONTROL_SHADER_BIT;
+            case GL_TESS_EVALUATION_SHADER:
+                return GL_TESS_EVALUATION_SHADER_BIT;
+            case GL_GEOMETRY_SHADER:
+                return GL_GEOMETRY_SHADER_BIT;
+            case GL_FRAGMENT_SHADER:
+                return GL_FRAGMENT_SHADER_BIT;
+            default:
+                return 0;
+        }
+    }
+}
+
+inline ProgramPipelineCache::ProgramPipelineCache() :
+    bound(0),
+    supported(false)
+{
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    supported = major > 4 || (major == 4 && minor >= 1);
+
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for(GLint i = 0; i < extensions && !supported; ++i)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        supported = std::strcmp(extension, "GL_ARB_separate_shader_objects") == 0;
+    }
+}
+
+inline ProgramPipelineCache::~ProgramPipelineCache()
+{
+    if(bound != 0)
+    {
+        glBindProgramPipeline(0);
+    }
+    for(const auto& pipeline : pipelines)
+    {
+        /// Call should never fail
+        glDeleteProgramPipelines(1, &pipeline.second.handle);
+    }
+}
+
+inline bool ProgramPipelineCache::isSupported() const noexcept
+{
+    return supported;
+}
+
+inline std::shared_ptr<Program> ProgramPipelineCache::acquireStage(GLenum type, const std::string& source)
+{
+    if(detail::stageBit(type) == 0)
+    {
+        throw IllegalArgumentException(std::string("The shader type ") + std::to_string(type) + " is no program pipeline stage");
+    }
+    if(!supported)
+    {
+        throw ResourceException("The implementation does not support separable programs");
+    }
+
+    const std::uint64_t key = detail::fnv1a(source.data(), source.size(), detail::fnv1a(&type, sizeof(type)));
+    auto range = stages.equal_range(key);
+    for(auto entry = range.first; entry != range.second;)
+    {
+        std::shared_ptr<Program> program = entry->second.program.lock();
+        if(!program)
+        {
+            /// Drop stages whose users are all gone
+            entry = stages.erase(entry);
+            continue;
+        }
+        if(entry->second.stage.type == type && entry->second.stage.source == source)
+        {
+            ++statistics.stagesShared;
+            return program;
+        }
+        ++entry;
+    }
+
+    /// Compiles, marks the program separable, links, and detaches the shader in one call
+    const GLchar* string = source.c_str();
+    GLuint handle = glCreateShaderProgramv(type, 1, &string);
+    if(handle == 0)
+    {
+        throw ResourceException("implementation failed to create program");
+    }
+    GLint result;
+    glGetProgramiv(handle, GL_LINK_STATUS, &result);
+    if(result == GL_FALSE)
+    {
+        /// The info log of the program holds the compiler log as well
+        glGetProgramiv(handle, GL_INFO_LOG_LENGTH, &result);
+        std::string log(static_cast<std::size_t>(std::max(result, 1)), '\0');
+        glGetProgramInfoLog(handle, result, nullptr, &log[0]);
+        glDeleteProgram(handle);
+        throw glsl::LinkingError(log.c_str());
+    }
+
+    std::shared_ptr<Program> program(new Program(handle));
+    stages.emplace(key, StageEntry{ProgramBinaryCache::Stage{type, source}, program});
+    ++statistics.stagesCreated;
+    return program;
+}
+
+inline void ProgramPipelineCache::bind(std::initializer_list<std::shared_ptr<Program>> stages)
+{
+    std::uint64_t key = detail::fnv1a(nullptr, 0);
+    for(const std::shared_ptr<Program>& stage : stages)
+    {
+        const Program* address = stage.get();
+        key = detail::fnv1a(&address, sizeof(address), key);
+    }
+
+    GLuint handle = 0;
+    auto range = pipelines.equal_range(key);
+    for(auto entry = range.first; entry != range.second && handle == 0; ++entry)
+    {
+        const std::vector<std::weak_ptr<Program>>& assembled = entry->second.stages;
+        /// Compares ownership rather than addresses, which a new stage may have inherited from a dead one
+        handle = assembled.size() == stages.size() && std::equal(assembled.begin(), assembled.end(), stages.begin(),
+                [](const std::weak_ptr<Program>& a, const std::shared_ptr<Program>& b)
+                {
+                    return !a.owner_before(b) && !b.owner_before(a);
+                }) ? entry->second.handle : 0;
+    }
+    if(handle == 0)
+    {
+        handle = assemble(std::vector<std::shared_ptr<Program>>(stages));
+        pipelines.emplace(key, PipelineEntry{std::vector<std::weak_ptr<Program>>(stages.begin(), stages.end()), handle});
+    }
+
+    /// A bound Program takes precedence over the bound pipeline
+    glUseProgram(0);
+    if(handle != bound)
+    {
+        glBindProgramPipeline(handle);
+        bound = handle;
+        ++statistics.pipelineSwitches;
+    }
+}
+
+inline void ProgramPipelineCache::bind(const std::shared_ptr<Program>& vertexStage, const std::shared_ptr<Program>& fragmentStage)
+{
+    bind({vertexStage, fragmentStage});
+}
+
+inline void ProgramPipelineCache::unbind()
+{
+    glBindProgramPipeline(0);
+    bound = 0;
+}
+
+inline std::size_t ProgramPipelineCache::collect()
+{
+    std::size_t deleted = 0;
+    for(auto entry = pipelines.begin(); entry != pipelines.end();)
+    {
+        bool expired = false;
+        for(const std::weak_ptr<Program>& stage : entry->second.stages)
+        {
+            expired = expired || stage.expired();
+        }
+        if(!expired)
+        {
+            ++entry;
+            continue;
+        }
+        if(entry->second.handle == bound)
+        {
+            unbind();
+        }
+        glDeleteProgramPipelines(1, &entry->second.handle);
+        entry = pipelines.erase(entry);
+        ++deleted;
+    }
+    return deleted;
+}
+
+inline std::size_t ProgramPipelineCache::getPipelineCount() const noexcept
+{
+    return pipelines.size();
+}
+
+inline const ProgramPipelineCache::Statistics& ProgramPipelineCache::getStatistics() const noexcept
+{
+    return statistics;
+}
+
+inline GLuint ProgramPipelineCache::assemble(const std::vector<std::shared_ptr<Program>>& stages)
+{
+    /// Look up every bit before creating anything that would have to be cleaned up
+    std::vector<GLbitfield> bits;
+    GLbitfield used = 0;
+    for(const std::shared_ptr<Program>& stage : stages)
+    {
+        bits.push_back(stageBitOf(*stage));
+        if((used & bits.back()) != 0)
+        {
+            throw IllegalArgumentException("A program pipeline may only hold one stage of each type");
+        }
+        used |= bits.back();
+    }
+
+    GLuint handle = 0;
+    glGenProgramPipelines(1, &handle);
+    if(handle == 0)
+    {
+        throw ResourceException("implementation failed to create program pipeline");
+    }
+    for(std::size_t i = 0; i < stages.size(); ++i)
+    {
+        glUseProgramStages(handle, bits[i], stages[i]->handle);
+    }
+
+#if defined(MIDNIGHT_UNIFORM_VALIDATION)
+    /// Validation also depends on the current state (e.g. sampler units), so only warn about it
+    glValidateProgramPipeline(handle);
+    GLint valid = GL_TRUE;
+    glGetProgramPipelineiv(handle, GL_VALIDATE_STATUS, &valid);
+    if(valid == GL_FALSE)
+    {
+        GLint length = 0;
+        glGetProgramPipelineiv(handle, GL_INFO_LOG_LENGTH, &length);
+        std::string log(static_cast<std::size_t>(std::max(length, 1)), '\0');
+        glGetProgramPipelineInfoLog(handle, length, nullptr, &log[0]);
+        dynamic_warn(std::string("Program pipeline failed to validate: ") + log.c_str());
+    }
+#endif
+
+    ++statistics.pipelinesCreated;
+    return handle;
+}
+
+inline GLbitfield ProgramPipelineCache::stageBitOf(const Program& stage) const
+{
+    for(const auto& entry : stages)
+    {
+        std::shared_ptr<Program> program = entry.second.program.lock();
+        if(program.get() == &stage)
+        {
+            return detail::stageBit(entry.second.stage.type);
+        }
+    }
+    throw IllegalArgumentException("Only stages acquired from a ProgramPipelineCache may be bound through it");
+}
+
+}
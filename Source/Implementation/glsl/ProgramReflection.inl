@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <memory>
+
+#include "UniformMismatchException.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    /**
+     * Splits a non-matrix GL type into its scalar type and component count
+     *
+     * @return the number of components, or zero for other types
+     *
+     */
+    inline int decomposeType(GLenum type, GLenum& scalar) noexcept
+    {
+        switch(type)
+        {
+            case GL_FLOAT: scalar = GL_FLOAT; return 1;
+            case GL_FLOAT_VEC2: scalar = GL_FLOAT; return 2;
+            case GL_FLOAT_VEC3: scalar = GL_FLOAT; return 3;
+            case GL_FLOAT_VEC4: scalar = GL_FLOAT; return 4;
+            case GL_INT: scalar = GL_INT; return 1;
+            case GL_INT_VEC2: scalar = GL_INT; return 2;
+            case GL_INT_VEC3: scalar = GL_INT; return 3;
+            case GL_INT_VEC4: scalar = GL_INT; return 4;
+            case GL_UNSIGNED_INT: scalar = GL_UNSIGNED_INT; return 1;
+            case GL_UNSIGNED_INT_VEC2: scalar = GL_UNSIGNED_INT; return 2;
+            case GL_UNSIGNED_INT_VEC3: scalar = GL_UNSIGNED_INT; return 3;
+            case GL_UNSIGNED_INT_VEC4: scalar = GL_UNSIGNED_INT; return 4;
+            case GL_BOOL: scalar = GL_BOOL; return 1;
+            case GL_BOOL_VEC2: scalar = GL_BOOL; return 2;
+            case GL_BOOL_VEC3: scalar = GL_BOOL; return 3;
+            case GL_BOOL_VEC4: scalar = GL_BOOL; return 4;
+            default: scalar = GL_NONE; return 0;
+        }
+    }
+}
+
+inline ProgramReflection::ProgramReflection(GLuint program)
+{
+    GLint count = 0;
+    GLint length = 0;
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &length);
+    std::unique_ptr<GLchar[]> name(new GLchar[std::max(length, 1)]());
+    for(GLint i = 0; i < count; ++i)
+    {
+        Uniform uniform;
+        glGetActiveUniform(program, static_cast<GLuint>(i), std::max(length, 1), nullptr, &uniform.size, &uniform.type, name.get());
+        uniform.name = name.get();
+        uniform.location = glGetUniformLocation(program, name.get());
+        uniforms.push_back(uniform);
+    }
+    if(count > 0)
+    {
+        /// The block layout is queried for all uniforms at once
+        std::vector<GLuint> indices(static_cast<std::size_t>(count));
+        std::vector<GLint> values(static_cast<std::size_t>(count));
+        for(GLint i = 0; i < count; ++i)
+        {
+            indices[static_cast<std::size_t>(i)] = static_cast<GLuint>(i);
+        }
+        const GLenum properties[] = {GL_UNIFORM_BLOCK_INDEX, GL_UNIFORM_OFFSET, GL_UNIFORM_ARRAY_STRIDE, GL_UNIFORM_MATRIX_STRIDE};
+        GLint Uniform::* const members[] = {&Uniform::blockIndex, &Uniform::offset, &Uniform::arrayStride, &Uniform::matrixStride};
+        for(std::size_t p = 0; p < 4; ++p)
+        {
+            glGetActiveUniformsiv(program, count, indices.data(), properties[p], values.data());
+            for(std::size_t i = 0; i < uniforms.size(); ++i)
+            {
+                uniforms[i].*members[p] = values[i];
+            }
+        }
+    }
+    for(std::size_t i = 0; i < uniforms.size(); ++i)
+    {
+        const std::string& uniformName = uniforms[i].name;
+        uniformsByName[uniformName] = i;
+        if(uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+        {
+            uniformsByName[uniformName.substr(0, uniformName.size() - 3)] = i;
+        }
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &length);
+    name.reset(new GLchar[std::max(length, 1)]());
+    for(GLint i = 0; i < count; ++i)
+    {
+        Attribute attribute;
+        glGetActiveAttrib(program, static_cast<GLuint>(i), std::max(length, 1), nullptr, &attribute.size, &attribute.type, name.get());
+        attribute.name = name.get();
+        attribute.location = glGetAttribLocation(program, name.get());
+        attributes.push_back(attribute);
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &length);
+    name.reset(new GLchar[std::max(length, 1)]());
+    for(GLint i = 0; i < count; ++i)
+    {
+        UniformBlock block;
+        block.index = static_cast<GLuint>(i);
+        glGetActiveUniformBlockName(program, block.index, std::max(length, 1), nullptr, name.get());
+        block.name = name.get();
+        glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+        for(std::size_t u = 0; u < uniforms.size(); ++u)
+        {
+            if(uniforms[u].blockIndex == i)
+            {
+                block.members.push_back(u);
+            }
+        }
+        blocks.push_back(block);
+    }
+}
+
+inline const std::vector<ProgramReflection::Uniform>& ProgramReflection::getUniforms() const noexcept
+{
+    return uniforms;
+}
+
+inline const std::vector<ProgramReflection::Attribute>& ProgramReflection::getAttributes() const noexcept
+{
+    return attributes;
+}
+
+inline const std::vector<ProgramReflection::UniformBlock>& ProgramReflection::getUniformBlocks() const noexcept
+{
+    return blocks;
+}
+
+inline std::vector<const ProgramReflection::Uniform*> ProgramReflection::getSamplers() const
+{
+    std::vector<const Uniform*> samplers;
+    for(const Uniform& uniform : uniforms)
+    {
+        if(isSampler(uniform.type))
+        {
+            samplers.push_back(&uniform);
+        }
+    }
+    return samplers;
+}
+
+inline const ProgramReflection::Uniform* ProgramReflection::findUniform(const std::string& name) const
+{
+    auto found = uniformsByName.find(name);
+    return found != uniformsByName.end() ? &uniforms[found->second] : nullptr;
+}
+
+inline const ProgramReflection::Attribute* ProgramReflection::findAttribute(const std::string& name) const
+{
+    for(const Attribute& attribute : attributes)
+    {
+        if(attribute.name == name)
+        {
+            return &attribute;
+        }
+    }
+    return nullptr;
+}
+
+inline const ProgramReflection::UniformBlock* ProgramReflection::findUniformBlock(const std::string& name) const
+{
+    for(const UniformBlock& block : blocks)
+    {
+        if(block.name == name)
+        {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+inline bool ProgramReflection::verifyBlock(const std::string& blockName, std::size_t size,
+        const std::vector<std::pair<std::string, std::size_t>>& offsets) const
+{
+    const UniformBlock* block = findUniformBlock(blockName);
+    if(block == nullptr)
+    {
+        return false;
+    }
+    if(static_cast<std::size_t>(block->dataSize) > size)
+    {
+        throw glsl::UniformMismatchException(std::string("The uniform block \"") + blockName + "\" occupies " +
+                std::to_string(block->dataSize) + " bytes, but its struct only " + std::to_string(size));
+    }
+    for(const std::pair<std::string, std::size_t>& member : offsets)
+    {
+        /// Members of blocks with an instance name are reported with the block name as a prefix
+        const Uniform* uniform = findUniform(blockName + "." + member.first);
+        uniform = uniform != nullptr ? uniform : findUniform(member.first);
+        if(uniform == nullptr || uniform->blockIndex != static_cast<GLint>(block->index))
+        {
+            throw glsl::UniformMismatchException(std::string("The uniform block \"") + blockName + "\" has no member \"" + member.first + "\"");
+        }
+        if(static_cast<std::size_t>(uniform->offset) != member.second)
+        {
+            throw glsl::UniformMismatchException(std::string("The member \"") + member.first + "\" of the uniform block \"" + blockName +
+                    "\" resides at offset " + std::to_string(uniform->offset) + ", but at " + std::to_string(member.second) + " in its struct");
+        }
+    }
+    return true;
+}
+
+inline bool ProgramReflection::isSampler(GLenum type) noexcept
+{
+    switch(type)
+    {
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_1D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT:
+        case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D:
+        case GL_INT_SAMPLER_2D:
+        case GL_INT_SAMPLER_3D:
+        case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY:
+        case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        case GL_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+        case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline const char* ProgramReflection::getTypeName(GLenum type) noexcept
+{
+    switch(type)
+    {
+        case GL_FLOAT: return "float";
+        case GL_FLOAT_VEC2: return "vec2";
+        case GL_FLOAT_VEC3: return "vec3";
+        case GL_FLOAT_VEC4: return "vec4";
+        case GL_INT: return "int";
+        case GL_INT_VEC2: return "ivec2";
+        case GL_INT_VEC3: return "ivec3";
+        case GL_INT_VEC4: return "ivec4";
+        case GL_UNSIGNED_INT: return "uint";
+        case GL_UNSIGNED_INT_VEC2: return "uvec2";
+        case GL_UNSIGNED_INT_VEC3: return "uvec3";
+        case GL_UNSIGNED_INT_VEC4: return "uvec4";
+        case GL_BOOL: return "bool";
+        case GL_BOOL_VEC2: return "bvec2";
+        case GL_BOOL_VEC3: return "bvec3";
+        case GL_BOOL_VEC4: return "bvec4";
+        case GL_FLOAT_MAT2: return "mat2";
+        case GL_FLOAT_MAT3: return "mat3";
+        case GL_FLOAT_MAT4: return "mat4";
+        case GL_FLOAT_MAT2x3: return "mat2x3";
+        case GL_FLOAT_MAT2x4: return "mat2x4";
+        case GL_FLOAT_MAT3x2: return "mat3x2";
+        case GL_FLOAT_MAT3x4: return "mat3x4";
+        case GL_FLOAT_MAT4x2: return "mat4x2";
+        case GL_FLOAT_MAT4x3: return "mat4x3";
+        case GL_SAMPLER_2D: return "sampler2D";
+        case GL_SAMPLER_3D: return "sampler3D";
+        case GL_SAMPLER_CUBE: return "samplerCube";
+        case GL_SAMPLER_2D_SHADOW: return "sampler2DShadow";
+        case GL_SAMPLER_2D_ARRAY: return "sampler2DArray";
+        default: return isSampler(type) ? "sampler" : "unknown";
+    }
+}
+
+inline bool ProgramReflection::isCompatible(GLenum declared, GLenum provided) noexcept
+{
+    if(declared == provided)
+    {
+        return true;
+    }
+    /// Samplers are set with glUniform1i
+    if(isSampler(declared))
+    {
+        return provided == GL_INT;
+    }
+    /// Booleans may be set with any scalar type of the same component count
+    GLenum declaredScalar;
+    GLenum providedScalar;
+    const int components = detail::decomposeType(declared, declaredScalar);
+    return declaredScalar == GL_BOOL && components == detail::decomposeType(provided, providedScalar) && providedScalar != GL_BOOL;
+}
+
+}
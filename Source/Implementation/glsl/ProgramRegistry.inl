@@ -0,0 +1,84 @@
+#include <algorithm>
+
+namespace midnight
+{
+
+inline ProgramRegistry::ProgramRegistry(ProgramBinaryCache* cache) :
+    cache(cache)
+{
+
+}
+
+inline std::shared_ptr<Program> ProgramRegistry::acquire(const std::vector<ProgramBinaryCache::Stage>& stages)
+{
+    std::uint64_t key = detail::fnv1a(nullptr, 0);
+    for(const ProgramBinaryCache::Stage& stage : stages)
+    {
+        key = detail::fnv1a(&stage.type, sizeof(stage.type), key);
+        key = detail::fnv1a(stage.source.data(), stage.source.size(), key);
+    }
+
+    auto range = entries.equal_range(key);
+    for(auto entry = range.first; entry != range.second;)
+    {
+        std::shared_ptr<Program> program = entry->second.program.lock();
+        if(!program)
+        {
+            /// Drop Programs whose users are all gone
+            entry = entries.erase(entry);
+            continue;
+        }
+        /// Rule out hash collisions
+        const std::vector<ProgramBinaryCache::Stage>& interned = entry->second.stages;
+        if(interned.size() == stages.size() && std::equal(interned.begin(), interned.end(), stages.begin(),
+                [](const ProgramBinaryCache::Stage& a, const ProgramBinaryCache::Stage& b)
+                {
+                    return a.type == b.type && a.source == b.source;
+                }))
+        {
+            ++statistics.shared;
+            return program;
+        }
+        ++entry;
+    }
+
+    std::shared_ptr<Program> program = std::make_shared<Program>(cache != nullptr ? cache->load(stages) : ProgramBinaryCache::compile(stages));
+    entries.emplace(key, Entry{stages, program});
+    ++statistics.created;
+    return program;
+}
+
+inline std::shared_ptr<Program> ProgramRegistry::acquire(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    return acquire(std::vector<ProgramBinaryCache::Stage>{ProgramBinaryCache::Stage{GL_VERTEX_SHADER, vertexSource},
+            ProgramBinaryCache::Stage{GL_FRAGMENT_SHADER, fragmentSource}});
+}
+
+inline void ProgramRegistry::setCache(ProgramBinaryCache* cache) noexcept
+{
+    this->cache = cache;
+}
+
+inline std::size_t ProgramRegistry::getLiveCount() const noexcept
+{
+    std::size_t live = 0;
+    for(const auto& entry : entries)
+    {
+        live += entry.second.program.expired() ? 0 : 1;
+    }
+    return live;
+}
+
+inline const ProgramRegistry::Statistics& ProgramRegistry::getStatistics() const noexcept
+{
+    return statistics;
+}
+
+inline ProgramRegistry& ProgramRegistry::getDefault()
+{
+    /// Holds no GL objects itself, so outliving the context is harmless
+    static ProgramRegistry registry;
+    return registry;
+}
+
+}
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cstring>
+
+#include "CompilationError.hpp"
+#include "IllegalArgumentException.hpp"
+#include "LinkingError.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+inline ProgramVariants::ProgramVariants(const std::vector<ProgramBinaryCache::Stage>& stages, const std::vector<std::string>& modes,
+        const std::vector<std::string>& features, ProgramBinaryCache* cache, std::size_t compileBudget) :
+    stages(stages),
+    modes(modes),
+    features(features),
+    cache(cache),
+    compileBudget(compileBudget),
+    parallel(false)
+{
+    if(stages.empty())
+    {
+        throw IllegalArgumentException("ProgramVariants require at least one shader stage");
+    }
+    if(features.size() > 32)
+    {
+        throw IllegalArgumentException("ProgramVariants support at most 32 feature flags");
+    }
+
+    bool khr = false;
+    bool arb = false;
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for(GLint i = 0; i < extensions; ++i)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        khr = khr || std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0;
+        arb = arb || std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0;
+    }
+    /// Let the driver use as many threads as it sees fit
+    if(khr)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    else if(arb)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+    parallel = khr || arb;
+}
+
+inline ProgramVariants::~ProgramVariants()
+{
+    for(auto& variant : variants)
+    {
+        abandon(variant.second);
+    }
+}
+
+template<typename Mode>
+inline Program* ProgramVariants::request(Mode mode, std::uint32_t features)
+{
+    return lookup(keyOf(static_cast<std::uint64_t>(mode), features));
+}
+
+template<typename Mode>
+inline Program& ProgramVariants::require(Mode mode, std::uint32_t features)
+{
+    return complete(keyOf(static_cast<std::uint64_t>(mode), features));
+}
+
+inline void ProgramVariants::update()
+{
+    /// Finish everything possible before reporting the first failure
+    std::exception_ptr error;
+    auto remaining = compiling.begin();
+    for(Key key : compiling)
+    {
+        Variant& variant = variants[key];
+        GLint complete = GL_FALSE;
+        glGetProgramiv(variant.handle, GL_COMPLETION_STATUS_KHR, &complete);
+        if(complete == GL_FALSE)
+        {
+            *remaining++ = key;
+            continue;
+        }
+        try
+        {
+            finish(key, variant);
+        }
+        catch(...)
+        {
+            error = error ? error : std::current_exception();
+        }
+    }
+    compiling.erase(remaining, compiling.end());
+
+    for(std::size_t i = 0; i < compileBudget && !queued.empty(); ++i)
+    {
+        Key key = queued.front();
+        queued.pop_front();
+        Variant& variant = variants[key];
+        try
+        {
+            issue(key, variant);
+            finish(key, variant);
+        }
+        catch(...)
+        {
+            error = error ? error : std::current_exception();
+        }
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+inline std::size_t ProgramVariants::getPendingCount() const noexcept
+{
+    return compiling.size() + queued.size();
+}
+
+inline bool ProgramVariants::isParallel() const noexcept
+{
+    return parallel;
+}
+
+inline ProgramVariants::Key ProgramVariants::keyOf(std::uint64_t mode, std::uint32_t flags) const
+{
+    if(mode >= std::max<std::size_t>(modes.size(), 1))
+    {
+        throw IllegalArgumentException(std::string("No mode exists with the index ") + std::to_string(mode));
+    }
+    if(features.size() < 32 && (flags >> features.size()) != 0)
+    {
+        throw IllegalArgumentException(std::string("Undefined feature flags requested: ") + std::to_string(flags));
+    }
+    return mode << 32 | flags;
+}
+
+inline std::vector<std::string> ProgramVariants::definesOf(Key key) const
+{
+    std::vector<std::string> defines;
+    if(!modes.empty())
+    {
+        defines.push_back(modes[static_cast<std::size_t>(key >> 32)]);
+    }
+    for(std::size_t i = 0; i < features.size(); ++i)
+    {
+        if((key >> i) & 1)
+        {
+            defines.push_back(features[i]);
+        }
+    }
+    return defines;
+}
+
+inline Program* ProgramVariants::lookup(Key key)
+{
+    auto found = variants.find(key);
+    if(found != variants.end())
+    {
+        return found->second.program.get();
+    }
+
+    Variant& variant = variants[key];
+    if(cache != nullptr)
+    {
+        variant.program = cache->find(stages, definesOf(key));
+        if(variant.program)
+        {
+            return variant.program.get();
+        }
+    }
+    if(parallel)
+    {
+        issue(key, variant);
+        compiling.push_back(key);
+    }
+    else
+    {
+        queued.push_back(key);
+    }
+    return nullptr;
+}
+
+inline Program& ProgramVariants::complete(Key key)
+{
+    Program* program = lookup(key);
+    if(program != nullptr)
+    {
+        return *program;
+    }
+    Variant& variant = variants[key];
+    if(variant.error)
+    {
+        std::rethrow_exception(variant.error);
+    }
+    /// Jump the queue, or wait for the driver
+    auto waiting = std::find(queued.begin(), queued.end(), key);
+    if(waiting != queued.end())
+    {
+        queued.erase(waiting);
+        issue(key, variant);
+    }
+    else
+    {
+        compiling.erase(std::find(compiling.begin(), compiling.end(), key));
+    }
+    finish(key, variant);
+    return *variant.program;
+}
+
+inline void ProgramVariants::issue(Key key, Variant& variant)
+{
+    const std::vector<std::string> defines = definesOf(key);
+    variant.handle = glCreateProgram();
+    if(variant.handle == 0)
+    {
+        variant.error = std::make_exception_ptr(ResourceException("implementation failed to create program"));
+        std::rethrow_exception(variant.error);
+    }
+    for(const ProgramBinaryCache::Stage& stage : stages)
+    {
+        const std::string source = detail::injectDefines(stage.source, defines);
+        const GLchar* string = source.c_str();
+        const GLint length = static_cast<GLint>(source.length());
+        GLuint shader = glCreateShader(stage.type);
+        variant.shaders.push_back(shader);
+        glShaderSource(shader, 1, &string, &length);
+        glCompileShader(shader);
+        glAttachShader(variant.handle, shader);
+    }
+    /// Linking waits for the compilers, but only on the driver's threads
+    glLinkProgram(variant.handle);
+}
+
+inline void ProgramVariants::finish(Key key, Variant& variant)
+{
+    const std::vector<std::string> defines = definesOf(key);
+    GLint result;
+    for(std::size_t i = 0; i < variant.shaders.size(); ++i)
+    {
+        glGetShaderiv(variant.shaders[i], GL_COMPILE_STATUS, &result);
+        if(result == GL_FALSE)
+        {
+            glGetShaderiv(variant.shaders[i], GL_INFO_LOG_LENGTH, &result);
+            std::unique_ptr<GLchar[]> buffer(new GLchar[std::max(result, 1)]());
+            glGetShaderInfoLog(variant.shaders[i], result, nullptr, buffer.get());
+            abandon(variant);
+            variant.error = std::make_exception_ptr(glsl::CompilationError(std::string(buffer.get()),
+                    detail::injectDefines(stages[i].source, defines)));
+            std::rethrow_exception(variant.error);
+        }
+    }
+    glGetProgramiv(variant.handle, GL_LINK_STATUS, &result);
+    if(result == GL_FALSE)
+    {
+        glGetProgramiv(variant.handle, GL_INFO_LOG_LENGTH, &result);
+        std::unique_ptr<GLchar[]> buffer(new GLchar[std::max(result, 1)]());
+        glGetProgramInfoLog(variant.handle, result, nullptr, buffer.get());
+        abandon(variant);
+        variant.error = std::make_exception_ptr(glsl::LinkingError(std::string(buffer.get())));
+        std::rethrow_exception(variant.error);
+    }
+
+    /// The linked program no longer needs its shaders
+    for(GLuint shader : variant.shaders)
+    {
+        glDetachShader(variant.handle, shader);
+        glDeleteShader(shader);
+    }
+    variant.shaders.clear();
+    variant.program.reset(new Program(variant.handle));
+    variant.handle = 0;
+    if(cache != nullptr)
+    {
+        cache->store(stages, defines, *variant.program);
+    }
+}
+
+inline void ProgramVariants::abandon(Variant& variant)
+{
+    /// Call should never fail
+    for(GLuint shader : variant.shaders)
+    {
+        glDeleteShader(shader);
+    }
+    variant.shaders.clear();
+    if(variant.handle != 0)
+    {
+        glDeleteProgram(variant.handle);
+        variant.handle = 0;
+    }
+}
+
+}
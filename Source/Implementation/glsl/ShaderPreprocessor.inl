@@ -0,0 +1,207 @@
+#include <fstream>
+#include <sstream>
+
+#include "CompilationError.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+namespace detail
+{
+    inline std::string injectDefines(const std::string& source, const std::vector<std::string>& defines)
+    {
+        if(defines.empty())
+        {
+            return source;
+        }
+        std::string directives;
+        for(const std::string& define : defines)
+        {
+            directives += "#define " + define + "\n";
+        }
+        /// Nothing but comments and whitespace may precede #version, so insert right after its line
+        std::size_t version = source.find("#version");
+        if(version == std::string::npos)
+        {
+            return directives + source;
+        }
+        std::size_t end = source.find('\n', version);
+        if(end == std::string::npos)
+        {
+            return source + "\n" + directives;
+        }
+        return source.substr(0, end + 1) + directives + source.substr(end + 1);
+    }
+
+    inline bool readFile(const std::string& fileName, std::string& contents)
+    {
+        std::ifstream stream(fileName, std::ios::binary);
+        if(!stream)
+        {
+            return false;
+        }
+        std::stringstream ss;
+        ss << stream.rdbuf();
+        contents = ss.str();
+        return true;
+    }
+}
+
+inline ShaderPreprocessor::ShaderPreprocessor() :
+    files(1)
+{
+
+}
+
+inline void ShaderPreprocessor::addSearchPath(const std::string& directory)
+{
+    std::string path(directory);
+    if(!path.empty() && path.back() != '/' && path.back() != '\\')
+    {
+        path += '/';
+    }
+    searchPaths.push_back(path);
+}
+
+inline void ShaderPreprocessor::addSource(const std::string& name, const std::string& source)
+{
+    sources[name] = source;
+}
+
+inline std::string ShaderPreprocessor::process(const std::string& source, const std::vector<std::string>& defines)
+{
+    std::unordered_set<std::string> included;
+    std::string output;
+    output.reserve(source.size());
+    expand(source, std::string(), 0, included, output);
+    return detail::injectDefines(output, defines);
+}
+
+inline std::string ShaderPreprocessor::load(const std::string& fileName, const std::vector<std::string>& defines)
+{
+    std::string source;
+    if(!detail::readFile(fileName, source))
+    {
+        throw ResourceException(std::string("The file \"") + fileName + "\" could not be opened for reading");
+    }
+    /// A file that includes itself is already included
+    std::unordered_set<std::string> included{fileName};
+    std::string output;
+    output.reserve(source.size());
+    expand(source, fileName, 0, included, output);
+    return detail::injectDefines(output, defines);
+}
+
+inline std::string ShaderPreprocessor::getFileName(int sourceString) const
+{
+    if(sourceString < 0 || static_cast<std::size_t>(sourceString) >= files.size())
+    {
+        return std::string();
+    }
+    return files[static_cast<std::size_t>(sourceString)];
+}
+
+inline void ShaderPreprocessor::expand(const std::string& source, const std::string& fileName, int sourceString,
+        std::unordered_set<std::string>& included, std::string& output)
+{
+    std::size_t lineNumber = 0;
+    std::size_t begin = 0;
+    while(begin < source.size())
+    {
+        std::size_t end = source.find('\n', begin);
+        if(end == std::string::npos)
+        {
+            end = source.size();
+        }
+        ++lineNumber;
+
+        /// Recognize '#', 'include' and the name, each optionally preceded by whitespace
+        std::size_t cursor = source.find_first_not_of(" \t", begin);
+        bool directive = cursor < end && source[cursor] == '#';
+        if(directive)
+        {
+            cursor = source.find_first_not_of(" \t", cursor + 1);
+            directive = cursor < end && source.compare(cursor, 7, "include") == 0;
+        }
+        if(!directive)
+        {
+            output.append(source, begin, end - begin);
+            output += '\n';
+            begin = end + 1;
+            continue;
+        }
+
+        cursor = source.find_first_not_of(" \t", cursor + 7);
+        const char close = cursor < end && source[cursor] == '<' ? '>' : '"';
+        const std::size_t last = cursor < end ? source.find(close, cursor + 1) : std::string::npos;
+        if(cursor >= end || (source[cursor] != '"' && source[cursor] != '<') || last == std::string::npos || last > end)
+        {
+            throw glsl::CompilationError(std::string("Malformed #include directive on line ") + std::to_string(lineNumber), source);
+        }
+        const std::string name = source.substr(cursor + 1, last - cursor - 1);
+
+        std::string path;
+        std::string includedSource;
+        if(!find(name, fileName, path, includedSource))
+        {
+            throw ResourceException(std::string("The included file \"") + name + "\" could not be found");
+        }
+        if(included.insert(path).second)
+        {
+            output += "#line 1 " + std::to_string(sourceStringOf(path)) + "\n";
+            expand(includedSource, path, sourceStringOf(path), included, output);
+            output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceString) + "\n";
+        }
+        else
+        {
+            /// Keep the line count intact
+            output += '\n';
+        }
+        begin = end + 1;
+    }
+}
+
+inline bool ShaderPreprocessor::find(const std::string& name, const std::string& includer, std::string& path, std::string& source) const
+{
+    auto registered = sources.find(name);
+    if(registered != sources.end())
+    {
+        path = name;
+        source = registered->second;
+        return true;
+    }
+    std::size_t separator = includer.find_last_of("/\\");
+    if(separator != std::string::npos)
+    {
+        path = includer.substr(0, separator + 1) + name;
+        if(detail::readFile(path, source))
+        {
+            return true;
+        }
+    }
+    for(const std::string& directory : searchPaths)
+    {
+        path = directory + name;
+        if(detail::readFile(path, source))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline int ShaderPreprocessor::sourceStringOf(const std::string& path)
+{
+    for(std::size_t i = 1; i < files.size(); ++i)
+    {
+        if(files[i] == path)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    files.push_back(path);
+    return static_cast<int>(files.size() - 1);
+}
+
+}
@@ -1,20 +1,116 @@
+#include <algorithm>
+
+#include "FrameUniforms.hpp"
+
 namespace midnight
 {
-    const std::vector<std::shared_ptr<SceneGraphNode>>& AbstractSceneGraphNode::getChildren() const
+    inline AbstractSceneGraphNode::AbstractSceneGraphNode() :
+        boundsValid(false)
+    {
+
+    }
+
+    inline AbstractSceneGraphNode::~AbstractSceneGraphNode()
+    {
+        for(const auto& child : children)
+        {
+            auto& parents = child->parents;
+            parents.erase(std::find(parents.begin(), parents.end(), this));
+        }
+    }
+
+    inline const std::vector<std::shared_ptr<SceneGraphNode>>& AbstractSceneGraphNode::getChildren() const
     {
         return this->children;
     }
 
-    void AbstractSceneGraphNode::add(std::shared_ptr<SceneGraphNode> child)
+    inline void AbstractSceneGraphNode::setLocalBounds(const BoundingBoxF& localBounds)
+    {
+        this->localBounds = localBounds;
+        invalidateBounds();
+    }
+
+    inline BoundingBoxF AbstractSceneGraphNode::computeBounds()
     {
+        BoundingBoxF rv = localBounds;
+        for(const auto& child : children)
+        {
+            rv.merge(child->getBounds());
+        }
+        return rv;
+    }
+
+    inline void AbstractSceneGraphNode::invalidateBounds()
+    {
+        /// Ancestors of a node with stale bounds are already stale
+        if(boundsValid)
+        {
+            boundsValid = false;
+            SceneGraphNode::invalidateBounds();
+        }
+    }
+
+    inline bool AbstractSceneGraphNode::hasPickableChildren()
+    {
+        for(const auto& child : children)
+        {
+            if(child->isPickable())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void AbstractSceneGraphNode::add(std::shared_ptr<SceneGraphNode> child)
+    {
+        child->parents.push_back(this);
         this->children.push_back(child);
+        invalidateBounds();
+    }
+
+    inline const BoundingBoxF& AbstractSceneGraphNode::getBounds()
+    {
+        if(!boundsValid)
+        {
+            bounds = computeBounds();
+            boundsValid = true;
+        }
+        return bounds;
+    }
+
+    inline void AbstractSceneGraphNode::render(const Camera& camera)
+    {
+        FrameUniforms& uniforms = FrameUniforms::getActive();
+        for(const auto& child : children)
+        {
+            if(uniforms.enter(child->getBounds()))
+            {
+                child->render(camera);
+                uniforms.leave();
+            }
+        }
     }
 
-    void AbstractSceneGraphNode::render(const Camera& camera)
+    inline bool AbstractSceneGraphNode::intersect(const Ray& ray, float maximum, SurfaceHit& hit)
     {
+        bool found = false;
         for(const auto& child : children)
         {
-            child->render(camera);
+            float distance;
+            SurfaceHit childHit;
+            childHit.node = nullptr;
+            if(child->isPickable() && ray.intersects(child->getBounds(), distance, maximum) && child->intersect(ray, maximum, childHit))
+            {
+                hit = childHit;
+                if(hit.node == nullptr)
+                {
+                    hit.node = child.get();
+                }
+                maximum = hit.distance;
+                found = true;
+            }
         }
+        return found;
     }
 }
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+    inline BatchRenderer::BatchRenderer(std::size_t initialCapacity) :
+        activeBatches(0),
+        commandBuffer(0),
+        drawDataBuffer(0),
+        drawIdBuffer(0),
+        capacity(0)
+    {
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &drawDataBuffer);
+        glGenBuffers(1, &drawIdBuffer);
+        reserve(std::max<std::size_t>(initialCapacity, 1));
+    }
+
+    inline BatchRenderer::~BatchRenderer()
+    {
+        /// Call should never fail
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &drawDataBuffer);
+        glDeleteBuffers(1, &drawIdBuffer);
+    }
+
+    inline void BatchRenderer::submit(Program& program, GeometryArena& arena, GeometryArena::Handle mesh, const Matrix4x4F& transform,
+            std::uint32_t firstIndex, std::uint32_t indexCount)
+    {
+        const GeometryArena::Range& range = arena.getRange(mesh);
+
+        /// Frames rarely hold more than a handful of batches, so a linear search beats a map
+        Batch* batch = nullptr;
+        for(std::size_t i = 0; i < activeBatches; ++i)
+        {
+            if(batches[i].program == &program && batches[i].arena == &arena)
+            {
+                batch = &batches[i];
+                break;
+            }
+        }
+        if(batch == nullptr)
+        {
+            if(activeBatches == batches.size())
+            {
+                batches.push_back(Batch());
+            }
+            batch = &batches[activeBatches++];
+            batch->program = &program;
+            batch->arena = &arena;
+        }
+
+        DrawElementsIndirectCommand command;
+        command.count = indexCount == 0 ? static_cast<GLuint>(range.indexCount) : indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = static_cast<GLuint>(range.firstIndex) + firstIndex;
+        command.baseVertex = range.baseVertex;
+        /// Selects the draw id, and with it the transform, of this draw
+        command.baseInstance = static_cast<GLuint>(batch->commands.size());
+        batch->commands.push_back(command);
+
+        const GLfloat* elements = &transform;
+        batch->transforms.insert(batch->transforms.end(), elements, elements + 16);
+    }
+
+    inline void BatchRenderer::flush()
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        statistics = Statistics();
+
+        for(std::size_t i = 0; i < activeBatches; ++i)
+        {
+            Batch& batch = batches[i];
+            const std::size_t draws = batch.commands.size();
+            reserve(draws);
+
+            batch.program->bind();
+            batch.arena->bind();
+
+            GLint program;
+            /// Call should never fail
+            glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+            GLint drawId = glGetAttribLocation(static_cast<GLuint>(program), "draw_id");
+            if(drawId != -1)
+            {
+                /// Recorded into the arena's vertex array, so this is only a state refresh after the first frame
+                glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+                glEnableVertexAttribArray(static_cast<GLuint>(drawId));
+                glVertexAttribIPointer(static_cast<GLuint>(drawId), 1, GL_UNSIGNED_INT, 0, nullptr);
+                glVertexAttribDivisor(static_cast<GLuint>(drawId), 1);
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+            }
+
+            /// Orphan the previous contents so the driver never stalls on draws still in flight
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(DrawElementsIndirectCommand)), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(draws * sizeof(DrawElementsIndirectCommand)), &batch.commands[0]);
+
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawDataBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity * 16 * sizeof(GLfloat)), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(batch.transforms.size() * sizeof(GLfloat)), &batch.transforms[0]);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, drawDataBuffer);
+
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(draws), 0);
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            batch.arena->unbind();
+            batch.program->unbind();
+
+            ++statistics.batches;
+            statistics.draws += draws;
+            batch.commands.clear();
+            batch.transforms.clear();
+        }
+        activeBatches = 0;
+
+        statistics.submissionMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    inline const BatchRenderer::Statistics& BatchRenderer::getStatistics() const noexcept
+    {
+        return statistics;
+    }
+
+    inline bool BatchRenderer::isSupported() noexcept
+    {
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        return major > 4 || (major == 4 && minor >= 3);
+    }
+
+    inline void BatchRenderer::reserve(std::size_t draws)
+    {
+        if(draws <= capacity)
+        {
+            return;
+        }
+        std::size_t grown = std::max(draws, capacity * 2);
+
+        std::vector<GLuint> identity(grown);
+        std::iota(identity.begin(), identity.end(), 0);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+        /// Can set GL_OUT_OF_MEMORY
+        /// https://www.opengl.org/sdk/docs/man4/xhtml/glBufferData.xml
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(grown * sizeof(GLuint)), &identity[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        if(glGetError() == GL_OUT_OF_MEMORY)
+        {
+            throw ResourceException("Unable to allocate GPU memory for BatchRenderer");
+        }
+        /// The command and draw data storage is (re)specified on every flush
+        capacity = grown;
+    }
+
+}
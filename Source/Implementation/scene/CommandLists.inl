@@ -0,0 +1,67 @@
+#include "IllegalArgumentException.hpp"
+
+namespace midnight
+{
+
+    template<typename Command>
+    inline CommandLists<Command>::CommandLists(std::size_t count)
+    {
+        if(count == 0)
+        {
+            throw IllegalArgumentException("CommandLists require at least one list");
+        }
+        lists.resize(count);
+    }
+
+    template<typename Command>
+    inline void CommandLists<Command>::clear() noexcept
+    {
+        for(std::vector<Command>& list : lists)
+        {
+            list.clear();
+        }
+    }
+
+    template<typename Command>
+    inline std::size_t CommandLists<Command>::getListCount() const noexcept
+    {
+        return lists.size();
+    }
+
+    template<typename Command>
+    inline std::vector<Command>& CommandLists<Command>::getList(std::size_t index) noexcept
+    {
+        return lists[index];
+    }
+
+    template<typename Command>
+    inline const std::vector<Command>& CommandLists<Command>::getList(std::size_t index) const noexcept
+    {
+        return lists[index];
+    }
+
+    template<typename Command>
+    inline std::size_t CommandLists<Command>::getCommandCount() const noexcept
+    {
+        std::size_t rv = 0;
+        for(const std::vector<Command>& list : lists)
+        {
+            rv += list.size();
+        }
+        return rv;
+    }
+
+    template<typename Command>
+    template<typename F>
+    inline void CommandLists<Command>::replay(F function) const
+    {
+        for(const std::vector<Command>& list : lists)
+        {
+            for(const Command& command : list)
+            {
+                function(command);
+            }
+        }
+    }
+
+}
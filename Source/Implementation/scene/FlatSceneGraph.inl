@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "IllegalArgumentException.hpp"
+
+namespace midnight
+{
+
+    inline void FlatSceneGraph::reserve(std::size_t nodes)
+    {
+        parents.reserve(nodes);
+        subtreeSizes.reserve(nodes);
+        localTransforms.reserve(nodes);
+        worldTransforms.reserve(nodes);
+        localBounds.reserve(nodes);
+        worldBounds.reserve(nodes);
+        subtreeBounds.reserve(nodes);
+        renderables.reserve(nodes);
+        owners.reserve(nodes);
+        slots.reserve(nodes);
+        generations.reserve(nodes);
+        queued.reserve(nodes);
+    }
+
+    inline FlatSceneGraph::Handle FlatSceneGraph::create(Handle parent, const Matrix4x4F& localTransform,
+            const BoundingBoxF& localBounds, Renderable renderable)
+    {
+        const std::uint32_t none = NONE;
+        std::uint32_t parentPosition = none;
+        std::uint32_t position = static_cast<std::uint32_t>(parents.size());
+        if(parent != Handle())
+        {
+            parentPosition = positionOf(parent);
+            position = parentPosition + subtreeSizes[parentPosition];
+        }
+
+        std::uint32_t index;
+        if(releasedHandles.empty())
+        {
+            index = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(position);
+            generations.push_back(0);
+            queued.push_back(0);
+        }
+        else
+        {
+            index = releasedHandles.back();
+            releasedHandles.pop_back();
+            slots[index] = position;
+        }
+
+        const bool appending = position == parents.size();
+        parents.insert(parents.begin() + position, parentPosition);
+        subtreeSizes.insert(subtreeSizes.begin() + position, 1);
+        localTransforms.insert(localTransforms.begin() + position, localTransform);
+        worldTransforms.insert(worldTransforms.begin() + position, localTransform);
+        this->localBounds.insert(this->localBounds.begin() + position, localBounds);
+        worldBounds.insert(worldBounds.begin() + position, localBounds);
+        subtreeBounds.insert(subtreeBounds.begin() + position, localBounds);
+        renderables.insert(renderables.begin() + position, renderable);
+        owners.insert(owners.begin() + position, index);
+
+        if(!appending)
+        {
+            /// Every node behind the new one moved up by one
+            for(std::size_t i = position + 1; i < parents.size(); ++i)
+            {
+                if(parents[i] != none && parents[i] >= position)
+                {
+                    ++parents[i];
+                }
+                slots[owners[i]] = static_cast<std::uint32_t>(i);
+            }
+        }
+        for(std::uint32_t ancestor = parentPosition; ancestor != none; ancestor = parents[ancestor])
+        {
+            ++subtreeSizes[ancestor];
+        }
+        markDirty(index);
+        return Handle(index, generations[index]);
+    }
+
+    inline void FlatSceneGraph::destroy(Handle node)
+    {
+        const std::uint32_t none = NONE;
+        const std::uint32_t position = positionOf(node);
+        const std::uint32_t size = subtreeSizes[position];
+        const std::uint32_t end = position + size;
+
+        const std::uint32_t parent = parents[position];
+        if(parent != none)
+        {
+            shrunkNodes.push_back(owners[parent]);
+        }
+        for(std::uint32_t ancestor = parent; ancestor != none; ancestor = parents[ancestor])
+        {
+            subtreeSizes[ancestor] -= size;
+        }
+        for(std::uint32_t i = position; i < end; ++i)
+        {
+            slots[owners[i]] = none;
+            ++generations[owners[i]];
+            releasedHandles.push_back(owners[i]);
+        }
+
+        parents.erase(parents.begin() + position, parents.begin() + end);
+        subtreeSizes.erase(subtreeSizes.begin() + position, subtreeSizes.begin() + end);
+        localTransforms.erase(localTransforms.begin() + position, localTransforms.begin() + end);
+        worldTransforms.erase(worldTransforms.begin() + position, worldTransforms.begin() + end);
+        localBounds.erase(localBounds.begin() + position, localBounds.begin() + end);
+        worldBounds.erase(worldBounds.begin() + position, worldBounds.begin() + end);
+        subtreeBounds.erase(subtreeBounds.begin() + position, subtreeBounds.begin() + end);
+        renderables.erase(renderables.begin() + position, renderables.begin() + end);
+        owners.erase(owners.begin() + position, owners.begin() + end);
+
+        /// Every node behind the subtree moved down by its size
+        for(std::size_t i = position; i < parents.size(); ++i)
+        {
+            if(parents[i] != none && parents[i] >= end)
+            {
+                parents[i] -= size;
+            }
+            slots[owners[i]] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    inline bool FlatSceneGraph::isValid(Handle node) const noexcept
+    {
+        return node.index < slots.size() && generations[node.index] == node.generation && slots[node.index] != NONE;
+    }
+
+    inline FlatSceneGraph::Handle FlatSceneGraph::getParent(Handle node) const
+    {
+        const std::uint32_t parent = parents[positionOf(node)];
+        if(parent == NONE)
+        {
+            return Handle();
+        }
+        return Handle(owners[parent], generations[owners[parent]]);
+    }
+
+    inline void FlatSceneGraph::setLocalTransform(Handle node, const Matrix4x4F& localTransform)
+    {
+        localTransforms[positionOf(node)] = localTransform;
+        markDirty(node.index);
+    }
+
+    inline void FlatSceneGraph::setLocalBounds(Handle node, const BoundingBoxF& localBounds)
+    {
+        this->localBounds[positionOf(node)] = localBounds;
+        markDirty(node.index);
+    }
+
+    inline void FlatSceneGraph::setRenderable(Handle node, Renderable renderable)
+    {
+        renderables[positionOf(node)] = renderable;
+    }
+
+    inline const Matrix4x4F& FlatSceneGraph::getLocalTransform(Handle node) const
+    {
+        return localTransforms[positionOf(node)];
+    }
+
+    inline const Matrix4x4F& FlatSceneGraph::getWorldTransform(Handle node) const
+    {
+        return worldTransforms[positionOf(node)];
+    }
+
+    inline const BoundingBoxF& FlatSceneGraph::getWorldBounds(Handle node) const
+    {
+        return worldBounds[positionOf(node)];
+    }
+
+    inline const BoundingBoxF& FlatSceneGraph::getSubtreeBounds(Handle node) const
+    {
+        return subtreeBounds[positionOf(node)];
+    }
+
+    inline FlatSceneGraph::Renderable FlatSceneGraph::getRenderable(Handle node) const
+    {
+        return renderables[positionOf(node)];
+    }
+
+    inline std::size_t FlatSceneGraph::getNodeCount() const noexcept
+    {
+        return parents.size();
+    }
+
+    inline std::size_t FlatSceneGraph::update()
+    {
+        dirtyPositions.clear();
+        for(std::uint32_t index : dirtyNodes)
+        {
+            queued[index] = 0;
+            if(slots[index] != NONE)
+            {
+                dirtyPositions.push_back(slots[index]);
+            }
+        }
+        dirtyNodes.clear();
+        std::sort(dirtyPositions.begin(), dirtyPositions.end());
+
+        /// The ancestors of a changed subtree must refit their subtree bounds, each only once
+        refitPositions.clear();
+        refitting.resize(parents.size(), 0);
+        auto refit = [this](std::uint32_t ancestor)
+        {
+            while(ancestor != NONE && !refitting[ancestor])
+            {
+                refitting[ancestor] = 1;
+                refitPositions.push_back(ancestor);
+                ancestor = parents[ancestor];
+            }
+        };
+
+        /// Parents precede their children, so their world transforms are always ready.  A dirty
+        /// node inside a subtree that was already recomputed is skipped.
+        std::size_t recomputed = 0;
+        std::size_t end = 0;
+        for(std::uint32_t position : dirtyPositions)
+        {
+            if(position < end)
+            {
+                continue;
+            }
+            end = position + subtreeSizes[position];
+            for(std::size_t i = position; i < end; ++i)
+            {
+                if(parents[i] == NONE)
+                {
+                    worldTransforms[i] = localTransforms[i];
+                }
+                else
+                {
+                    worldTransforms[i] = localTransforms[i] * worldTransforms[parents[i]];
+                }
+                worldBounds[i] = localBounds[i].transform(worldTransforms[i]);
+                subtreeBounds[i] = worldBounds[i];
+            }
+            /// Children follow their parents, so walking backwards completes each subtree before
+            /// it is merged into its parent
+            for(std::size_t i = end - 1; i > position; --i)
+            {
+                subtreeBounds[parents[i]].merge(subtreeBounds[i]);
+            }
+            refit(parents[position]);
+            recomputed += end - position;
+        }
+        for(std::uint32_t index : shrunkNodes)
+        {
+            if(slots[index] != NONE)
+            {
+                refit(slots[index]);
+            }
+        }
+        shrunkNodes.clear();
+
+        std::sort(refitPositions.begin(), refitPositions.end(), std::greater<std::uint32_t>());
+        for(std::uint32_t position : refitPositions)
+        {
+            subtreeBounds[position] = worldBounds[position];
+            const std::size_t last = position + subtreeSizes[position];
+            for(std::size_t child = position + 1; child < last; child += subtreeSizes[child])
+            {
+                subtreeBounds[position].merge(subtreeBounds[child]);
+            }
+            refitting[position] = 0;
+        }
+        return recomputed;
+    }
+
+    template<typename Visitor>
+    inline void FlatSceneGraph::traverse(Visitor&& visitor) const
+    {
+        std::size_t i = 0;
+        while(i < parents.size())
+        {
+            if(visitor(renderables[i], worldTransforms[i], worldBounds[i]))
+            {
+                ++i;
+            }
+            else
+            {
+                i += subtreeSizes[i];
+            }
+        }
+    }
+
+    template<typename Visitor>
+    inline CullingStatistics FlatSceneGraph::traverse(const Frustum& frustum, Visitor&& visitor) const
+    {
+        return traverseRange(frustum, 0, parents.size(), visitor);
+    }
+
+    template<typename Command, typename Generator>
+    inline CullingStatistics FlatSceneGraph::traverse(const Frustum& frustum, CommandLists<Command>& lists,
+            Generator generator) const
+    {
+        lists.clear();
+        const std::size_t count = lists.getListCount();
+        std::vector<CullingStatistics> statistics(count, CullingStatistics());
+        parallel_for(0, count, [&](std::size_t range)
+        {
+            std::vector<Command>& list = lists.getList(range);
+            auto visitor = [&](Renderable renderable, const Matrix4x4F& worldTransform)
+            {
+                generator(renderable, worldTransform, list);
+            };
+            statistics[range] = traverseRange(frustum, parents.size() * range / count, parents.size() * (range + 1) / count, visitor);
+        });
+
+        CullingStatistics rv = CullingStatistics();
+        for(const CullingStatistics& range : statistics)
+        {
+            rv.drawn += range.drawn;
+            rv.culled += range.culled;
+        }
+        return rv;
+    }
+
+    template<typename Visitor>
+    inline CullingStatistics FlatSceneGraph::traverseRange(const Frustum& frustum, std::size_t begin, std::size_t end,
+            Visitor& visitor) const
+    {
+        CullingStatistics statistics = CullingStatistics();
+
+        /// The end of each enclosing visible subtree, and the planes left to test within it
+        std::vector<std::pair<std::size_t, std::uint32_t>> enclosing;
+        std::size_t i = begin;
+        if(begin < end && parents[begin] != NONE)
+        {
+            std::vector<std::uint32_t> ancestors;
+            for(std::uint32_t ancestor = parents[begin]; ancestor != NONE; ancestor = parents[ancestor])
+            {
+                ancestors.push_back(ancestor);
+            }
+            for(auto ancestor = ancestors.rbegin(); ancestor != ancestors.rend(); ++ancestor)
+            {
+                std::uint32_t mask = enclosing.empty() ? Frustum::ALL_PLANES : enclosing.back().second;
+                const std::size_t subtreeEnd = *ancestor + subtreeSizes[*ancestor];
+                if(!frustum.intersects(subtreeBounds[*ancestor], mask))
+                {
+                    /// The rest of the culled subtree was counted by the range of the ancestor
+                    i = std::min(end, subtreeEnd);
+                    statistics.culled += i - begin;
+                    break;
+                }
+                enclosing.push_back(std::make_pair(subtreeEnd, mask));
+            }
+        }
+
+        while(i < end)
+        {
+            while(!enclosing.empty() && enclosing.back().first <= i)
+            {
+                enclosing.pop_back();
+            }
+            std::uint32_t mask = enclosing.empty() ? Frustum::ALL_PLANES : enclosing.back().second;
+            if(!frustum.intersects(subtreeBounds[i], mask))
+            {
+                const std::size_t next = std::min<std::size_t>(end, i + subtreeSizes[i]);
+                statistics.culled += next - i;
+                i = next;
+                continue;
+            }
+            if(renderables[i] != NO_RENDERABLE)
+            {
+                std::uint32_t own = mask;
+                if(frustum.intersects(worldBounds[i], own))
+                {
+                    visitor(renderables[i], worldTransforms[i]);
+                    ++statistics.drawn;
+                }
+                else
+                {
+                    ++statistics.culled;
+                }
+            }
+            if(subtreeSizes[i] > 1)
+            {
+                enclosing.push_back(std::make_pair(i + subtreeSizes[i], mask));
+            }
+            ++i;
+        }
+        return statistics;
+    }
+
+    inline void FlatSceneGraph::markDirty(std::uint32_t index)
+    {
+        if(!queued[index])
+        {
+            queued[index] = 1;
+            dirtyNodes.push_back(index);
+        }
+    }
+
+    inline std::uint32_t FlatSceneGraph::positionOf(Handle node) const
+    {
+        if(!isValid(node))
+        {
+            throw IllegalArgumentException(std::string("Handle ") + std::to_string(node.index) + " (generation " +
+                    std::to_string(node.generation) + ") does not refer to a live node");
+        }
+        return slots[node.index];
+    }
+
+}
@@ -0,0 +1,255 @@
+#include "BindException.hpp"
+
+namespace midnight
+{
+
+    inline FrameUniforms::FrameUniforms(std::size_t objectsPerFrame, std::size_t framesInFlight) :
+        /// Leave room for the FrameData and the alignment padding of every block
+        ring((objectsPerFrame + 1) * ((sizeof(ObjectData) + 255) / 256 * 256) + sizeof(FrameData), framesInFlight),
+        frame(),
+        view(Matrix4x4F::IDENTITY()),
+        projection(Matrix4x4F::IDENTITY()),
+        viewProjection(Matrix4x4F::IDENTITY()),
+        occlusion(nullptr),
+        statistics(),
+        ambientColor(1.0f, 1.0f, 1.0f, 1.0f),
+        lightDirection(0.0f, -1.0f, 0.0f),
+        lightColor(1.0f, 1.0f, 1.0f, 1.0f)
+    {
+
+    }
+
+    inline FrameUniforms::~FrameUniforms()
+    {
+        if(active() == this)
+        {
+            active() = nullptr;
+        }
+    }
+
+    inline void FrameUniforms::setAmbientLight(const Color4F& color) noexcept
+    {
+        ambientColor = color;
+    }
+
+    inline void FrameUniforms::setDirectionalLight(const Vector3F& direction, const Color4F& color) noexcept
+    {
+        lightDirection = direction;
+        lightColor = color;
+    }
+
+    inline void FrameUniforms::begin(const Camera& camera)
+    {
+        ring.beginFrame();
+        transforms.clear();
+        planeMasks.clear();
+        statistics = CullingStatistics();
+        Program::resetTotalUniformStatistics();
+
+        view = computeView(camera);
+        projection = camera.getProjection();
+        viewProjection = view * projection;
+        frustum = Frustum(viewProjection);
+        frame.view = view;
+        frame.projection = projection;
+        frame.viewProjection = viewProjection;
+        frame.cameraPosition.set(camera.getPosition()[0], camera.getPosition()[1], camera.getPosition()[2], 1.0f);
+        frame.ambientColor = ambientColor;
+        frame.lightDirection.set(lightDirection[0], lightDirection[1], lightDirection[2], 0.0f);
+        frame.lightColor = lightColor;
+
+        ring.bind(FRAME_BINDING, frame);
+        active() = this;
+    }
+
+    inline void FrameUniforms::bindObject()
+    {
+        if(transforms.empty())
+        {
+            ObjectData object;
+            object.modelView = view;
+            object.modelViewProjection = viewProjection;
+            ring.bind(OBJECT_BINDING, object);
+            return;
+        }
+        ring.bind(OBJECT_BINDING, derive().object);
+    }
+
+    inline void FrameUniforms::bindObject(const Matrix4x4F& world)
+    {
+        ObjectData object;
+        object.modelView = world * view;
+        object.modelViewProjection = world * viewProjection;
+        ring.bind(OBJECT_BINDING, object);
+    }
+
+    inline void FrameUniforms::bindObject(const Camera& camera)
+    {
+        ObjectData object;
+        Matrix4x4F modelView = computeView(camera);
+        if(!transforms.empty())
+        {
+            modelView = transforms.back().world * modelView;
+        }
+        object.modelView = modelView;
+        object.modelViewProjection = modelView * projection;
+        ring.bind(OBJECT_BINDING, object);
+    }
+
+    inline std::size_t FrameUniforms::writeObject()
+    {
+        if(transforms.empty())
+        {
+            ObjectData object;
+            object.modelView = view;
+            object.modelViewProjection = viewProjection;
+            return ring.write(object);
+        }
+        return ring.write(derive().object);
+    }
+
+    inline void FrameUniforms::bindObjectAt(std::size_t offset) noexcept
+    {
+        ring.bind(OBJECT_BINDING, offset, sizeof(ObjectData));
+    }
+
+    inline float FrameUniforms::computeDepth(const BoundingBoxF& bounds)
+    {
+        const Matrix4x4F& clip = transforms.empty() ? viewProjection : derive().clip;
+        const Point3F center = bounds.getCenter();
+        return center[0] * clip(0, 3) + center[1] * clip(1, 3) + center[2] * clip(2, 3) + clip(3, 3);
+    }
+
+    inline Matrix4x4F FrameUniforms::getWorldTransform() const noexcept
+    {
+        return transforms.empty() ? Matrix4x4F::IDENTITY() : transforms.back().world;
+    }
+
+    inline void FrameUniforms::pushTransform(const Matrix4x4F& local)
+    {
+        Transform transform;
+        /// Row vectors, so the local transform applies first
+        transform.world = transforms.empty() ? local : local * transforms.back().world;
+        transform.derived = false;
+        transforms.push_back(transform);
+    }
+
+    inline void FrameUniforms::popTransform() noexcept
+    {
+        transforms.pop_back();
+    }
+
+    inline bool FrameUniforms::enter(const BoundingBoxF& bounds)
+    {
+        std::uint32_t mask = planeMasks.empty() ? Frustum::ALL_PLANES : planeMasks.back();
+        const Frustum& volume = transforms.empty() ? frustum : derive().frustum;
+        if(!volume.intersects(bounds, mask))
+        {
+            ++statistics.culled;
+            return false;
+        }
+        if(occlusion != nullptr && !occlusion->isVisible(bounds, transforms.empty() ? viewProjection : derive().clip))
+        {
+            ++statistics.occluded;
+            return false;
+        }
+        ++statistics.drawn;
+        planeMasks.push_back(mask);
+        return true;
+    }
+
+    inline void FrameUniforms::setOcclusionBuffer(const OcclusionBuffer* occlusion) noexcept
+    {
+        this->occlusion = occlusion;
+    }
+
+    inline void FrameUniforms::leave() noexcept
+    {
+        planeMasks.pop_back();
+    }
+
+    inline const CullingStatistics& FrameUniforms::getCullingStatistics() const noexcept
+    {
+        return statistics;
+    }
+
+    inline const Program::UniformStatistics& FrameUniforms::getUniformStatistics() const noexcept
+    {
+        return uniformStatistics;
+    }
+
+    inline void FrameUniforms::end()
+    {
+        ring.endFrame();
+        uniformStatistics = Program::getTotalUniformStatistics();
+        active() = nullptr;
+    }
+
+    inline const FrameData& FrameUniforms::getFrameData() const noexcept
+    {
+        return frame;
+    }
+
+    inline void FrameUniforms::attach(Program& program)
+    {
+        program.bindUniformBlock("FrameUniforms", FRAME_BINDING);
+        program.bindUniformBlock("ObjectUniforms", OBJECT_BINDING);
+#if defined(MIDNIGHT_UNIFORM_VALIDATION)
+        /// Catches a GLSL_BLOCKS edit that the structs did not follow
+        program.getReflection().verifyBlock("FrameUniforms", sizeof(FrameData), {
+            {"view", offsetof(FrameData, view)},
+            {"projection", offsetof(FrameData, projection)},
+            {"view_projection", offsetof(FrameData, viewProjection)},
+            {"camera_position", offsetof(FrameData, cameraPosition)},
+            {"ambient_color", offsetof(FrameData, ambientColor)},
+            {"light_direction", offsetof(FrameData, lightDirection)},
+            {"light_color", offsetof(FrameData, lightColor)}
+        });
+        program.getReflection().verifyBlock("ObjectUniforms", sizeof(ObjectData), {
+            {"model_view", offsetof(ObjectData, modelView)},
+            {"model_view_projection", offsetof(ObjectData, modelViewProjection)}
+        });
+#endif
+    }
+
+    inline FrameUniforms& FrameUniforms::getActive()
+    {
+        if(active() == nullptr)
+        {
+            throw glsl::BindException("No FrameUniforms are active; nodes must be rendered between begin() and end()");
+        }
+        return *active();
+    }
+
+    inline Matrix4x4F FrameUniforms::computeView(const Camera& camera) noexcept
+    {
+        /// Row-vector translation, as the shaders compute vec4(position + offset, 1.0) * orientation
+        Matrix4x4F translation = Matrix4x4F::IDENTITY();
+        for(std::size_t i = 0; i < 3; ++i)
+        {
+            translation(3, i) = camera.getPosition()[i];
+        }
+        return translation * camera.getOrientation();
+    }
+
+    inline FrameUniforms::Transform& FrameUniforms::derive()
+    {
+        Transform& transform = transforms.back();
+        if(!transform.derived)
+        {
+            transform.clip = transform.world * viewProjection;
+            transform.object.modelView = transform.world * view;
+            transform.object.modelViewProjection = transform.clip;
+            transform.frustum = Frustum(transform.clip);
+            transform.derived = true;
+        }
+        return transform;
+    }
+
+    inline FrameUniforms*& FrameUniforms::active() noexcept
+    {
+        static FrameUniforms* current = nullptr;
+        return current;
+    }
+
+}
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+    inline InstancedMeshNode::InstancedMeshNode(const Mesh& mesh, std::size_t initialCapacity) :
+        mesh(mesh),
+        meshBounds(mesh.getBounds()),
+        program(ProgramRegistry::getDefault().acquire(getVertexShaderSource(), getFragmentShaderSource())),
+        vertexArray(0),
+        vertexBuffer(0),
+        indexBuffer(0),
+        instanceBuffer(0),
+        capacity(std::max<std::size_t>(initialCapacity, 1)),
+        dirtyBegin(0),
+        dirtyEnd(0)
+    {
+        std::vector<GLfloat> vertices;
+        vertices.reserve(mesh.getVertices().size() * 8);
+        for(const Vertex32F& vertex : mesh.getVertices())
+        {
+            vertices.insert(vertices.end(), {
+                vertex.getPosition()[0], vertex.getPosition()[1], vertex.getPosition()[2],
+                vertex.getNormal()[0], vertex.getNormal()[1], vertex.getNormal()[2],
+                vertex.getTexCoord()[0], vertex.getTexCoord()[1]
+            });
+        }
+        std::vector<GLuint> indices;
+        for(const Mesh::Renderable& renderable : mesh.getMeshes())
+        {
+            ranges.push_back(std::make_pair(indices.size(), static_cast<GLsizei>(renderable.indices.size())));
+            for(std::size_t index : renderable.indices)
+            {
+                indices.push_back(static_cast<GLuint>(index));
+            }
+        }
+
+        glGenVertexArrays(1, &vertexArray);
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+        glGenBuffers(1, &instanceBuffer);
+        glBindVertexArray(vertexArray);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(GLfloat)), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
+
+        /// The attribute locations are fixed by the shader, so the vertex array can be recorded once
+        program->bind();
+        GLint handle;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &handle);
+        auto locate = [&](const char* name)
+        {
+            return glGetAttribLocation(static_cast<GLuint>(handle), name);
+        };
+
+        const GLsizei vertexStride = 8 * sizeof(GLfloat);
+        GLint location = locate("position");
+        if(location != -1)
+        {
+            glEnableVertexAttribArray(static_cast<GLuint>(location));
+            glVertexAttribPointer(static_cast<GLuint>(location), 3, GL_FLOAT, GL_FALSE, vertexStride, reinterpret_cast<const GLvoid*>(0));
+        }
+        location = locate("uv_in");
+        if(location != -1)
+        {
+            glEnableVertexAttribArray(static_cast<GLuint>(location));
+            glVertexAttribPointer(static_cast<GLuint>(location), 2, GL_FLOAT, GL_FALSE, vertexStride, reinterpret_cast<const GLvoid*>(6 * sizeof(GLfloat)));
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(InstanceData)), nullptr, GL_DYNAMIC_DRAW);
+        const GLsizei instanceStride = sizeof(InstanceData);
+        location = locate("instance_transform");
+        if(location != -1)
+        {
+            /// A mat4 attribute occupies four consecutive locations, one per column
+            for(GLuint column = 0; column < 4; ++column)
+            {
+                glEnableVertexAttribArray(static_cast<GLuint>(location) + column);
+                glVertexAttribPointer(static_cast<GLuint>(location) + column, 4, GL_FLOAT, GL_FALSE, instanceStride,
+                        reinterpret_cast<const GLvoid*>(column * 4 * sizeof(GLfloat)));
+                glVertexAttribDivisor(static_cast<GLuint>(location) + column, 1);
+            }
+        }
+        location = locate("instance_color");
+        if(location != -1)
+        {
+            glEnableVertexAttribArray(static_cast<GLuint>(location));
+            glVertexAttribPointer(static_cast<GLuint>(location), 4, GL_FLOAT, GL_FALSE, instanceStride,
+                    reinterpret_cast<const GLvoid*>(16 * sizeof(GLfloat)));
+            glVertexAttribDivisor(static_cast<GLuint>(location), 1);
+        }
+        program->unbind();
+        FrameUniforms::attach(*program);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        if(glGetError() == GL_OUT_OF_MEMORY)
+        {
+            glDeleteVertexArrays(1, &vertexArray);
+            GLuint buffers[] = {vertexBuffer, indexBuffer, instanceBuffer};
+            glDeleteBuffers(3, buffers);
+            throw ResourceException("Unable to allocate GPU memory for InstancedMeshNode");
+        }
+    }
+
+    inline InstancedMeshNode::~InstancedMeshNode()
+    {
+        /// Call should never fail
+        glDeleteVertexArrays(1, &vertexArray);
+        GLuint buffers[] = {vertexBuffer, indexBuffer, instanceBuffer};
+        glDeleteBuffers(3, buffers);
+    }
+
+    inline InstancedMeshNode::InstanceHandle InstancedMeshNode::addInstance(const Matrix4x4F& transform, const Color4F& color)
+    {
+        InstanceData data;
+        std::memcpy(data.transform, &transform, sizeof(data.transform));
+        for(std::size_t i = 0; i < 4; ++i)
+        {
+            data.color[i] = color[i];
+        }
+
+        InstanceHandle instance;
+        if(releasedHandles.empty())
+        {
+            instance = handleSlots.size();
+            handleSlots.push_back(instances.size());
+        }
+        else
+        {
+            instance = releasedHandles.back();
+            releasedHandles.pop_back();
+            handleSlots[instance] = instances.size();
+        }
+        markDirty(instances.size());
+        instances.push_back(data);
+        slotHandles.push_back(instance);
+        invalidateBounds();
+        return instance;
+    }
+
+    inline void InstancedMeshNode::removeInstance(InstanceHandle instance)
+    {
+        const std::size_t slot = slotOf(instance);
+        const std::size_t last = instances.size() - 1;
+        if(slot != last)
+        {
+            /// Fill the hole with the last instance to keep the storage dense
+            instances[slot] = instances[last];
+            slotHandles[slot] = slotHandles[last];
+            handleSlots[slotHandles[slot]] = slot;
+            markDirty(slot);
+        }
+        instances.pop_back();
+        slotHandles.pop_back();
+        handleSlots[instance] = RELEASED;
+        releasedHandles.push_back(instance);
+        invalidateBounds();
+    }
+
+    inline void InstancedMeshNode::setTransform(InstanceHandle instance, const Matrix4x4F& transform)
+    {
+        const std::size_t slot = slotOf(instance);
+        std::memcpy(instances[slot].transform, &transform, sizeof(instances[slot].transform));
+        markDirty(slot);
+        invalidateBounds();
+    }
+
+    inline void InstancedMeshNode::setColor(InstanceHandle instance, const Color4F& color)
+    {
+        const std::size_t slot = slotOf(instance);
+        for(std::size_t i = 0; i < 4; ++i)
+        {
+            instances[slot].color[i] = color[i];
+        }
+        markDirty(slot);
+    }
+
+    inline BoundingBoxF InstancedMeshNode::computeBounds()
+    {
+        BoundingBoxF rv = AbstractSceneGraphNode::computeBounds();
+        for(const InstanceData& instance : instances)
+        {
+            /// The transform is stored column-major, as Matrix4x4F is
+            Matrix4x4F transform;
+            for(std::size_t i = 0; i < 16; ++i)
+            {
+                transform(i % 4, i / 4) = instance.transform[i];
+            }
+            rv.merge(meshBounds.transform(transform));
+        }
+        return rv;
+    }
+
+    inline std::size_t InstancedMeshNode::getInstanceCount() const noexcept
+    {
+        return instances.size();
+    }
+
+    inline void InstancedMeshNode::render(const Camera& camera)
+    {
+        if(!instances.empty())
+        {
+            upload();
+            program->bind();
+            FrameUniforms::getActive().bindObject();
+            glBindVertexArray(vertexArray);
+            for(const std::pair<std::size_t, GLsizei>& range : ranges)
+            {
+                glDrawElementsInstanced(GL_TRIANGLES, range.second, GL_UNSIGNED_INT,
+                        reinterpret_cast<const GLvoid*>(range.first * sizeof(GLuint)), static_cast<GLsizei>(instances.size()));
+            }
+            glBindVertexArray(0);
+            program->unbind();
+        }
+
+        /// Render my children
+        this->AbstractSceneGraphNode::render(camera);
+    }
+
+    inline std::size_t InstancedMeshNode::slotOf(InstanceHandle instance) const
+    {
+        if(instance >= handleSlots.size() || handleSlots[instance] == RELEASED)
+        {
+            throw IllegalArgumentException(std::string("No instance exists for handle ") + std::to_string(instance));
+        }
+        return handleSlots[instance];
+    }
+
+    inline void InstancedMeshNode::markDirty(std::size_t slot) noexcept
+    {
+        if(dirtyBegin == dirtyEnd)
+        {
+            dirtyBegin = slot;
+            dirtyEnd = slot + 1;
+        }
+        else
+        {
+            dirtyBegin = std::min(dirtyBegin, slot);
+            dirtyEnd = std::max(dirtyEnd, slot + 1);
+        }
+    }
+
+    inline void InstancedMeshNode::upload()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        if(instances.size() > capacity)
+        {
+            /// Respecifying the storage keeps the vertex array valid, but everything must be uploaded again
+            capacity = std::max(instances.size(), capacity * 2);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(InstanceData)), nullptr, GL_DYNAMIC_DRAW);
+            dirtyBegin = 0;
+            dirtyEnd = instances.size();
+        }
+        /// Slots past the end were removed and need not be uploaded
+        dirtyEnd = std::min(dirtyEnd, instances.size());
+        if(dirtyBegin < dirtyEnd)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(dirtyBegin * sizeof(InstanceData)),
+                    static_cast<GLsizeiptr>((dirtyEnd - dirtyBegin) * sizeof(InstanceData)), &instances[dirtyBegin]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dirtyBegin = dirtyEnd = 0;
+    }
+
+    inline const std::string& InstancedMeshNode::getVertexShaderSource()
+    {
+        static const std::string source = std::string("#version 330\n") + FrameUniforms::GLSL_BLOCKS +
+            "in vec3 position;\n\
+            in vec2 uv_in;\n\
+            in mat4 instance_transform;\n\
+            in vec4 instance_color;\n\
+            out vec2 uv_out;\n\
+            out vec4 color_out;\n\
+            void main()\n\
+            {\n\
+                vec4 world = vec4(position, 1.0) * instance_transform;\n\
+                gl_Position = world * object.model_view_projection;\n\
+                uv_out = uv_in;\n\
+                color_out = instance_color;\n\
+            }";
+        return source;
+    }
+
+    inline const std::string& InstancedMeshNode::getFragmentShaderSource()
+    {
+        static const std::string source =
+            "#version 330\n\
+            in vec2 uv_out;\n\
+            in vec4 color_out;\n\
+            uniform sampler2D tex;\n\
+            out vec4 fragment;\n\
+            void main()\n\
+            {\n\
+                fragment = texture(tex, uv_out) * color_out;\n\
+            }";
+        return source;
+    }
+
+}
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+#include "IllegalArgumentException.hpp"
+#include "parallel_for.hpp"
+
+namespace midnight
+{
+
+    namespace octree
+    {
+
+        /// The deepest subdivision a LooseOctree supports
+        constexpr std::size_t MAXIMUM_DEPTH = 20;
+
+        /// The most cells a traversal holds at once: the siblings left at every level
+        constexpr std::size_t STACK_SIZE = 8 * (MAXIMUM_DEPTH + 1);
+
+    }
+
+    template<typename T>
+    constexpr std::size_t LooseOctree<T>::DEFAULT_MAXIMUM_DEPTH;
+
+    template<typename T>
+    constexpr std::uint32_t LooseOctree<T>::NONE;
+
+    template<typename T>
+    inline LooseOctree<T>::LooseOctree(const BoundingBoxF& world, std::size_t maximumDepth) :
+        objectCount(0),
+        maximumDepth(maximumDepth)
+    {
+        if(world.isEmpty())
+        {
+            throw IllegalArgumentException("The world of a LooseOctree must not be empty");
+        }
+        if(maximumDepth > octree::MAXIMUM_DEPTH)
+        {
+            throw IllegalArgumentException("The depth of a LooseOctree must not exceed 20");
+        }
+        Cell root;
+        const Vector3F extents = world.getExtents();
+        const Point3F center = world.getCenter();
+        for(std::size_t i = 0; i < 3; ++i)
+        {
+            root.center[i] = center[i];
+        }
+        root.half = std::max(std::max(extents[0], extents[1]), std::max(extents[2], std::numeric_limits<float>::min()));
+        root.parent = NONE;
+        std::fill(root.children, root.children + 8, NONE);
+        root.first = NONE;
+        root.objectCount = 0;
+        root.childCount = 0;
+        root.depth = 0;
+        root.octant = 0;
+        cells.push_back(root);
+    }
+
+    template<typename T>
+    inline typename LooseOctree<T>::Handle LooseOctree<T>::insert(const BoundingBoxF& bounds, const T& value)
+    {
+        std::uint32_t index;
+        if(releasedObjects.empty())
+        {
+            index = static_cast<std::uint32_t>(objects.size());
+            objects.push_back(Object());
+            objects[index].generation = 0;
+        }
+        else
+        {
+            index = releasedObjects.back();
+            releasedObjects.pop_back();
+        }
+        Object& object = objects[index];
+        object.bounds = bounds;
+        object.value = value;
+        link(index, locate(bounds));
+        ++objectCount;
+        return Handle(index, object.generation);
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::update(Handle object, const BoundingBoxF& bounds)
+    {
+        check(object);
+        Object& slot = objects[object.index];
+        slot.bounds = bounds;
+
+        /// Most moves keep the center within the cell, and cost nothing more
+        if(!belongs(bounds, cells[slot.cell]))
+        {
+            unlink(object.index);
+            link(object.index, locate(bounds));
+        }
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::remove(Handle object)
+    {
+        check(object);
+        unlink(object.index);
+        Object& slot = objects[object.index];
+        slot.value = T();
+        ++slot.generation;
+        releasedObjects.push_back(object.index);
+        --objectCount;
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::clear()
+    {
+        for(std::uint32_t i = 0; i < objects.size(); ++i)
+        {
+            if(objects[i].cell != NONE)
+            {
+                objects[i].cell = NONE;
+                objects[i].value = T();
+                ++objects[i].generation;
+                releasedObjects.push_back(i);
+            }
+        }
+        cells.resize(1);
+        releasedCells.clear();
+        std::fill(cells[0].children, cells[0].children + 8, NONE);
+        cells[0].first = NONE;
+        cells[0].objectCount = 0;
+        cells[0].childCount = 0;
+        objectCount = 0;
+    }
+
+    template<typename T>
+    inline bool LooseOctree<T>::isValid(Handle object) const noexcept
+    {
+        return object.index < objects.size() && objects[object.index].cell != NONE &&
+                objects[object.index].generation == object.generation;
+    }
+
+    template<typename T>
+    inline T& LooseOctree<T>::get(Handle object)
+    {
+        check(object);
+        return objects[object.index].value;
+    }
+
+    template<typename T>
+    inline const T& LooseOctree<T>::get(Handle object) const
+    {
+        check(object);
+        return objects[object.index].value;
+    }
+
+    template<typename T>
+    inline const BoundingBoxF& LooseOctree<T>::getBounds(Handle object) const
+    {
+        check(object);
+        return objects[object.index].bounds;
+    }
+
+    template<typename T>
+    inline std::size_t LooseOctree<T>::getSize() const noexcept
+    {
+        return objectCount;
+    }
+
+    template<typename T>
+    inline std::size_t LooseOctree<T>::getCellCount() const noexcept
+    {
+        return cells.size() - releasedCells.size();
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::query(const BoundingBoxF& box, std::vector<Handle>& results) const
+    {
+        if(box.isEmpty())
+        {
+            return;
+        }
+        std::uint32_t stack[octree::STACK_SIZE];
+        std::size_t size = 0;
+        stack[size++] = 0;
+        while(size != 0)
+        {
+            const Cell& cell = cells[stack[--size]];
+            for(std::uint32_t i = cell.first; i != NONE; i = objects[i].next)
+            {
+                if(objects[i].bounds.intersects(box))
+                {
+                    results.push_back(Handle(i, objects[i].generation));
+                }
+            }
+            for(std::uint32_t child : cell.children)
+            {
+                if(child != NONE && getLooseBounds(cells[child]).intersects(box))
+                {
+                    stack[size++] = child;
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::query(const Ray& ray, float maximum, std::vector<RayHit>& results) const
+    {
+        const std::size_t first = results.size();
+        std::uint32_t stack[octree::STACK_SIZE];
+        std::size_t size = 0;
+        stack[size++] = 0;
+        while(size != 0)
+        {
+            const Cell& cell = cells[stack[--size]];
+            for(std::uint32_t i = cell.first; i != NONE; i = objects[i].next)
+            {
+                float distance;
+                if(ray.intersects(objects[i].bounds, distance, maximum))
+                {
+                    RayHit hit;
+                    hit.handle = Handle(i, objects[i].generation);
+                    hit.distance = distance;
+                    results.push_back(hit);
+                }
+            }
+            for(std::uint32_t child : cell.children)
+            {
+                float distance;
+                if(child != NONE && ray.intersects(getLooseBounds(cells[child]), distance, maximum))
+                {
+                    stack[size++] = child;
+                }
+            }
+        }
+        std::sort(results.begin() + first, results.end(), [](const RayHit& lhs, const RayHit& rhs)
+        {
+            return lhs.distance < rhs.distance;
+        });
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::nearest(const Point3F& point, std::size_t count, std::vector<Handle>& results, float maximum) const
+    {
+        if(count == 0)
+        {
+            return;
+        }
+        typedef std::pair<float, std::uint32_t> Entry;
+        const float limit = maximum * maximum;
+
+        /// Cells are visited nearest first, until the nearest remaining cell is further than the
+        /// furthest of the objects found
+        std::vector<Entry> pending;
+        std::vector<Entry> found;
+        pending.push_back(Entry(0.0f, 0));
+        while(!pending.empty())
+        {
+            std::pop_heap(pending.begin(), pending.end(), std::greater<Entry>());
+            const Entry entry = pending.back();
+            pending.pop_back();
+            if(found.size() == count && entry.first >= found.front().first)
+            {
+                break;
+            }
+            const Cell& cell = cells[entry.second];
+            for(std::uint32_t i = cell.first; i != NONE; i = objects[i].next)
+            {
+                const float distance = squaredDistance(point, objects[i].bounds);
+                if(distance > limit)
+                {
+                    continue;
+                }
+                if(found.size() < count)
+                {
+                    found.push_back(Entry(distance, i));
+                    std::push_heap(found.begin(), found.end());
+                }
+                else if(distance < found.front().first)
+                {
+                    std::pop_heap(found.begin(), found.end());
+                    found.back() = Entry(distance, i);
+                    std::push_heap(found.begin(), found.end());
+                }
+            }
+            for(std::uint32_t child : cell.children)
+            {
+                if(child != NONE)
+                {
+                    const float distance = squaredDistance(point, getLooseBounds(cells[child]));
+                    if(distance <= limit)
+                    {
+                        pending.push_back(Entry(distance, child));
+                        std::push_heap(pending.begin(), pending.end(), std::greater<Entry>());
+                    }
+                }
+            }
+        }
+        std::sort_heap(found.begin(), found.end());
+        for(const Entry& entry : found)
+        {
+            results.push_back(Handle(entry.second, objects[entry.second].generation));
+        }
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::query(const std::vector<BoundingBoxF>& boxes, std::vector<Handle>& results,
+            std::vector<std::size_t>& offsets) const
+    {
+        batch(boxes.size(), results, offsets, [this, &boxes](std::size_t i, std::vector<Handle>& answer)
+        {
+            query(boxes[i], answer);
+        });
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::query(const std::vector<Ray>& rays, float maximum, std::vector<RayHit>& results,
+            std::vector<std::size_t>& offsets) const
+    {
+        batch(rays.size(), results, offsets, [this, &rays, maximum](std::size_t i, std::vector<RayHit>& answer)
+        {
+            query(rays[i], maximum, answer);
+        });
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::nearest(const std::vector<Point3F>& points, std::size_t count,
+            std::vector<Handle>& results, std::vector<std::size_t>& offsets) const
+    {
+        batch(points.size(), results, offsets, [this, &points, count](std::size_t i, std::vector<Handle>& answer)
+        {
+            nearest(points[i], count, answer);
+        });
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::check(Handle object) const
+    {
+        if(!isValid(object))
+        {
+            throw IllegalArgumentException("Invalid LooseOctree handle");
+        }
+    }
+
+    template<typename T>
+    inline std::uint32_t LooseOctree<T>::locate(const BoundingBoxF& bounds)
+    {
+        if(!encloses(cells[0], bounds))
+        {
+            return 0;
+        }
+        const Point3F center = bounds.getCenter();
+        const std::size_t depth = computeDepth(bounds);
+        std::uint32_t cell = 0;
+        while(cells[cell].depth < depth)
+        {
+            const Cell& current = cells[cell];
+            const std::uint8_t octant = static_cast<std::uint8_t>((center[0] >= current.center[0] ? 1 : 0) |
+                    (center[1] >= current.center[1] ? 2 : 0) | (center[2] >= current.center[2] ? 4 : 0));
+            const std::uint32_t child = current.children[octant];
+            cell = child == NONE ? createCell(cell, octant) : child;
+        }
+        return cell;
+    }
+
+    template<typename T>
+    inline bool LooseOctree<T>::belongs(const BoundingBoxF& bounds, const Cell& cell) const noexcept
+    {
+        /// The root also holds what no other cell can: empty bounds and those centered outside
+        if(!encloses(cells[0], bounds))
+        {
+            return cell.depth == 0;
+        }
+        return encloses(cell, bounds) && computeDepth(bounds) == cell.depth;
+    }
+
+    template<typename T>
+    inline bool LooseOctree<T>::encloses(const Cell& cell, const BoundingBoxF& bounds) noexcept
+    {
+        if(bounds.isEmpty())
+        {
+            return false;
+        }
+        const Point3F center = bounds.getCenter();
+        for(std::size_t i = 0; i < 3; ++i)
+        {
+            if(std::abs(center[i] - cell.center[i]) > cell.half)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename T>
+    inline std::size_t LooseOctree<T>::computeDepth(const BoundingBoxF& bounds) const noexcept
+    {
+        const Vector3F extents = bounds.getExtents();
+        const float size = std::max(std::max(extents[0], extents[1]), extents[2]);
+        std::size_t depth = 0;
+        float half = cells[0].half;
+        while(depth < maximumDepth && half * 0.5f >= size)
+        {
+            half *= 0.5f;
+            ++depth;
+        }
+        return depth;
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::link(std::uint32_t object, std::uint32_t cell) noexcept
+    {
+        Object& slot = objects[object];
+        Cell& target = cells[cell];
+        slot.cell = cell;
+        slot.previous = NONE;
+        slot.next = target.first;
+        if(target.first != NONE)
+        {
+            objects[target.first].previous = object;
+        }
+        target.first = object;
+        ++target.objectCount;
+    }
+
+    template<typename T>
+    inline void LooseOctree<T>::unlink(std::uint32_t object) noexcept
+    {
+        Object& slot = objects[object];
+        std::uint32_t cell = slot.cell;
+        if(slot.previous != NONE)
+        {
+            objects[slot.previous].next = slot.next;
+        }
+        else
+        {
+            cells[cell].first = slot.next;
+        }
+        if(slot.next != NONE)
+        {
+            objects[slot.next].previous = slot.previous;
+        }
+        slot.cell = NONE;
+        --cells[cell].objectCount;
+
+        while(cell != 0 && cells[cell].objectCount == 0 && cells[cell].childCount == 0)
+        {
+            const std::uint32_t parent = cells[cell].parent;
+            cells[parent].children[cells[cell].octant] = NONE;
+            --cells[parent].childCount;
+            releasedCells.push_back(cell);
+            cell = parent;
+        }
+    }
+
+    template<typename T>
+    inline std::uint32_t LooseOctree<T>::createCell(std::uint32_t parent, std::uint8_t octant)
+    {
+        std::uint32_t index;
+        if(releasedCells.empty())
+        {
+            index = static_cast<std::uint32_t>(cells.size());
+            cells.push_back(Cell());
+        }
+        else
+        {
+            index = releasedCells.back();
+            releasedCells.pop_back();
+        }
+        Cell& cell = cells[index];
+        const Cell& owner = cells[parent];
+        cell.half = owner.half * 0.5f;
+        for(std::size_t i = 0; i < 3; ++i)
+        {
+            cell.center[i] = owner.center[i] + ((octant >> i) & 1 ? cell.half : -cell.half);
+        }
+        cell.parent = parent;
+        std::fill(cell.children, cell.children + 8, NONE);
+        cell.first = NONE;
+        cell.objectCount = 0;
+        cell.childCount = 0;
+        cell.depth = static_cast<std::uint8_t>(owner.depth + 1);
+        cell.octant = octant;
+        cells[parent].children[octant] = index;
+        ++cells[parent].childCount;
+        return index;
+    }
+
+    template<typename T>
+    inline BoundingBoxF LooseOctree<T>::getLooseBounds(const Cell& cell) const noexcept
+    {
+        const float reach = 2.0f * cell.half;
+        return BoundingBoxF(Point3F(cell.center[0] - reach, cell.center[1] - reach, cell.center[2] - reach),
+                Point3F(cell.center[0] + reach, cell.center[1] + reach, cell.center[2] + reach));
+    }
+
+    template<typename T>
+    inline float LooseOctree<T>::squaredDistance(const Point3F& point, const BoundingBoxF& box) noexcept
+    {
+        if(box.isEmpty())
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+        float rv = 0.0f;
+        for(std::size_t i = 0; i < 3; ++i)
+        {
+            const float outside = std::max(std::max(box.getMinimum(i) - point[i], point[i] - box.getMaximum(i)), 0.0f);
+            rv += outside * outside;
+        }
+        return rv;
+    }
+
+    template<typename T>
+    template<typename Result, typename F>
+    inline void LooseOctree<T>::batch(std::size_t count, std::vector<Result>& results, std::vector<std::size_t>& offsets, F query)
+    {
+        std::vector<std::vector<Result>> answers(count);
+        parallel_for(0, count, [&answers, &query](std::size_t i)
+        {
+            query(i, answers[i]);
+        });
+        results.clear();
+        offsets.resize(count + 1);
+        offsets[0] = 0;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            offsets[i + 1] = offsets[i] + answers[i].size();
+        }
+        results.reserve(offsets[count]);
+        for(const std::vector<Result>& answer : answers)
+        {
+            results.insert(results.end(), answer.begin(), answer.end());
+        }
+    }
+
+}
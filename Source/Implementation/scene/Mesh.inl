@@ -7,6 +7,16 @@ namespace midnight
         
     }
 
+    inline BoundingBoxF Mesh::getBounds() const noexcept
+    {
+        BoundingBoxF rv;
+        for(const Vertex32F& vertex : vertices)
+        {
+            rv.merge(vertex.getPosition());
+        }
+        return rv;
+    }
+
 
 
     inline std::ostream& operator<<(std::ostream& stream, const Mesh& /*mesh*/)
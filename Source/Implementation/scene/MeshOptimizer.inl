@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "IllegalArgumentException.hpp"
+#include "parallel_for.hpp"
+
+namespace midnight
+{
+
+    namespace detail
+    {
+        /// Marks a vertex or triangle that has not been assigned
+        constexpr std::size_t UNASSIGNED = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * Validates that the provided indices form a triangle list over the provided vertices
+         *
+         */
+        inline void validateTriangleList(const std::vector<std::size_t>& indices, std::size_t vertexCount)
+        {
+            if(indices.size() % 3 != 0)
+            {
+                throw IllegalArgumentException("Renderable indices must form a triangle list");
+            }
+            for(std::size_t index : indices)
+            {
+                if(index >= vertexCount)
+                {
+                    throw IllegalArgumentException(std::string("Renderable references vertex ") + std::to_string(index) +
+                            " of a Mesh with only " + std::to_string(vertexCount) + " vertices");
+                }
+            }
+        }
+
+        /**
+         * Scores a vertex according to its position in the simulated LRU cache and the number of
+         * triangles that still reference it (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+         *
+         */
+        inline float forsythVertexScore(std::size_t cachePosition, std::size_t remaining, std::size_t cacheSize)
+        {
+            if(remaining == 0)
+            {
+                /// No triangle needs this vertex anymore
+                return -1.0f;
+            }
+            float score = 0.0f;
+            if(cachePosition != UNASSIGNED)
+            {
+                if(cachePosition < 3)
+                {
+                    /// The vertices of the last triangle are deliberately penalized to avoid strips
+                    score = 0.75f;
+                }
+                else
+                {
+                    float scaler = 1.0f / static_cast<float>(cacheSize - 3);
+                    score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, 1.5f);
+                }
+            }
+            /// Boost vertices with few remaining triangles so that lone triangles are not left behind
+            return score + 2.0f / std::sqrt(static_cast<float>(remaining));
+        }
+    }
+
+    inline MeshOptimizer::MeshOptimizer(std::size_t cacheSize, float overdrawThreshold) :
+        cacheSize(cacheSize),
+        overdrawThreshold(overdrawThreshold)
+    {
+        if(cacheSize < 4)
+        {
+            throw IllegalArgumentException("The vertex cache must hold at least 4 entries");
+        }
+    }
+
+    inline MeshOptimizer::Report MeshOptimizer::optimize(Mesh& mesh) const
+    {
+        const std::size_t vertexCount = mesh.vertices.size();
+        for(const Mesh::Renderable& renderable : mesh.meshes)
+        {
+            detail::validateTriangleList(renderable.indices, vertexCount);
+        }
+
+        std::vector<Statistics> before(mesh.meshes.size());
+        std::vector<Statistics> after(mesh.meshes.size());
+
+        /// Each Renderable only reads the shared vertex data, so they may be processed concurrently
+        parallel_for(0, mesh.meshes.size(), [&](std::size_t i)
+        {
+            std::vector<std::size_t>& indices = mesh.meshes[i].indices;
+            before[i] = analyze(indices, vertexCount, cacheSize);
+            optimizeVertexCache(indices, vertexCount, cacheSize);
+            optimizeOverdraw(indices, mesh.vertices, cacheSize, overdrawThreshold);
+            after[i] = analyze(indices, vertexCount, cacheSize);
+        });
+
+        /// The vertex buffer is shared between Renderables, so this pass must be serial
+        optimizeVertexFetch(mesh.vertices, mesh.meshes);
+
+        Report report;
+        for(std::size_t i = 0; i < before.size(); ++i)
+        {
+            report.before += before[i];
+            report.after += after[i];
+        }
+        return report;
+    }
+
+    inline MeshOptimizer::Statistics MeshOptimizer::analyze(const std::vector<std::size_t>& indices, std::size_t vertexCount, std::size_t cacheSize)
+    {
+        Statistics statistics;
+        statistics.triangles = indices.size() / 3;
+
+        /// A vertex is resident if it was inserted within the last 'cacheSize' misses
+        std::vector<std::size_t> insertedAt(vertexCount, detail::UNASSIGNED);
+        std::size_t clock = 0;
+        for(std::size_t index : indices)
+        {
+            if(insertedAt[index] == detail::UNASSIGNED)
+            {
+                ++statistics.vertices;
+            }
+            if(insertedAt[index] == detail::UNASSIGNED || clock - insertedAt[index] >= cacheSize)
+            {
+                insertedAt[index] = clock++;
+                ++statistics.transforms;
+            }
+        }
+        return statistics;
+    }
+
+    inline void MeshOptimizer::optimizeVertexCache(std::vector<std::size_t>& indices, std::size_t vertexCount, std::size_t cacheSize)
+    {
+        const std::size_t triangleCount = indices.size() / 3;
+        if(triangleCount < 2)
+        {
+            return;
+        }
+
+        /// Build a compact vertex -> triangle adjacency list
+        std::vector<std::size_t> remaining(vertexCount, 0);
+        for(std::size_t index : indices)
+        {
+            ++remaining[index];
+        }
+        std::vector<std::size_t> offsets(vertexCount + 1, 0);
+        for(std::size_t v = 0; v < vertexCount; ++v)
+        {
+            offsets[v + 1] = offsets[v] + remaining[v];
+        }
+        std::vector<std::size_t> adjacency(indices.size());
+        {
+            std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+            for(std::size_t i = 0; i < indices.size(); ++i)
+            {
+                adjacency[cursor[indices[i]]++] = i / 3;
+            }
+        }
+
+        std::vector<std::size_t> cachePosition(vertexCount, detail::UNASSIGNED);
+        std::vector<float> vertexScore(vertexCount);
+        for(std::size_t v = 0; v < vertexCount; ++v)
+        {
+            vertexScore[v] = detail::forsythVertexScore(detail::UNASSIGNED, remaining[v], cacheSize);
+        }
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        std::size_t best = 0;
+        for(std::size_t t = 0; t < triangleCount; ++t)
+        {
+            triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+            if(triangleScore[t] > triangleScore[best])
+            {
+                best = t;
+            }
+        }
+
+        std::vector<std::size_t> output;
+        output.reserve(indices.size());
+        std::vector<std::size_t> cache;
+        std::vector<std::size_t> grown;
+        cache.reserve(cacheSize + 3);
+        grown.reserve(cacheSize + 3);
+        std::size_t cursor = 0;
+
+        for(std::size_t count = 0; count < triangleCount; ++count)
+        {
+            if(best == detail::UNASSIGNED)
+            {
+                /// Nothing adjacent to the cache remains, so restart from the next unemitted triangle
+                while(emitted[cursor])
+                {
+                    ++cursor;
+                }
+                best = cursor;
+            }
+
+            const std::size_t triangle = best;
+            emitted[triangle] = true;
+            grown.clear();
+            for(std::size_t k = 0; k < 3; ++k)
+            {
+                const std::size_t v = indices[3 * triangle + k];
+                output.push_back(v);
+                grown.push_back(v);
+
+                /// Detach the emitted triangle from the vertex
+                std::size_t* begin = &adjacency[offsets[v]];
+                std::size_t* end = begin + remaining[v];
+                std::size_t* found = std::find(begin, end, triangle);
+                if(found != end)
+                {
+                    std::swap(*found, *(end - 1));
+                    --remaining[v];
+                }
+            }
+
+            /// Move the triangle's vertices to the front of the LRU cache
+            for(std::size_t v : cache)
+            {
+                if(std::find(grown.begin(), grown.begin() + 3, v) == grown.begin() + 3)
+                {
+                    grown.push_back(v);
+                }
+            }
+
+            for(std::size_t i = 0; i < grown.size(); ++i)
+            {
+                const std::size_t v = grown[i];
+                cachePosition[v] = i < cacheSize ? i : detail::UNASSIGNED;
+                vertexScore[v] = detail::forsythVertexScore(cachePosition[v], remaining[v], cacheSize);
+            }
+
+            /// Only triangles touching the cache are candidates for the next emission
+            best = detail::UNASSIGNED;
+            float bestScore = -std::numeric_limits<float>::max();
+            for(std::size_t v : grown)
+            {
+                for(std::size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+                {
+                    const std::size_t t = adjacency[a];
+                    triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+                    if(triangleScore[t] > bestScore)
+                    {
+                        bestScore = triangleScore[t];
+                        best = t;
+                    }
+                }
+            }
+
+            if(grown.size() > cacheSize)
+            {
+                grown.resize(cacheSize);
+            }
+            cache.swap(grown);
+        }
+        indices.swap(output);
+    }
+
+    inline void MeshOptimizer::optimizeOverdraw(std::vector<std::size_t>& indices, const std::vector<Vertex32F>& vertices, std::size_t cacheSize, float threshold)
+    {
+        const std::size_t triangleCount = indices.size() / 3;
+        if(triangleCount < 2)
+        {
+            return;
+        }
+
+        /// Simulate the cache to find the misses of each triangle
+        std::vector<std::size_t> misses(triangleCount, 0);
+        std::vector<std::size_t> insertedAt(vertices.size(), detail::UNASSIGNED);
+        std::size_t clock = 0;
+        for(std::size_t i = 0; i < indices.size(); ++i)
+        {
+            const std::size_t v = indices[i];
+            if(insertedAt[v] == detail::UNASSIGNED || clock - insertedAt[v] >= cacheSize)
+            {
+                insertedAt[v] = clock++;
+                ++misses[i / 3];
+            }
+        }
+
+        /// Hard boundaries are placed wherever the cache was flushed completely
+        std::vector<std::size_t> hard;
+        for(std::size_t t = 0; t < triangleCount; ++t)
+        {
+            if(t == 0 || misses[t] == 3)
+            {
+                hard.push_back(t);
+            }
+        }
+        hard.push_back(triangleCount);
+
+        /// Soft boundaries split a hard cluster wherever the local ACMR is already acceptable
+        std::vector<std::size_t> clusters;
+        for(std::size_t h = 0; h + 1 < hard.size(); ++h)
+        {
+            std::size_t clusterMisses = 0;
+            for(std::size_t t = hard[h]; t < hard[h + 1]; ++t)
+            {
+                clusterMisses += misses[t];
+            }
+            const float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(hard[h + 1] - hard[h]);
+
+            clusters.push_back(hard[h]);
+            std::size_t runningMisses = 0;
+            std::size_t runningTriangles = 0;
+            for(std::size_t t = hard[h]; t + 1 < hard[h + 1]; ++t)
+            {
+                runningMisses += misses[t];
+                ++runningTriangles;
+                if(runningTriangles > 1 && static_cast<float>(runningMisses) / static_cast<float>(runningTriangles) <= limit)
+                {
+                    clusters.push_back(t + 1);
+                    runningMisses = 0;
+                    runningTriangles = 0;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        /// Compute the area-weighted centroid and normal of each cluster
+        const std::size_t clusterCount = clusters.size() - 1;
+        std::vector<Vector3F> centroids(clusterCount);
+        std::vector<Vector3F> normals(clusterCount);
+        Vector3F meshCentroid;
+        float meshArea = 0.0f;
+        for(std::size_t c = 0; c < clusterCount; ++c)
+        {
+            float area = 0.0f;
+            for(std::size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+            {
+                const Point3F& p0 = vertices[indices[3 * t]].getPosition();
+                const Point3F& p1 = vertices[indices[3 * t + 1]].getPosition();
+                const Point3F& p2 = vertices[indices[3 * t + 2]].getPosition();
+                Vector3F normal = cross(Vector3F(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]),
+                                        Vector3F(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]));
+                const float weight = normal.length() * 0.5f;
+                for(std::size_t k = 0; k < 3; ++k)
+                {
+                    centroids[c][k] += (p0[k] + p1[k] + p2[k]) * (weight / 3.0f);
+                }
+                normals[c] += normal;
+                area += weight;
+            }
+            for(std::size_t k = 0; k < 3; ++k)
+            {
+                meshCentroid[k] += centroids[c][k];
+            }
+            meshArea += area;
+            if(area > 0.0f)
+            {
+                centroids[c] *= 1.0f / area;
+            }
+        }
+        if(meshArea > 0.0f)
+        {
+            meshCentroid *= 1.0f / meshArea;
+        }
+
+        /// Clusters facing away from the center of the mesh are likely occluders, so draw them first
+        std::vector<float> sortKeys(clusterCount);
+        std::vector<std::size_t> order(clusterCount);
+        for(std::size_t c = 0; c < clusterCount; ++c)
+        {
+            order[c] = c;
+            Vector3F offset(centroids[c][0] - meshCentroid[0], centroids[c][1] - meshCentroid[1], centroids[c][2] - meshCentroid[2]);
+            sortKeys[c] = dot(offset, normals[c]);
+        }
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](std::size_t lhs, std::size_t rhs)
+        {
+            return sortKeys[lhs] > sortKeys[rhs];
+        });
+
+        std::vector<std::size_t> output;
+        output.reserve(indices.size());
+        for(std::size_t c : order)
+        {
+            output.insert(output.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+        }
+        indices.swap(output);
+    }
+
+    inline void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex32F>& vertices, std::vector<Mesh::Renderable>& renderables)
+    {
+        std::vector<std::size_t> remap(vertices.size(), detail::UNASSIGNED);
+        std::vector<std::size_t> order;
+        order.reserve(vertices.size());
+        for(Mesh::Renderable& renderable : renderables)
+        {
+            for(std::size_t& index : renderable.indices)
+            {
+                if(remap[index] == detail::UNASSIGNED)
+                {
+                    remap[index] = order.size();
+                    order.push_back(index);
+                }
+                index = remap[index];
+            }
+        }
+
+        std::vector<Vertex32F> reordered;
+        reordered.reserve(order.size());
+        for(std::size_t index : order)
+        {
+            reordered.push_back(std::move(vertices[index]));
+        }
+        vertices.swap(reordered);
+    }
+
+}
@@ -0,0 +1,842 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "IllegalArgumentException.hpp"
+#include "MeshOptimizer.hpp"
+#include "constexpr_math.hpp"
+
+namespace midnight
+{
+
+    namespace detail
+    {
+        /// Marks a missing vertex, or a vertex with several open edges in one direction
+        constexpr std::uint32_t NO_VERTEX = std::numeric_limits<std::uint32_t>::max();
+        constexpr std::uint32_t SEVERAL_VERTICES = NO_VERTEX - 1;
+
+        /// The weight of the planes that hold borders and seams in place, relative to the planes of
+        /// the triangles
+        constexpr double EDGE_PLANE_WEIGHT = 10.0;
+
+        /// How far beyond the cost of its goal a pass may collapse edges
+        constexpr double PASS_COST_BOUND = 1.5;
+
+        /// How many candidates a pass considers, relative to the number of collapses it aims for
+        constexpr std::size_t PASS_CANDIDATES = 4;
+
+        /**
+         * The sum of the squared distances to a set of weighted planes, as a symmetric matrix A, a
+         * vector b and a constant c: Q(p) = p'Ap + 2b'p + c
+         *
+         */
+        struct Quadric
+        {
+            double a00, a11, a22, a01, a02, a12;
+            double b0, b1, b2;
+            double c;
+
+            /// The sum of the weights of the planes
+            double weight;
+
+            Quadric() : a00(0.0), a11(0.0), a22(0.0), a01(0.0), a02(0.0), a12(0.0), b0(0.0), b1(0.0), b2(0.0), c(0.0), weight(0.0)
+            {
+
+            }
+
+            /**
+             * Adds the plane n'p + d = 0, whose normal has unit length
+             *
+             */
+            void addPlane(const double (&n)[3], double d, double w) noexcept
+            {
+                a00 += w * n[0] * n[0];
+                a11 += w * n[1] * n[1];
+                a22 += w * n[2] * n[2];
+                a01 += w * n[0] * n[1];
+                a02 += w * n[0] * n[2];
+                a12 += w * n[1] * n[2];
+                b0 += w * n[0] * d;
+                b1 += w * n[1] * d;
+                b2 += w * n[2] * d;
+                c += w * d * d;
+                weight += w;
+            }
+
+            Quadric& operator+=(const Quadric& rhs) noexcept
+            {
+                a00 += rhs.a00;
+                a11 += rhs.a11;
+                a22 += rhs.a22;
+                a01 += rhs.a01;
+                a02 += rhs.a02;
+                a12 += rhs.a12;
+                b0 += rhs.b0;
+                b1 += rhs.b1;
+                b2 += rhs.b2;
+                c += rhs.c;
+                weight += rhs.weight;
+                return *this;
+            }
+
+            /**
+             * Computes the weighted mean of the squared distances from a point to the planes
+             *
+             */
+            double evaluate(const Point3F& point) const noexcept
+            {
+                const double x = point[0];
+                const double y = point[1];
+                const double z = point[2];
+                const double sum = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                        2.0 * (b0 * x + b1 * y + b2 * z) + c;
+                return weight == 0.0 ? 0.0 : std::max(sum / weight, 0.0);
+            }
+        };
+
+        /**
+         * How far a vertex may move
+         *
+         */
+        enum class VertexKind : std::uint8_t
+        {
+            /// Surrounded by triangles that share its attributes: collapses onto any neighbour
+            MANIFOLD,
+
+            /// On an open border: slides along the border
+            BORDER,
+
+            /// On an attribute seam, with a twin on the other side: slides along the seam
+            SEAM,
+
+            /// Never moves
+            LOCKED
+        };
+
+        /**
+         * A candidate half-edge collapse, which moves a vertex onto a neighbour
+         *
+         */
+        struct Collapse
+        {
+            std::uint32_t from;
+            std::uint32_t to;
+            double cost;
+        };
+
+        /**
+         * Computes the (unnormalized) normal of a triangle in double precision
+         *
+         */
+        inline void triangleNormal(const Point3F& a, const Point3F& b, const Point3F& c, double (&normal)[3]) noexcept
+        {
+            const double ab[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+            const double ac[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+            normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+            normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+            normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+        }
+
+        /**
+         * The state of a simplification: the remaining triangles and what is known of their
+         * vertices
+         *
+         */
+        class Simplification
+        {
+            const std::vector<Vertex32F>& vertices;
+
+            /// The triangles left, and the Renderable each belongs to
+            std::vector<std::uint32_t>& indices;
+            std::vector<std::uint32_t>& owners;
+
+            /// The first vertex at the position of every vertex, which stands for all of them
+            std::vector<std::uint32_t> leaders;
+
+            /// The next vertex at the same position (a ring, which is a single vertex off seams)
+            std::vector<std::uint32_t> twins;
+
+            std::vector<VertexKind> kinds;
+
+            /// The quadric of every position, indexed by its leader
+            std::vector<Quadric> quadrics;
+
+            /// The end of the open edge leaving each vertex, and the start of the one entering it
+            std::vector<std::uint32_t> openOut;
+            std::vector<std::uint32_t> openIn;
+
+            /// The triangles around every vertex (a compressed row of triangles per vertex)
+            std::vector<std::uint32_t> adjacencyOffsets;
+            std::vector<std::uint32_t> adjacency;
+
+            /// Scratch storage of a pass
+            std::vector<Collapse> collapses;
+            std::vector<std::uint32_t> destinations;
+            std::vector<std::uint8_t> moved;
+            std::vector<std::uint32_t> fromNeighbours;
+            std::vector<std::uint32_t> toNeighbours;
+            std::vector<std::uint32_t> opposites;
+
+            /// The largest cost of the collapses performed so far, and the cost no collapse may exceed
+            double maximumCost;
+            double costLimit;
+
+          public:
+
+            Simplification(const std::vector<Vertex32F>& vertices, std::vector<std::uint32_t>& indices,
+                    std::vector<std::uint32_t>& owners, double maximumError) :
+                vertices(vertices),
+                indices(indices),
+                owners(owners),
+                leaders(vertices.size()),
+                twins(vertices.size()),
+                kinds(vertices.size(), VertexKind::MANIFOLD),
+                quadrics(vertices.size()),
+                destinations(vertices.size()),
+                moved(vertices.size()),
+                maximumCost(0.0),
+                costLimit(maximumError * maximumError)
+            {
+                weld();
+                buildAdjacency();
+                findOpenEdges();
+                classify();
+                accumulateQuadrics();
+            }
+
+            std::size_t getTriangleCount() const noexcept
+            {
+                return owners.size();
+            }
+
+            float getError() const noexcept
+            {
+                return static_cast<float>(std::sqrt(maximumCost));
+            }
+
+            /**
+             * Collapses edges until no more than the target number of triangles remains
+             *
+             * @return false if no edge could be collapsed within the error limit before the target
+             * was reached
+             *
+             */
+            bool reduce(std::size_t target)
+            {
+                while(getTriangleCount() > target)
+                {
+                    if(!pass(target))
+                    {
+                        return false;
+                    }
+                    buildAdjacency();
+                    findOpenEdges();
+                }
+                return true;
+            }
+
+          private:
+
+            const Point3F& position(std::uint32_t vertex) const noexcept
+            {
+                return vertices[vertex].getPosition();
+            }
+
+            /**
+             * Groups the vertices by their position
+             *
+             */
+            void weld()
+            {
+                std::vector<std::uint32_t> order(vertices.size());
+                std::iota(order.begin(), order.end(), 0u);
+                std::stable_sort(order.begin(), order.end(), [this](std::uint32_t lhs, std::uint32_t rhs)
+                {
+                    const Point3F& a = position(lhs);
+                    const Point3F& b = position(rhs);
+                    return a[0] != b[0] ? a[0] < b[0] : a[1] != b[1] ? a[1] < b[1] : a[2] < b[2];
+                });
+                for(std::size_t first = 0; first < order.size();)
+                {
+                    std::size_t last = first + 1;
+                    while(last < order.size() && position(order[last]) == position(order[first]))
+                    {
+                        ++last;
+                    }
+                    for(std::size_t i = first; i < last; ++i)
+                    {
+                        leaders[order[i]] = order[first];
+                        twins[order[i]] = order[i + 1 < last ? i + 1 : first];
+                    }
+                    first = last;
+                }
+            }
+
+            /**
+             * Counts the triangles that run along an edge in its direction
+             *
+             */
+            std::size_t countEdge(std::uint32_t from, std::uint32_t to) const noexcept
+            {
+                std::size_t count = 0;
+                for(std::uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+                {
+                    const std::size_t triangle = 3 * adjacency[i];
+                    for(std::size_t k = 0; k < 3; ++k)
+                    {
+                        count += indices[triangle + k] == from && indices[triangle + (k + 1) % 3] == to;
+                    }
+                }
+                return count;
+            }
+
+            bool hasEdge(std::uint32_t from, std::uint32_t to) const noexcept
+            {
+                for(std::uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+                {
+                    const std::size_t triangle = 3 * adjacency[i];
+                    if((indices[triangle] == from && indices[triangle + 1] == to) ||
+                            (indices[triangle + 1] == from && indices[triangle + 2] == to) ||
+                            (indices[triangle + 2] == from && indices[triangle] == to))
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Finds the edges that only one triangle runs along in its direction, which lie on a
+             * border or a seam
+             *
+             */
+            void findOpenEdges()
+            {
+                openOut.assign(vertices.size(), NO_VERTEX);
+                openIn.assign(vertices.size(), NO_VERTEX);
+                for(std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    const std::uint32_t from = indices[i];
+                    const std::uint32_t to = indices[i % 3 == 2 ? i - 2 : i + 1];
+                    if(!hasEdge(to, from))
+                    {
+                        openOut[from] = openOut[from] == NO_VERTEX ? to : SEVERAL_VERTICES;
+                        openIn[to] = openIn[to] == NO_VERTEX ? from : SEVERAL_VERTICES;
+                    }
+                }
+            }
+
+            bool isOpen(std::uint32_t from, std::uint32_t to) const noexcept
+            {
+                return openOut[from] == to || (openOut[from] == SEVERAL_VERTICES && !hasEdge(to, from));
+            }
+
+            /**
+             * Decides how far every vertex may move, from the topology of the original triangles
+             *
+             */
+            void classify()
+            {
+                /// Positions shared by several Renderables, or by edges of three or more triangles
+                std::vector<std::uint32_t> positionOwners(vertices.size(), NO_VERTEX);
+                std::vector<std::uint8_t> locked(vertices.size(), 0);
+                for(std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    std::uint32_t& owner = positionOwners[leaders[indices[i]]];
+                    if(owner != NO_VERTEX && owner != owners[i / 3])
+                    {
+                        locked[leaders[indices[i]]] = 1;
+                    }
+                    owner = owners[i / 3];
+                }
+                for(std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    const std::uint32_t from = indices[i];
+                    const std::uint32_t to = indices[i % 3 == 2 ? i - 2 : i + 1];
+                    if(countEdge(from, to) > 1)
+                    {
+                        locked[leaders[from]] = 1;
+                        locked[leaders[to]] = 1;
+                    }
+                }
+
+                auto single = [](std::uint32_t vertex)
+                {
+                    return vertex != NO_VERTEX && vertex != SEVERAL_VERTICES;
+                };
+                for(std::uint32_t vertex = 0; vertex < vertices.size(); ++vertex)
+                {
+                    if(leaders[vertex] != vertex)
+                    {
+                        continue;
+                    }
+                    VertexKind kind = VertexKind::LOCKED;
+                    const std::uint32_t twin = twins[vertex];
+                    if(locked[vertex])
+                    {
+                        kind = VertexKind::LOCKED;
+                    }
+                    else if(twin == vertex)
+                    {
+                        if(openOut[vertex] == NO_VERTEX && openIn[vertex] == NO_VERTEX)
+                        {
+                            kind = VertexKind::MANIFOLD;
+                        }
+                        else if(single(openOut[vertex]) && single(openIn[vertex]))
+                        {
+                            kind = VertexKind::BORDER;
+                        }
+                    }
+                    else if(twins[twin] == vertex && single(openOut[vertex]) && single(openIn[vertex]) &&
+                            single(openOut[twin]) && single(openIn[twin]))
+                    {
+                        /// The two sides of the seam must run along the same positions
+                        if(leaders[openOut[vertex]] == leaders[openIn[twin]] && leaders[openIn[vertex]] == leaders[openOut[twin]])
+                        {
+                            kind = VertexKind::SEAM;
+                        }
+                    }
+                    for(std::uint32_t member = vertex;;)
+                    {
+                        kinds[member] = kind;
+                        member = twins[member];
+                        if(member == vertex)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Gives every position the planes of its triangles, and of the open edges through it
+             *
+             */
+            void accumulateQuadrics()
+            {
+                for(std::size_t i = 0; i < indices.size(); i += 3)
+                {
+                    double normal[3];
+                    triangleNormal(position(indices[i]), position(indices[i + 1]), position(indices[i + 2]), normal);
+                    const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if(length == 0.0)
+                    {
+                        continue;
+                    }
+                    const double n[3] = {normal[0] / length, normal[1] / length, normal[2] / length};
+                    const Point3F& a = position(indices[i]);
+                    const double d = -(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]);
+                    for(std::size_t k = 0; k < 3; ++k)
+                    {
+                        quadrics[leaders[indices[i + k]]].addPlane(n, d, length * 0.5);
+                    }
+
+                    for(std::size_t k = 0; k < 3; ++k)
+                    {
+                        const std::uint32_t from = indices[i + k];
+                        const std::uint32_t to = indices[i + (k + 1) % 3];
+                        if(!isOpen(from, to))
+                        {
+                            continue;
+                        }
+
+                        /// The plane through the edge, perpendicular to the triangle
+                        const Point3F& p = position(from);
+                        const Point3F& q = position(to);
+                        const double edge[3] = {double(q[0]) - p[0], double(q[1]) - p[1], double(q[2]) - p[2]};
+                        double e[3] = {edge[1] * n[2] - edge[2] * n[1], edge[2] * n[0] - edge[0] * n[2], edge[0] * n[1] - edge[1] * n[0]};
+                        const double squaredLength = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+                        const double eLength = std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+                        if(eLength == 0.0)
+                        {
+                            continue;
+                        }
+                        for(double& component : e)
+                        {
+                            component /= eLength;
+                        }
+                        const double ed = -(e[0] * p[0] + e[1] * p[1] + e[2] * p[2]);
+                        quadrics[leaders[from]].addPlane(e, ed, squaredLength * EDGE_PLANE_WEIGHT);
+                        quadrics[leaders[to]].addPlane(e, ed, squaredLength * EDGE_PLANE_WEIGHT);
+                    }
+                }
+            }
+
+            /**
+             * Queries whether a vertex may move onto a neighbour
+             *
+             */
+            bool canCollapse(std::uint32_t from, std::uint32_t to) const noexcept
+            {
+                switch(kinds[from])
+                {
+                    case VertexKind::MANIFOLD:
+                        return true;
+                    case VertexKind::BORDER:
+                        return kinds[to] == VertexKind::BORDER && (openOut[from] == to || openIn[from] == to);
+                    case VertexKind::SEAM:
+                    {
+                        if(kinds[to] != VertexKind::SEAM || (openOut[from] != to && openIn[from] != to))
+                        {
+                            return false;
+                        }
+
+                        /// The twins must be joined by an edge of the other side as well
+                        const std::uint32_t twin = twins[from];
+                        return openOut[twin] == twins[to] || openIn[twin] == twins[to];
+                    }
+                    default:
+                        return false;
+                }
+            }
+
+            /**
+             * Queries whether moving a vertex onto another would turn over one of the triangles
+             * around it that remain, given the collapses already chosen in this pass
+             *
+             */
+            bool flips(std::uint32_t from, std::uint32_t to) const noexcept
+            {
+                const std::uint32_t target = leaders[to];
+                for(std::uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+                {
+                    const std::size_t triangle = 3 * adjacency[i];
+                    std::uint32_t corners[3];
+                    bool collapses = false;
+                    for(std::size_t k = 0; k < 3; ++k)
+                    {
+                        corners[k] = destinations[indices[triangle + k]];
+                        collapses = collapses || leaders[corners[k]] == target;
+                    }
+                    if(collapses)
+                    {
+                        continue;
+                    }
+                    double before[3];
+                    triangleNormal(position(corners[0]), position(corners[1]), position(corners[2]), before);
+                    for(std::uint32_t& corner : corners)
+                    {
+                        if(corner == from)
+                        {
+                            corner = to;
+                        }
+                    }
+                    double after[3];
+                    triangleNormal(position(corners[0]), position(corners[1]), position(corners[2]), after);
+                    const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                    const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) *
+                            (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+
+                    /// Also rejects triangles that would become degenerate
+                    if(dot <= 1e-3 * lengths)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Queries whether moving a position onto another would join two of their neighbours
+             * by a second edge, or otherwise pinch the surface (the link condition)
+             *
+             */
+            bool joinsNeighbours(std::uint32_t source, std::uint32_t target)
+            {
+                opposites.clear();
+                gatherNeighbours(source, target, fromNeighbours);
+                gatherNeighbours(target, NO_VERTEX, toNeighbours);
+                std::sort(opposites.begin(), opposites.end());
+                opposites.erase(std::unique(opposites.begin(), opposites.end()), opposites.end());
+
+                std::size_t common = 0;
+                auto to = toNeighbours.begin();
+                for(std::uint32_t neighbour : fromNeighbours)
+                {
+                    to = std::lower_bound(to, toNeighbours.end(), neighbour);
+                    common += to != toNeighbours.end() && *to == neighbour;
+                }
+                return common > opposites.size();
+            }
+
+            /**
+             * Gathers the positions around a position (sorted, without duplicates), and the
+             * positions opposite to the edge from it to another
+             *
+             */
+            void gatherNeighbours(std::uint32_t group, std::uint32_t other, std::vector<std::uint32_t>& neighbours)
+            {
+                neighbours.clear();
+                for(std::uint32_t member = group;;)
+                {
+                    for(std::uint32_t i = adjacencyOffsets[member]; i < adjacencyOffsets[member + 1]; ++i)
+                    {
+                        const std::size_t triangle = 3 * adjacency[i];
+                        std::uint32_t corners[3];
+                        for(std::size_t k = 0; k < 3; ++k)
+                        {
+                            corners[k] = leaders[destinations[indices[triangle + k]]];
+                        }
+                        if(corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+                        {
+                            continue;
+                        }
+                        const bool shared = corners[0] == other || corners[1] == other || corners[2] == other;
+                        for(std::uint32_t corner : corners)
+                        {
+                            if(corner != group)
+                            {
+                                neighbours.push_back(corner);
+                                if(shared && corner != other)
+                                {
+                                    opposites.push_back(corner);
+                                }
+                            }
+                        }
+                    }
+                    member = twins[member];
+                    if(member == group)
+                    {
+                        break;
+                    }
+                }
+                std::sort(neighbours.begin(), neighbours.end());
+                neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            }
+
+            void buildAdjacency()
+            {
+                adjacencyOffsets.assign(vertices.size() + 1, 0);
+                for(std::uint32_t index : indices)
+                {
+                    ++adjacencyOffsets[index + 1];
+                }
+                std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+                adjacency.resize(indices.size());
+                std::vector<std::uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for(std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    adjacency[cursors[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+                }
+            }
+
+            /**
+             * Performs the cheapest independent collapses, about as many as it takes to reach the
+             * target
+             *
+             * @return false if no edge could be collapsed
+             *
+             */
+            bool pass(std::size_t target)
+            {
+                /// Every edge once, in the direction that costs less
+                collapses.clear();
+                for(std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    const std::uint32_t a = indices[i];
+                    const std::uint32_t b = indices[i % 3 == 2 ? i - 2 : i + 1];
+                    if((a > b && !isOpen(a, b)) || leaders[a] == leaders[b])
+                    {
+                        continue;
+                    }
+                    Quadric quadric = quadrics[leaders[a]];
+                    quadric += quadrics[leaders[b]];
+                    Collapse collapse = {0, 0, std::numeric_limits<double>::infinity()};
+                    if(canCollapse(a, b))
+                    {
+                        collapse = Collapse{a, b, quadric.evaluate(position(b))};
+                    }
+                    if(canCollapse(b, a))
+                    {
+                        const double cost = quadric.evaluate(position(a));
+                        if(cost < collapse.cost)
+                        {
+                            collapse = Collapse{b, a, cost};
+                        }
+                    }
+                    if(collapse.cost != std::numeric_limits<double>::infinity())
+                    {
+                        collapses.push_back(collapse);
+                    }
+                }
+                if(collapses.empty())
+                {
+                    return false;
+                }
+
+                /// A collapse removes two triangles off borders and seams.  The pass stops short of
+                /// the collapses that cost much more than the goal, which the collapses that would
+                /// flip a triangle do not count towards.  Only the cheapest candidates are sorted,
+                /// since a pass seldom gets far beyond its goal.
+                const std::size_t goal = (getTriangleCount() - target) / 2 + 1;
+                const std::size_t considered = std::min(collapses.size(), PASS_CANDIDATES * goal);
+                auto cheaper = [](const Collapse& lhs, const Collapse& rhs)
+                {
+                    return lhs.cost < rhs.cost;
+                };
+                std::nth_element(collapses.begin(), collapses.begin() + (considered - 1), collapses.end(), cheaper);
+                std::sort(collapses.begin(), collapses.begin() + considered, cheaper);
+                collapses.resize(considered);
+                std::size_t flipped = 0;
+
+                std::iota(destinations.begin(), destinations.end(), 0u);
+                std::fill(moved.begin(), moved.end(), 0);
+                std::size_t performed = 0;
+                for(const Collapse& collapse : collapses)
+                {
+                    const double bound = collapses[std::min(collapses.size(), goal + flipped) - 1].cost * PASS_COST_BOUND;
+                    if(performed == goal || collapse.cost > bound || collapse.cost > costLimit)
+                    {
+                        break;
+                    }
+                    const std::uint32_t from = leaders[collapse.from];
+                    const std::uint32_t to = leaders[collapse.to];
+                    if(moved[from] || moved[to])
+                    {
+                        continue;
+                    }
+                    const bool seam = kinds[collapse.from] == VertexKind::SEAM;
+                    if(joinsNeighbours(from, to) || flips(collapse.from, collapse.to) ||
+                            (seam && flips(twins[collapse.from], twins[collapse.to])))
+                    {
+                        ++flipped;
+                        continue;
+                    }
+                    destinations[collapse.from] = collapse.to;
+                    if(seam)
+                    {
+                        destinations[twins[collapse.from]] = twins[collapse.to];
+                    }
+                    moved[from] = 1;
+                    moved[to] = 1;
+                    quadrics[to] += quadrics[from];
+                    maximumCost = std::max(maximumCost, collapse.cost);
+                    ++performed;
+                }
+
+                /// Drops the triangles whose corners have come together
+                std::size_t kept = 0;
+                for(std::size_t triangle = 0; triangle < owners.size(); ++triangle)
+                {
+                    std::uint32_t corners[3];
+                    for(std::size_t k = 0; k < 3; ++k)
+                    {
+                        corners[k] = destinations[indices[3 * triangle + k]];
+                    }
+                    if(leaders[corners[0]] == leaders[corners[1]] || leaders[corners[1]] == leaders[corners[2]] ||
+                            leaders[corners[0]] == leaders[corners[2]])
+                    {
+                        continue;
+                    }
+                    std::copy(corners, corners + 3, indices.begin() + 3 * kept);
+                    owners[kept++] = owners[triangle];
+                }
+                indices.resize(3 * kept);
+                owners.resize(kept);
+                return performed != 0;
+            }
+        };
+    }
+
+    inline MeshSimplifier::MeshSimplifier(float ratio, std::size_t maximumLevels, std::size_t minimumTriangles, float maximumError) :
+        ratio(ratio),
+        maximumLevels(maximumLevels),
+        minimumTriangles(minimumTriangles),
+        maximumError(maximumError)
+    {
+        if(!(ratio > 0.0f && ratio < 1.0f))
+        {
+            throw IllegalArgumentException("The ratio of a MeshSimplifier must lie between zero and one");
+        }
+        if(maximumLevels < 2)
+        {
+            throw IllegalArgumentException("A MeshSimplifier must build at least two levels");
+        }
+        if(!(maximumError > 0.0f))
+        {
+            throw IllegalArgumentException("The maximum error of a MeshSimplifier must be positive");
+        }
+    }
+
+    inline std::vector<MeshSimplifier::Level> MeshSimplifier::simplify(const Mesh& mesh) const
+    {
+        const std::vector<Vertex32F>& vertices = mesh.getVertices();
+        const std::vector<Mesh::Renderable>& renderables = mesh.getMeshes();
+        if(vertices.size() >= detail::SEVERAL_VERTICES)
+        {
+            throw IllegalArgumentException("The Mesh has too many vertices to be simplified");
+        }
+
+        std::vector<Level> levels(1);
+        std::vector<std::uint32_t> indices;
+        std::vector<std::uint32_t> owners;
+        for(std::size_t i = 0; i < renderables.size(); ++i)
+        {
+            detail::validateTriangleList(renderables[i].indices, vertices.size());
+            levels[0].indices.push_back(renderables[i].indices);
+            for(std::size_t index : renderables[i].indices)
+            {
+                indices.push_back(static_cast<std::uint32_t>(index));
+            }
+            owners.resize(indices.size() / 3, static_cast<std::uint32_t>(i));
+        }
+        levels[0].triangles = owners.size();
+        levels[0].error = 0.0f;
+
+        const Vector3F extents = mesh.getBounds().getExtents();
+        const float size = std::sqrt(extents[0] * extents[0] + extents[1] * extents[1] + extents[2] * extents[2]) / 2.0f;
+        detail::Simplification simplification(vertices, indices, owners, maximumError * size);
+        while(levels.size() < maximumLevels && levels.back().triangles > minimumTriangles)
+        {
+            const std::size_t previous = levels.back().triangles;
+            const std::size_t target = std::max(minimumTriangles, static_cast<std::size_t>(static_cast<double>(previous) * ratio));
+            const bool reached = simplification.reduce(target);
+            if(simplification.getTriangleCount() == previous)
+            {
+                break;
+            }
+
+            Level level;
+            level.indices.resize(renderables.size());
+            for(std::size_t triangle = 0; triangle < owners.size(); ++triangle)
+            {
+                std::vector<std::size_t>& destination = level.indices[owners[triangle]];
+                destination.insert(destination.end(), indices.begin() + 3 * triangle, indices.begin() + 3 * triangle + 3);
+            }
+            level.triangles = owners.size();
+            level.error = simplification.getError();
+            levels.push_back(std::move(level));
+            if(!reached)
+            {
+                break;
+            }
+        }
+        return levels;
+    }
+
+    inline float MeshSimplifier::computeScreenError(float error, float distance, float fieldOfView) noexcept
+    {
+        if(!(distance > 0.0f))
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+
+        /// The height of the view at the distance
+        return error / (2.0f * distance * std::tan(toRadians(fieldOfView) / 2.0f));
+    }
+
+    inline std::size_t MeshSimplifier::selectLevel(const std::vector<float>& errors, float distance, float fieldOfView,
+            float tolerance) noexcept
+    {
+        for(std::size_t level = errors.size(); level > 1; --level)
+        {
+            if(computeScreenError(errors[level - 1], distance, fieldOfView) <= tolerance)
+            {
+                return level - 1;
+            }
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace midnight
+{
+
+    namespace picking
+    {
+
+        inline bool invert(const Matrix4x4F& matrix, Matrix4x4F& inverse) noexcept
+        {
+            /// The matrix augmented with the identity, reduced until its left half is the identity
+            double rows[4][8];
+            for(std::size_t row = 0; row < 4; ++row)
+            {
+                for(std::size_t column = 0; column < 4; ++column)
+                {
+                    rows[row][column] = matrix(row, column);
+                    rows[row][column + 4] = row == column ? 1.0 : 0.0;
+                }
+            }
+            for(std::size_t column = 0; column < 4; ++column)
+            {
+                std::size_t pivot = column;
+                for(std::size_t row = column + 1; row < 4; ++row)
+                {
+                    if(std::abs(rows[row][column]) > std::abs(rows[pivot][column]))
+                    {
+                        pivot = row;
+                    }
+                }
+                if(rows[pivot][column] == 0.0)
+                {
+                    return false;
+                }
+                std::swap(rows[pivot], rows[column]);
+                const double scale = 1.0 / rows[column][column];
+                for(double& element : rows[column])
+                {
+                    element *= scale;
+                }
+                for(std::size_t row = 0; row < 4; ++row)
+                {
+                    const double factor = rows[row][column];
+                    if(row != column && factor != 0.0)
+                    {
+                        for(std::size_t i = 0; i < 8; ++i)
+                        {
+                            rows[row][i] -= factor * rows[column][i];
+                        }
+                    }
+                }
+            }
+            for(std::size_t row = 0; row < 4; ++row)
+            {
+                for(std::size_t column = 0; column < 4; ++column)
+                {
+                    inverse(row, column) = static_cast<float>(rows[row][column + 4]);
+                }
+            }
+            return true;
+        }
+
+        inline Ray unproject(const Matrix4x4F& viewProjection, float x, float y, float& length) noexcept
+        {
+            Matrix4x4F inverse;
+            if(!invert(viewProjection, inverse))
+            {
+                length = 0.0f;
+                return Ray(Point3F(0.0f, 0.0f, 0.0f), Vector3F(0.0f, 0.0f, 1.0f));
+            }
+
+            /// The points of the near (z = -1) and far (z = 1) planes under the screen position
+            float points[2][3];
+            for(std::size_t plane = 0; plane < 2; ++plane)
+            {
+                const float z = plane == 0 ? -1.0f : 1.0f;
+                float clip[4];
+                for(std::size_t column = 0; column < 4; ++column)
+                {
+                    clip[column] = x * inverse(0, column) + y * inverse(1, column) + z * inverse(2, column) + inverse(3, column);
+                }
+                for(std::size_t i = 0; i < 3; ++i)
+                {
+                    points[plane][i] = clip[i] / clip[3];
+                }
+            }
+            const float direction[3] = {points[1][0] - points[0][0], points[1][1] - points[0][1], points[1][2] - points[0][2]};
+            length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+            return Ray(Point3F(points[0][0], points[0][1], points[0][2]),
+                    Vector3F(direction[0] / length, direction[1] / length, direction[2] / length));
+        }
+
+        inline Ray transform(const Ray& ray, const Matrix4x4F& matrix) noexcept
+        {
+            const Point3F& origin = ray.getOrigin();
+            const Vector3F& direction = ray.getDirection();
+            float point[3];
+            float vector[3];
+            for(std::size_t column = 0; column < 3; ++column)
+            {
+                point[column] = origin[0] * matrix(0, column) + origin[1] * matrix(1, column) + origin[2] * matrix(2, column) + matrix(3, column);
+                vector[column] = direction[0] * matrix(0, column) + direction[1] * matrix(1, column) + direction[2] * matrix(2, column);
+            }
+            return Ray(Point3F(point[0], point[1], point[2]), Vector3F(vector[0], vector[1], vector[2]));
+        }
+
+        template<typename F>
+        inline bool marchHeightfield(const Ray& ray, float maximum, std::size_t columns, std::size_t rows, float originX,
+                float originZ, F height, SurfaceHit& hit)
+        {
+            if(columns < 2 || rows < 2)
+            {
+                return false;
+            }
+            const Point3F& origin = ray.getOrigin();
+            const Vector3F& direction = ray.getDirection();
+
+            /// Clips the Ray to the footprint of the grid
+            const std::size_t axes[2] = {0, 2};
+            const float low[2] = {originX, originZ};
+            const float high[2] = {originX + static_cast<float>(columns - 1), originZ + static_cast<float>(rows - 1)};
+            float enter = 0.0f;
+            float exit = maximum;
+            for(std::size_t k = 0; k < 2; ++k)
+            {
+                const float inverse = 1.0f / direction[axes[k]];
+                const float t0 = (low[k] - origin[axes[k]]) * inverse;
+                const float t1 = (high[k] - origin[axes[k]]) * inverse;
+                enter = std::max(enter, std::min(t0, t1));
+                exit = std::min(exit, std::max(t0, t1));
+            }
+            if(!(enter <= exit))
+            {
+                return false;
+            }
+
+            /// The cell the Ray enters the grid through, and the distances to the next column and
+            /// row boundaries (Amanatides and Woo)
+            const std::ptrdiff_t lastCell[2] = {static_cast<std::ptrdiff_t>(columns) - 2, static_cast<std::ptrdiff_t>(rows) - 2};
+            std::ptrdiff_t cell[2];
+            std::ptrdiff_t step[2];
+            float next[2];
+            float delta[2];
+            for(std::size_t k = 0; k < 2; ++k)
+            {
+                const float position = origin[axes[k]] + direction[axes[k]] * enter - low[k];
+                cell[k] = std::min(std::max(static_cast<std::ptrdiff_t>(std::floor(position)), std::ptrdiff_t(0)), lastCell[k]);
+                if(direction[axes[k]] == 0.0f)
+                {
+                    step[k] = 0;
+                    next[k] = std::numeric_limits<float>::infinity();
+                    delta[k] = std::numeric_limits<float>::infinity();
+                    continue;
+                }
+                step[k] = direction[axes[k]] > 0.0f ? 1 : -1;
+                const float boundary = low[k] + static_cast<float>(cell[k] + (step[k] > 0 ? 1 : 0));
+                next[k] = (boundary - origin[axes[k]]) / direction[axes[k]];
+                delta[k] = 1.0f / std::abs(direction[axes[k]]);
+            }
+
+            auto corner = [&](std::size_t column, std::size_t row)
+            {
+                return Point3F(originX + static_cast<float>(column), height(column, row), originZ + static_cast<float>(row));
+            };
+            for(;;)
+            {
+                const std::size_t i = static_cast<std::size_t>(cell[0]);
+                const std::size_t j = static_cast<std::size_t>(cell[1]);
+                const Point3F a = corner(i, j);
+                const Point3F b = corner(i, j + 1);
+                const Point3F c = corner(i + 1, j);
+                const Point3F d = corner(i + 1, j + 1);
+
+                /// A triangle lies over its cell, so the first cell with a hit holds the nearest one
+                float best = maximum;
+                float distance;
+                bool found = false;
+                if(ray.intersects(a, b, c, distance, best))
+                {
+                    best = distance;
+                    hit.primitive = 2 * (i * (rows - 1) + j);
+                    found = true;
+                }
+                if(ray.intersects(c, b, d, distance, best))
+                {
+                    best = distance;
+                    hit.primitive = 2 * (i * (rows - 1) + j) + 1;
+                    found = true;
+                }
+                if(found)
+                {
+                    hit.distance = best;
+                    return true;
+                }
+
+                const std::size_t k = next[0] < next[1] ? 0 : 1;
+                if(next[k] > exit)
+                {
+                    return false;
+                }
+                cell[k] += step[k];
+                next[k] += delta[k];
+                if(cell[k] < 0 || cell[k] > lastCell[k])
+                {
+                    return false;
+                }
+            }
+        }
+
+    }
+
+}
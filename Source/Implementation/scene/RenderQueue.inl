@@ -0,0 +1,253 @@
+#include <cstring>
+#include <utility>
+
+#include "TextureUnits.hpp"
+
+namespace midnight
+{
+
+    inline RenderQueue::RenderQueue() :
+        statistics()
+    {
+
+    }
+
+    inline RenderQueue::~RenderQueue()
+    {
+        if(active() == this)
+        {
+            active() = nullptr;
+        }
+    }
+
+    inline void RenderQueue::begin()
+    {
+        items.clear();
+        transforms.clear();
+        /// Ids only order the items of one frame, so they start anew rather than outliving their state
+        programIds.clear();
+        textureIds.clear();
+        bufferIds.clear();
+        active() = this;
+    }
+
+    inline void RenderQueue::submit(std::uint32_t layer, Program& program, std::uint32_t material, GLuint texture,
+            GLuint sampler, GeometryArena& arena, GeometryArena::Handle mesh, float depth, std::size_t object,
+            std::uint32_t firstIndex, std::uint32_t indexCount)
+    {
+        /// Ids in order of first use; an insertion that finds the state keeps its id
+        const std::uint32_t programId = programIds.insert(std::make_pair(&program, static_cast<std::uint32_t>(programIds.size()))).first->second;
+        const std::uint32_t textureId = textureIds.insert(std::make_pair(texture, static_cast<std::uint32_t>(textureIds.size()))).first->second;
+        const std::uint32_t bufferId = bufferIds.insert(std::make_pair(&arena, static_cast<std::uint32_t>(bufferIds.size()))).first->second;
+
+        RenderItem item;
+        item.key = makeKey(layer, programId, material, textureId, bufferId, depth);
+        item.program = &program;
+        item.arena = &arena;
+        item.mesh = mesh;
+        item.texture = texture;
+        item.sampler = sampler;
+        item.firstIndex = firstIndex;
+        item.indexCount = indexCount;
+        item.object = object;
+        item.batched = false;
+        item.transform = 0;
+        items.push_back(item);
+    }
+
+    inline void RenderQueue::submit(std::uint32_t layer, Program& program, std::uint32_t material, GLuint texture,
+            GLuint sampler, GeometryArena& arena, GeometryArena::Handle mesh, float depth, const Matrix4x4F& world,
+            std::uint32_t firstIndex, std::uint32_t indexCount)
+    {
+        submit(layer, program, material, texture, sampler, arena, mesh, depth, 0, firstIndex, indexCount);
+        items.back().batched = true;
+        items.back().transform = static_cast<std::uint32_t>(transforms.size());
+        transforms.push_back(world);
+    }
+
+    inline void RenderQueue::submit(const RenderItem& item)
+    {
+        items.push_back(item);
+    }
+
+    inline void RenderQueue::sort()
+    {
+        const std::size_t count = items.size();
+        keys.resize(count);
+        order.resize(count);
+        scratchKeys.resize(count);
+        scratchOrder.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            keys[i] = items[i].key;
+            order[i] = static_cast<std::uint32_t>(i);
+        }
+
+        /// Least significant digit first, eight bits at a time.  Each pass is stable, and a pass
+        /// whose digit every key shares (e.g. the layer) is skipped.
+        for(unsigned shift = 0; shift < 64; shift += 8)
+        {
+            std::size_t offsets[256] = {};
+            for(std::uint64_t key : keys)
+            {
+                ++offsets[(key >> shift) & 0xFF];
+            }
+            if(offsets[keys.empty() ? 0 : (keys[0] >> shift) & 0xFF] == count)
+            {
+                continue;
+            }
+            std::size_t total = 0;
+            for(std::size_t& offset : offsets)
+            {
+                const std::size_t digits = offset;
+                offset = total;
+                total += digits;
+            }
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                const std::size_t position = offsets[(keys[i] >> shift) & 0xFF]++;
+                scratchKeys[position] = keys[i];
+                scratchOrder[position] = order[i];
+            }
+            keys.swap(scratchKeys);
+            order.swap(scratchOrder);
+        }
+
+        sortedItems.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            sortedItems[i] = items[order[i]];
+        }
+        items.swap(sortedItems);
+    }
+
+    inline void RenderQueue::flush(FrameUniforms& uniforms)
+    {
+        statistics.items = items.size();
+        statistics.unsorted = countSwitches(items);
+        sort();
+        statistics.sorted = countSwitches(items);
+        statistics.batches = 0;
+
+        Program* program = nullptr;
+        GeometryArena* arena = nullptr;
+        for(std::size_t i = 0; i < items.size(); ++i)
+        {
+            const RenderItem& item = items[i];
+            if(i == 0 || item.texture != items[i - 1].texture || item.sampler != items[i - 1].sampler)
+            {
+                TextureUnits::getDefault().bind(0, item.texture, item.sampler);
+            }
+            if(item.batched)
+            {
+                if(!batchRenderer)
+                {
+                    batchRenderer.reset(new BatchRenderer());
+                }
+                /// The run of draws that share every state goes out as one multi-draw
+                std::size_t end = i;
+                while(end < items.size() && items[end].batched && items[end].program == item.program && items[end].arena == item.arena &&
+                      items[end].texture == item.texture && items[end].sampler == item.sampler)
+                {
+                    batchRenderer->submit(*items[end].program, *items[end].arena, items[end].mesh, transforms[items[end].transform],
+                            items[end].firstIndex, items[end].indexCount);
+                    ++end;
+                }
+                batchRenderer->flush();
+                ++statistics.batches;
+                i = end - 1;
+
+                /// The BatchRenderer leaves neither the program nor the arena bound
+                program = nullptr;
+                arena = nullptr;
+                continue;
+            }
+            if(item.program != program)
+            {
+                /// The vertex array of an arena belongs to a program
+                item.program->bind();
+                program = item.program;
+                arena = nullptr;
+            }
+            if(item.arena != arena)
+            {
+                item.arena->bind();
+                arena = item.arena;
+            }
+            uniforms.bindObjectAt(item.object);
+            if(item.indexCount == 0)
+            {
+                arena->draw(item.mesh);
+            }
+            else
+            {
+                arena->draw(item.mesh, item.firstIndex, static_cast<GLsizei>(item.indexCount));
+            }
+        }
+        if(arena != nullptr)
+        {
+            arena->unbind();
+        }
+        if(program != nullptr)
+        {
+            program->unbind();
+        }
+        items.clear();
+        transforms.clear();
+        active() = nullptr;
+    }
+
+    inline const std::vector<RenderQueue::RenderItem>& RenderQueue::getItems() const noexcept
+    {
+        return items;
+    }
+
+    inline const RenderQueue::Statistics& RenderQueue::getStatistics() const noexcept
+    {
+        return statistics;
+    }
+
+    inline std::uint64_t RenderQueue::makeKey(std::uint32_t layer, std::uint32_t program, std::uint32_t material,
+            std::uint32_t texture, std::uint32_t buffer, float depth) noexcept
+    {
+        /// The bits of a positive float order like the float itself
+        std::uint32_t depthBits = 0;
+        if(depth > 0.0f)
+        {
+            std::memcpy(&depthBits, &depth, sizeof(depth));
+            depthBits >>= 15;
+        }
+        return static_cast<std::uint64_t>(layer & 0xF) << 60 |
+                static_cast<std::uint64_t>(program & 0xFFF) << 48 |
+                static_cast<std::uint64_t>(material & 0xFFF) << 36 |
+                static_cast<std::uint64_t>(texture & 0xFFF) << 24 |
+                static_cast<std::uint64_t>(buffer & 0xFF) << 16 |
+                static_cast<std::uint64_t>(depthBits);
+    }
+
+    inline RenderQueue::Switches RenderQueue::countSwitches(const std::vector<RenderItem>& items) noexcept
+    {
+        Switches rv = Switches();
+        for(std::size_t i = 0; i < items.size(); ++i)
+        {
+            const bool first = i == 0;
+            const bool program = first || items[i].program != items[i - 1].program;
+            rv.programs += program;
+            rv.buffers += program || items[i].arena != items[i - 1].arena;
+            rv.textures += first || items[i].texture != items[i - 1].texture || items[i].sampler != items[i - 1].sampler;
+        }
+        return rv;
+    }
+
+    inline RenderQueue* RenderQueue::getActive() noexcept
+    {
+        return active();
+    }
+
+    inline RenderQueue*& RenderQueue::active() noexcept
+    {
+        static RenderQueue* current = nullptr;
+        return current;
+    }
+
+}
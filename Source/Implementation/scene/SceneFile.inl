@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#if !defined(MIDNIGHT_WINDOWS)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+    namespace detail
+    {
+        /// The records are copied byte for byte, and their layout is part of the version
+        static_assert(std::is_standard_layout<SceneFile::NodeRecord>::value && sizeof(SceneFile::NodeRecord) == 120,
+                "The layout of SceneFile::NodeRecord changed");
+        static_assert(std::is_standard_layout<SceneFile::MeshRecord>::value && sizeof(SceneFile::MeshRecord) == 40,
+                "The layout of SceneFile::MeshRecord changed");
+        static_assert(std::is_standard_layout<SceneFile::MaterialRecord>::value && sizeof(SceneFile::MaterialRecord) == 80,
+                "The layout of SceneFile::MaterialRecord changed");
+        static_assert(std::is_standard_layout<SceneFile::Header>::value && sizeof(SceneFile::Header) == 64,
+                "The layout of SceneFile::Header changed");
+
+        inline BoundingBoxF toBounds(const float (&bounds)[6]) noexcept
+        {
+            return BoundingBoxF(Point3F(bounds[0], bounds[1], bounds[2]), Point3F(bounds[3], bounds[4], bounds[5]));
+        }
+
+        inline void fromBounds(const BoundingBoxF& box, float (&bounds)[6]) noexcept
+        {
+            for(std::size_t axis = 0; axis < 3; ++axis)
+            {
+                bounds[axis] = box.getMinimum(axis);
+                bounds[axis + 3] = box.getMaximum(axis);
+            }
+        }
+
+        template<typename T>
+        void link(SceneFile::RelativeArray<T>& array, std::vector<unsigned char>& bytes, std::size_t target, std::size_t count) noexcept
+        {
+            const std::size_t position = static_cast<std::size_t>(reinterpret_cast<unsigned char*>(&array) - bytes.data());
+            array.offset = static_cast<std::int64_t>(target) - static_cast<std::int64_t>(position);
+            array.count = count;
+        }
+    }
+
+    inline Matrix4x4F SceneFile::NodeRecord::getTransform() const noexcept
+    {
+        std::array<float, 16> elements;
+        std::copy(transform, transform + 16, elements.begin());
+        return Matrix4x4F(elements);
+    }
+
+    inline BoundingBoxF SceneFile::NodeRecord::getBounds() const noexcept
+    {
+        return detail::toBounds(bounds);
+    }
+
+    inline BoundingBoxF SceneFile::MeshRecord::getBounds() const noexcept
+    {
+        return detail::toBounds(bounds);
+    }
+
+    inline Material SceneFile::MaterialRecord::toMaterial() const
+    {
+        return Material(static_cast<LightingMode>(lightingMode), static_cast<CullingMode>(cullingMode), autoNormalize != 0,
+                Color<float, 4>(ambience[0], ambience[1], ambience[2], ambience[3]),
+                Color<float, 4>(diffusion[0], diffusion[1], diffusion[2], diffusion[3]),
+                Color<float, 4>(emission[0], emission[1], emission[2], emission[3]),
+                Color<float, 4>(specularity[0], specularity[1], specularity[2], specularity[3]));
+    }
+
+    inline SceneFile::SceneFile(const std::string& path) : data(nullptr), size(0), mapping(nullptr)
+    {
+#if defined(MIDNIGHT_WINDOWS)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file == INVALID_HANDLE_VALUE)
+        {
+            throw ResourceException("Unable to open the scene file " + path);
+        }
+        LARGE_INTEGER length;
+        HANDLE view = NULL;
+        if(GetFileSizeEx(file, &length) && length.QuadPart > 0)
+        {
+            view = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        }
+        CloseHandle(file);
+        if(view == NULL)
+        {
+            throw ResourceException("Unable to map the scene file " + path);
+        }
+        data = static_cast<const unsigned char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+        if(data == nullptr)
+        {
+            CloseHandle(view);
+            throw ResourceException("Unable to map the scene file " + path);
+        }
+        mapping = view;
+        size = static_cast<std::size_t>(length.QuadPart);
+#else
+        const int descriptor = open(path.c_str(), O_RDONLY);
+        if(descriptor < 0)
+        {
+            throw ResourceException("Unable to open the scene file " + path);
+        }
+        struct stat status;
+        void* address = MAP_FAILED;
+        if(fstat(descriptor, &status) == 0 && status.st_size > 0)
+        {
+            address = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+        /// The mapping keeps the file alive
+        close(descriptor);
+        if(address == MAP_FAILED)
+        {
+            throw ResourceException("Unable to map the scene file " + path);
+        }
+        data = static_cast<const unsigned char*>(address);
+        size = static_cast<std::size_t>(status.st_size);
+        mapping = address;
+#endif
+        try
+        {
+            validate();
+        }
+        catch(...)
+        {
+            unmap();
+            throw;
+        }
+    }
+
+    inline SceneFile::SceneFile(const void* data, std::size_t size) :
+        data(static_cast<const unsigned char*>(data)),
+        size(size),
+        mapping(nullptr)
+    {
+        validate();
+    }
+
+    inline SceneFile::~SceneFile()
+    {
+        unmap();
+    }
+
+    inline void SceneFile::unmap() noexcept
+    {
+        if(mapping == nullptr)
+        {
+            return;
+        }
+#if defined(MIDNIGHT_WINDOWS)
+        UnmapViewOfFile(data);
+        CloseHandle(mapping);
+#else
+        munmap(mapping, size);
+#endif
+        mapping = nullptr;
+    }
+
+    inline const SceneFile::Header& SceneFile::getHeader() const noexcept
+    {
+        return *reinterpret_cast<const Header*>(data);
+    }
+
+    inline const SceneFile::RelativeArray<SceneFile::NodeRecord>& SceneFile::getNodes() const noexcept
+    {
+        return getHeader().nodes;
+    }
+
+    inline const SceneFile::RelativeArray<SceneFile::MeshRecord>& SceneFile::getMeshes() const noexcept
+    {
+        return getHeader().meshes;
+    }
+
+    inline const SceneFile::RelativeArray<SceneFile::MaterialRecord>& SceneFile::getMaterials() const noexcept
+    {
+        return getHeader().materials;
+    }
+
+    inline bool SceneFile::verify() const noexcept
+    {
+        const RelativeArray<NodeRecord>& nodes = getNodes();
+        const RelativeArray<MeshRecord>& meshes = getMeshes();
+        const RelativeArray<MaterialRecord>& materials = getMaterials();
+        if(nodes.count >= NONE || meshes.count >= NONE || materials.count >= NONE)
+        {
+            return false;
+        }
+        const std::uint32_t count = static_cast<std::uint32_t>(nodes.count);
+        for(std::uint32_t i = 0; i < count; ++i)
+        {
+            const NodeRecord& node = nodes[i];
+            if(!contains(node.name) || node.subtreeSize == 0 || node.subtreeSize > count - i ||
+                    (node.mesh != NONE && node.mesh >= meshes.count) || (node.material != NONE && node.material >= materials.count))
+            {
+                return false;
+            }
+
+            /// The parent must be the innermost subtree that the node lies in.  The subtrees that
+            /// end before the node are left behind for good, so the walks take linear time.
+            std::uint32_t enclosing = i == 0 ? NONE : i - 1;
+            while(enclosing != NONE && enclosing + nodes[enclosing].subtreeSize <= i)
+            {
+                enclosing = nodes[enclosing].parent;
+            }
+            if(node.parent != enclosing ||
+                    (enclosing != NONE && i + node.subtreeSize > enclosing + nodes[enclosing].subtreeSize))
+            {
+                return false;
+            }
+        }
+        for(const MeshRecord& mesh : meshes)
+        {
+            if(!contains(mesh.path))
+            {
+                return false;
+            }
+        }
+        for(const MaterialRecord& material : materials)
+        {
+            if(material.lightingMode > ALL_LIGHTING || material.cullingMode > CULL_ALL_FACES)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline std::vector<FlatSceneGraph::Handle> SceneFile::instantiate(FlatSceneGraph& graph) const
+    {
+        const RelativeArray<NodeRecord>& nodes = getNodes();
+        std::vector<FlatSceneGraph::Handle> handles;
+        handles.reserve(nodes.size());
+        graph.reserve(graph.getNodeCount() + nodes.size());
+
+        /// Nodes arrive depth-first, so every node is appended to the last subtree
+        for(const NodeRecord& node : nodes)
+        {
+            if(node.parent != NONE && node.parent >= handles.size())
+            {
+                throw ResourceException("A node of a scene file must follow its parent");
+            }
+
+            const FlatSceneGraph::Handle parent = node.parent == NONE ? FlatSceneGraph::Handle() : handles[node.parent];
+            handles.push_back(graph.create(parent, node.getTransform(), node.getBounds(), node.mesh));
+        }
+        return handles;
+    }
+
+    inline void SceneFile::validate() const
+    {
+        if(size < sizeof(Header) || reinterpret_cast<std::uintptr_t>(data) % alignof(Header) != 0)
+        {
+            throw ResourceException("A scene file must start with an aligned header");
+        }
+        const Header& header = getHeader();
+        if(header.magic != MAGIC)
+        {
+            throw ResourceException("Not a scene file (or of another byte order)");
+        }
+        if(header.version != VERSION)
+        {
+            throw ResourceException("Scene file version " + std::to_string(header.version) + " is not supported (expected " +
+                    std::to_string(VERSION) + ")");
+        }
+        if(header.size != size)
+        {
+            throw ResourceException("The scene file is " + std::to_string(size) + " bytes long instead of " +
+                    std::to_string(header.size));
+        }
+        if(!contains(header.nodes) || !contains(header.meshes) || !contains(header.materials))
+        {
+            throw ResourceException("The records of the scene file lie outside of it");
+        }
+    }
+
+    template<typename T>
+    inline bool SceneFile::contains(const RelativeArray<T>& array) const noexcept
+    {
+        const std::int64_t position = reinterpret_cast<const unsigned char*>(&array) - data;
+        if(array.offset < -position || array.offset > static_cast<std::int64_t>(size) - position)
+        {
+            return false;
+        }
+        const std::size_t start = static_cast<std::size_t>(position + array.offset);
+        return start % alignof(T) == 0 && array.count <= (size - start) / sizeof(T);
+    }
+
+    inline bool SceneFile::contains(const RelativeString& string) const noexcept
+    {
+        /// The terminating null character lies within the file as well
+        const std::int64_t position = reinterpret_cast<const unsigned char*>(&string) - data;
+        return contains<char>(string) && static_cast<std::uint64_t>(position + string.offset) + string.count < size &&
+                string.data()[string.count] == '\0';
+    }
+
+    inline std::uint32_t SceneFileWriter::addMesh(const std::string& path, const BoundingBoxF& bounds)
+    {
+        meshes.push_back(MeshReference{path, bounds});
+        return static_cast<std::uint32_t>(meshes.size() - 1);
+    }
+
+    inline std::uint32_t SceneFileWriter::addMaterial(const Material& material)
+    {
+        materials.push_back(material);
+        return static_cast<std::uint32_t>(materials.size() - 1);
+    }
+
+    inline std::uint32_t SceneFileWriter::addNode(std::uint32_t parent, const Matrix4x4F& transform, const BoundingBoxF& bounds,
+            std::uint32_t mesh, std::uint32_t material, const std::string& name)
+    {
+        if(parent != SceneFile::NONE && parent >= nodes.size())
+        {
+            throw IllegalArgumentException("Node " + std::to_string(parent) + " has not been added");
+        }
+        if(mesh != SceneFile::NONE && mesh >= meshes.size())
+        {
+            throw IllegalArgumentException("Mesh " + std::to_string(mesh) + " has not been added");
+        }
+        if(material != SceneFile::NONE && material >= materials.size())
+        {
+            throw IllegalArgumentException("Material " + std::to_string(material) + " has not been added");
+        }
+        if(nodes.size() + 1 >= SceneFile::NONE)
+        {
+            throw IllegalArgumentException("A scene file cannot hold any more nodes");
+        }
+        nodes.push_back(Node{name, parent, mesh, material, transform, bounds});
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+
+    inline std::size_t SceneFileWriter::getNodeCount() const noexcept
+    {
+        return nodes.size();
+    }
+
+    inline std::vector<unsigned char> SceneFileWriter::serialize(std::vector<std::uint32_t>* positions) const
+    {
+        const std::uint32_t NONE = SceneFile::NONE;
+        const std::uint32_t count = static_cast<std::uint32_t>(nodes.size());
+
+        /// The children of every node (and the roots) as lists in the order of addition
+        std::vector<std::uint32_t> firstChild(count, NONE);
+        std::vector<std::uint32_t> nextSibling(count, NONE);
+        std::uint32_t firstRoot = NONE;
+        for(std::uint32_t i = count; i-- > 0;)
+        {
+            std::uint32_t& first = nodes[i].parent == NONE ? firstRoot : firstChild[nodes[i].parent];
+            nextSibling[i] = first;
+            first = i;
+        }
+
+        /// Depth-first order, and the position of every node within it
+        std::vector<std::uint32_t> order;
+        order.reserve(count);
+        std::vector<std::uint32_t> position(count);
+        std::vector<std::uint32_t> stack;
+        for(std::uint32_t root = firstRoot; root != NONE; root = nextSibling[root])
+        {
+            stack.push_back(root);
+            while(!stack.empty())
+            {
+                const std::uint32_t node = stack.back();
+                stack.pop_back();
+                position[node] = static_cast<std::uint32_t>(order.size());
+                order.push_back(node);
+
+                /// Pushed in reverse, so that the first child is visited first
+                const std::size_t mark = stack.size();
+                for(std::uint32_t child = firstChild[node]; child != NONE; child = nextSibling[child])
+                {
+                    stack.push_back(child);
+                }
+                std::reverse(stack.begin() + mark, stack.end());
+            }
+        }
+
+        /// The records, then the strings, every section aligned to eight bytes
+        auto align = [](std::size_t offset)
+        {
+            return (offset + 7) & ~static_cast<std::size_t>(7);
+        };
+        const std::size_t nodesStart = align(sizeof(SceneFile::Header));
+        const std::size_t meshesStart = nodesStart + count * sizeof(SceneFile::NodeRecord);
+        const std::size_t materialsStart = meshesStart + meshes.size() * sizeof(SceneFile::MeshRecord);
+        const std::size_t stringsStart = materialsStart + materials.size() * sizeof(SceneFile::MaterialRecord);
+        std::size_t stringsSize = 0;
+        for(const Node& node : nodes)
+        {
+            stringsSize += node.name.size() + 1;
+        }
+        for(const MeshReference& mesh : meshes)
+        {
+            stringsSize += mesh.path.size() + 1;
+        }
+        std::vector<unsigned char> bytes(align(stringsStart + stringsSize), 0);
+
+        SceneFile::Header& header = *reinterpret_cast<SceneFile::Header*>(bytes.data());
+        header.magic = SceneFile::MAGIC;
+        header.version = SceneFile::VERSION;
+        header.size = bytes.size();
+        detail::link(header.nodes, bytes, nodesStart, count);
+        detail::link(header.meshes, bytes, meshesStart, meshes.size());
+        detail::link(header.materials, bytes, materialsStart, materials.size());
+
+        std::size_t strings = stringsStart;
+        auto store = [&bytes, &strings](SceneFile::RelativeString& string, const std::string& value)
+        {
+            std::memcpy(bytes.data() + strings, value.data(), value.size());
+            detail::link(string, bytes, strings, value.size());
+            strings += value.size() + 1;
+        };
+
+        SceneFile::NodeRecord* nodeRecords = reinterpret_cast<SceneFile::NodeRecord*>(bytes.data() + nodesStart);
+        std::vector<std::uint32_t> subtreeSizes(count, 1);
+        for(std::uint32_t i = count; i-- > 0;)
+        {
+            const Node& node = nodes[order[i]];
+            SceneFile::NodeRecord& record = nodeRecords[i];
+            record.parent = node.parent == NONE ? NONE : position[node.parent];
+            if(record.parent != NONE)
+            {
+                subtreeSizes[record.parent] += subtreeSizes[i];
+            }
+            record.subtreeSize = subtreeSizes[i];
+            record.mesh = node.mesh;
+            record.material = node.material;
+            std::copy(node.transform.begin(), node.transform.end(), record.transform);
+            detail::fromBounds(node.bounds, record.bounds);
+        }
+        for(std::uint32_t i = 0; i < count; ++i)
+        {
+            store(nodeRecords[i].name, nodes[order[i]].name);
+        }
+
+        SceneFile::MeshRecord* meshRecords = reinterpret_cast<SceneFile::MeshRecord*>(bytes.data() + meshesStart);
+        for(std::size_t i = 0; i < meshes.size(); ++i)
+        {
+            store(meshRecords[i].path, meshes[i].path);
+            detail::fromBounds(meshes[i].bounds, meshRecords[i].bounds);
+        }
+
+        SceneFile::MaterialRecord* materialRecords = reinterpret_cast<SceneFile::MaterialRecord*>(bytes.data() + materialsStart);
+        for(std::size_t i = 0; i < materials.size(); ++i)
+        {
+            const Material& material = materials[i];
+            SceneFile::MaterialRecord& record = materialRecords[i];
+            record.lightingMode = static_cast<std::uint32_t>(material.getLightingMode());
+            record.cullingMode = static_cast<std::uint32_t>(material.getCullingMode());
+            record.autoNormalize = material.autoNormalizes() ? 1 : 0;
+            for(std::size_t k = 0; k < 4; ++k)
+            {
+                record.ambience[k] = material.getAmbience()[k];
+                record.diffusion[k] = material.getDiffusion()[k];
+                record.emission[k] = material.getEmission()[k];
+                record.specularity[k] = material.getSpecularity()[k];
+            }
+        }
+
+        if(positions != nullptr)
+        {
+            *positions = std::move(position);
+        }
+        return bytes;
+    }
+
+    inline void SceneFileWriter::write(const std::string& path) const
+    {
+        const std::vector<unsigned char> bytes = serialize();
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if(!stream)
+            {
+                std::remove(temporary.c_str());
+                throw ResourceException("Unable to write the scene file " + path);
+            }
+        }
+        /// rename does not replace existing files everywhere
+        std::remove(path.c_str());
+        if(std::rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temporary.c_str());
+            throw ResourceException("Unable to write the scene file " + path);
+        }
+    }
+
+}
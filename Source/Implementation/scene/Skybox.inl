@@ -55,25 +55,19 @@ namespace midnight
 
     template<typename T, std::size_t W, std::size_t H, std::size_t L>
     const std::string Skybox<T, W, H, L>::VERTEX_SHADER_SRC = 
-        "#version 130\n\
-        in vec3 position;\n\
+        std::string("#version 150\n") + FrameUniforms::GLSL_BLOCKS +
+        "in vec3 position;\n\
         in vec2 uv_in;\n\
         out vec2 uv_out;\n\
-        uniform vec3 offset;\n\
-        uniform mat4 projection;\n\
-        uniform mat4 orientation;\n\
         void main()\n\
         {\n\
-            vec4 cameraPos = vec4(position.x, position.y, position.z, 1.0) + vec4(offset.x, offset.y, offset.z, 0.0);\n\
-            cameraPos *= orientation;\n\
-            cameraPos *= projection;\n\
-            gl_Position = cameraPos;\n\
+            gl_Position = vec4(position, 1.0) * object.model_view_projection;\n\
             uv_out = uv_in;\n\
         }";
 
     template<typename T, std::size_t W, std::size_t H, std::size_t L>
     const std::string Skybox<T, W, H, L>::FRAGMENT_SHADER_SRC = 
-        "#version 130\n\
+        "#version 140\n\
         in vec2 uv_out;\n\
         uniform sampler2D tex;\n\
         void main()\n\
@@ -82,36 +76,32 @@ namespace midnight
         }";
 
     template<typename T, std::size_t W, std::size_t H, std::size_t L>
-    Skybox<T, W, H, L>::Skybox(std::shared_ptr<SceneGraphNode> parent, const Texture& texture) : 
+    Skybox<T, W, H, L>::Skybox(std::shared_ptr<SceneGraphNode> parent, Texture texture) : 
         AbstractSceneGraphNode(), 
         parent(parent), 
-        program(VertexShader(VERTEX_SHADER_SRC), FragmentShader(FRAGMENT_SHADER_SRC)), 
-        texture(texture), 
+        program(ProgramRegistry::getDefault().acquire(VERTEX_SHADER_SRC, FRAGMENT_SHADER_SRC)), 
+        texture(std::move(texture)), 
+        sampler(Sampler::acquire(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE)), 
         vbo(DATA)
     {
         vbo.addAttributePointer("position", 3, GL_FLOAT, GL_FALSE, 0, 0);
         vbo.addAttributePointer("uv_in", 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid*>(48 * 6));
+        FrameUniforms::attach(*program);
+        setLocalBounds(BoundingBoxF(Point3F(-static_cast<float>(W), -static_cast<float>(H), -static_cast<float>(L)),
+                Point3F(static_cast<float>(W), static_cast<float>(H), static_cast<float>(L))));
     }
 
     template<typename T, std::size_t W, std::size_t H, std::size_t L>
     void Skybox<T, W, H, L>::render(const Camera& camera)
     {
-   		glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture.handle);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP);
-        
-		program.bind();
-		program.setUniform("offset", camera.getPosition());
-		program.setMatrixUniform("projection", camera.getProjection());
-		program.setMatrixUniform("orientation", camera.getOrientation());
+        texture.bind(0, *sampler);
+
+		program->bind();
+		FrameUniforms::getActive().bindObject();
 		vbo.bind();
 		glDrawArrays(GL_QUADS, 0, 24);
 		vbo.unbind();
-		program.unbind();
+		program->unbind();
         this->AbstractSceneGraphNode::render(camera);
     }
 
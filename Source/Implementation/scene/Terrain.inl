@@ -1,5 +1,6 @@
 
 #include "Terrain.hpp"
+#include "parallel_for.hpp"
 
 namespace midnight
 {
@@ -10,49 +11,65 @@ namespace midnight
         horizontalScale(horizontalScale), 
         heightmap(io::loadHeightmap(heightmapFile)), 
         texture(io::loadTexture(texturemapFile)), 
-        program(VertexShader(VERTEX_SHADER_SRC), FragmentShader(FRAGMENT_SHADER_SRC))
+        sampler(Sampler::acquire(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE)), 
+        program(ProgramRegistry::getDefault().acquire(VERTEX_SHADER_SRC, FRAGMENT_SHADER_SRC))
     {
+            const std::size_t width = heightmap.getWidth();
+            const std::size_t height = heightmap.getHeight();
+
+            /// Every column of the grid is generated by its own job
             std::vector<uint32_t> _indexData;
-            _indexData.resize(heightmap.getWidth() * heightmap.getHeight() * 6);
-            std::size_t ptr = 0;
-            for(uint32_t i = 0; i < heightmap.getWidth() - 1; ++i)
+            _indexData.resize(width * height * 6);
+            parallel_for(0, width - 1, [&](std::size_t i)
             {
-                for(uint32_t j = 0; j < heightmap.getHeight() - 1; ++j)
+                std::size_t ptr = i * (height - 1) * 6;
+                for(std::size_t j = 0; j < height - 1; ++j)
                 {
-                    _indexData[ptr++] = static_cast<uint32_t>(j * heightmap.getWidth() + i);
-                    _indexData[ptr++] = static_cast<uint32_t>((j + 1) * heightmap.getWidth() + i);
-                    _indexData[ptr++] = static_cast<uint32_t>(j * heightmap.getWidth() + i+ 1);
+                    _indexData[ptr++] = static_cast<uint32_t>(j * width + i);
+                    _indexData[ptr++] = static_cast<uint32_t>((j + 1) * width + i);
+                    _indexData[ptr++] = static_cast<uint32_t>(j * width + i+ 1);
 
-                    _indexData[ptr++] = static_cast<uint32_t>(j * heightmap.getWidth() + i+ 1);
-                    _indexData[ptr++] = static_cast<uint32_t>((j + 1) * heightmap.getWidth() + i);
-                    _indexData[ptr++] = static_cast<uint32_t>((j + 1) * heightmap.getWidth() + i+ 1);
+                    _indexData[ptr++] = static_cast<uint32_t>(j * width + i+ 1);
+                    _indexData[ptr++] = static_cast<uint32_t>((j + 1) * width + i);
+                    _indexData[ptr++] = static_cast<uint32_t>((j + 1) * width + i+ 1);
 
                 }
-            }
+            });
 
             std::vector<T> _vertexData;
             constexpr std::size_t DATA_COUNT = 8;
-            _vertexData.resize(heightmap.getWidth() * heightmap.getHeight() * DATA_COUNT);
-            for(std::size_t i = 0; i < heightmap.getWidth(); ++i)
+            _vertexData.resize(width * height * DATA_COUNT);
+            std::vector<BoundingBoxF> columnBounds(width);
+            parallel_for(0, width, [&](std::size_t i)
             {
-                for(std::size_t j = 0; j < heightmap.getHeight(); ++j)
+                for(std::size_t j = 0; j < height; ++j)
                 {
 
-                    std::size_t index = j * heightmap.getWidth() + i;
+                    std::size_t index = j * width + i;
 
                     /// Positions
-                    _vertexData[DATA_COUNT * index + 0] = (T)i - (T)((T)heightmap.getWidth() / 2.0f);
+                    _vertexData[DATA_COUNT * index + 0] = (T)i - (T)((T)width / 2.0f);
                     _vertexData[DATA_COUNT * index + 1] = -static_cast<T>(heightmap[index * 4]) / 255.0f * verticalScale;
-                    _vertexData[DATA_COUNT * index + 2] = (T)j - (T)((T)heightmap.getHeight() / 2.0f);
+                    _vertexData[DATA_COUNT * index + 2] = (T)j - (T)((T)height / 2.0f);
+                    columnBounds[i].merge(Point3F(static_cast<float>(_vertexData[DATA_COUNT * index + 0]),
+                            static_cast<float>(_vertexData[DATA_COUNT * index + 1]), static_cast<float>(_vertexData[DATA_COUNT * index + 2])));
 
                     /// Texture Coordinates
-                    _vertexData[DATA_COUNT * index + 3] = static_cast<T>(i) / static_cast<T>(heightmap.getWidth());
-                    _vertexData[DATA_COUNT * index + 4] = static_cast<T>(j) / static_cast<T>(heightmap.getHeight());
+                    _vertexData[DATA_COUNT * index + 3] = static_cast<T>(i) / static_cast<T>(width);
+                    _vertexData[DATA_COUNT * index + 4] = static_cast<T>(j) / static_cast<T>(height);
                 }
+            });
+            BoundingBoxF bounds;
+            for(const BoundingBoxF& column : columnBounds)
+            {
+                bounds.merge(column);
             }
 
-            for(std::size_t i = 0; i < _indexData.size(); i += 3)
+            /// The normal of every triangle, in the order of the index data
+            std::vector<Vector3F> faceNormals(2 * (width - 1) * (height - 1));
+            parallel_for(0, faceNormals.size(), [&](std::size_t face)
             {
+                const std::size_t i = 3 * face;
                 Point3F p0(_vertexData[DATA_COUNT * _indexData[i + 0] + 0], _vertexData[DATA_COUNT * _indexData[i + 0] + 1], _vertexData[DATA_COUNT * _indexData[i + 0] + 2]);
                 Point3F p1(_vertexData[DATA_COUNT * _indexData[i + 1] + 0], _vertexData[DATA_COUNT * _indexData[i + 1] + 1], _vertexData[DATA_COUNT * _indexData[i + 1] + 2]);
                 Point3F p2(_vertexData[DATA_COUNT * _indexData[i + 2] + 0], _vertexData[DATA_COUNT * _indexData[i + 2] + 1], _vertexData[DATA_COUNT * _indexData[i + 2] + 2]);
@@ -60,20 +77,43 @@ namespace midnight
                 Vector3F v0(p0 - p1);
                 Vector3F v1(p0 - p2);
 
-                Vector3F normal = cross(v0, v1).normalize();
-
-                _vertexData[DATA_COUNT * _indexData[i + 0] + 5] += normal[0];
-                _vertexData[DATA_COUNT * _indexData[i + 0] + 6] += normal[1];
-                _vertexData[DATA_COUNT * _indexData[i + 0] + 7] += normal[2];
+                faceNormals[face] = cross(v0, v1).normalize();
+            });
 
-                _vertexData[DATA_COUNT * _indexData[i + 1] + 5] += normal[0];
-                _vertexData[DATA_COUNT * _indexData[i + 1] + 6] += normal[1];
-                _vertexData[DATA_COUNT * _indexData[i + 1] + 7] += normal[2];
-
-                _vertexData[DATA_COUNT * _indexData[i + 2] + 5] += normal[0];
-                _vertexData[DATA_COUNT * _indexData[i + 2] + 6] += normal[1];
-                _vertexData[DATA_COUNT * _indexData[i + 2] + 7] += normal[2];
-            }
+            /// Each vertex gathers the normals of the (up to six) triangles around it, in the order
+            /// the triangles were laid out, so that no two jobs write the same vertex
+            parallel_for(0, width, [&](std::size_t i)
+            {
+                for(std::size_t j = 0; j < height; ++j)
+                {
+                    const std::size_t index = j * width + i;
+                    auto accumulate = [&](std::size_t column, std::size_t row, std::size_t triangle)
+                    {
+                        const Vector3F& normal = faceNormals[2 * (column * (height - 1) + row) + triangle];
+                        _vertexData[DATA_COUNT * index + 5] += normal[0];
+                        _vertexData[DATA_COUNT * index + 6] += normal[1];
+                        _vertexData[DATA_COUNT * index + 7] += normal[2];
+                    };
+                    if(i > 0 && j > 0)
+                    {
+                        accumulate(i - 1, j - 1, 1);
+                    }
+                    if(i > 0 && j < height - 1)
+                    {
+                        accumulate(i - 1, j, 0);
+                        accumulate(i - 1, j, 1);
+                    }
+                    if(i < width - 1 && j > 0)
+                    {
+                        accumulate(i, j - 1, 0);
+                        accumulate(i, j - 1, 1);
+                    }
+                    if(i < width - 1 && j < height - 1)
+                    {
+                        accumulate(i, j, 0);
+                    }
+                }
+            });
 
        this->vertexData.reset(new StaticDrawTriangleBuffer<float>(_vertexData));
        this->indexBuffer.reset(new StaticDrawIndexBuffer<uint32_t>(_indexData));
@@ -81,33 +121,28 @@ namespace midnight
         this->vertexData->addAttributePointer("position", 3, GL_FLOAT, GL_FALSE, DATA_COUNT * 4, reinterpret_cast<GLvoid*>(0));
         this->vertexData->addAttributePointer("uv", 2, GL_FLOAT, GL_FALSE, DATA_COUNT * 4, reinterpret_cast<GLvoid*>(12));
         this->vertexData->addAttributePointer("normal", 3, GL_FLOAT, GL_FALSE, DATA_COUNT * 4, reinterpret_cast<GLvoid*>(20));
+        FrameUniforms::attach(*program);
+        setLocalBounds(bounds);
     }
 
     template<typename T>
     void Terrain<T>::render(const Camera& camera)
     {
         this->AbstractSceneGraphNode::render(camera);
-        program.setUniform("ambient_color", ambientLighting.getColor());
-        program.setUniform("sun_position", Tuple4F(0.0f, 100.0f, 1.0f, 1.0f));
-        program.setUniform("sun_color", Tuple4F(1.0f, 1.0f, 0.0f, 1.0f));
-        program.setUniform("offset", (Tuple3F)camera.getPosition());
-        program.setMatrixUniform("projection", camera.getProjection());
-        program.setMatrixUniform("orientation", camera.getOrientation());
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture.handle);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP);
-        this->program.bind();
+        /// The lighting of a Terrain rarely changes, so these are usually skipped by the shadows
+        program->setUniforms("ambient_color", ambientLighting.getColor(),
+                "sun_position", Tuple4F(0.0f, 100.0f, 1.0f, 1.0f),
+                "sun_color", Tuple4F(1.0f, 1.0f, 0.0f, 1.0f));
+        FrameUniforms::getActive().bindObject();
+        texture.bind(0, *sampler);
+        this->program->bind();
 
         this->indexBuffer->bind();
         this->vertexData->bind();
         glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(heightmap.getWidth() * heightmap.getHeight() * 6), GL_UNSIGNED_INT, (GLvoid*)0);
         this->vertexData->unbind();
         this->indexBuffer->unbind();
-        this->program.unbind();
+        this->program->unbind();
 
     }
     
@@ -123,6 +158,21 @@ namespace midnight
         return true;
     }
     
+    template<typename T>
+    bool Terrain<T>::intersect(const Ray& ray, float maximum, SurfaceHit& hit)
+    {
+        const std::size_t width = heightmap.getWidth();
+        const std::size_t height = heightmap.getHeight();
+        const Heightmap& samples = heightmap;
+
+        /// The positions of the vertices, as the constructor computes them
+        return picking::marchHeightfield(ray, maximum, width, height, -static_cast<float>((T)((T)width / 2.0f)),
+                -static_cast<float>((T)((T)height / 2.0f)), [&samples, width, this](std::size_t i, std::size_t j)
+        {
+            return static_cast<float>(-static_cast<T>(samples[(j * width + i) * 4]) / 255.0f * verticalScale);
+        }, hit);
+    }
+
     template<typename T>
     void Terrain<T>::setAmbience(const AmbientLight<float>& ambience)
     {
@@ -131,8 +181,8 @@ namespace midnight
     
     template<typename T>
     const std::string Terrain<T>::VERTEX_SHADER_SRC = 
-        "#version 130\n\
-        in vec3 position;\n\
+        std::string("#version 150\n") + FrameUniforms::GLSL_BLOCKS +
+        "in vec3 position;\n\
         in vec2 uv;\n\
         in vec3 normal;\n\
 \
@@ -142,16 +192,15 @@ namespace midnight
         uniform vec4 ambient_color;\n\
         uniform vec4 sun_position;\n\
         uniform vec4 sun_color;\n\
-\
-        uniform vec3 offset;\n\
-        uniform mat4 projection;\n\
-        uniform mat4 orientation;\n\
 \
         void main()\n\
         {\n\
-            vec4 cameraPos = vec4(position.x, position.y, position.z, 1.0) + vec4(offset.x, offset.y, offset.z, 0.0);\n\
-            cameraPos *= orientation;\n\
-            cameraPos *= projection;\n\
+            /// The orientation is the model-view without its translation row\n\
+            mat4 orientation = object.model_view;\n\
+            orientation[0][3] = 0.0;\n\
+            orientation[1][3] = 0.0;\n\
+            orientation[2][3] = 0.0;\n\
+            vec4 cameraPos = vec4(position.x, position.y, position.z, 1.0) * object.model_view_projection;\n\
             vec4 _normal = vec4(normal.x, normal.y, normal.z, 1.0);\n\
             _normal *= orientation;\n\
             vec4 pos = sun_position;\n\
@@ -164,7 +213,7 @@ namespace midnight
     
     template<typename T>
     const std::string Terrain<T>::FRAGMENT_SHADER_SRC = 
-        "#version 130\n\
+        "#version 140\n\
         uniform sampler2D tex0;\n\
         in vec2 uv_out;\n\
         in vec4 rgba_out;\n\
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <initializer_list>
+
+#include "IllegalArgumentException.hpp"
+
+namespace midnight
+{
+
+    inline TriangleBVH::TriangleBVH(const std::vector<Point3F>& positions, const std::vector<std::uint32_t>& indices)
+    {
+        if(indices.size() % 3 != 0)
+        {
+            throw IllegalArgumentException("The number of indices of a TriangleBVH must be a multiple of three");
+        }
+        for(std::uint32_t index : indices)
+        {
+            if(index >= positions.size())
+            {
+                throw IllegalArgumentException("An index of a TriangleBVH is out of range");
+            }
+        }
+        const std::size_t count = indices.size() / 3;
+        if(count == 0)
+        {
+            return;
+        }
+
+        std::vector<BoundingBoxF> bounds(count);
+        std::vector<Point3F> centroids(count);
+        triangles.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            for(std::size_t corner = 0; corner < 3; ++corner)
+            {
+                bounds[i].merge(positions[indices[3 * i + corner]]);
+            }
+            centroids[i] = bounds[i].getCenter();
+            triangles[i] = static_cast<std::uint32_t>(i);
+        }
+
+        /// Roughly as many nodes as a median split yields
+        nodes.reserve(4 * (count / LEAF_SIZE + 1));
+        nodes.push_back(Node());
+        build(0, 0, count, bounds, centroids);
+
+        corners.reserve(3 * count);
+        for(std::uint32_t triangle : triangles)
+        {
+            for(std::size_t corner = 0; corner < 3; ++corner)
+            {
+                corners.push_back(positions[indices[3 * triangle + corner]]);
+            }
+        }
+    }
+
+    inline void TriangleBVH::build(std::size_t node, std::size_t begin, std::size_t end,
+            const std::vector<BoundingBoxF>& bounds, const std::vector<Point3F>& centroids)
+    {
+        BoundingBoxF box;
+        BoundingBoxF centers;
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            box.merge(bounds[triangles[i]]);
+            centers.merge(centroids[triangles[i]]);
+        }
+        nodes[node].bounds = box;
+        if(end - begin <= LEAF_SIZE)
+        {
+            nodes[node].first = static_cast<std::uint32_t>(begin);
+            nodes[node].count = static_cast<std::uint32_t>(end - begin);
+            return;
+        }
+
+        std::size_t axis = 0;
+        for(std::size_t i = 1; i < 3; ++i)
+        {
+            if(centers.getMaximum(i) - centers.getMinimum(i) > centers.getMaximum(axis) - centers.getMinimum(axis))
+            {
+                axis = i;
+            }
+        }
+        const std::size_t middle = begin + (end - begin) / 2;
+        std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+                [&centroids, axis](std::uint32_t lhs, std::uint32_t rhs)
+        {
+            return centroids[lhs][axis] < centroids[rhs][axis];
+        });
+
+        const std::size_t first = nodes.size();
+        nodes[node].first = static_cast<std::uint32_t>(first);
+        nodes[node].count = 0;
+        nodes.push_back(Node());
+        nodes.push_back(Node());
+        build(first, begin, middle, bounds, centroids);
+        build(first + 1, middle, end, bounds, centroids);
+    }
+
+    inline bool TriangleBVH::intersect(const Ray& ray, float maximum, SurfaceHit& hit) const noexcept
+    {
+        if(nodes.empty())
+        {
+            return false;
+        }
+
+        /// A median split halves the triangles at every level, so 64 entries outlast any mesh.
+        /// Every entry keeps the distance at which the Ray enters its node, so that nodes beyond
+        /// a hit found since they were pushed are skipped.
+        std::uint32_t stack[64];
+        float entries[64];
+        std::size_t size = 0;
+        float best = maximum;
+        bool found = false;
+        float distance;
+        if(!ray.intersects(nodes[0].bounds, distance, best))
+        {
+            return false;
+        }
+        stack[size] = 0;
+        entries[size++] = distance;
+        while(size != 0)
+        {
+            --size;
+            if(entries[size] > best)
+            {
+                continue;
+            }
+            const Node& node = nodes[stack[size]];
+            if(node.count != 0)
+            {
+                for(std::size_t i = node.first; i < node.first + node.count; ++i)
+                {
+                    if(ray.intersects(corners[3 * i], corners[3 * i + 1], corners[3 * i + 2], distance, best))
+                    {
+                        best = distance;
+                        hit.primitive = triangles[i];
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            /// Pushes the farther child first, so that the nearer one is visited next
+            float near[2];
+            bool entered[2];
+            for(std::size_t i = 0; i < 2; ++i)
+            {
+                entered[i] = ray.intersects(nodes[node.first + i].bounds, near[i], best);
+            }
+            const std::size_t nearer = entered[1] && (!entered[0] || near[1] < near[0]) ? 1 : 0;
+            const std::size_t farther = 1 - nearer;
+            for(std::size_t i : {farther, nearer})
+            {
+                if(entered[i])
+                {
+                    stack[size] = node.first + static_cast<std::uint32_t>(i);
+                    entries[size++] = near[i];
+                }
+            }
+        }
+        if(found)
+        {
+            hit.distance = best;
+        }
+        return found;
+    }
+
+    inline std::size_t TriangleBVH::getTriangleCount() const noexcept
+    {
+        return triangles.size();
+    }
+
+    inline std::size_t TriangleBVH::getNodeCount() const noexcept
+    {
+        return nodes.size();
+    }
+
+}
@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "IllegalArgumentException.hpp"
+#include "parallel_for.hpp"
+
+namespace midnight
+{
+
+    namespace detail
+    {
+        /// The number of quantized components per vertex (position, normal and texture coordinate)
+        constexpr std::size_t WELD_KEY_SIZE = 8;
+
+        /// Marks a hash table slot that holds no vertex
+        constexpr std::size_t WELD_EMPTY = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * Quantizes a single attribute component onto a grid with the provided cells per unit
+         * (zero requests an exact, bit-wise key)
+         *
+         */
+        inline std::int64_t weldQuantize(float value, double scale)
+        {
+            if(scale == 0.0)
+            {
+                /// Exact comparison -- fold negative zero onto positive zero and compare bits
+                float folded = value == 0.0f ? 0.0f : value;
+                std::uint32_t bits;
+                std::memcpy(&bits, &folded, sizeof(bits));
+                return static_cast<std::int64_t>(bits);
+            }
+            double cell = std::floor(static_cast<double>(value) * scale + 0.5);
+            /// Beyond 2^62 cells the grid no longer resolves the tolerance anyway
+            const double limit = 4611686018427387904.0;
+            if(!(cell >= -limit && cell <= limit))
+            {
+                throw IllegalArgumentException(std::string("Vertex attribute ") + std::to_string(value) +
+                        " cannot be welded with a tolerance of " + std::to_string(1.0 / scale));
+            }
+            return static_cast<std::int64_t>(cell);
+        }
+
+        /**
+         * Hashes a quantized vertex (a 64-bit variant of MurmurHash's finalizer per component)
+         *
+         */
+        inline std::uint64_t weldHash(const std::int64_t* key) noexcept
+        {
+            std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+            for(std::size_t i = 0; i < WELD_KEY_SIZE; ++i)
+            {
+                hash ^= static_cast<std::uint64_t>(key[i]);
+                hash *= 0xFF51AFD7ED558CCDull;
+                hash ^= hash >> 32;
+            }
+            hash *= 0xC4CEB9FE1A85EC53ull;
+            return hash ^ (hash >> 29);
+        }
+
+        inline bool weldKeysEqual(const std::vector<std::int64_t>& keys, std::size_t a, std::size_t b) noexcept
+        {
+            return std::equal(keys.begin() + a * WELD_KEY_SIZE, keys.begin() + (a + 1) * WELD_KEY_SIZE, keys.begin() + b * WELD_KEY_SIZE);
+        }
+
+        /**
+         * Retrieves the number of contiguous chunks that a pass over 'count' vertices is split into
+         *
+         */
+        inline std::size_t weldChunkCount(std::size_t count) noexcept
+        {
+            /// Chunks smaller than this are not worth a thread
+            const std::size_t minimum = 16384;
+            return std::max<std::size_t>(1, std::min(count / minimum, hardwareConcurrency() * 4));
+        }
+
+        inline std::size_t weldChunkBegin(std::size_t count, std::size_t chunk, std::size_t chunks) noexcept
+        {
+            return count * chunk / chunks;
+        }
+    }
+
+    inline VertexWelder::VertexWelder(float positionTolerance, float normalTolerance, float texCoordTolerance, Strategy strategy) :
+        positionTolerance(positionTolerance),
+        normalTolerance(normalTolerance),
+        texCoordTolerance(texCoordTolerance),
+        strategy(strategy)
+    {
+        /// Written to reject NaN as well
+        if(!(positionTolerance >= 0.0f && normalTolerance >= 0.0f && texCoordTolerance >= 0.0f))
+        {
+            throw IllegalArgumentException("Weld tolerances must not be negative");
+        }
+    }
+
+    inline std::vector<std::size_t> VertexWelder::weld(const std::vector<Vertex32F>& soup, std::vector<Vertex32F>& vertices) const
+    {
+        const std::size_t count = soup.size();
+        vertices.clear();
+        if(count == 0)
+        {
+            return std::vector<std::size_t>();
+        }
+        const std::size_t chunks = detail::weldChunkCount(count);
+
+        /// Multiplying by the reciprocal keeps the division out of the hot loop
+        auto scaleOf = [](float tolerance)
+        {
+            return tolerance == 0.0f ? 0.0 : 1.0 / static_cast<double>(tolerance);
+        };
+        const double positionScale = scaleOf(positionTolerance);
+        const double normalScale = scaleOf(normalTolerance);
+        const double texCoordScale = scaleOf(texCoordTolerance);
+
+        std::vector<std::int64_t> keys(count * detail::WELD_KEY_SIZE);
+        std::vector<std::uint64_t> hashes(count);
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            for(std::size_t i = detail::weldChunkBegin(count, chunk, chunks); i < last; ++i)
+            {
+                const Vertex32F& vertex = soup[i];
+                std::int64_t* key = &keys[i * detail::WELD_KEY_SIZE];
+                key[0] = detail::weldQuantize(vertex.getPosition()[0], positionScale);
+                key[1] = detail::weldQuantize(vertex.getPosition()[1], positionScale);
+                key[2] = detail::weldQuantize(vertex.getPosition()[2], positionScale);
+                key[3] = detail::weldQuantize(vertex.getNormal()[0], normalScale);
+                key[4] = detail::weldQuantize(vertex.getNormal()[1], normalScale);
+                key[5] = detail::weldQuantize(vertex.getNormal()[2], normalScale);
+                key[6] = detail::weldQuantize(vertex.getTexCoord()[0], texCoordScale);
+                key[7] = detail::weldQuantize(vertex.getTexCoord()[1], texCoordScale);
+                hashes[i] = detail::weldHash(key);
+            }
+        });
+
+        std::vector<std::size_t> representatives(count);
+        bool radixSort = strategy == Strategy::RADIX_SORT || (strategy == Strategy::AUTOMATIC && count >= RADIX_SORT_THRESHOLD);
+        if(radixSort)
+        {
+            groupByRadixSort(hashes, keys, representatives);
+        }
+        else
+        {
+            groupByHash(hashes, keys, representatives);
+        }
+
+        /// Number the representatives in order of first occurrence with a chunked prefix sum
+        std::vector<std::size_t> firsts(chunks + 1, 0);
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            for(std::size_t i = detail::weldChunkBegin(count, chunk, chunks); i < last; ++i)
+            {
+                firsts[chunk + 1] += representatives[i] == i;
+            }
+        });
+        for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            firsts[chunk + 1] += firsts[chunk];
+        }
+
+        std::vector<std::size_t> remap(count);
+        vertices.assign(firsts[chunks], soup[0]);
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            std::size_t next = firsts[chunk];
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            for(std::size_t i = detail::weldChunkBegin(count, chunk, chunks); i < last; ++i)
+            {
+                if(representatives[i] == i)
+                {
+                    vertices[next] = soup[i];
+                    remap[i] = next++;
+                }
+            }
+        });
+
+        /// A representative's own entry is never overwritten, so this may run in place
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            for(std::size_t i = detail::weldChunkBegin(count, chunk, chunks); i < last; ++i)
+            {
+                if(representatives[i] != i)
+                {
+                    remap[i] = remap[representatives[i]];
+                }
+            }
+        });
+        return remap;
+    }
+
+    inline Mesh VertexWelder::createMesh(const std::vector<Vertex32F>& soup, const std::vector<Material>& materials, std::size_t materialIndex) const
+    {
+        if(soup.size() % 3 != 0)
+        {
+            throw IllegalArgumentException("A triangle soup must hold a multiple of 3 vertices");
+        }
+        std::vector<Vertex32F> vertices;
+        std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(materialIndex));
+        renderables[0].indices = weld(soup, vertices);
+        return Mesh(vertices, materials, renderables);
+    }
+
+    inline void VertexWelder::groupByHash(const std::vector<std::uint64_t>& hashes, const std::vector<std::int64_t>& keys, std::vector<std::size_t>& representatives)
+    {
+        const std::size_t count = hashes.size();
+        const std::size_t chunks = detail::weldChunkCount(count);
+
+        /// The upper hash bits select the shard and the lower bits the slot, keeping them independent
+        std::size_t shardBits = 0;
+        while((std::size_t(1) << shardBits) < chunks)
+        {
+            ++shardBits;
+        }
+        const std::size_t shards = std::size_t(1) << shardBits;
+        auto shardOf = [&](std::size_t i)
+        {
+            return shardBits == 0 ? 0 : static_cast<std::size_t>(hashes[i] >> (64 - shardBits));
+        };
+
+        /// Stable counting sort of the vertices into their shards, so each shard sees ascending indices
+        std::vector<std::size_t> offsets(chunks * shards, 0);
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            for(std::size_t i = detail::weldChunkBegin(count, chunk, chunks); i < last; ++i)
+            {
+                ++offsets[chunk * shards + shardOf(i)];
+            }
+        });
+        std::vector<std::size_t> shardBegin(shards + 1, 0);
+        for(std::size_t shard = 0, total = 0; shard < shards; ++shard)
+        {
+            shardBegin[shard] = total;
+            for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                std::size_t size = offsets[chunk * shards + shard];
+                offsets[chunk * shards + shard] = total;
+                total += size;
+            }
+        }
+        shardBegin[shards] = count;
+
+        std::vector<std::size_t> order(count);
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            for(std::size_t i = detail::weldChunkBegin(count, chunk, chunks); i < last; ++i)
+            {
+                order[offsets[chunk * shards + shardOf(i)]++] = i;
+            }
+        });
+
+        parallel_for(0, shards, [&](std::size_t shard)
+        {
+            const std::size_t size = shardBegin[shard + 1] - shardBegin[shard];
+            std::size_t capacity = 16;
+            while(capacity < size * 2)
+            {
+                capacity <<= 1;
+            }
+            const std::size_t mask = capacity - 1;
+            std::vector<std::size_t> table(capacity, detail::WELD_EMPTY);
+            for(std::size_t n = shardBegin[shard]; n < shardBegin[shard + 1]; ++n)
+            {
+                const std::size_t i = order[n];
+                std::size_t slot = static_cast<std::size_t>(hashes[i]) & mask;
+                while(true)
+                {
+                    const std::size_t j = table[slot];
+                    if(j == detail::WELD_EMPTY)
+                    {
+                        table[slot] = i;
+                        representatives[i] = i;
+                        break;
+                    }
+                    if(hashes[j] == hashes[i] && detail::weldKeysEqual(keys, i, j))
+                    {
+                        representatives[i] = j;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+            }
+        });
+    }
+
+    inline void VertexWelder::groupByRadixSort(const std::vector<std::uint64_t>& hashes, const std::vector<std::int64_t>& keys, std::vector<std::size_t>& representatives)
+    {
+        const std::size_t count = hashes.size();
+        const std::size_t chunks = detail::weldChunkCount(count);
+        const std::size_t radix = 256;
+
+        std::vector<std::size_t> order(count);
+        std::vector<std::size_t> scratch(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            order[i] = i;
+        }
+
+        /// Sorting on the lower 32 hash bits is enough; collisions are resolved by comparing keys below
+        std::vector<std::size_t> offsets(chunks * radix);
+        for(std::size_t shift = 0; shift < 32; shift += 8)
+        {
+            auto digitOf = [&](std::size_t i)
+            {
+                return static_cast<std::size_t>(hashes[i] >> shift) & (radix - 1);
+            };
+            std::fill(offsets.begin(), offsets.end(), 0);
+            parallel_for(0, chunks, [&](std::size_t chunk)
+            {
+                const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+                for(std::size_t n = detail::weldChunkBegin(count, chunk, chunks); n < last; ++n)
+                {
+                    ++offsets[chunk * radix + digitOf(order[n])];
+                }
+            });
+            for(std::size_t digit = 0, total = 0; digit < radix; ++digit)
+            {
+                for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+                {
+                    std::size_t size = offsets[chunk * radix + digit];
+                    offsets[chunk * radix + digit] = total;
+                    total += size;
+                }
+            }
+            parallel_for(0, chunks, [&](std::size_t chunk)
+            {
+                const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+                for(std::size_t n = detail::weldChunkBegin(count, chunk, chunks); n < last; ++n)
+                {
+                    scratch[offsets[chunk * radix + digitOf(order[n])]++] = order[n];
+                }
+            });
+            order.swap(scratch);
+        }
+
+        /// The sort is stable, so every run of equal hashes lists its vertices in ascending order
+        auto runStartsAt = [&](std::size_t n)
+        {
+            return n == 0 || static_cast<std::uint32_t>(hashes[order[n]]) != static_cast<std::uint32_t>(hashes[order[n - 1]]);
+        };
+        parallel_for(0, chunks, [&](std::size_t chunk)
+        {
+            /// Each chunk owns the runs that start within it
+            std::size_t n = detail::weldChunkBegin(count, chunk, chunks);
+            const std::size_t last = detail::weldChunkBegin(count, chunk + 1, chunks);
+            while(n < last && !runStartsAt(n))
+            {
+                ++n;
+            }
+            std::vector<std::size_t> distinct;
+            while(n < last)
+            {
+                distinct.clear();
+                do
+                {
+                    const std::size_t i = order[n];
+                    representatives[i] = i;
+                    for(std::size_t j : distinct)
+                    {
+                        if(detail::weldKeysEqual(keys, i, j))
+                        {
+                            representatives[i] = j;
+                            break;
+                        }
+                    }
+                    if(representatives[i] == i)
+                    {
+                        distinct.push_back(i);
+                    }
+                    ++n;
+                }
+                while(n < count && !runStartsAt(n));
+            }
+        });
+    }
+
+}
@@ -0,0 +1,79 @@
+#include <string>
+#include <unordered_map>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+inline Sampler::Sampler(GLenum minFilter, GLenum magFilter, GLenum wrap) :
+    handle(0),
+    minFilter(minFilter),
+    magFilter(magFilter),
+    wrap(wrap)
+{
+    glGenSamplers(1, &handle);
+    if(handle == 0)
+    {
+        throw ResourceException("implementation failed to create sampler");
+    }
+    /// Clear any previous error, so that only a rejected parameter is reported
+    glGetError();
+    glSamplerParameteri(handle, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(minFilter));
+    glSamplerParameteri(handle, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(magFilter));
+    glSamplerParameteri(handle, GL_TEXTURE_WRAP_S, static_cast<GLint>(wrap));
+    glSamplerParameteri(handle, GL_TEXTURE_WRAP_T, static_cast<GLint>(wrap));
+    glSamplerParameteri(handle, GL_TEXTURE_WRAP_R, static_cast<GLint>(wrap));
+    if(glGetError() == GL_INVALID_ENUM)
+    {
+        glDeleteSamplers(1, &handle);
+        throw IllegalArgumentException(std::string("Invalid sampler parameters: ") + std::to_string(minFilter) + ", " +
+                std::to_string(magFilter) + ", " + std::to_string(wrap));
+    }
+}
+
+inline Sampler::~Sampler()
+{
+    TextureUnits::getDefault().forgetSampler(handle);
+    /// Call should never fail
+    glDeleteSamplers(1, &handle);
+}
+
+inline GLuint Sampler::getHandle() const noexcept
+{
+    return handle;
+}
+
+inline GLenum Sampler::getMinFilter() const noexcept
+{
+    return minFilter;
+}
+
+inline GLenum Sampler::getMagFilter() const noexcept
+{
+    return magFilter;
+}
+
+inline GLenum Sampler::getWrap() const noexcept
+{
+    return wrap;
+}
+
+inline std::shared_ptr<Sampler> Sampler::acquire(GLenum minFilter, GLenum magFilter, GLenum wrap)
+{
+    /// Every parameter is a 16-bit token
+    static std::unordered_map<std::uint64_t, std::weak_ptr<Sampler>> samplers;
+    const std::uint64_t key = static_cast<std::uint64_t>(minFilter) << 32 | static_cast<std::uint64_t>(magFilter) << 16 | wrap;
+
+    std::weak_ptr<Sampler>& interned = samplers[key];
+    std::shared_ptr<Sampler> sampler = interned.lock();
+    if(!sampler)
+    {
+        sampler = std::make_shared<Sampler>(minFilter, magFilter, wrap);
+        interned = sampler;
+    }
+    return sampler;
+}
+
+}
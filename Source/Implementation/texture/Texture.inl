@@ -0,0 +1,100 @@
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+namespace midnight
+{
+
+inline Texture::Texture(std::size_t width, std::size_t height, const std::vector<unsigned char>& data, std::size_t levels) :
+    handle(0),
+    width(width),
+    height(height)
+{
+    if(width == 0 || height == 0 || levels == 0)
+    {
+        throw IllegalArgumentException("A Texture requires a non-zero size and at least one level");
+    }
+    if(data.size() != width * height * 4)
+    {
+        throw IllegalArgumentException("The data of a Texture must hold width * height RGBA8 texels");
+    }
+
+    glGenTextures(1, &handle);
+    if(handle == 0)
+    {
+        throw ResourceException("implementation failed to create texture");
+    }
+
+    /// Restore the binding of the active unit, which the TextureUnits shadow
+    GLint preserved = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &preserved);
+    glBindTexture(GL_TEXTURE_2D, handle);
+    glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(levels), GL_RGBA8, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+    if(levels > 1)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(preserved));
+
+    if(glGetError() == GL_OUT_OF_MEMORY)
+    {
+        glDeleteTextures(1, &handle);
+        throw ResourceException("Unable to allocate GPU memory for Texture");
+    }
+}
+
+inline Texture::Texture(Texture&& other) noexcept :
+    handle(other.handle),
+    width(other.width),
+    height(other.height)
+{
+    other.handle = 0;
+}
+
+inline Texture& Texture::operator=(Texture&& other) noexcept
+{
+    if(&other != this)
+    {
+        TextureUnits::getDefault().forgetTexture(handle);
+        /// Silently ignores the zero handle of moved-from Textures
+        glDeleteTextures(1, &handle);
+        handle = other.handle;
+        width = other.width;
+        height = other.height;
+        other.handle = 0;
+    }
+    return *this;
+}
+
+inline Texture::~Texture()
+{
+    if(handle != 0)
+    {
+        TextureUnits::getDefault().forgetTexture(handle);
+        /// Call should never fail
+        glDeleteTextures(1, &handle);
+    }
+}
+
+inline void Texture::bind(GLuint unit, const Sampler& sampler) const
+{
+    TextureUnits::getDefault().bind(unit, handle, sampler.getHandle());
+}
+
+inline GLuint Texture::getHandle() const noexcept
+{
+    return handle;
+}
+
+inline std::size_t Texture::getWidth() const noexcept
+{
+    return width;
+}
+
+inline std::size_t Texture::getHeight() const noexcept
+{
+    return height;
+}
+
+}
@@ -0,0 +1,87 @@
+namespace midnight
+{
+
+inline TextureUnits::TextureUnits() :
+    active(GL_NONE)
+{
+
+}
+
+inline void TextureUnits::bind(GLuint unit, GLuint texture, GLuint sampler)
+{
+    if(unit >= units.size())
+    {
+        /// Nothing is known about units that were never bound through here
+        units.resize(unit + 1, Unit{UNKNOWN, UNKNOWN});
+    }
+
+    Unit& bound = units[unit];
+    if(bound.texture != texture)
+    {
+        if(active != GL_TEXTURE0 + unit)
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            active = GL_TEXTURE0 + unit;
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        bound.texture = texture;
+        ++statistics.issued;
+    }
+    else
+    {
+        ++statistics.skipped;
+    }
+
+    /// Sampler binds name their unit, so the active unit does not matter
+    if(bound.sampler != sampler)
+    {
+        glBindSampler(unit, sampler);
+        bound.sampler = sampler;
+        ++statistics.issued;
+    }
+    else
+    {
+        ++statistics.skipped;
+    }
+}
+
+inline void TextureUnits::forgetTexture(GLuint texture) noexcept
+{
+    for(Unit& unit : units)
+    {
+        unit.texture = unit.texture == texture ? UNKNOWN : unit.texture;
+    }
+}
+
+inline void TextureUnits::forgetSampler(GLuint sampler) noexcept
+{
+    for(Unit& unit : units)
+    {
+        unit.sampler = unit.sampler == sampler ? UNKNOWN : unit.sampler;
+    }
+}
+
+inline void TextureUnits::invalidate() noexcept
+{
+    units.clear();
+    active = GL_NONE;
+}
+
+inline const TextureUnits::Statistics& TextureUnits::getStatistics() const noexcept
+{
+    return statistics;
+}
+
+inline void TextureUnits::resetStatistics() noexcept
+{
+    statistics = Statistics();
+}
+
+inline TextureUnits& TextureUnits::getDefault()
+{
+    /// Holds no GL objects itself, so outliving the context is harmless
+    static TextureUnits units;
+    return units;
+}
+
+}
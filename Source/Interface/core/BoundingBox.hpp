@@ -0,0 +1,148 @@
+#ifndef BOUNDING_BOX_HPP
+#    define BOUNDING_BOX_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include "Matrix.hpp"
+#    include "Point.hpp"
+#    include "Vector.hpp"
+
+namespace midnight
+{
+
+/**
+ * An axis-aligned box in three dimensions.  A default-constructed BoundingBox is empty: it
+ * contains nothing, and merging anything into it yields that thing.
+ *
+ * The corners are stored as plain arrays, so BoundingBoxes may be kept densely in large
+ * arrays and copied with memcpy.
+ *
+ */
+template<typename T>
+class BoundingBox
+{
+    T minimum[3];
+    T maximum[3];
+
+  public:
+
+    /**
+     * Constructs an empty BoundingBox
+     *
+     */
+    BoundingBox() noexcept;
+
+    /**
+     * Constructs a BoundingBox from its corners
+     *
+     * @param minimum the corner with the smallest coordinates
+     *
+     * @param maximum the corner with the largest coordinates
+     *
+     */
+    BoundingBox(const Point<T, 3>& minimum, const Point<T, 3>& maximum) noexcept;
+
+    /**
+     * Queries whether this BoundingBox contains nothing
+     *
+     * @return true if the minimum exceeds the maximum on any axis, otherwise false
+     *
+     */
+    bool isEmpty() const noexcept;
+
+    /**
+     * Retrieves a coordinate of the minimum corner
+     *
+     * @param axis the axis (0, 1 or 2)
+     *
+     * @return the smallest coordinate on the axis
+     *
+     */
+    T getMinimum(std::size_t axis) const noexcept;
+
+    /**
+     * Retrieves a coordinate of the maximum corner
+     *
+     * @param axis the axis (0, 1 or 2)
+     *
+     * @return the largest coordinate on the axis
+     *
+     */
+    T getMaximum(std::size_t axis) const noexcept;
+
+    /// The corners of this BoundingBox
+    Point<T, 3> getMinimum() const noexcept;
+    Point<T, 3> getMaximum() const noexcept;
+
+    /**
+     * Retrieves the center of this BoundingBox
+     *
+     * @return the point halfway between the corners
+     *
+     */
+    Point<T, 3> getCenter() const noexcept;
+
+    /**
+     * Retrieves the half-size of this BoundingBox
+     *
+     * @return the distance from the center to the maximum corner on every axis
+     *
+     */
+    Vector<T, 3> getExtents() const noexcept;
+
+    /**
+     * Grows this BoundingBox to enclose the provided one
+     *
+     * @param box the BoundingBox to enclose (which may be empty)
+     *
+     */
+    void merge(const BoundingBox& box) noexcept;
+
+    /**
+     * Grows this BoundingBox to enclose the provided point
+     *
+     * @param point the point to enclose
+     *
+     */
+    void merge(const Point<T, 3>& point) noexcept;
+
+    /**
+     * Queries whether the provided point lies inside (or on) this BoundingBox
+     *
+     * @param point the point to test
+     *
+     * @return true if the point is inside, otherwise false
+     *
+     */
+    bool contains(const Point<T, 3>& point) const noexcept;
+
+    /**
+     * Queries whether this BoundingBox overlaps (or touches) the provided one
+     *
+     * @param box the BoundingBox to test
+     *
+     * @return true if the boxes overlap, otherwise false
+     *
+     */
+    bool intersects(const BoundingBox& box) const noexcept;
+
+    /**
+     * Computes the BoundingBox that encloses this one after a transform.  Points are treated as
+     * row vectors (p * transform), as in the shaders.
+     *
+     * @param transform the affine transform to apply
+     *
+     * @return the enclosing BoundingBox (empty if this one is)
+     *
+     */
+    BoundingBox transform(const Matrix<T, 4, 4>& transform) const noexcept;
+};
+
+typedef BoundingBox<float> BoundingBoxF;
+typedef BoundingBox<double> BoundingBoxD;
+
+}
+
+#    include "BoundingBox.inl"
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef BUDDY_ALLOCATOR_HPP
+#    define BUDDY_ALLOCATOR_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include <cstdint>
+#    include <set>
+#    include <vector>
+
+namespace midnight
+{
+
+/**
+ * A binary buddy allocator that hands out ranges of an abstract address space.  No memory is
+ * owned by this class -- offsets are intended to index into a resource owned elsewhere (such
+ * as a GPU buffer).
+ *
+ * Blocks are powers of two multiples of the minimum block size.  Allocations are rounded up to
+ * the nearest block, and released blocks are eagerly merged with their buddies.  Among the free
+ * blocks of a size, the lowest address is always handed out first, which keeps live data packed
+ * towards the start of the address space.
+ *
+ */
+class BuddyAllocator
+{
+    /// The size of the smallest block that may be handed out
+    std::size_t minimumBlock;
+
+    /// The highest block order (the whole address space)
+    std::size_t maximumOrder;
+
+    /// The free blocks of every order, ordered by address
+    std::vector<std::set<std::size_t>> freeBlocks;
+
+    /// The order of the allocated block starting at each minimum block (or UNALLOCATED)
+    std::vector<std::uint8_t> allocatedOrders;
+
+    /// The sum of the sizes of all allocated blocks
+    std::size_t allocatedSize;
+
+    /// The number of allocated blocks
+    std::size_t allocationCount;
+
+  public:
+
+    /**
+     * Constructs a BuddyAllocator
+     *
+     * @param capacity the size of the address space (a power of two)
+     *
+     * @param minimumBlock the size of the smallest block (a power of two no larger than capacity)
+     *
+     * @throws IllegalArgumentException if either size is not a power of two, or the minimum
+     * block exceeds the capacity
+     *
+     */
+    BuddyAllocator(std::size_t capacity, std::size_t minimumBlock);
+
+    /**
+     * Allocates a block that holds at least the provided size
+     *
+     * @param size the requested size
+     *
+     * @return the offset of the allocated block
+     *
+     * @throws IllegalArgumentException if the requested size is zero
+     *
+     * @throws ResourceException if no free block is large enough
+     *
+     */
+    std::size_t allocate(std::size_t size);
+
+    /**
+     * Releases the block at the provided offset
+     *
+     * @param offset the offset that was returned by allocate
+     *
+     * @throws IllegalArgumentException if no block is allocated at the provided offset
+     *
+     */
+    void release(std::size_t offset);
+
+    /**
+     * Queries whether a block that holds the provided size is currently available
+     *
+     * @param size the requested size
+     *
+     * @return true if a call to allocate with the provided size would succeed, otherwise false
+     *
+     */
+    bool canAllocate(std::size_t size) const noexcept;
+
+    /**
+     * Rounds the provided size up to the size of the block that would be allocated for it
+     *
+     * @param size the requested size
+     *
+     * @return the block size
+     *
+     */
+    std::size_t getBlockSize(std::size_t size) const noexcept;
+
+    /**
+     * Retrieves the size of the address space
+     *
+     * @return the size of the address space
+     *
+     */
+    std::size_t getCapacity() const noexcept;
+
+    /**
+     * Retrieves the sum of the sizes of all allocated blocks
+     *
+     * @return the allocated size, including the internal fragmentation caused by rounding
+     *
+     */
+    std::size_t getAllocatedSize() const noexcept;
+
+    /**
+     * Retrieves the number of allocated blocks
+     *
+     * @return the number of allocated blocks
+     *
+     */
+    std::size_t getAllocationCount() const noexcept;
+
+    /**
+     * Retrieves the size of the largest free block
+     *
+     * @return the size of the largest free block (zero if the address space is exhausted)
+     *
+     */
+    std::size_t getLargestFreeBlock() const noexcept;
+
+  private:
+
+    /**
+     * Retrieves the order of the smallest block that holds the provided size
+     *
+     */
+    std::size_t orderOf(std::size_t size) const noexcept;
+};
+
+}
+
+#    include "BuddyAllocator.inl"
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef FRUSTUM_HPP
+#    define FRUSTUM_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include <cstddef>
+#    include <cstdint>
+
+#    include "BoundingBox.hpp"
+#    include "Matrix.hpp"
+
+/// SSE is part of every x86-64 target, so the plane tests only fall back to scalar code elsewhere
+#    if defined(__SSE__) || defined(_M_X64)
+#        define MIDNIGHT_FRUSTUM_SSE
+#        include <xmmintrin.h>
+#    endif
+
+namespace midnight
+{
+
+/**
+ * The number of scene graph nodes that were drawn and culled during a traversal
+ *
+ */
+struct CullingStatistics
+{
+    std::size_t drawn;
+
+    /// Outside of the view volume
+    std::size_t culled;
+
+    /// Inside of the view volume, but hidden behind occluders
+    std::size_t occluded;
+};
+
+/**
+ * The six clipping planes of a view volume, used to cull BoundingBoxes that lie outside of it.
+ *
+ * The planes are kept as a structure of arrays so that a box is tested against four planes at
+ * once.  Tests take a plane mask: a box that lies entirely inside a plane clears its bit, so the
+ * descendants of a node, which lie within its bounds, skip the planes it was already inside of.
+ *
+ */
+class Frustum
+{
+    /// a * x + b * y + c * z + d >= 0 inside each plane, padded to eight with planes that
+    /// contain everything
+    alignas(16) float a[8];
+    alignas(16) float b[8];
+    alignas(16) float c[8];
+    alignas(16) float d[8];
+
+  public:
+
+    /// The mask that tests every plane
+    static constexpr std::uint32_t ALL_PLANES = 0x3F;
+
+    /**
+     * Constructs a Frustum that contains everything
+     *
+     */
+    Frustum() noexcept;
+
+    /**
+     * Constructs the Frustum of a clip transform.  Points are treated as row vectors
+     * (p * clip), as in the shaders, so a model-view-projection yields the planes in model space.
+     *
+     * @param clip the transform into clip space
+     *
+     */
+    explicit Frustum(const Matrix4x4F& clip) noexcept;
+
+    /**
+     * Tests a BoundingBox against the planes of the provided mask
+     *
+     * @param box the BoundingBox to test
+     *
+     * @param mask the planes to test against, from which the planes that the box lies entirely
+     * inside of are removed
+     *
+     * @return false if the box is empty or lies entirely outside of a plane, otherwise true
+     *
+     */
+    bool intersects(const BoundingBoxF& box, std::uint32_t& mask) const noexcept;
+
+    /**
+     * Tests a BoundingBox against every plane
+     *
+     * @param box the BoundingBox to test
+     *
+     * @return false if the box is empty or lies entirely outside of a plane, otherwise true
+     *
+     */
+    bool intersects(const BoundingBoxF& box) const noexcept;
+};
+
+}
+
+#    include "Frustum.inl"
+
+#endif
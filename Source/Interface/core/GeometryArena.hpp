@@ -0,0 +1,359 @@
+#ifndef GEOMETRY_ARENA_HPP
+#    define GEOMETRY_ARENA_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <map>
+#    include <vector>
+
+#    include "BuddyAllocator.hpp"
+#    include "Vertex.hpp"
+
+namespace midnight
+{
+
+/**
+ * A pair of large, shared GPU buffers (vertices and indices) out of which the geometry of many
+ * meshes is sub-allocated.  Indices are stored relative to the first vertex of their mesh and
+ * drawn with glDrawElementsBaseVertex, so a single vertex array object serves every mesh in
+ * the arena.
+ *
+ * Vertices are stored interleaved as 8 floats (position, normal, texture coordinate) and bound
+ * to the attributes named "position", "normal" and "uv_in" of the current program; attributes
+ * that the program does not declare are skipped.  Indices are stored as GLuint.
+ *
+ * Several meshes may share one range of vertices, such as the parts of a model that differ
+ * only in their material; the vertices are then stored once, and released with the last of
+ * those meshes.
+ *
+ * Released ranges are coalesced by the underlying BuddyAllocators.  When an allocation does not
+ * fit although enough space is free, the arena is compacted with glCopyBufferSubData.  Handles
+ * remain valid across compaction, but their Ranges move.
+ *
+ * @note Requires OpenGL 3.2 (or ARB_draw_elements_base_vertex and ARB_copy_buffer)
+ *
+ */
+class GeometryArena
+{
+  public:
+
+    /// Identifies a mesh within a GeometryArena
+    typedef std::size_t Handle;
+
+    /**
+     * The current location of a mesh within the arena
+     *
+     */
+    struct Range
+    {
+        /// The offset of the first vertex of the mesh (in vertices)
+        GLint baseVertex;
+
+        /// The number of vertices of the mesh
+        std::size_t vertexCount;
+
+        /// The offset of the first index of the mesh (in indices)
+        std::size_t firstIndex;
+
+        /// The number of indices of the mesh
+        GLsizei indexCount;
+    };
+
+    /**
+     * A snapshot of the occupancy of a GeometryArena
+     *
+     */
+    struct Statistics
+    {
+        /// The number of vertices the arena can hold
+        std::size_t vertexCapacity;
+
+        /// The number of vertices reserved by live allocations (including rounding)
+        std::size_t verticesReserved;
+
+        /// The number of vertices actually stored
+        std::size_t verticesStored;
+
+        /// The number of vertices in the largest free range
+        std::size_t largestFreeVertexRange;
+
+        /// The number of indices the arena can hold
+        std::size_t indexCapacity;
+
+        /// The number of indices reserved by live allocations (including rounding)
+        std::size_t indicesReserved;
+
+        /// The number of indices actually stored
+        std::size_t indicesStored;
+
+        /// The number of indices in the largest free range
+        std::size_t largestFreeIndexRange;
+
+        /// The number of live allocations
+        std::size_t allocations;
+
+        /// The number of times the arena was compacted
+        std::size_t defragmentations;
+
+        /// The number of bytes copied on the GPU by compaction
+        std::size_t bytesCopied;
+
+        /**
+         * Retrieves the fraction of the vertex storage that holds live vertices
+         *
+         * @return the vertex occupancy in [0, 1]
+         *
+         */
+        double getVertexOccupancy() const noexcept
+        {
+            return vertexCapacity == 0 ? 0.0 : static_cast<double>(verticesStored) / static_cast<double>(vertexCapacity);
+        }
+
+        /**
+         * Retrieves the fraction of the index storage that holds live indices
+         *
+         * @return the index occupancy in [0, 1]
+         *
+         */
+        double getIndexOccupancy() const noexcept
+        {
+            return indexCapacity == 0 ? 0.0 : static_cast<double>(indicesStored) / static_cast<double>(indexCapacity);
+        }
+    };
+
+    /// The number of floats stored per vertex
+    static constexpr std::size_t VERTEX_COMPONENTS = 8;
+
+  private:
+
+    /**
+     * The bookkeeping of a single mesh
+     *
+     */
+    struct Allocation
+    {
+        Range range;
+        bool live;
+    };
+
+    /**
+     * The bookkeeping of a range of vertices, which may be shared by several meshes
+     *
+     */
+    struct VertexBlock
+    {
+        std::size_t vertexCount;
+
+        /// The number of live meshes that use the vertices
+        std::size_t references;
+    };
+
+    /// The implementation provided handle to the vertex storage
+    GLuint vertexBuffer;
+
+    /// The implementation provided handle to the index storage
+    GLuint indexBuffer;
+
+    /// Distributes the vertex storage
+    BuddyAllocator vertexAllocator;
+
+    /// Distributes the index storage
+    BuddyAllocator indexAllocator;
+
+    /// The meshes of this arena, indexed by Handle
+    std::vector<Allocation> allocations;
+
+    /// Handles of released meshes that may be reused
+    std::vector<Handle> releasedHandles;
+
+    /// The ranges of vertices of the live meshes, keyed by their first vertex
+    std::map<std::size_t, VertexBlock> vertexBlocks;
+
+    /// One vertex array object per program (keyed by program handle), created on first bind and
+    /// deleted along with the program (see forgetProgram)
+    std::map<GLint, GLuint> vertexArrays;
+
+    /// The number of times this arena was compacted
+    std::size_t defragmentations;
+
+    /// The number of bytes copied by compaction
+    std::size_t bytesCopied;
+
+  public:
+
+    /**
+     * Constructs a GeometryArena
+     *
+     * @param vertexCapacity the number of vertices to reserve (rounded up to a power of two)
+     *
+     * @param indexCapacity the number of indices to reserve (rounded up to a power of two)
+     *
+     * @throws ResourceException if the implementation fails to allocate the storage
+     *
+     */
+    GeometryArena(std::size_t vertexCapacity, std::size_t indexCapacity);
+
+    /**
+     * GeometryArenas are not copy-constructible
+     *
+     */
+    GeometryArena(const GeometryArena&) = delete;
+
+    /**
+     * GeometryArenas are not copy-assignable
+     *
+     */
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    /**
+     * Cleans up the GPU resources that were allocated by this GeometryArena
+     *
+     */
+    ~GeometryArena();
+
+    /**
+     * Uploads a mesh into this arena
+     *
+     * @param vertices the vertices of the mesh
+     *
+     * @param indices the triangle list of the mesh, relative to its first vertex
+     *
+     * @return a handle to the uploaded mesh
+     *
+     * @throws IllegalArgumentException if the mesh is empty, or an index is out of range
+     *
+     * @throws ResourceException if the arena cannot hold the mesh even after compaction
+     *
+     */
+    Handle allocate(const std::vector<Vertex32F>& vertices, const std::vector<std::size_t>& indices);
+
+    /**
+     * Uploads several meshes that share their vertices into this arena, storing the vertices
+     * once
+     *
+     * @param vertices the vertices shared by the meshes
+     *
+     * @param indices the triangle list of every mesh, relative to the first vertex
+     *
+     * @return a handle to every uploaded mesh, in the order of the triangle lists
+     *
+     * @throws IllegalArgumentException if there are no triangle lists, the vertices or a
+     * triangle list is empty, or an index is out of range
+     *
+     * @throws ResourceException if the arena cannot hold the meshes even after compaction
+     *
+     */
+    std::vector<Handle> allocate(const std::vector<Vertex32F>& vertices, const std::vector<std::vector<std::size_t>>& indices);
+
+    /**
+     * Releases the storage of a mesh, and that of its vertices unless another mesh shares them
+     *
+     * @param handle the mesh to release
+     *
+     * @throws IllegalArgumentException if the handle does not refer to a live mesh
+     *
+     */
+    void release(Handle handle);
+
+    /**
+     * Retrieves the current location of a mesh
+     *
+     * @param handle the mesh to locate
+     *
+     * @return the current Range of the mesh
+     *
+     * @throws IllegalArgumentException if the handle does not refer to a live mesh
+     *
+     */
+    const Range& getRange(Handle handle) const;
+
+    /**
+     * Binds the vertex array object of this arena for the current program
+     *
+     * @throws BindException if there is currently no program bound to the implementation
+     *
+     */
+    void bind();
+
+    /**
+     * Unbinds the vertex array object of this arena
+     *
+     */
+    void unbind() noexcept;
+
+    /**
+     * Draws a mesh of this arena (which must be bound)
+     *
+     * @param handle the mesh to draw
+     *
+     */
+    void draw(Handle handle) const;
+
+    /**
+     * Draws part of the indices of a mesh of this arena (which must be bound), e.g. one level of
+     * detail out of several stored one after the other
+     *
+     * @param handle the mesh to draw
+     *
+     * @param firstIndex the offset of the first index to draw, relative to those of the mesh
+     *
+     * @param indexCount the number of indices to draw
+     *
+     */
+    void draw(Handle handle, std::size_t firstIndex, GLsizei indexCount) const;
+
+    /**
+     * Compacts the live meshes to the start of the storage, merging the free space into as few
+     * ranges as possible.  The storage is copied into freshly allocated buffers, so this
+     * temporarily requires twice the memory of the arena.
+     *
+     * @throws ResourceException if the implementation fails to allocate the new storage
+     *
+     */
+    void defragment();
+
+    /**
+     * Retrieves a snapshot of the occupancy of this arena
+     *
+     * @return the current Statistics
+     *
+     */
+    Statistics getStatistics() const noexcept;
+
+    /**
+     * Deletes the vertex array objects that every GeometryArena created for a deleted program,
+     * whose name the implementation may give to the next program.  Programs call this as they
+     * are deleted.
+     *
+     * @param program the implementation provided handle to the deleted program
+     *
+     */
+    static void forgetProgram(GLuint program) noexcept;
+
+  private:
+
+    /**
+     * Retrieves every constructed GeometryArena of the current context
+     *
+     */
+    static std::vector<GeometryArena*>& getArenas();
+
+    /**
+     * Creates a buffer with uninitialized storage of the provided size
+     *
+     */
+    static GLuint createBuffer(std::size_t bytes);
+
+    /**
+     * Deletes every cached vertex array object
+     *
+     */
+    void clearVertexArrays() noexcept;
+};
+
+}
+
+#    include "GeometryArena.inl"
+
+#endif
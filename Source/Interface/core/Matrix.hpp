@@ -62,6 +62,19 @@ bool operator!=(const midnight::Matrix<T, Rows, Columns>& lhs, const midnight::M
 template<typename T, std::size_t Rows, std::size_t Columns>
 midnight::Matrix<T, Rows, Columns> operator-(const midnight::Matrix<T, Rows, Columns>& source) noexcept;
 
+/**
+ * Multiplies the two provided matrices
+ * 
+ * @param lhs the left-hand side of the product
+ * 
+ * @param rhs the right-hand side of the product
+ * 
+ * @return the matrix product lhs * rhs
+ * 
+ */
+template<typename T, std::size_t Rows, std::size_t Inner, std::size_t Columns>
+midnight::Matrix<T, Rows, Columns> operator*(const midnight::Matrix<T, Rows, Inner>& lhs, const midnight::Matrix<T, Inner, Columns>& rhs) noexcept;
+
 /**
  * Inserts the provided Matrix into the provided output stream
  * 
@@ -0,0 +1,200 @@
+#ifndef OCCLUSION_BUFFER_HPP
+#    define OCCLUSION_BUFFER_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include <cstddef>
+#    include <cstdint>
+#    include <vector>
+
+#    include "BoundingBox.hpp"
+#    include "Matrix.hpp"
+#    include "Point.hpp"
+
+/// Rows are rasterized eight pixels at a time with AVX2, four at a time with SSE, and one at a
+/// time elsewhere
+#    if defined(__AVX2__)
+#        define MIDNIGHT_OCCLUSION_AVX2
+#        include <immintrin.h>
+#    elif defined(__SSE__) || defined(_M_X64)
+#        define MIDNIGHT_OCCLUSION_SSE
+#        include <xmmintrin.h>
+#    endif
+
+namespace midnight
+{
+
+/**
+ * A low resolution depth buffer that occluders are rasterized into on the CPU, so that objects
+ * hidden behind them are culled before any draw is issued.
+ *
+ * Each frame, the buffer is cleared, the triangles of the occluders are added through
+ * addOccluder() and rasterized by rasterize(), after which isVisible() tests the bounds of the
+ * objects to draw.  Rasterization splits the buffer into rows of tiles, which are spread across
+ * worker threads, and each row of pixels is rasterized several pixels at a time.  Alongside the
+ * pixels, the buffer keeps the nearest and farthest depth of each tile, so that most tests are
+ * answered without touching a single pixel.
+ *
+ * The buffer stores the reciprocal of the clip space w rather than the projected depth, which
+ * interpolates linearly across the screen and keeps its precision at a distance (larger is
+ * nearer).  As on the GPU, a triangle covers the pixels whose centers it contains; each takes
+ * the farthest depth of the triangle within the pixel, so an occluder is never nearer in the
+ * buffer than it is on the screen.  The coverage of the low resolution is approximate along the
+ * silhouettes of occluders, which should therefore be chosen among large, solid geometry.
+ *
+ * Transforms follow the row-vector convention of the shaders (p * clip).
+ *
+ */
+class OcclusionBuffer
+{
+  public:
+
+    /// The dimensions of the tiles that keep the depth bounds of their pixels
+    static constexpr std::size_t TILE_WIDTH = 8;
+    static constexpr std::size_t TILE_HEIGHT = 8;
+
+  private:
+
+    /**
+     * A triangle in screen space, set up for rasterization
+     *
+     */
+    struct Triangle
+    {
+        /// a * x + b * y + c >= 0 inside of each edge
+        float a[3];
+        float b[3];
+        float c[3];
+
+        /// The farthest depth within the pixel centered at (x, y) is
+        /// depthX * x + depthY * y + depth
+        float depthX;
+        float depthY;
+        float depth;
+
+        /// The pixels that may be covered, as [minimum, maximum)
+        std::uint32_t minimumX;
+        std::uint32_t maximumX;
+        std::uint32_t minimumY;
+        std::uint32_t maximumY;
+    };
+
+    std::size_t width;
+    std::size_t height;
+
+    /// The depth of each pixel, row by row from the bottom of the screen
+    std::vector<float> depths;
+
+    /// The farthest and nearest depth within each tile
+    std::vector<float> tileMinimums;
+    std::vector<float> tileMaximums;
+
+    std::vector<Triangle> triangles;
+
+    /// The triangles that overlap each row of tiles
+    std::vector<std::vector<std::uint32_t>> bins;
+
+    /// Scratch storage for the clip space x, y, z and w of an occluder's vertices
+    std::vector<float> clipVertices;
+
+  public:
+
+    /**
+     * Constructs an empty OcclusionBuffer
+     *
+     * @param width the width of the buffer in pixels, a multiple of TILE_WIDTH
+     *
+     * @param height the height of the buffer in pixels, a multiple of TILE_HEIGHT
+     *
+     * @throws IllegalArgumentException if either dimension is zero or not a multiple of the tiles
+     *
+     */
+    explicit OcclusionBuffer(std::size_t width = 256, std::size_t height = 128);
+
+    /**
+     * Removes every occluder, leaving nothing hidden
+     *
+     */
+    void clear() noexcept;
+
+    /**
+     * Adds the triangles of an occluder to the next rasterize().  Triangles are clipped against
+     * the near plane, so an occluder may pass behind the viewer.
+     *
+     * @param positions the positions of the occluder's vertices
+     *
+     * @param indices three indices into the positions for each triangle
+     *
+     * @param clip the transform from the occluder's space into clip space
+     *
+     * @throws IllegalArgumentException if an index is out of range
+     *
+     */
+    void addOccluder(const std::vector<Point3F>& positions, const std::vector<std::uint32_t>& indices, const Matrix4x4F& clip);
+
+    /**
+     * Rasterizes the occluders added since the last clear() into the buffer
+     *
+     */
+    void rasterize();
+
+    /**
+     * Tests whether a BoundingBox may be visible past the rasterized occluders
+     *
+     * @param box the BoundingBox to test
+     *
+     * @param clip the transform from the box's space into clip space
+     *
+     * @return false if every pixel the box covers is nearer than the box, otherwise true
+     *
+     */
+    bool isVisible(const BoundingBoxF& box, const Matrix4x4F& clip) const noexcept;
+
+    /**
+     * Retrieves the depth of a pixel as of the last rasterize()
+     *
+     * @param x the column of the pixel, from the left
+     *
+     * @param y the row of the pixel, from the bottom
+     *
+     * @return the reciprocal of the clip space w of the nearest occluder, or zero if none
+     *
+     */
+    float getDepth(std::size_t x, std::size_t y) const noexcept;
+
+    /// The dimensions of the buffer, in pixels
+    std::size_t getWidth() const noexcept;
+    std::size_t getHeight() const noexcept;
+
+    /**
+     * Retrieves the number of triangles added since the last clear(), after clipping
+     *
+     * @return the number of triangles
+     *
+     */
+    std::size_t getTriangleCount() const noexcept;
+
+  private:
+
+    /**
+     * Sets up and bins a triangle whose vertices lie in front of the near plane
+     *
+     * @param vertices the clip space x, y and w of each vertex
+     *
+     */
+    void addTriangle(const float (&vertices)[3][3]);
+
+    /**
+     * Rasterizes the triangles of a row of tiles, and refreshes the depth bounds of its tiles
+     *
+     * @param band the row of tiles, from the bottom
+     *
+     */
+    void rasterizeBand(std::size_t band) noexcept;
+};
+
+}
+
+#    include "OcclusionBuffer.inl"
+
+#endif
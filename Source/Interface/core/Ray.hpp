@@ -0,0 +1,106 @@
+#ifndef RAY_HPP
+#    define RAY_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include <limits>
+
+#    include "BoundingBox.hpp"
+#    include "Point.hpp"
+#    include "Vector.hpp"
+
+namespace midnight
+{
+
+/**
+ * A half-line in three dimensions, from an origin along a direction.
+ *
+ * Distances along a Ray are measured in multiples of its direction, which need not be of unit
+ * length.  The reciprocal of the direction is kept, so that box tests need no divisions.
+ *
+ */
+class Ray
+{
+    Point3F origin;
+    Vector3F direction;
+    float inverse[3];
+
+  public:
+
+    /**
+     * Constructs a Ray
+     *
+     * @param origin the point the Ray starts from
+     *
+     * @param direction the direction of the Ray (not the zero vector)
+     *
+     */
+    Ray(const Point3F& origin, const Vector3F& direction) noexcept;
+
+    /**
+     * Retrieves the point the Ray starts from
+     *
+     * @return the origin
+     *
+     */
+    const Point3F& getOrigin() const noexcept;
+
+    /**
+     * Retrieves the direction of the Ray
+     *
+     * @return the direction
+     *
+     */
+    const Vector3F& getDirection() const noexcept;
+
+    /**
+     * Computes the point at a distance along the Ray
+     *
+     * @param distance the distance, in multiples of the direction
+     *
+     * @return origin + direction * distance
+     *
+     */
+    Point3F getPoint(float distance) const noexcept;
+
+    /**
+     * Finds where the Ray enters a BoundingBox (the slab test)
+     *
+     * @param box the BoundingBox to test
+     *
+     * @param distance receives the distance at which the Ray enters the box, or zero if the
+     * origin lies inside of it
+     *
+     * @param maximum the distance beyond which hits are ignored
+     *
+     * @return true if the Ray enters the box no further than the maximum, otherwise false
+     *
+     */
+    bool intersects(const BoundingBoxF& box, float& distance,
+            float maximum = std::numeric_limits<float>::infinity()) const noexcept;
+
+    /**
+     * Finds where the Ray crosses a triangle, from either side (Moller-Trumbore)
+     *
+     * @param a the first corner of the triangle
+     *
+     * @param b the second corner of the triangle
+     *
+     * @param c the third corner of the triangle
+     *
+     * @param distance receives the distance at which the Ray crosses the triangle
+     *
+     * @param maximum the distance beyond which hits are ignored
+     *
+     * @return true if the Ray crosses the triangle no further than the maximum, otherwise false
+     *
+     */
+    bool intersects(const Point3F& a, const Point3F& b, const Point3F& c, float& distance,
+            float maximum = std::numeric_limits<float>::infinity()) const noexcept;
+};
+
+}
+
+#    include "Ray.inl"
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef UNIFORM_RING_HPP
+#    define UNIFORM_RING_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <vector>
+
+namespace midnight
+{
+
+/**
+ * A persistently mapped uniform buffer that is carved up, frame after frame, into the blocks of
+ * many draws.  Each block is written straight into the mapping and selected with a single
+ * glBindBufferRange, so a draw costs one bind instead of a series of glUniform calls.
+ *
+ * The buffer is split into one segment per frame in flight.  A segment is fenced when its frame
+ * ends, and only rewritten once that fence has signaled, so the GPU never reads a block that is
+ * being overwritten.
+ *
+ * @note Requires OpenGL 4.4 (or ARB_buffer_storage)
+ *
+ */
+class UniformRing
+{
+    /// The implementation provided handle to the buffer
+    GLuint buffer;
+
+    /// The persistent mapping of the buffer
+    unsigned char* mapping;
+
+    /// The number of bytes available to a single frame
+    std::size_t segmentSize;
+
+    /// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    std::size_t alignment;
+
+    /// The segment of the current frame, and the next free byte within it
+    std::size_t segment;
+    std::size_t head;
+
+    /// Guards the frame that last wrote each segment (zero if none is in flight)
+    std::vector<GLsync> fences;
+
+  public:
+
+    /**
+     * Constructs a UniformRing
+     *
+     * @param frameCapacity the number of bytes that may be written in one frame
+     *
+     * @param framesInFlight the number of frames the GPU may lag behind
+     *
+     * @throws IllegalArgumentException if either argument is zero
+     *
+     * @throws ResourceException if the implementation fails to allocate the buffer
+     *
+     */
+    explicit UniformRing(std::size_t frameCapacity = 1 << 20, std::size_t framesInFlight = 3);
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    ~UniformRing();
+
+    /**
+     * Starts writing the next segment, waiting for the GPU to release it if necessary
+     *
+     */
+    void beginFrame();
+
+    /**
+     * Fences the segment of the current frame
+     *
+     */
+    void endFrame();
+
+    /**
+     * Copies a block into the current segment and binds it to an indexed uniform buffer binding
+     *
+     * @param binding the uniform buffer binding point
+     *
+     * @param block the block to copy (a standard-layout struct that mirrors the GLSL block)
+     *
+     * @throws ResourceException if the current frame has exhausted its capacity
+     *
+     */
+    template<typename T>
+    void bind(GLuint binding, const T& block);
+
+    /**
+     * Copies a block into the current segment without binding it, so that it may be bound by a
+     * later draw of the same frame
+     *
+     * @param block the block to copy (a standard-layout struct that mirrors the GLSL block)
+     *
+     * @return the offset of the block within the buffer
+     *
+     * @throws ResourceException if the current frame has exhausted its capacity
+     *
+     */
+    template<typename T>
+    std::size_t write(const T& block);
+
+    /**
+     * Binds a block written during the current frame to an indexed uniform buffer binding
+     *
+     * @param binding the uniform buffer binding point
+     *
+     * @param offset the offset returned by write()
+     *
+     * @param size the size of the block
+     *
+     */
+    void bind(GLuint binding, std::size_t offset, std::size_t size) noexcept;
+
+    /**
+     * Retrieves the number of bytes written during the current frame
+     *
+     * @return the number of bytes written, including alignment padding
+     *
+     */
+    std::size_t getFrameUsage() const noexcept;
+
+  private:
+
+    /**
+     * Reserves aligned space in the current segment
+     *
+     * @return the offset of the space within the buffer
+     *
+     */
+    std::size_t allocate(std::size_t size);
+};
+
+}
+
+#    include "UniformRing.inl"
+
+#endif
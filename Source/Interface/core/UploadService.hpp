@@ -0,0 +1,343 @@
+#ifndef UPLOAD_SERVICE_HPP
+#    define UPLOAD_SERVICE_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <atomic>
+#    include <condition_variable>
+#    include <deque>
+#    include <functional>
+#    include <memory>
+#    include <mutex>
+#    include <string>
+#    include <thread>
+#    include <vector>
+
+namespace midnight
+{
+
+/**
+ * Moves the upload of buffer and texture data off the critical path of the render thread.
+ *
+ * Data is produced (loaded, decoded, generated...) on a worker thread, which then copies it in
+ * chunks into a persistently mapped staging ring.  Once per frame the render thread calls pump(),
+ * which issues the GPU-side copies (glCopyBufferSubData for buffers, glTexSubImage2D from the
+ * ring bound as a pixel unpack buffer for textures) for at most 'frameBudget' bytes and fences
+ * them.  Ring space is recycled as the fences signal, and a Resource becomes resident once all
+ * of its chunks have landed.
+ *
+ * No GL call is ever made on the worker thread, so no shared context is required.
+ *
+ * @note Requires OpenGL 4.4 (or ARB_buffer_storage) for the persistently mapped ring, and
+ * OpenGL 4.2 (or ARB_texture_storage) for textures
+ *
+ */
+class UploadService
+{
+  public:
+
+    /**
+     * Produces the bytes to upload.  Invoked on the worker thread.
+     *
+     */
+    typedef std::function<std::vector<unsigned char>()> Producer;
+
+    /**
+     * A buffer or texture that is being uploaded by an UploadService.  The GL object is owned by
+     * this Resource and is deleted along with it, so the last reference must be released on the
+     * render thread.
+     *
+     */
+    class Resource
+    {
+        friend class UploadService;
+
+      public:
+
+        enum class State
+        {
+            /// Data is still being produced or copied
+            PENDING,
+
+            /// The GL object holds all of its data and may be drawn with
+            RESIDENT,
+
+            /// The Producer threw, or produced data that does not fit the Resource
+            FAILED
+        };
+
+      private:
+
+        /// GL_ARRAY_BUFFER style buffer targets, or GL_TEXTURE_2D
+        GLenum target;
+
+        /// The implementation provided handle (zero until the first chunk is copied)
+        GLuint name;
+
+        /// The dimensions of a texture Resource
+        std::size_t width;
+        std::size_t height;
+
+        /// The number of bytes produced for this Resource
+        std::size_t size;
+
+        /// The number of bytes that have not yet landed on the GPU
+        std::size_t remaining;
+
+        std::atomic<State> state;
+
+        /// Why the upload failed, written before the FAILED state is published
+        std::string error;
+
+        Resource(GLenum target, std::size_t width, std::size_t height);
+
+      public:
+
+        Resource(const Resource&) = delete;
+        Resource& operator=(const Resource&) = delete;
+
+        ~Resource();
+
+        /**
+         * Retrieves the state of this Resource
+         *
+         * @return the current State
+         *
+         */
+        State getState() const noexcept;
+
+        /**
+         * Queries whether this Resource may be drawn with
+         *
+         * @return true if all data has landed on the GPU, otherwise false
+         *
+         */
+        bool isResident() const noexcept;
+
+        /**
+         * Retrieves the implementation provided handle of this Resource
+         *
+         * @return the GL buffer or texture name, which is only meaningful once resident
+         *
+         */
+        GLuint getName() const noexcept;
+
+        /**
+         * Retrieves the reason this Resource failed to upload
+         *
+         * @return the error message (empty unless the State is FAILED)
+         *
+         */
+        std::string getError() const;
+    };
+
+    /**
+     * The work performed by the most recent pump
+     *
+     */
+    struct Statistics
+    {
+        /// The number of bytes whose copies were issued
+        std::size_t bytesIssued;
+
+        /// The number of chunks whose copies were issued
+        std::size_t chunksIssued;
+
+        /// The number of Resources that became resident
+        std::size_t resourcesCompleted;
+
+        /// The number of Resources that are not yet resident (nor failed)
+        std::size_t resourcesPending;
+
+        Statistics() : bytesIssued(0), chunksIssued(0), resourcesCompleted(0), resourcesPending(0)
+        {
+
+        }
+    };
+
+  private:
+
+    /**
+     * A contiguous piece of a Resource that resides in the staging ring
+     *
+     */
+    struct Chunk
+    {
+        std::shared_ptr<Resource> resource;
+
+        /// The offset of the data within the ring
+        std::size_t ringOffset;
+
+        /// The number of ring bytes held (including padding skipped at the end of the ring)
+        std::size_t reserved;
+
+        /// The offset of the data within the Resource (in bytes)
+        std::size_t targetOffset;
+
+        /// The number of bytes of data
+        std::size_t size;
+    };
+
+    /**
+     * A request waiting for the worker thread
+     *
+     */
+    struct Job
+    {
+        std::shared_ptr<Resource> resource;
+        Producer producer;
+    };
+
+    /**
+     * The chunks whose copies were issued in one pump, along with the fence that guards them
+     *
+     */
+    struct Flight
+    {
+        GLsync fence;
+        std::vector<Chunk> chunks;
+    };
+
+    /// The implementation provided handle to the staging ring
+    GLuint ring;
+
+    /// The persistent mapping of the staging ring
+    unsigned char* mapping;
+
+    std::size_t ringCapacity;
+    std::size_t frameBudget;
+
+    /// The largest number of bytes staged at once
+    std::size_t chunkSize;
+
+    /// The ring is managed FIFO: allocated at 'ringHead', released at 'ringTail'
+    std::size_t ringHead;
+    std::size_t ringTail;
+    std::size_t ringUsed;
+
+    /// Guards everything the worker thread shares with the render thread
+    std::mutex lock;
+    std::condition_variable wakeWorker;
+
+    std::deque<Job> jobs;
+    std::deque<Chunk> staged;
+    bool stopping;
+
+    /// Render thread only
+    std::deque<Flight> flights;
+
+    std::atomic<std::size_t> pending;
+    Statistics statistics;
+
+    std::thread worker;
+
+  public:
+
+    /**
+     * Constructs an UploadService and starts its worker thread
+     *
+     * @param stagingCapacity the size of the staging ring in bytes
+     *
+     * @param frameBudget the number of bytes that pump may issue copies for
+     *
+     * @throws IllegalArgumentException if either size is smaller than the 256 byte granularity
+     * of the ring
+     *
+     * @throws ResourceException if the implementation fails to allocate the staging ring
+     *
+     */
+    explicit UploadService(std::size_t stagingCapacity = 32 << 20, std::size_t frameBudget = 4 << 20);
+
+    UploadService(const UploadService&) = delete;
+    UploadService& operator=(const UploadService&) = delete;
+
+    /**
+     * Stops the worker thread and cleans up the staging ring.  Resources that are not yet
+     * resident remain pending forever.
+     *
+     */
+    ~UploadService();
+
+    /**
+     * Requests the upload of a buffer.  May be invoked from any thread.
+     *
+     * @param producer produces the contents of the buffer on the worker thread
+     *
+     * @return the Resource that receives the data
+     *
+     */
+    std::shared_ptr<Resource> uploadBuffer(Producer producer);
+
+    /**
+     * Requests the upload of an RGBA8 texture (without mipmaps).  May be invoked from any thread.
+     *
+     * @param width the width of the texture in texels
+     *
+     * @param height the height of the texture in texels
+     *
+     * @param producer produces width * height * 4 bytes of tightly packed rows on the worker thread
+     *
+     * @return the Resource that receives the data
+     *
+     * @throws IllegalArgumentException if either dimension is zero
+     *
+     */
+    std::shared_ptr<Resource> uploadTexture(std::size_t width, std::size_t height, Producer producer);
+
+    /**
+     * Retires completed copies and issues new ones within the frame budget.  Must be invoked on
+     * the render thread, ideally once per frame.
+     *
+     * @return the work performed by this pump
+     *
+     */
+    const Statistics& pump();
+
+    /**
+     * Pumps until every requested Resource is resident or failed.  Must be invoked on the render
+     * thread; intended for loading screens and shutdown, as it ignores the frame budget.
+     *
+     */
+    void finish();
+
+  private:
+
+    /**
+     * The body of the worker thread
+     *
+     */
+    void run();
+
+    /**
+     * Copies the produced data of a Resource into the ring, chunk by chunk (worker thread).  The
+     * reference to the Resource is handed to its last chunk, so that the worker never holds the
+     * last reference to a Resource whose GL object exists.
+     *
+     */
+    void stage(std::shared_ptr<Resource> resource, const std::vector<unsigned char>& data);
+
+    /**
+     * Marks a Resource as failed (any thread)
+     *
+     */
+    void fail(const std::shared_ptr<Resource>& resource, const std::string& error);
+
+    /**
+     * Releases the ring space of every chunk whose fence has signaled (render thread)
+     *
+     */
+    void retire(GLuint64 timeout);
+
+    /**
+     * Issues the copy of a single chunk (render thread)
+     *
+     */
+    void issue(const Chunk& chunk);
+};
+
+}
+
+#    include "UploadService.inl"
+
+#endif
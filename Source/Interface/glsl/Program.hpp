@@ -3,8 +3,31 @@
 
 #include "BuildConstraints.hpp"
 #include "Matrix.hpp"
+#include "ProgramReflection.hpp"
 #include "Shader.hpp"
 
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/// Uniform updates are validated against the reflected declarations unless NDEBUG is defined
+#if !defined(NDEBUG) && !defined(MIDNIGHT_UNIFORM_VALIDATION)
+#    define MIDNIGHT_UNIFORM_VALIDATION
+#endif
+
+namespace detail
+{
+    class BindHelper;
+}
+
+namespace midnight
+{
+    class ProgramPipelineCache;
+    class ProgramVariants;
+}
+
 /**
  * A wrapper class for a GLSL program.  Programs may not be copy-constructed 
  * or copy-assigned, but may be move-constructed and move-assigned.  Programs 
@@ -13,13 +36,74 @@
  * also means that programs may not have shaders added or removed from them 
  * after construction, nor are they able to be re-linked.
  * 
+ * Every uniform set through a Program is shadowed: its location and last 
+ * value are cached, and setting a uniform to the value it already holds 
+ * issues no GL calls at all.  Uniforms must therefore only be modified 
+ * through this class.
+ * 
+ * When MIDNIGHT_UNIFORM_VALIDATION is defined (the default unless NDEBUG is), 
+ * every update is checked against the type and array size the shaders 
+ * declare (see getReflection) before anything is sent.  Otherwise updates 
+ * are sent without any checks.
+ * 
  */
 class Program
 {
+    /// Links asynchronously, and adopts the handles once they are complete
+    friend class midnight::ProgramVariants;
+
+    /// Creates separable single-stage Programs, and assembles their handles into pipelines
+    friend class midnight::ProgramPipelineCache;
+
+  public:
+
+    /**
+     * Counts the uniform updates requested from a Program
+     * 
+     */
+    struct UniformStatistics
+    {
+        /// The number of updates that reached the implementation
+        std::size_t issued;
+
+        /// The number of updates skipped because the value was unchanged
+        std::size_t skipped;
+
+        UniformStatistics() : issued(0), skipped(0)
+        {
+
+        }
+    };
+
+  private:
+
+    /**
+     * The cached location and last value of a uniform
+     * 
+     */
+    struct UniformShadow
+    {
+        GLint location;
+
+        /// The declared type and array size (GL_NONE and zero when not validating)
+        GLenum type;
+        GLint size;
+
+        /// The raw bytes last sent (empty until the uniform is first set)
+        std::vector<unsigned char> value;
+    };
 
     /// The implementation provided handle to this Program    
     GLuint handle;
 
+    /// The shadow of every uniform set so far, keyed by name
+    std::unordered_map<std::string, UniformShadow> shadows;
+
+    UniformStatistics uniformStatistics;
+
+    /// The interface of this Program (reflected on first use)
+    mutable std::unique_ptr<midnight::ProgramReflection> reflection;
+
   public:
 
     /**
@@ -79,6 +163,34 @@ class Program
      */
     explicit Program(const std::initializer_list<Shader*>& shaders);
 
+    /**
+     * Constructs a Program from the provided vector of Shaders
+     * 
+     * @param shaders pointers to the shaders to create this Program with
+     * 
+     * @throws LinkingError if an error occurs while linking this Program
+     * 
+     * @throws ResourceException if the implementation fails to create this Program
+     * 
+     */
+    explicit Program(const std::vector<Shader*>& shaders);
+
+    /**
+     * Constructs a Program from a binary previously retrieved with getBinary
+     * 
+     * @param binaryFormat the format reported alongside the binary
+     * 
+     * @param binary the binary
+     * 
+     * @throws LinkingError if the implementation rejects the binary (e.g. after a driver update)
+     * 
+     * @throws ResourceException if the implementation fails to create this Program
+     * 
+     * @note Requires OpenGL 4.1 (or ARB_get_program_binary)
+     * 
+     */
+    Program(GLenum binaryFormat, const std::vector<unsigned char>& binary);
+
     /**
      * Programs are not copy-constructible
      * 
@@ -109,6 +221,12 @@ class Program
      */
     Program& operator=(Program&& other);
 
+    /**
+     * Deletes this Program from the implementation
+     * 
+     */
+    ~Program();
+
     /**
      * Binds this Program to the current context
      * 
@@ -129,6 +247,7 @@ class Program
      * @param tuples the value(s) to set
      * 
      * @throws UniformMismatchException if the provided arguments do not match the type in the program
+     * (only detected when validating)
      * 
      */
     template<typename... E>
@@ -142,10 +261,148 @@ class Program
      * @param matrix the Matrix to set
      * 
      * @throws UniformMismatchException if the provided arguments do not match the type in the program
+     * (only detected when validating)
      * 
      */
     template<typename T, std::size_t Rows, std::size_t Columns>
     void setMatrixUniform(const std::string& uniformID, const midnight::Matrix<T, Rows, Columns>& matrix);
+
+    /**
+     * Sets several uniforms at once, binding this Program at most once.  The 
+     * arguments alternate between a uniform name and its value, which may be 
+     * a Tuple or a Matrix, e.g. setUniforms("offset", position, "projection", projection)
+     * 
+     * @param uniforms the names and values of the uniforms to set
+     * 
+     * @throws UniformMismatchException if a value does not match the type in the program
+     * (only detected when validating)
+     * 
+     */
+    template<typename... E>
+    void setUniforms(E&&... uniforms);
+
+    /**
+     * Retrieves the implementation specific binary of this linked Program
+     * 
+     * @param binaryFormat receives the format of the binary
+     * 
+     * @return the binary, which is only valid for the same implementation and driver version
+     * 
+     * @throws ResourceException if the implementation does not provide a binary
+     * 
+     * @note Requires OpenGL 4.1 (or ARB_get_program_binary)
+     * 
+     */
+    std::vector<unsigned char> getBinary(GLenum& binaryFormat) const;
+
+    /**
+     * Assigns the provided uniform block of this Program to an indexed uniform 
+     * buffer binding point
+     * 
+     * @param blockID the name of the uniform block
+     * 
+     * @param binding the binding point to read the block from
+     * 
+     * @return true if the block is active in this Program, otherwise false
+     * 
+     */
+    bool bindUniformBlock(const std::string& blockID, GLuint binding);
+
+    /**
+     * Retrieves the interface of this linked Program, reflecting it on first use
+     * 
+     * @return the active uniforms, attributes and uniform blocks
+     * 
+     */
+    const midnight::ProgramReflection& getReflection() const;
+
+    /**
+     * Retrieves the uniform updates requested since the last reset
+     * 
+     * @return the number of issued and skipped updates
+     * 
+     */
+    const UniformStatistics& getUniformStatistics() const noexcept;
+
+    /**
+     * Resets the uniform update counters, typically once per frame
+     * 
+     */
+    void resetUniformStatistics() noexcept;
+
+    /**
+     * Retrieves the uniform updates requested from every Program since the 
+     * last reset (FrameUniforms resets them as each frame begins)
+     * 
+     * @return the number of issued and skipped updates
+     * 
+     */
+    static const UniformStatistics& getTotalUniformStatistics() noexcept;
+
+    /**
+     * Resets the uniform update counters of every Program
+     * 
+     */
+    static void resetTotalUniformStatistics() noexcept;
+
+  private:
+
+    /**
+     * The storage of the counters of every Program (render thread only)
+     * 
+     */
+    static UniformStatistics& totalUniformStatistics() noexcept;
+
+    /**
+     * Adopts the handle of a successfully linked program
+     * 
+     * @param handle the handle, which this Program takes ownership of
+     * 
+     */
+    explicit Program(GLuint handle) noexcept;
+
+    /**
+     * Looks up (and caches) the shadow of the provided uniform
+     * 
+     * @throws UniformNotFoundException if the uniform does not exist
+     * 
+     */
+    UniformShadow& shadowOf(const std::string& uniformID);
+
+    /**
+     * Compares the provided value against the shadow, updating the shadow 
+     * and the counters.
+     * 
+     * @return true if the value differs and must be sent
+     * 
+     */
+    bool update(UniformShadow& shadow, const void* value, std::size_t size);
+
+    /**
+     * Verifies that an update matches the declaration of a uniform
+     * 
+     * @throws UniformMismatchException if it does not
+     * 
+     */
+    void validate(const UniformShadow& shadow, const std::string& uniformID, GLenum type, std::size_t count) const;
+
+    template<typename... E>
+    void applyUniform(detail::BindHelper& binder, const std::string& uniformID, E&&... tuples);
+
+    template<typename T, std::size_t Rows, std::size_t Columns>
+    void applyMatrixUniform(detail::BindHelper& binder, const std::string& uniformID, const midnight::Matrix<T, Rows, Columns>& matrix);
+
+    /// Dispatches a value of setUniforms to applyMatrixUniform (std::true_type) or applyUniform
+    template<typename V>
+    void applyAny(detail::BindHelper& binder, const std::string& uniformID, const V& matrix, std::true_type);
+
+    template<typename V>
+    void applyAny(detail::BindHelper& binder, const std::string& uniformID, const V& value, std::false_type);
+
+    void applyUniforms(detail::BindHelper& binder);
+
+    template<typename V, typename... E>
+    void applyUniforms(detail::BindHelper& binder, const std::string& uniformID, V&& value, E&&... remaining);
 };
 
 #include "Program.inl"
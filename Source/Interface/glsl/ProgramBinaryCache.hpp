@@ -0,0 +1,217 @@
+#ifndef PROGRAM_BINARY_CACHE_HPP
+#    define PROGRAM_BINARY_CACHE_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <cstdint>
+#    include <memory>
+#    include <string>
+#    include <vector>
+
+#    include "Program.hpp"
+#    include "ShaderPreprocessor.hpp"
+
+namespace midnight
+{
+
+/**
+ * Caches linked Programs on disk as implementation specific binaries, so that only the first
+ * start (or the first start after a driver update) pays for compiling and linking.
+ *
+ * A binary is keyed by a hash of the stage types and sources, the defines, and the vendor,
+ * renderer and version strings of the implementation.  When the implementation rejects a cached
+ * binary anyway, the Program is compiled from source and the entry is replaced.
+ *
+ * Caching degrades gracefully: when the implementation offers no binary formats, or the cache
+ * directory cannot be written, every load simply compiles from source.
+ *
+ * @note Binaries require OpenGL 4.1 (or ARB_get_program_binary)
+ *
+ */
+class ProgramBinaryCache
+{
+  public:
+
+    /**
+     * The source of a single shader stage
+     *
+     */
+    struct Stage
+    {
+        /// GL_VERTEX_SHADER, GL_FRAGMENT_SHADER...
+        GLenum type;
+
+        std::string source;
+    };
+
+    /**
+     * Counts the outcomes of load
+     *
+     */
+    struct Statistics
+    {
+        /// Programs created from a cached binary
+        std::size_t hits;
+
+        /// Lookups that found no cached binary
+        std::size_t misses;
+
+        /// Lookups whose cached binary the implementation rejected
+        std::size_t rejected;
+
+        Statistics() : hits(0), misses(0), rejected(0)
+        {
+
+        }
+    };
+
+  private:
+
+    /// The directory that holds the binaries (with a trailing separator)
+    std::string directory;
+
+    /// The vendor, renderer and version of the implementation (queried on first use)
+    std::string implementation;
+
+    /// Whether the implementation supports any binary format (queried on first use)
+    bool supported;
+
+    Statistics statistics;
+
+  public:
+
+    /**
+     * Constructs a ProgramBinaryCache, creating its directory if it does not exist
+     *
+     * @param directory the directory to store binaries in
+     *
+     */
+    explicit ProgramBinaryCache(const std::string& directory);
+
+    /**
+     * Creates a Program from a cached binary, or compiles it from source and caches its binary
+     *
+     * @param stages the shader stages of the Program
+     *
+     * @param defines the preprocessor definitions inserted after the #version directive of every
+     * stage, each written as "NAME" or "NAME VALUE"
+     *
+     * @return the linked Program
+     *
+     * @throws CompilationError if a stage fails to compile
+     *
+     * @throws LinkingError if the Program fails to link
+     *
+     * @throws ResourceException if the implementation fails to create the Program
+     *
+     */
+    Program load(const std::vector<Stage>& stages, const std::vector<std::string>& defines = std::vector<std::string>());
+
+    /**
+     * Creates a Program of a vertex and a fragment shader (see above)
+     *
+     */
+    Program load(const std::string& vertexSource, const std::string& fragmentSource,
+            const std::vector<std::string>& defines = std::vector<std::string>());
+
+    /**
+     * Creates a Program from a cached binary without ever compiling
+     *
+     * @param stages the shader stages of the Program
+     *
+     * @param defines the preprocessor definitions of the Program (see load)
+     *
+     * @return the Program, or nullptr if no binary is cached or the implementation rejected it
+     *
+     * @throws ResourceException if the implementation fails to create the Program
+     *
+     */
+    std::unique_ptr<Program> find(const std::vector<Stage>& stages, const std::vector<std::string>& defines = std::vector<std::string>());
+
+    /**
+     * Caches the binary of a Program that was linked from the provided stages and definitions.
+     * Failures to retrieve or write the binary are ignored.
+     *
+     * @param stages the shader stages of the Program
+     *
+     * @param defines the preprocessor definitions of the Program (see load)
+     *
+     * @param program the linked Program
+     *
+     */
+    void store(const std::vector<Stage>& stages, const std::vector<std::string>& defines, const Program& program);
+
+    /**
+     * Retrieves the outcomes of every load and find so far
+     *
+     * @return the Statistics of this cache
+     *
+     */
+    const Statistics& getStatistics() const noexcept;
+
+    /**
+     * Compiles and links the provided stages without consulting any cache
+     *
+     * @param stages the shader stages of the Program
+     *
+     * @return the linked Program
+     *
+     * @throws IllegalArgumentException if a stage type is not a shader type
+     *
+     * @throws CompilationError if a stage fails to compile
+     *
+     * @throws LinkingError if the Program fails to link
+     *
+     */
+    static Program compile(const std::vector<Stage>& stages);
+
+  private:
+
+    /**
+     * Queries the implementation strings and binary support once a context is guaranteed
+     *
+     */
+    void queryImplementation();
+
+    /**
+     * Computes the key of a Program
+     *
+     */
+    std::uint64_t computeKey(const std::vector<Stage>& stages, const std::vector<std::string>& defines) const;
+
+    /**
+     * Retrieves the path of the binary with the provided key
+     *
+     */
+    std::string pathOf(std::uint64_t key) const;
+
+    /**
+     * Reads a cached binary
+     *
+     * @return true if a binary with the provided key was found
+     *
+     */
+    bool read(std::uint64_t key, GLenum& format, std::vector<unsigned char>& binary) const;
+
+    /**
+     * Writes a binary (through a temporary file, so that readers never see a partial one)
+     *
+     */
+    void write(std::uint64_t key, GLenum format, const std::vector<unsigned char>& binary) const;
+};
+
+namespace detail
+{
+    /**
+     * Computes the 64-bit FNV-1a hash of the provided bytes, continuing from the provided hash
+     *
+     */
+    std::uint64_t fnv1a(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL) noexcept;
+}
+
+}
+
+#    include "ProgramBinaryCache.inl"
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef PROGRAM_PIPELINE_CACHE_HPP
+#    define PROGRAM_PIPELINE_CACHE_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <cstdint>
+#    include <initializer_list>
+#    include <memory>
+#    include <string>
+#    include <unordered_map>
+#    include <vector>
+
+#    include "Program.hpp"
+#    include "ProgramBinaryCache.hpp"
+
+namespace midnight
+{
+
+/**
+ * Combines separately linked shader stages at draw time, so that N vertex stages and M fragment
+ * stages cost N + M links rather than N * M.
+ *
+ * Every stage is a separable Program of its own (glCreateShaderProgramv), interned by its source
+ * like the Programs of a ProgramRegistry.  Its uniforms are set through the usual Program
+ * interface.  bind() assembles the requested stages into a program pipeline object, which is
+ * created on first use and cached for as long as all of its stages live.
+ *
+ * The stages must agree on their interfaces by location or by name, and vertex stages of
+ * GLSL 4.10 and later must redeclare the gl_PerVertex block they write.
+ *
+ * @note Requires OpenGL 4.1 (or ARB_separate_shader_objects); see isSupported
+ *
+ */
+class ProgramPipelineCache
+{
+  public:
+
+    /**
+     * Counts the work performed by a ProgramPipelineCache
+     *
+     */
+    struct Statistics
+    {
+        /// Stages that were compiled and linked
+        std::size_t stagesCreated;
+
+        /// Acquisitions that returned an existing stage
+        std::size_t stagesShared;
+
+        /// Program pipeline objects that were created
+        std::size_t pipelinesCreated;
+
+        /// Binds that had to switch the program pipeline
+        std::size_t pipelineSwitches;
+
+        Statistics() : stagesCreated(0), stagesShared(0), pipelinesCreated(0), pipelineSwitches(0)
+        {
+
+        }
+    };
+
+  private:
+
+    /**
+     * An interned stage along with the source it was created from
+     *
+     */
+    struct StageEntry
+    {
+        ProgramBinaryCache::Stage stage;
+        std::weak_ptr<Program> program;
+    };
+
+    /**
+     * A program pipeline object along with the stages it was assembled from
+     *
+     */
+    struct PipelineEntry
+    {
+        std::vector<std::weak_ptr<Program>> stages;
+        GLuint handle;
+    };
+
+    /// The interned stages, keyed by the hash of their type and source
+    std::unordered_multimap<std::uint64_t, StageEntry> stages;
+
+    /// The pipelines, keyed by the hash of the addresses of their stages
+    std::unordered_multimap<std::uint64_t, PipelineEntry> pipelines;
+
+    /// The pipeline bound by the previous bind (zero if none)
+    GLuint bound;
+
+    bool supported;
+
+    Statistics statistics;
+
+  public:
+
+    /**
+     * Constructs an empty ProgramPipelineCache for the current context
+     *
+     */
+    ProgramPipelineCache();
+
+    ProgramPipelineCache(const ProgramPipelineCache&) = delete;
+    ProgramPipelineCache& operator=(const ProgramPipelineCache&) = delete;
+
+    /**
+     * Deletes every cached program pipeline object.  The stages remain valid.
+     *
+     */
+    ~ProgramPipelineCache();
+
+    /**
+     * Queries whether the current context supports separable programs
+     *
+     * @return true with OpenGL 4.1 or ARB_separate_shader_objects, otherwise false
+     *
+     */
+    bool isSupported() const noexcept;
+
+    /**
+     * Retrieves the separable Program of a single stage, creating it if no user holds one
+     *
+     * @param type GL_VERTEX_SHADER, GL_FRAGMENT_SHADER...
+     *
+     * @param source the source of the stage
+     *
+     * @return the shared stage
+     *
+     * @throws IllegalArgumentException if the type does not name a pipeline stage
+     *
+     * @throws LinkingError if the stage fails to compile or link (the log holds either)
+     *
+     * @throws ResourceException if separable programs are not supported
+     *
+     */
+    std::shared_ptr<Program> acquireStage(GLenum type, const std::string& source);
+
+    /**
+     * Makes the provided stages current, replacing any bound Program.  Every stage must have
+     * been acquired from this cache, and no two may share a type.
+     *
+     * @param stages the stages to draw with
+     *
+     * @throws IllegalArgumentException if a stage was not acquired from this cache
+     *
+     */
+    void bind(std::initializer_list<std::shared_ptr<Program>> stages);
+
+    /**
+     * Makes a vertex and a fragment stage current (see above)
+     *
+     */
+    void bind(const std::shared_ptr<Program>& vertexStage, const std::shared_ptr<Program>& fragmentStage);
+
+    /**
+     * Unbinds the current program pipeline
+     *
+     */
+    void unbind();
+
+    /**
+     * Deletes the pipelines that reference a stage which no longer has any users
+     *
+     * @return the number of deleted pipelines
+     *
+     */
+    std::size_t collect();
+
+    /**
+     * Retrieves the number of cached program pipeline objects
+     *
+     * @return the number of pipelines
+     *
+     */
+    std::size_t getPipelineCount() const noexcept;
+
+    /**
+     * Retrieves the work performed so far
+     *
+     * @return the Statistics of this cache
+     *
+     */
+    const Statistics& getStatistics() const noexcept;
+
+  private:
+
+    /**
+     * Creates the program pipeline object of the provided stages
+     *
+     */
+    GLuint assemble(const std::vector<std::shared_ptr<Program>>& stages);
+
+    /**
+     * Retrieves the stage bit (GL_VERTEX_SHADER_BIT...) of an interned stage
+     *
+     * @throws IllegalArgumentException if the stage was not acquired from this cache
+     *
+     */
+    GLbitfield stageBitOf(const Program& stage) const;
+};
+
+}
+
+#    include "ProgramPipelineCache.inl"
+
+#endif
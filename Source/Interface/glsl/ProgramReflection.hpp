@@ -0,0 +1,218 @@
+#ifndef PROGRAM_REFLECTION_HPP
+#    define PROGRAM_REFLECTION_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <string>
+#    include <unordered_map>
+#    include <utility>
+#    include <vector>
+
+namespace midnight
+{
+
+/**
+ * Everything the implementation reports about the interface of a linked program: its active
+ * uniforms (including samplers and the members of uniform blocks), vertex attributes and uniform
+ * blocks, along with their GL types, array sizes and block layouts.
+ *
+ * Intended for validating what the application sends against what the shaders declare, and for
+ * tooling.  Requires OpenGL 3.1 (or ARB_uniform_buffer_object).
+ *
+ */
+class ProgramReflection
+{
+  public:
+
+    /**
+     * An active uniform
+     *
+     */
+    struct Uniform
+    {
+        /// The name as reported by the implementation (arrays end in "[0]")
+        std::string name;
+
+        /// GL_FLOAT_VEC3, GL_SAMPLER_2D...
+        GLenum type;
+
+        /// The number of array elements (one for non-arrays)
+        GLint size;
+
+        /// The location (-1 for members of uniform blocks)
+        GLint location;
+
+        /// The index of the enclosing uniform block (-1 for the default block)
+        GLint blockIndex;
+
+        /// The byte offset, array stride and matrix stride within the enclosing block (-1 otherwise)
+        GLint offset;
+        GLint arrayStride;
+        GLint matrixStride;
+    };
+
+    /**
+     * An active vertex attribute
+     *
+     */
+    struct Attribute
+    {
+        std::string name;
+        GLenum type;
+        GLint size;
+        GLint location;
+    };
+
+    /**
+     * An active uniform block
+     *
+     */
+    struct UniformBlock
+    {
+        std::string name;
+        GLuint index;
+
+        /// The size of the block's buffer storage in bytes
+        GLint dataSize;
+
+        /// The indices of the members within getUniforms()
+        std::vector<std::size_t> members;
+    };
+
+  private:
+
+    std::vector<Uniform> uniforms;
+    std::vector<Attribute> attributes;
+    std::vector<UniformBlock> blocks;
+
+    /// The index of every uniform (arrays with and without their "[0]" suffix), by name
+    std::unordered_map<std::string, std::size_t> uniformsByName;
+
+  public:
+
+    /**
+     * Reflects the provided linked program
+     *
+     * @param program the implementation provided handle to the program
+     *
+     */
+    explicit ProgramReflection(GLuint program);
+
+    /**
+     * Retrieves every active uniform
+     *
+     * @return the active uniforms in the order of their implementation provided indices
+     *
+     */
+    const std::vector<Uniform>& getUniforms() const noexcept;
+
+    /**
+     * Retrieves every active vertex attribute
+     *
+     * @return the active attributes
+     *
+     */
+    const std::vector<Attribute>& getAttributes() const noexcept;
+
+    /**
+     * Retrieves every active uniform block
+     *
+     * @return the active uniform blocks in the order of their indices
+     *
+     */
+    const std::vector<UniformBlock>& getUniformBlocks() const noexcept;
+
+    /**
+     * Retrieves the uniforms of a sampler type
+     *
+     * @return the samplers
+     *
+     */
+    std::vector<const Uniform*> getSamplers() const;
+
+    /**
+     * Looks up a uniform by name
+     *
+     * @param name the name of the uniform (or of a uniform array, with or without "[0]")
+     *
+     * @return the uniform, or nullptr if no such uniform is active
+     *
+     */
+    const Uniform* findUniform(const std::string& name) const;
+
+    /**
+     * Looks up an attribute by name
+     *
+     * @return the attribute, or nullptr if no such attribute is active
+     *
+     */
+    const Attribute* findAttribute(const std::string& name) const;
+
+    /**
+     * Looks up a uniform block by name
+     *
+     * @return the uniform block, or nullptr if no such block is active
+     *
+     */
+    const UniformBlock* findUniformBlock(const std::string& name) const;
+
+    /**
+     * Verifies that a C++ struct matches the layout of a uniform block.  Typically used with
+     * offsetof on a struct of std140 types:
+     *
+     * verifyBlock("FrameUniforms", sizeof(FrameData), {{"view", offsetof(FrameData, view)}, ...})
+     *
+     * @param blockName the name of the block
+     *
+     * @param size the size of the struct
+     *
+     * @param offsets the name (without the block prefix) and offset of every member of the struct
+     *
+     * @return false if the block is not active, otherwise true
+     *
+     * @throws UniformMismatchException if the block is larger than the struct, or if a member is
+     * not part of the block or resides at a different offset
+     *
+     */
+    bool verifyBlock(const std::string& blockName, std::size_t size, const std::vector<std::pair<std::string, std::size_t>>& offsets) const;
+
+    /**
+     * Queries whether a GL type is a sampler type
+     *
+     * @param type the GL type
+     *
+     * @return true for sampler types, otherwise false
+     *
+     */
+    static bool isSampler(GLenum type) noexcept;
+
+    /**
+     * Retrieves the GLSL name of a GL type, for diagnostics
+     *
+     * @param type the GL type
+     *
+     * @return the GLSL name (e.g. "vec3"), or "unknown"
+     *
+     */
+    static const char* getTypeName(GLenum type) noexcept;
+
+    /**
+     * Queries whether a uniform of the provided GL type may be set with glUniform of the provided
+     * scalar type and component count (or glUniformMatrix, for matrix types)
+     *
+     * @param declared the GL type declared by the shader
+     *
+     * @param provided the GL type of the data (GL_FLOAT_VEC3, GL_INT, GL_FLOAT_MAT4...)
+     *
+     * @return true if the update is valid
+     *
+     */
+    static bool isCompatible(GLenum declared, GLenum provided) noexcept;
+};
+
+}
+
+#    include "ProgramReflection.inl"
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef PROGRAM_REGISTRY_HPP
+#    define PROGRAM_REGISTRY_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <cstdint>
+#    include <memory>
+#    include <string>
+#    include <unordered_map>
+#    include <vector>
+
+#    include "Program.hpp"
+#    include "ProgramBinaryCache.hpp"
+
+namespace midnight
+{
+
+/**
+ * Interns Programs by their shader sources, so that every user of the same sources shares a
+ * single GL program object: it is compiled and linked once, occupies driver memory once, and
+ * draws that use it need no program switch between them.
+ *
+ * The registry only holds weak references; a Program is deleted along with its last user and
+ * created anew on the next acquire.
+ *
+ */
+class ProgramRegistry
+{
+  public:
+
+    /**
+     * Counts the outcomes of acquire
+     *
+     */
+    struct Statistics
+    {
+        /// Programs created (compiled or loaded from the binary cache)
+        std::size_t created;
+
+        /// Acquisitions that returned an existing Program
+        std::size_t shared;
+
+        Statistics() : created(0), shared(0)
+        {
+
+        }
+    };
+
+  private:
+
+    /**
+     * An interned Program along with the sources it was created from
+     *
+     */
+    struct Entry
+    {
+        std::vector<ProgramBinaryCache::Stage> stages;
+        std::weak_ptr<Program> program;
+    };
+
+    /// The interned Programs, keyed by the hash of their sources
+    std::unordered_multimap<std::uint64_t, Entry> entries;
+
+    /// Where new Programs come from (compiled from source if nullptr)
+    ProgramBinaryCache* cache;
+
+    Statistics statistics;
+
+  public:
+
+    /**
+     * Constructs an empty ProgramRegistry
+     *
+     * @param cache the cache to create Programs through, or nullptr to always compile
+     *
+     */
+    explicit ProgramRegistry(ProgramBinaryCache* cache = nullptr);
+
+    ProgramRegistry(const ProgramRegistry&) = delete;
+    ProgramRegistry& operator=(const ProgramRegistry&) = delete;
+
+    /**
+     * Retrieves the Program of the provided stages, creating it if no user holds one
+     *
+     * @param stages the shader stages of the Program
+     *
+     * @return the shared Program
+     *
+     * @throws CompilationError if a stage fails to compile
+     *
+     * @throws LinkingError if the Program fails to link
+     *
+     * @throws ResourceException if the implementation fails to create the Program
+     *
+     */
+    std::shared_ptr<Program> acquire(const std::vector<ProgramBinaryCache::Stage>& stages);
+
+    /**
+     * Retrieves the Program of a vertex and a fragment shader (see above)
+     *
+     */
+    std::shared_ptr<Program> acquire(const std::string& vertexSource, const std::string& fragmentSource);
+
+    /**
+     * Sets the cache that new Programs are created through
+     *
+     * @param cache the cache, or nullptr to always compile
+     *
+     */
+    void setCache(ProgramBinaryCache* cache) noexcept;
+
+    /**
+     * Retrieves the number of interned Programs that are still in use
+     *
+     * @return the number of live Programs
+     *
+     */
+    std::size_t getLiveCount() const noexcept;
+
+    /**
+     * Retrieves the outcomes of every acquire so far
+     *
+     * @return the Statistics of this registry
+     *
+     */
+    const Statistics& getStatistics() const noexcept;
+
+    /**
+     * Retrieves the registry that the built-in scene nodes acquire their Programs from
+     *
+     * @return the default ProgramRegistry
+     *
+     */
+    static ProgramRegistry& getDefault();
+};
+
+}
+
+#    include "ProgramRegistry.inl"
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef PROGRAM_VARIANTS_HPP
+#    define PROGRAM_VARIANTS_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <cstdint>
+#    include <deque>
+#    include <exception>
+#    include <memory>
+#    include <string>
+#    include <unordered_map>
+#    include <vector>
+
+#    include "Program.hpp"
+#    include "ProgramBinaryCache.hpp"
+
+namespace midnight
+{
+
+/**
+ * The permutations of a single set of shader stages, selected by a mode (one of several mutually
+ * exclusive definitions, such as the lighting model) and a set of feature flags (one definition
+ * per bit).  Variants are built lazily on first request, and requesting one never stalls on the
+ * compiler: request returns nullptr until the variant is linked, so render code may skip the draw
+ * (or fall back to another variant) in the meantime.
+ *
+ * With KHR_parallel_shader_compile (or ARB_parallel_shader_compile) the driver compiles and links
+ * on its own threads, and update merely polls for completion.  Without it, update compiles at
+ * most 'compileBudget' variants per call on the calling thread.
+ *
+ * Variants found in the optional ProgramBinaryCache are available immediately, and variants that
+ * are built are stored to it.
+ *
+ * Sources are expected to be fully preprocessed (see ShaderPreprocessor); the definitions of a
+ * variant are inserted after the #version directive of every stage.
+ *
+ */
+class ProgramVariants
+{
+  public:
+
+    /// Identifies a variant: the mode in the upper, the feature flags in the lower 32 bits
+    typedef std::uint64_t Key;
+
+  private:
+
+    /**
+     * A variant that has been requested
+     *
+     */
+    struct Variant
+    {
+        /// The linked Program (nullptr while building, or if the build failed)
+        std::unique_ptr<Program> program;
+
+        /// The program and shaders being built (zero and empty otherwise)
+        GLuint handle;
+        std::vector<GLuint> shaders;
+
+        /// Why the build failed
+        std::exception_ptr error;
+
+        Variant() : handle(0)
+        {
+
+        }
+    };
+
+    std::vector<ProgramBinaryCache::Stage> stages;
+
+    /// The definition of every mode, and of every feature flag
+    std::vector<std::string> modes;
+    std::vector<std::string> features;
+
+    ProgramBinaryCache* cache;
+
+    /// The number of variants update may compile without parallel compilation
+    std::size_t compileBudget;
+
+    /// Whether the driver compiles on its own threads
+    bool parallel;
+
+    std::unordered_map<Key, Variant> variants;
+
+    /// Variants being compiled by the driver
+    std::vector<Key> compiling;
+
+    /// Variants waiting for update (without parallel compilation)
+    std::deque<Key> queued;
+
+  public:
+
+    /**
+     * Constructs ProgramVariants without building any variant
+     *
+     * @param stages the (preprocessed) shader stages
+     *
+     * @param modes the definition of every mode (e.g. {"LIGHTING_UNLIT", "LIGHTING_PHONG"}), or
+     * empty if there is only the default mode
+     *
+     * @param features the definition of every feature flag, the first selected by bit 0
+     *
+     * @param cache the cache to look binaries up in and store them to, or nullptr
+     *
+     * @param compileBudget the number of variants update may compile without parallel compilation
+     *
+     * @throws IllegalArgumentException if there are no stages or more than 32 features
+     *
+     */
+    ProgramVariants(const std::vector<ProgramBinaryCache::Stage>& stages, const std::vector<std::string>& modes,
+            const std::vector<std::string>& features, ProgramBinaryCache* cache = nullptr, std::size_t compileBudget = 1);
+
+    ProgramVariants(const ProgramVariants&) = delete;
+    ProgramVariants& operator=(const ProgramVariants&) = delete;
+
+    /**
+     * Deletes the variants, abandoning those that are still being built
+     *
+     */
+    ~ProgramVariants();
+
+    /**
+     * Retrieves a variant, starting its build if it was never requested
+     *
+     * @param mode the index of the mode (an enumerator is fine)
+     *
+     * @param features the feature flags
+     *
+     * @return the linked Program, or nullptr while it is being built (or if its build failed)
+     *
+     * @throws IllegalArgumentException if the mode or a feature flag does not exist
+     *
+     */
+    template<typename Mode>
+    Program* request(Mode mode, std::uint32_t features = 0);
+
+    /**
+     * Retrieves a variant, building it on the spot if required
+     *
+     * @param mode the index of the mode (an enumerator is fine)
+     *
+     * @param features the feature flags
+     *
+     * @return the linked Program
+     *
+     * @throws IllegalArgumentException if the mode or a feature flag does not exist
+     *
+     * @throws CompilationError if a stage of the variant fails to compile
+     *
+     * @throws LinkingError if the variant fails to link
+     *
+     */
+    template<typename Mode>
+    Program& require(Mode mode, std::uint32_t features = 0);
+
+    /**
+     * Completes the variants that finished building, and compiles queued variants within the
+     * budget.  Should be invoked once per frame.
+     *
+     * @throws CompilationError if a completed variant failed to compile
+     *
+     * @throws LinkingError if a completed variant failed to link
+     *
+     */
+    void update();
+
+    /**
+     * Retrieves the number of variants that are still being built
+     *
+     * @return the number of requested variants that are neither linked nor failed
+     *
+     */
+    std::size_t getPendingCount() const noexcept;
+
+    /**
+     * Queries whether the driver compiles variants on its own threads
+     *
+     * @return true if KHR_parallel_shader_compile (or the ARB equivalent) is used
+     *
+     */
+    bool isParallel() const noexcept;
+
+  private:
+
+    /**
+     * Computes the Key of a variant
+     *
+     */
+    Key keyOf(std::uint64_t mode, std::uint32_t flags) const;
+
+    /**
+     * Retrieves the definitions of a variant
+     *
+     */
+    std::vector<std::string> definesOf(Key key) const;
+
+    Program* lookup(Key key);
+
+    Program& complete(Key key);
+
+    /**
+     * Issues the compilation and linking of a variant without waiting for either
+     *
+     */
+    void issue(Key key, Variant& variant);
+
+    /**
+     * Waits for the build of a variant and adopts the linked Program
+     *
+     */
+    void finish(Key key, Variant& variant);
+
+    /**
+     * Deletes the program and shaders that are being built
+     *
+     */
+    static void abandon(Variant& variant);
+};
+
+}
+
+#    include "ProgramVariants.inl"
+
+#endif
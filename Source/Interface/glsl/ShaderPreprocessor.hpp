@@ -0,0 +1,147 @@
+#ifndef SHADER_PREPROCESSOR_HPP
+#    define SHADER_PREPROCESSOR_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include <string>
+#    include <unordered_map>
+#    include <unordered_set>
+#    include <vector>
+
+namespace midnight
+{
+
+/**
+ * Resolves '#include "name"' directives and injects preprocessor definitions into GLSL sources,
+ * which the GLSL preprocessor itself does not support.
+ *
+ * An include is looked up, in order, among the sources registered with addSource, next to the
+ * including file, and in every search path.  Every file is included at most once per process,
+ * so include guards are unnecessary and cycles are harmless.
+ *
+ * Included text is wrapped in '#line' directives whose source string number identifies the file
+ * (see getFileName), so that compiler logs point at the right file and line.  The line numbers
+ * follow the GLSL 3.30 semantics; older versions report one line too far.
+ *
+ */
+class ShaderPreprocessor
+{
+    /// The directories searched for includes, in order
+    std::vector<std::string> searchPaths;
+
+    /// The sources registered by name
+    std::unordered_map<std::string, std::string> sources;
+
+    /// Every file ever included, indexed by its GLSL source string number (0 is the root source)
+    std::vector<std::string> files;
+
+  public:
+
+    /**
+     * Constructs a ShaderPreprocessor without any search paths or registered sources
+     *
+     */
+    ShaderPreprocessor();
+
+    /**
+     * Adds a directory to search for includes
+     *
+     * @param directory the directory
+     *
+     */
+    void addSearchPath(const std::string& directory);
+
+    /**
+     * Registers a source that may be included by name without touching the file system
+     *
+     * @param name the name used in '#include' directives
+     *
+     * @param source the source
+     *
+     */
+    void addSource(const std::string& name, const std::string& source);
+
+    /**
+     * Resolves the includes of a source and injects the provided definitions
+     *
+     * @param source the source to process
+     *
+     * @param defines the definitions inserted after the #version directive, each written as
+     * "NAME" or "NAME VALUE"
+     *
+     * @return the processed source
+     *
+     * @throws ResourceException if an included file cannot be found
+     *
+     * @throws CompilationError if an '#include' directive is malformed
+     *
+     */
+    std::string process(const std::string& source, const std::vector<std::string>& defines = std::vector<std::string>());
+
+    /**
+     * Loads and processes a source file (see above)
+     *
+     * @param fileName the name of the file, which relative includes are resolved against
+     *
+     * @throws ResourceException if the file (or an included file) cannot be read
+     *
+     */
+    std::string load(const std::string& fileName, const std::vector<std::string>& defines = std::vector<std::string>());
+
+    /**
+     * Retrieves the name of the file that a '#line' directive identifies
+     *
+     * @param sourceString the source string number reported by the compiler
+     *
+     * @return the file name (empty for the root source or unknown numbers)
+     *
+     */
+    std::string getFileName(int sourceString) const;
+
+  private:
+
+    /**
+     * Appends the processed text of a source to the output
+     *
+     */
+    void expand(const std::string& source, const std::string& fileName, int sourceString,
+            std::unordered_set<std::string>& included, std::string& output);
+
+    /**
+     * Locates and reads an included source
+     *
+     * @return false if nothing by that name exists
+     *
+     */
+    bool find(const std::string& name, const std::string& includer, std::string& path, std::string& source) const;
+
+    /**
+     * Retrieves the source string number of a file, assigning a new one on first use
+     *
+     */
+    int sourceStringOf(const std::string& path);
+};
+
+namespace detail
+{
+    /**
+     * Inserts '#define' directives after the #version directive of the provided source (or at
+     * its start, if it has none)
+     *
+     */
+    std::string injectDefines(const std::string& source, const std::vector<std::string>& defines);
+
+    /**
+     * Reads a whole file
+     *
+     * @return false if the file cannot be opened
+     *
+     */
+    bool readFile(const std::string& fileName, std::string& contents);
+}
+
+}
+
+#    include "ShaderPreprocessor.inl"
+
+#endif
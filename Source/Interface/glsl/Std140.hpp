@@ -0,0 +1,103 @@
+#ifndef STD140_HPP
+#    define STD140_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <cstddef>
+#    include <cstring>
+
+#    include "Matrix.hpp"
+#    include "Tuple.hpp"
+
+namespace midnight
+{
+namespace glsl
+{
+
+/**
+ * Building blocks for C++ mirrors of GLSL uniform blocks declared with layout(std140).
+ *
+ * Every type below has the size and alignment that std140 assigns to its GLSL counterpart, so a
+ * standard-layout struct composed of them is laid out by the compiler exactly as the GL lays out
+ * the block, member for member, and may be copied into a uniform buffer as is.  vec3 is
+ * deliberately missing: std140 aligns it to 16 bytes but lets the next scalar use its last 4,
+ * which no C++ type can express.  Use a Vec4 instead.
+ *
+ */
+namespace std140
+{
+
+/**
+ * A scalar (N == 1) or vector member
+ *
+ * @tparam T the component type (GLfloat, GLint or GLuint)
+ *
+ * @tparam N the number of components (1, 2 or 4)
+ *
+ */
+template<typename T, std::size_t N>
+struct alignas(N == 1 ? 4 : (N == 2 ? 8 : 16)) Vec
+{
+    static_assert(sizeof(T) == 4, "std140 members must have 32-bit components");
+    static_assert(N == 1 || N == 2 || N == 4, "std140 vectors must have 1, 2 or 4 components");
+
+    T elements[N];
+
+    Vec& operator=(const Tuple<T, N>& tuple) noexcept
+    {
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            elements[i] = tuple[i];
+        }
+        return *this;
+    }
+
+    /**
+     * Sets every component at once
+     *
+     * @param values the N new component values
+     *
+     */
+    template<typename... E>
+    void set(E... values) noexcept
+    {
+        static_assert(sizeof...(E) == N, "Incorrect number of components provided to a std140 vector");
+        const T array[] = {static_cast<T>(values)...};
+        std::memcpy(elements, array, sizeof(elements));
+    }
+};
+
+/**
+ * A column-major mat4 member
+ *
+ */
+struct alignas(16) Mat4
+{
+    GLfloat elements[16];
+
+    Mat4& operator=(const Matrix<GLfloat, 4, 4>& matrix) noexcept
+    {
+        /// Matrix is column-major as well
+        std::memcpy(elements, &matrix, sizeof(elements));
+        return *this;
+    }
+};
+
+typedef Vec<GLfloat, 1> Float;
+typedef Vec<GLint, 1> Int;
+typedef Vec<GLuint, 1> UInt;
+typedef Vec<GLfloat, 2> Vec2;
+typedef Vec<GLfloat, 4> Vec4;
+
+static_assert(sizeof(Float) == 4 && alignof(Float) == 4, "std140 float must be 4 bytes, aligned to 4");
+static_assert(sizeof(Vec2) == 8 && alignof(Vec2) == 8, "std140 vec2 must be 8 bytes, aligned to 8");
+static_assert(sizeof(Vec4) == 16 && alignof(Vec4) == 16, "std140 vec4 must be 16 bytes, aligned to 16");
+static_assert(sizeof(Mat4) == 64 && alignof(Mat4) == 16, "std140 mat4 must be 64 bytes, aligned to 16");
+
+}
+
+}
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "Mesh.hpp"
+#include "MeshOptimizer.hpp"
 
 namespace midnight
 {
@@ -25,14 +26,33 @@ namespace spi
     
 namespace io
 {     
-    midnight::Mesh loadMesh(const std::string& fileName)
+    /**
+     * Loads a Mesh through the first provider that handles the extension of the file, and
+     * optimizes it for the post-transform vertex cache, overdraw and vertex fetch
+     *
+     * @param fileName the file to load
+     *
+     * @param report receives the cache statistics of the Mesh before and after optimization
+     * (nullptr if they are of no interest)
+     *
+     * @return the optimized Mesh
+     *
+     */
+    midnight::Mesh loadMesh(const std::string& fileName, MeshOptimizer::Report* report = nullptr)
     {
         std::string extension = fileName.substr(fileName.find_last_of("."));
         for(auto provider : spi::meshProviders)
         {
             if(provider->isLoadableExtension(extension))
             {
-                return provider->loadMesh(fileName);
+                /// Loaders emit indices in file order, which is rarely GPU friendly
+                midnight::Mesh mesh = provider->loadMesh(fileName);
+                const MeshOptimizer::Report optimized = MeshOptimizer().optimize(mesh);
+                if(report != nullptr)
+                {
+                    *report = optimized;
+                }
+                return mesh;
             }
         }
         throw std::runtime_error("No known provider for " + extension + " format");
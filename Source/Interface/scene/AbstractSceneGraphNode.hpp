@@ -5,11 +5,26 @@
 
 namespace midnight
 {
+    /**
+     * The common implementation of scene graph nodes: holds the children, caches the bounds of
+     * the subtree, and renders the children whose bounds intersect the view.
+     * 
+     * Nodes that draw must declare the bounds of what they draw through setLocalBounds(), as
+     * nodes with empty bounds are culled.
+     * 
+     */
     class AbstractSceneGraphNode : public SceneGraphNode
     {
         /// The children of this node
         std::vector<std::shared_ptr<SceneGraphNode>> children;
 
+        /// The bounds of what this node draws itself
+        BoundingBoxF localBounds;
+
+        /// The bounds of the subtree, computed on demand
+        BoundingBoxF bounds;
+        bool boundsValid;
+
         protected:
 
           /**
@@ -19,6 +34,38 @@ namespace midnight
            * 
            */
           const std::vector<std::shared_ptr<SceneGraphNode>>& getChildren() const override;
+
+          /**
+           * Sets the bounds of what this node draws itself, in the space it is rendered in
+           * 
+           * @param localBounds the bounds of the geometry of this node
+           * 
+           */
+          void setLocalBounds(const BoundingBoxF& localBounds);
+
+          /**
+           * Computes the bounds of the subtree.  Nodes that transform their children override
+           * this to transform the result.
+           * 
+           * @return the local bounds merged with the bounds of every child
+           * 
+           */
+          virtual BoundingBoxF computeBounds();
+
+          /**
+           * Discards the cached bounds of this node and of its ancestors
+           * 
+           */
+          void invalidateBounds() override;
+
+          /**
+           * Queries whether any child is pickable, which makes a node that only transforms its
+           * children pickable
+           * 
+           * @return true if a child is pickable, otherwise false
+           * 
+           */
+          bool hasPickableChildren();
     
         public:
 
@@ -26,7 +73,10 @@ namespace midnight
            * Default constructor
            * 
            */
-          AbstractSceneGraphNode() = default;
+          AbstractSceneGraphNode();
+
+          AbstractSceneGraphNode(const AbstractSceneGraphNode&) = delete;
+          AbstractSceneGraphNode& operator=(const AbstractSceneGraphNode&) = delete;
 
           /**
            * Adds the provided child to this node
@@ -37,7 +87,17 @@ namespace midnight
           virtual void add(std::shared_ptr<SceneGraphNode> child) override;
 
           /**
-           * Renders this node
+           * Retrieves the bounds of this node and its descendants, recomputing them only after
+           * a change within the subtree
+           * 
+           * @return the bounds of the subtree
+           * 
+           */
+          const BoundingBoxF& getBounds() override;
+
+          /**
+           * Renders the children of this node that intersect the view of the active
+           * FrameUniforms
            * 
            * @param camera the Camera to render this node with
            * 
@@ -45,13 +105,30 @@ namespace midnight
           virtual void render(const Camera& camera) override;
 
           /**
-           * Default virtual destructor
+           * Finds where a Ray crosses the nearest of the pickable children whose bounds it
+           * enters, in the space the children are rendered in.  The bounds must be up to date
+           * (as they are after rendering, or after getBounds()), since picking does not
+           * recompute them.
+           * 
+           * @param ray the Ray to cast
+           * 
+           * @param maximum the distance beyond which hits are ignored
+           * 
+           * @param hit receives the nearest hit, whose node is the child or descendant hit
+           * 
+           * @return true if the Ray hits a child no further than the maximum, otherwise false
+           * 
+           */
+          virtual bool intersect(const Ray& ray, float maximum, SurfaceHit& hit) override;
+
+          /**
+           * Detaches this node from its children
            * 
            */
-          virtual ~AbstractSceneGraphNode() = default;
+          virtual ~AbstractSceneGraphNode();
     };
 }
 
 #include "AbstractSceneGraphNode.inl"
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,201 @@
+#ifndef BATCH_RENDERER_HPP
+#define BATCH_RENDERER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "GeometryArena.hpp"
+#include "Matrix.hpp"
+#include "Platform.hpp"
+#include "Program.hpp"
+
+namespace midnight
+{
+
+    /**
+     * Collects the draws of a frame and submits every group of draws that shares a Program and a
+     * GeometryArena with a single glMultiDrawElementsIndirect call.
+     *
+     * The transform of every draw is written to a shader storage buffer bound at
+     * DRAW_DATA_BINDING.  Each indirect command carries its position within the batch as its base
+     * instance, and a vertex attribute named "draw_id" (with a divisor of one) is fed from an
+     * identity buffer, so that shaders can index the storage buffer without
+     * ARB_shader_draw_parameters:
+     * <pre>
+     *  in uint draw_id;
+     *  layout(std430, binding = 0) readonly buffer DrawData { mat4 transforms[]; };
+     *  ...
+     *  vec4 world = vec4(position, 1.0) * transforms[draw_id];
+     * </pre>
+     *
+     * RenderQueue submits the draws queued with a world transform (such as those of MeshNodes in
+     * a GeometryArena) through a BatchRenderer.
+     *
+     * @note Requires OpenGL 4.3 (multi-draw indirect and shader storage buffers)
+     *
+     */
+    class BatchRenderer
+    {
+      public:
+
+        /**
+         * The layout of a single indirect draw, as consumed by glMultiDrawElementsIndirect
+         *
+         */
+        struct DrawElementsIndirectCommand
+        {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint firstIndex;
+            GLint baseVertex;
+            GLuint baseInstance;
+        };
+
+        /**
+         * The cost of the most recent flush
+         *
+         */
+        struct Statistics
+        {
+            /// The number of multi-draw calls issued
+            std::size_t batches;
+
+            /// The number of draws contained in those calls
+            std::size_t draws;
+
+            /// The CPU time spent building and submitting the batches
+            double submissionMilliseconds;
+
+            Statistics() : batches(0), draws(0), submissionMilliseconds(0.0)
+            {
+
+            }
+        };
+
+        /// The shader storage binding point of the per-draw transforms
+        static constexpr GLuint DRAW_DATA_BINDING = 0;
+
+      private:
+
+        /**
+         * The draws that share a Program and a GeometryArena
+         *
+         */
+        struct Batch
+        {
+            Program* program;
+            GeometryArena* arena;
+            std::vector<DrawElementsIndirectCommand> commands;
+            std::vector<GLfloat> transforms;
+        };
+
+        /// The batches of the current frame, in order of first submission
+        std::vector<Batch> batches;
+
+        /// The number of batches of the current frame that hold draws (the rest are recycled)
+        std::size_t activeBatches;
+
+        /// The implementation provided handle to the indirect command storage
+        GLuint commandBuffer;
+
+        /// The implementation provided handle to the per-draw transform storage
+        GLuint drawDataBuffer;
+
+        /// The implementation provided handle to the 0, 1, 2, ... draw id storage
+        GLuint drawIdBuffer;
+
+        /// The number of draws the buffers above can currently hold
+        std::size_t capacity;
+
+        /// The cost of the most recent flush
+        Statistics statistics;
+
+      public:
+
+        /**
+         * Constructs a BatchRenderer
+         *
+         * @param initialCapacity the number of draws per batch to reserve storage for
+         *
+         */
+        explicit BatchRenderer(std::size_t initialCapacity = 1024);
+
+        /**
+         * BatchRenderers are not copy-constructible
+         *
+         */
+        BatchRenderer(const BatchRenderer&) = delete;
+
+        /**
+         * BatchRenderers are not copy-assignable
+         *
+         */
+        BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+        /**
+         * Cleans up the GPU resources that were allocated by this BatchRenderer
+         *
+         */
+        ~BatchRenderer();
+
+        /**
+         * Queues a draw for the next flush
+         *
+         * @param program the Program to draw with (must outlive the flush)
+         *
+         * @param arena the GeometryArena that holds the mesh (must outlive the flush)
+         *
+         * @param mesh the mesh to draw
+         *
+         * @param transform the per-draw transform exposed to the shader
+         *
+         * @param firstIndex the first index of the mesh to draw (e.g. of a level of detail)
+         *
+         * @param indexCount the number of indices to draw (zero to draw the whole mesh)
+         *
+         * @throws IllegalArgumentException if the handle does not refer to a live mesh
+         *
+         */
+        void submit(Program& program, GeometryArena& arena, GeometryArena::Handle mesh, const Matrix4x4F& transform,
+                std::uint32_t firstIndex = 0, std::uint32_t indexCount = 0);
+
+        /**
+         * Submits every queued draw, one glMultiDrawElementsIndirect per batch, and clears the queue
+         *
+         * @throws BindException if a Program cannot be bound
+         *
+         * @throws ResourceException if the implementation fails to grow the batch storage
+         *
+         */
+        void flush();
+
+        /**
+         * Retrieves the cost of the most recent flush
+         *
+         * @return the Statistics of the most recent flush
+         *
+         */
+        const Statistics& getStatistics() const noexcept;
+
+        /**
+         * Queries whether the current context can submit batched draws (OpenGL 4.3 or later)
+         *
+         * @return true if a BatchRenderer can be used, otherwise false
+         *
+         */
+        static bool isSupported() noexcept;
+
+      private:
+
+        /**
+         * Grows the batch storage to hold at least the provided number of draws
+         *
+         */
+        void reserve(std::size_t draws);
+    };
+
+}
+
+#include "BatchRenderer.inl"
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef COMMAND_LISTS_HPP
+#define COMMAND_LISTS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "parallel_for.hpp"
+
+namespace midnight
+{
+
+    /**
+     * The commands recorded by the workers of a parallel traversal, one list per worker.  Each
+     * worker appends to its own list without synchronization; the lists are then replayed, in
+     * order, on the thread that owns the context.
+     *
+     * Lists keep their storage across frames, so that recording allocates nothing once the
+     * lists have grown to the size of a frame.
+     *
+     * @tparam Command the type of a recorded command (e.g. the parameters of a draw)
+     *
+     */
+    template<typename Command>
+    class CommandLists
+    {
+        std::vector<std::vector<Command>> lists;
+
+      public:
+
+        /**
+         * Constructs empty CommandLists
+         *
+         * @param count the number of lists, and so the number of ranges a traversal is split into
+         *
+         * @throws IllegalArgumentException if the count is zero
+         *
+         */
+        explicit CommandLists(std::size_t count = hardwareConcurrency());
+
+        /**
+         * Empties every list, keeping its storage
+         *
+         */
+        void clear() noexcept;
+
+        /**
+         * Retrieves the number of lists
+         *
+         * @return the number of lists
+         *
+         */
+        std::size_t getListCount() const noexcept;
+
+        /**
+         * Retrieves a list
+         *
+         * @param index the index of the list
+         *
+         * @return the list
+         *
+         */
+        std::vector<Command>& getList(std::size_t index) noexcept;
+        const std::vector<Command>& getList(std::size_t index) const noexcept;
+
+        /**
+         * Retrieves the number of commands in every list
+         *
+         * @return the number of commands
+         *
+         */
+        std::size_t getCommandCount() const noexcept;
+
+        /**
+         * Invokes the provided function for every command, list after list, on the calling
+         * thread
+         *
+         * @param function a callable that accepts a const Command&
+         *
+         */
+        template<typename F>
+        void replay(F function) const;
+    };
+
+}
+
+#include "CommandLists.inl"
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef FLAT_SCENE_GRAPH_HPP
+#define FLAT_SCENE_GRAPH_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "CommandLists.hpp"
+#include "Frustum.hpp"
+#include "Matrix.hpp"
+
+namespace midnight
+{
+
+    /**
+     * A scene hierarchy stored as parallel arrays rather than linked nodes.  Nodes are kept in
+     * depth-first order, so every parent precedes its children and every subtree is a contiguous
+     * range.  Updating world transforms and traversing are then single linear passes without
+     * pointer chasing, reference counting or virtual calls.
+     *
+     * update() only recomputes the subtrees of nodes whose transform or bounds changed since the
+     * previous update, so a mostly static hierarchy costs next to nothing per frame.  Along with
+     * the world bounds of each node, it maintains the bounds of each subtree, which let a
+     * Frustum traversal skip a subtree with a single test.
+     *
+     * Nodes are referred to by generational Handles, which remain stable while nodes move within
+     * the arrays and become invalid once their node is destroyed.
+     *
+     * A FlatSceneGraph knows nothing about rendering: each node carries an opaque Renderable id,
+     * which the owner maps to whatever it draws.  It coexists with the SceneGraphNode hierarchy
+     * rather than replacing it.
+     *
+     * Transforms follow the row-vector convention of the shaders: the world transform of a node
+     * is its local transform followed by the world transform of its parent.
+     *
+     */
+    class FlatSceneGraph
+    {
+      public:
+
+        /// Identifies what a node draws (NO_RENDERABLE if nothing)
+        typedef std::uint32_t Renderable;
+
+        static constexpr Renderable NO_RENDERABLE = std::numeric_limits<std::uint32_t>::max();
+
+        /**
+         * A stable reference to a node of a FlatSceneGraph.  A default-constructed Handle refers
+         * to no node, and is used as the parent of root nodes.
+         *
+         */
+        struct Handle
+        {
+            std::uint32_t index;
+            std::uint32_t generation;
+
+            Handle() noexcept : index(std::numeric_limits<std::uint32_t>::max()), generation(0)
+            {
+
+            }
+
+            Handle(std::uint32_t index, std::uint32_t generation) noexcept : index(index), generation(generation)
+            {
+
+            }
+
+            bool operator==(const Handle& rhs) const noexcept
+            {
+                return index == rhs.index && generation == rhs.generation;
+            }
+
+            bool operator!=(const Handle& rhs) const noexcept
+            {
+                return !(*this == rhs);
+            }
+        };
+
+      private:
+
+        /// Marks the parent of a root, and the slot of a destroyed node
+        static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+        /// The position of each node's parent (NONE for roots), in depth-first order
+        std::vector<std::uint32_t> parents;
+
+        /// The number of nodes in each node's subtree, including the node itself
+        std::vector<std::uint32_t> subtreeSizes;
+
+        std::vector<Matrix4x4F> localTransforms;
+        std::vector<Matrix4x4F> worldTransforms;
+        std::vector<BoundingBoxF> localBounds;
+        std::vector<BoundingBoxF> worldBounds;
+
+        /// The world bounds of each node merged with those of its descendants
+        std::vector<BoundingBoxF> subtreeBounds;
+        std::vector<Renderable> renderables;
+
+        /// The handle index of the node at each position
+        std::vector<std::uint32_t> owners;
+
+        /// The position of the node of each handle index (NONE once destroyed)
+        std::vector<std::uint32_t> slots;
+
+        /// The current generation of each handle index
+        std::vector<std::uint32_t> generations;
+
+        /// Handle indices that may be reused
+        std::vector<std::uint32_t> releasedHandles;
+
+        /// The handle indices of the nodes changed since the last update, and whether each
+        /// handle index is among them
+        std::vector<std::uint32_t> dirtyNodes;
+        std::vector<std::uint8_t> queued;
+
+        /// The handle indices of the nodes that lost a descendant since the last update
+        std::vector<std::uint32_t> shrunkNodes;
+
+        /// Scratch storage for update()
+        std::vector<std::uint32_t> dirtyPositions;
+        std::vector<std::uint32_t> refitPositions;
+        std::vector<std::uint8_t> refitting;
+
+      public:
+
+        /**
+         * Constructs an empty FlatSceneGraph
+         *
+         */
+        FlatSceneGraph() = default;
+
+        /**
+         * Reserves storage for the provided number of nodes
+         *
+         * @param nodes the number of nodes to reserve storage for
+         *
+         */
+        void reserve(std::size_t nodes);
+
+        /**
+         * Creates a node as the last child of the provided parent.  Appending to the last
+         * subtree (e.g. building the hierarchy depth-first) is O(depth); inserting elsewhere
+         * moves every node behind the insertion point.
+         *
+         * @param parent the parent of the new node, or Handle() for a root
+         *
+         * @param localTransform the transform of the new node relative to its parent
+         *
+         * @param localBounds the bounds of the new node in its own space (empty if none)
+         *
+         * @param renderable what the new node draws
+         *
+         * @return the Handle of the new node
+         *
+         * @throws IllegalArgumentException if the parent is neither Handle() nor a valid Handle
+         *
+         */
+        Handle create(Handle parent, const Matrix4x4F& localTransform = Matrix4x4F::IDENTITY(),
+                const BoundingBoxF& localBounds = BoundingBoxF(), Renderable renderable = NO_RENDERABLE);
+
+        /**
+         * Destroys a node along with its entire subtree
+         *
+         * @param node the node to destroy
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void destroy(Handle node);
+
+        /**
+         * Queries whether a Handle refers to a live node
+         *
+         * @param node the Handle to test
+         *
+         * @return true if the node has not been destroyed, otherwise false
+         *
+         */
+        bool isValid(Handle node) const noexcept;
+
+        /**
+         * Retrieves the parent of a node
+         *
+         * @param node the node
+         *
+         * @return the parent, or Handle() for a root
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        Handle getParent(Handle node) const;
+
+        /**
+         * Replaces the local transform of a node.  World transforms follow on the next update.
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void setLocalTransform(Handle node, const Matrix4x4F& localTransform);
+
+        /**
+         * Replaces the local bounds of a node.  World bounds follow on the next update.
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void setLocalBounds(Handle node, const BoundingBoxF& localBounds);
+
+        /**
+         * Replaces what a node draws
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void setRenderable(Handle node, Renderable renderable);
+
+        /// The state of a node (world transforms and bounds as of the last update)
+        const Matrix4x4F& getLocalTransform(Handle node) const;
+        const Matrix4x4F& getWorldTransform(Handle node) const;
+        const BoundingBoxF& getWorldBounds(Handle node) const;
+        const BoundingBoxF& getSubtreeBounds(Handle node) const;
+        Renderable getRenderable(Handle node) const;
+
+        /**
+         * Retrieves the number of live nodes
+         *
+         * @return the number of nodes
+         *
+         */
+        std::size_t getNodeCount() const noexcept;
+
+        /**
+         * Recomputes the world transforms and world bounds of the nodes that changed since the
+         * last update, along with their subtrees
+         *
+         * @return the number of nodes that were recomputed
+         *
+         */
+        std::size_t update();
+
+        /**
+         * Visits every node in depth-first order.  The visitor is invoked as
+         * visitor(renderable, worldTransform, worldBounds) and returns whether to descend into
+         * the children of the node, so that whole subtrees may be skipped.
+         *
+         * @param visitor the visitor to invoke
+         *
+         */
+        template<typename Visitor>
+        void traverse(Visitor&& visitor) const;
+
+        /**
+         * Visits the nodes that intersect a Frustum, in depth-first order.  A subtree whose
+         * bounds lie outside of the Frustum is skipped with a single test, and the planes a
+         * subtree lies entirely inside of are not tested again for its descendants.  The visitor
+         * is invoked as visitor(renderable, worldTransform) for each visible node that has a
+         * Renderable.
+         *
+         * @param frustum the view volume, in world space
+         *
+         * @param visitor the visitor to invoke
+         *
+         * @return the number of nodes visited and culled
+         *
+         */
+        template<typename Visitor>
+        CullingStatistics traverse(const Frustum& frustum, Visitor&& visitor) const;
+
+        /**
+         * Visits the nodes that intersect a Frustum on worker threads, recording commands into
+         * CommandLists.  The nodes are split into one contiguous range per list, each of which
+         * is traversed as by the Frustum traverse() and records into its own list, so that
+         * replaying the lists in order yields the commands in depth-first order.  The generator
+         * is invoked as generator(renderable, worldTransform, list) for each visible node that
+         * has a Renderable, concurrently for different lists.
+         *
+         * @param frustum the view volume, in world space
+         *
+         * @param lists the CommandLists to record into (cleared first)
+         *
+         * @param generator the generator to invoke
+         *
+         * @return the number of nodes visited and culled
+         *
+         */
+        template<typename Command, typename Generator>
+        CullingStatistics traverse(const Frustum& frustum, CommandLists<Command>& lists, Generator generator) const;
+
+      private:
+
+        /**
+         * Visits the nodes of a range of positions that intersect a Frustum.  A range that
+         * starts within a subtree first classifies the ancestors of its first node, so the
+         * ranges of a split traversal visit and count each node exactly as a single one would.
+         *
+         * @param frustum the view volume, in world space
+         *
+         * @param begin the first position
+         *
+         * @param end one past the last position
+         *
+         * @param visitor invoked as visitor(renderable, worldTransform)
+         *
+         * @return the number of nodes of the range visited and culled
+         *
+         */
+        template<typename Visitor>
+        CullingStatistics traverseRange(const Frustum& frustum, std::size_t begin, std::size_t end, Visitor& visitor) const;
+
+        /**
+         * Queues a node (by handle index) for the next update
+         *
+         */
+        void markDirty(std::uint32_t index);
+
+        /**
+         * Retrieves the position of a valid node
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        std::uint32_t positionOf(Handle node) const;
+    };
+
+}
+
+#include "FlatSceneGraph.inl"
+
+#endif
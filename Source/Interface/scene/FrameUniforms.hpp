@@ -0,0 +1,393 @@
+#ifndef FRAME_UNIFORMS_HPP
+#define FRAME_UNIFORMS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "Camera.hpp"
+#include "Color.hpp"
+#include "Frustum.hpp"
+#include "Matrix.hpp"
+#include "OcclusionBuffer.hpp"
+#include "Program.hpp"
+#include "Std140.hpp"
+#include "UniformRing.hpp"
+#include "Vector.hpp"
+
+namespace midnight
+{
+
+    /**
+     * The data shared by every draw of a frame, mirroring the FrameUniforms block of GLSL_BLOCKS
+     *
+     * Matrices follow the row-vector convention of the engine's shaders (vec4 * matrix).
+     *
+     */
+    struct FrameData
+    {
+        glsl::std140::Mat4 view;
+        glsl::std140::Mat4 projection;
+        glsl::std140::Mat4 viewProjection;
+
+        /// The w component is always one
+        glsl::std140::Vec4 cameraPosition;
+
+        glsl::std140::Vec4 ambientColor;
+
+        /// The direction the light travels in (w is always zero)
+        glsl::std140::Vec4 lightDirection;
+        glsl::std140::Vec4 lightColor;
+    };
+
+    /**
+     * The data of a single draw, mirroring the ObjectUniforms block of GLSL_BLOCKS.  The model
+     * transform of the draw is folded into both matrices.
+     *
+     */
+    struct ObjectData
+    {
+        glsl::std140::Mat4 modelView;
+        glsl::std140::Mat4 modelViewProjection;
+    };
+
+    static_assert(offsetof(FrameData, projection) == 64 && offsetof(FrameData, cameraPosition) == 192 &&
+            offsetof(FrameData, lightColor) == 240 && sizeof(FrameData) == 256, "FrameData does not match its std140 block");
+    static_assert(offsetof(ObjectData, modelViewProjection) == 64 && sizeof(ObjectData) == 128, "ObjectData does not match its std140 block");
+
+    /**
+     * Feeds the camera and lighting of a frame to every program through uniform buffers rather
+     * than per-program uniforms.
+     *
+     * begin() writes the FrameData and binds it to FRAME_BINDING once.  Nodes then call
+     * bindObject() before each draw, which writes an ObjectData into a ring-buffered uniform
+     * buffer and binds it to OBJECT_BINDING, a single glBindBufferRange per draw.
+     *
+     * The view and view-projection are computed once per frame.  Transform nodes (Translation,
+     * Rotation) push their cached local matrices onto a stack while their children render.  The
+     * ObjectData of a transform is computed on its first draw and shared by the draws after it,
+     * so draws outside of any transform, or beside a sibling, cost no matrix products at all.
+     *
+     * Nodes are culled against the view through enter() and leave(), which test bounds in the
+     * space of the innermost transform.  The planes a node lies entirely inside of are not tested
+     * again for its descendants.  Nodes inside of the view may further be tested against an
+     * OcclusionBuffer, rasterized from the occluders of the frame.
+     *
+     * Shaders declare the blocks by inserting GLSL_BLOCKS after their #version directive, and
+     * are connected to the binding points by attach().
+     *
+     */
+    class FrameUniforms
+    {
+        UniformRing ring;
+
+        FrameData frame;
+
+        /// The matrices of the current frame, reused by every object
+        Matrix4x4F view;
+        Matrix4x4F projection;
+        Matrix4x4F viewProjection;
+
+        /// A transform pushed by a transform node, and the ObjectData and Frustum derived from it
+        struct Transform
+        {
+            Matrix4x4F world;
+            ObjectData object;
+
+            /// The transform from the space of this transform into clip space
+            Matrix4x4F clip;
+
+            /// The view volume in the space of this transform
+            Frustum frustum;
+
+            /// Whether the ObjectData and the Frustum have been computed
+            bool derived;
+        };
+
+        /// The enclosing transforms (the last is the innermost)
+        std::vector<Transform> transforms;
+
+        /// The view volume in world space
+        Frustum frustum;
+
+        /// The planes left to test for the descendants of each entered node
+        std::vector<std::uint32_t> planeMasks;
+
+        /// The occluders that hide nodes within the view volume (none if null)
+        const OcclusionBuffer* occlusion;
+
+        CullingStatistics statistics;
+
+        /// The uniform updates of every Program during the last complete frame
+        Program::UniformStatistics uniformStatistics;
+
+        Color4F ambientColor;
+        Vector3F lightDirection;
+        Color4F lightColor;
+
+      public:
+
+        /// The uniform buffer binding point of the FrameUniforms block
+        static constexpr GLuint FRAME_BINDING = 0;
+
+        /// The uniform buffer binding point of the ObjectUniforms block
+        static constexpr GLuint OBJECT_BINDING = 1;
+
+        /// The GLSL declarations of both blocks (requires #version 150 for the instance names).  A constant expression,
+        /// so that it is initialized before the shader sources that embed it and defined in every translation unit
+        static constexpr const char* GLSL_BLOCKS =
+            "layout(std140) uniform FrameUniforms\n\
+            {\n\
+                mat4 view;\n\
+                mat4 projection;\n\
+                mat4 view_projection;\n\
+                vec4 camera_position;\n\
+                vec4 ambient_color;\n\
+                vec4 light_direction;\n\
+                vec4 light_color;\n\
+            } frame;\n\
+            layout(std140) uniform ObjectUniforms\n\
+            {\n\
+                mat4 model_view;\n\
+                mat4 model_view_projection;\n\
+            } object;\n";
+
+        /**
+         * Constructs FrameUniforms
+         *
+         * @param objectsPerFrame the largest number of draws a frame may bind objects for
+         *
+         * @param framesInFlight the number of frames the GPU may lag behind
+         *
+         * @throws ResourceException if the implementation fails to allocate the uniform buffer
+         *
+         */
+        explicit FrameUniforms(std::size_t objectsPerFrame = 4096, std::size_t framesInFlight = 3);
+
+        FrameUniforms(const FrameUniforms&) = delete;
+        FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+        ~FrameUniforms();
+
+        /**
+         * Sets the ambient light of the following frames
+         *
+         * @param color the color of the ambient light
+         *
+         */
+        void setAmbientLight(const Color4F& color) noexcept;
+
+        /**
+         * Sets the directional light of the following frames
+         *
+         * @param direction the direction the light travels in
+         *
+         * @param color the color of the light
+         *
+         */
+        void setDirectionalLight(const Vector3F& direction, const Color4F& color) noexcept;
+
+        /**
+         * Starts a frame: uploads and binds the FrameData of the provided Camera, and makes these
+         * FrameUniforms the active ones
+         *
+         * @param camera the Camera the frame is rendered from
+         *
+         */
+        void begin(const Camera& camera);
+
+        /**
+         * Uploads and binds the ObjectData of the next draw, transformed by the enclosing
+         * transform nodes
+         *
+         * @throws ResourceException if the frame has exhausted its objects
+         *
+         */
+        void bindObject();
+
+        /**
+         * Uploads and binds the ObjectData of the next draw, given its world transform (e.g. from
+         * a FlatSceneGraph).  The enclosing transform nodes are ignored.
+         *
+         * @param world the transform from the object's space to world space
+         *
+         * @throws ResourceException if the frame has exhausted its objects
+         *
+         */
+        void bindObject(const Matrix4x4F& world);
+
+        /**
+         * Uploads and binds the ObjectData of the next draw, seen from a Camera other than the
+         * one of the frame.  This recomputes the view, so prefer bindObject() where possible.
+         *
+         * @param camera the Camera the node renders with
+         *
+         * @throws ResourceException if the frame has exhausted its objects
+         *
+         */
+        void bindObject(const Camera& camera);
+
+        /**
+         * Writes the ObjectData of a later draw, transformed by the enclosing transform nodes,
+         * without binding it (e.g. for a draw that is queued and sorted before submission)
+         *
+         * @return the offset of the ObjectData, for bindObjectAt()
+         *
+         * @throws ResourceException if the frame has exhausted its objects
+         *
+         */
+        std::size_t writeObject();
+
+        /**
+         * Binds an ObjectData written by writeObject() during the current frame
+         *
+         * @param offset the offset returned by writeObject()
+         *
+         */
+        void bindObjectAt(std::size_t offset) noexcept;
+
+        /**
+         * Computes the distance of a node from the viewer, as the clip space w of the center of
+         * its bounds
+         *
+         * @param bounds the bounds of the node, in the space of the innermost transform
+         *
+         * @return the distance along the view direction (negative behind the viewer)
+         *
+         */
+        float computeDepth(const BoundingBoxF& bounds);
+
+        /**
+         * Retrieves the transform of the enclosing transform nodes, from the space of the
+         * innermost transform to world space
+         *
+         * @return the world transform (the identity outside of any transform)
+         *
+         */
+        Matrix4x4F getWorldTransform() const noexcept;
+
+        /**
+         * Applies a transform to the draws that follow, until the matching popTransform()
+         *
+         * @param local the transform relative to the enclosing transforms
+         *
+         */
+        void pushTransform(const Matrix4x4F& local);
+
+        /**
+         * Reverts the last pushTransform()
+         *
+         */
+        void popTransform() noexcept;
+
+        /**
+         * Tests whether a node intersects the view, and is not hidden by the OcclusionBuffer,
+         * before it is rendered.  If so, the node must be followed by a matching leave() once it
+         * has been rendered.
+         *
+         * @param bounds the bounds of the node and its descendants, in the space of the
+         * innermost transform
+         *
+         * @return true if the node must be rendered, false if it was culled or occluded
+         *
+         */
+        bool enter(const BoundingBoxF& bounds);
+
+        /**
+         * Sets the OcclusionBuffer that enter() tests nodes against, which must be rasterized
+         * from the view of the frame
+         *
+         * @param occlusion the OcclusionBuffer, or nullptr to test against the view alone
+         *
+         */
+        void setOcclusionBuffer(const OcclusionBuffer* occlusion) noexcept;
+
+        /**
+         * Reverts the last successful enter()
+         *
+         */
+        void leave() noexcept;
+
+        /**
+         * Retrieves the number of nodes entered, culled and occluded in the current (or last)
+         * frame.  A culled or occluded node counts once, however large its subtree.
+         *
+         * @return the CullingStatistics
+         *
+         */
+        const CullingStatistics& getCullingStatistics() const noexcept;
+
+        /**
+         * Retrieves the uniform updates that every Program issued and skipped between the last
+         * begin() and end()
+         *
+         * @return the UniformStatistics of the last complete frame
+         *
+         */
+        const Program::UniformStatistics& getUniformStatistics() const noexcept;
+
+        /**
+         * Ends the frame started by begin()
+         *
+         */
+        void end();
+
+        /**
+         * Retrieves the FrameData of the current (or last) frame
+         *
+         * @return the FrameData
+         *
+         */
+        const FrameData& getFrameData() const noexcept;
+
+        /**
+         * Connects the blocks that the provided Program declares to their binding points
+         *
+         * @param program the Program to connect
+         *
+         */
+        static void attach(Program& program);
+
+        /**
+         * Retrieves the FrameUniforms whose frame is being rendered
+         *
+         * @return the active FrameUniforms
+         *
+         * @throws BindException if no frame is being rendered
+         *
+         */
+        static FrameUniforms& getActive();
+
+        /**
+         * Computes the view of the provided Camera in the engine's row-vector convention
+         *
+         * @param camera the Camera to compute the view of
+         *
+         * @return the translation by the Camera's position followed by its orientation
+         *
+         */
+        static Matrix4x4F computeView(const Camera& camera) noexcept;
+
+      private:
+
+        /**
+         * Computes the ObjectData and the Frustum of the innermost transform, if not done yet
+         *
+         * @return the innermost transform
+         *
+         */
+        Transform& derive();
+
+        /**
+         * The storage of the active FrameUniforms (render thread only)
+         *
+         */
+        static FrameUniforms*& active() noexcept;
+    };
+
+}
+
+#include "FrameUniforms.inl"
+
+#endif
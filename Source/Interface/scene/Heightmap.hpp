@@ -82,6 +82,11 @@ namespace midnight
         {
             return samples[index];
         }
+
+        const_reference operator[](std::size_t index) const
+        {
+            return samples[index];
+        }
         
 /*        template<typename T>
         T interpolate(const Point<T, 2>& point)
@@ -0,0 +1,212 @@
+#ifndef INSTANCED_MESH_NODE_HPP
+#define INSTANCED_MESH_NODE_HPP
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AbstractSceneGraphNode.hpp"
+#include "Color.hpp"
+#include "FrameUniforms.hpp"
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include "Platform.hpp"
+#include "Program.hpp"
+#include "ProgramRegistry.hpp"
+
+namespace midnight
+{
+
+    /**
+     * Renders any number of copies of a single Mesh with one glDrawElementsInstanced per
+     * Renderable.  Every instance carries its own transform and color, which are streamed to the
+     * GPU as per-instance vertex attributes.
+     *
+     * Instances are stored densely; removing one moves the last instance into its slot.  Only the
+     * range of slots that changed since the previous frame is uploaded.
+     *
+     */
+    class InstancedMeshNode : public AbstractSceneGraphNode
+    {
+      public:
+
+        /// Identifies an instance of an InstancedMeshNode
+        typedef std::size_t InstanceHandle;
+
+      private:
+
+        /**
+         * The per-instance attributes, laid out exactly as they are uploaded
+         *
+         */
+        struct InstanceData
+        {
+            GLfloat transform[16];
+            GLfloat color[4];
+        };
+
+        /// The Mesh that is instanced
+        Mesh mesh;
+
+        /// The bounds of the Mesh, before any instance transform
+        BoundingBoxF meshBounds;
+
+        std::shared_ptr<Program> program;
+
+        /// The implementation provided handles to the vertex array and its storage
+        GLuint vertexArray;
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+        GLuint instanceBuffer;
+
+        /// The offset (in indices) and size of every Renderable within the index storage
+        std::vector<std::pair<std::size_t, GLsizei>> ranges;
+
+        /// The densely packed instance data
+        std::vector<InstanceData> instances;
+
+        /// The handle of the instance in each slot
+        std::vector<InstanceHandle> slotHandles;
+
+        /// The slot of each handle (or RELEASED)
+        std::vector<std::size_t> handleSlots;
+
+        /// Handles that may be reused
+        std::vector<InstanceHandle> releasedHandles;
+
+        /// The number of instances the instance storage can hold
+        std::size_t capacity;
+
+        /// The range of slots that must be uploaded before the next draw
+        std::size_t dirtyBegin;
+        std::size_t dirtyEnd;
+
+        static constexpr std::size_t RELEASED = std::numeric_limits<std::size_t>::max();
+
+
+      public:
+
+        /**
+         * Constructs an InstancedMeshNode without any instances
+         *
+         * @param mesh the Mesh to instance
+         *
+         * @param initialCapacity the number of instances to reserve storage for
+         *
+         * @throws ResourceException if the implementation fails to allocate the storage
+         *
+         */
+        explicit InstancedMeshNode(const Mesh& mesh, std::size_t initialCapacity = 64);
+
+        InstancedMeshNode(const InstancedMeshNode&) = delete;
+        InstancedMeshNode& operator=(const InstancedMeshNode&) = delete;
+
+        virtual ~InstancedMeshNode();
+
+        /**
+         * Adds an instance
+         *
+         * @param transform the transform of the new instance
+         *
+         * @param color the color of the new instance
+         *
+         * @return a handle to the new instance
+         *
+         */
+        InstanceHandle addInstance(const Matrix4x4F& transform, const Color4F& color = Color4F(1.0f, 1.0f, 1.0f, 1.0f));
+
+        /**
+         * Removes an instance
+         *
+         * @param instance the instance to remove
+         *
+         * @throws IllegalArgumentException if the handle does not refer to a live instance
+         *
+         */
+        void removeInstance(InstanceHandle instance);
+
+        /**
+         * Updates the transform of an instance
+         *
+         * @param instance the instance to update
+         *
+         * @param transform the new transform
+         *
+         * @throws IllegalArgumentException if the handle does not refer to a live instance
+         *
+         */
+        void setTransform(InstanceHandle instance, const Matrix4x4F& transform);
+
+        /**
+         * Updates the color of an instance
+         *
+         * @param instance the instance to update
+         *
+         * @param color the new color
+         *
+         * @throws IllegalArgumentException if the handle does not refer to a live instance
+         *
+         */
+        void setColor(InstanceHandle instance, const Color4F& color);
+
+        /**
+         * Retrieves the number of live instances
+         *
+         * @return the number of live instances
+         *
+         */
+        std::size_t getInstanceCount() const noexcept;
+
+        virtual void render(const Camera& camera) override;
+
+        /**
+         * Instances are not pickable, as picking would test the Mesh once per instance
+         *
+         */
+        virtual bool isPickable() override
+        {
+            return false;
+        }
+
+      protected:
+
+        /**
+         * Computes the bounds of every instance, along with those of the children
+         *
+         */
+        virtual BoundingBoxF computeBounds() override;
+
+      private:
+
+        /**
+         * Retrieves the slot of a live instance
+         *
+         */
+        std::size_t slotOf(InstanceHandle instance) const;
+
+        /**
+         * Widens the dirty range to include the provided slot
+         *
+         */
+        void markDirty(std::size_t slot) noexcept;
+
+        /**
+         * Uploads the dirty range, growing the instance storage if required
+         *
+         */
+        void upload();
+
+        /**
+         * Retrieves the sources of the shaders, built on first use
+         *
+         */
+        static const std::string& getVertexShaderSource();
+        static const std::string& getFragmentShaderSource();
+    };
+
+}
+
+#include "InstancedMeshNode.inl"
+
+#endif
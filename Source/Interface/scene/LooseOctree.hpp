@@ -0,0 +1,380 @@
+#ifndef LOOSE_OCTREE_HPP
+#define LOOSE_OCTREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "Point.hpp"
+#include "Ray.hpp"
+
+namespace midnight
+{
+
+    /**
+     * A spatial index of objects by their world bounds, answering box, ray and nearest-neighbour
+     * queries.
+     *
+     * Every cell of a loose octree reaches twice as far as its place in the subdivision: a cell of
+     * half-size h centered at c holds objects whose centers lie within h of c, and whose bounds
+     * therefore lie within 2h of c when they are no larger than the cell.  An object is stored in
+     * the deepest cell that is at least its size and contains its center, which is found from
+     * its bounds alone, without testing any neighbour.  An object that moves stays in its cell
+     * for as long as its center does; otherwise it is unlinked from one cell and linked into
+     * another, both in constant time for a bounded depth.  Objects outside of the world bounds,
+     * and those with empty bounds, are kept at the root.
+     *
+     * Cells and objects live in pools with free lists, and the objects of a cell form an
+     * intrusive list, so moving objects allocates nothing once the pools have grown.  Cells are
+     * created on demand and released once they hold nothing.
+     *
+     * Objects are referred to by generational Handles, which become invalid once their object is
+     * removed.  The batched queries answer many queries at once on the job scheduler.
+     *
+     * @tparam T the value stored with each object (default-constructible and copyable)
+     *
+     */
+    template<typename T>
+    class LooseOctree
+    {
+      public:
+
+        /// The default depth of the deepest cells
+        static constexpr std::size_t DEFAULT_MAXIMUM_DEPTH = 8;
+
+        /**
+         * A stable reference to an object of a LooseOctree.  A default-constructed Handle refers
+         * to no object.
+         *
+         */
+        struct Handle
+        {
+            std::uint32_t index;
+            std::uint32_t generation;
+
+            Handle() noexcept : index(std::numeric_limits<std::uint32_t>::max()), generation(0)
+            {
+
+            }
+
+            Handle(std::uint32_t index, std::uint32_t generation) noexcept : index(index), generation(generation)
+            {
+
+            }
+
+            bool operator==(const Handle& rhs) const noexcept
+            {
+                return index == rhs.index && generation == rhs.generation;
+            }
+
+            bool operator!=(const Handle& rhs) const noexcept
+            {
+                return !(*this == rhs);
+            }
+        };
+
+        /**
+         * An object whose bounds a Ray enters
+         *
+         */
+        struct RayHit
+        {
+            Handle handle;
+
+            /// The distance along the Ray at which it enters the bounds of the object
+            float distance;
+        };
+
+      private:
+
+        /// Marks a missing cell or object
+        static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+        struct Cell
+        {
+            float center[3];
+            float half;
+            std::uint32_t parent;
+            std::uint32_t children[8];
+
+            /// The first object of the intrusive list of this cell
+            std::uint32_t first;
+            std::uint32_t objectCount;
+            std::uint8_t childCount;
+            std::uint8_t depth;
+
+            /// The index of this cell among the children of its parent
+            std::uint8_t octant;
+        };
+
+        struct Object
+        {
+            BoundingBoxF bounds;
+            T value;
+
+            /// The cell holding this object (NONE while the slot is free)
+            std::uint32_t cell;
+            std::uint32_t next;
+            std::uint32_t previous;
+            std::uint32_t generation;
+        };
+
+        std::vector<Cell> cells;
+        std::vector<std::uint32_t> releasedCells;
+        std::vector<Object> objects;
+        std::vector<std::uint32_t> releasedObjects;
+        std::size_t objectCount;
+        std::size_t maximumDepth;
+
+      public:
+
+        /**
+         * Constructs an empty LooseOctree
+         *
+         * @param world the region to subdivide (the root cell is the cube enclosing it)
+         *
+         * @param maximumDepth the depth of the deepest cells (at most 20)
+         *
+         * @throws IllegalArgumentException if the world is empty or the depth exceeds 20
+         *
+         */
+        explicit LooseOctree(const BoundingBoxF& world, std::size_t maximumDepth = DEFAULT_MAXIMUM_DEPTH);
+
+        /**
+         * Adds an object
+         *
+         * @param bounds the world bounds of the object
+         *
+         * @param value the value to store with the object
+         *
+         * @return the Handle of the new object
+         *
+         */
+        Handle insert(const BoundingBoxF& bounds, const T& value);
+
+        /**
+         * Moves an object
+         *
+         * @param object the object to move
+         *
+         * @param bounds the new world bounds of the object
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void update(Handle object, const BoundingBoxF& bounds);
+
+        /**
+         * Removes an object, invalidating its Handle
+         *
+         * @param object the object to remove
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void remove(Handle object);
+
+        /**
+         * Removes every object
+         *
+         */
+        void clear();
+
+        /**
+         * Queries whether a Handle refers to an object of this LooseOctree
+         *
+         * @param object the Handle to test
+         *
+         * @return true if the object exists, otherwise false
+         *
+         */
+        bool isValid(Handle object) const noexcept;
+
+        /**
+         * Retrieves the value stored with an object
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        T& get(Handle object);
+        const T& get(Handle object) const;
+
+        /**
+         * Retrieves the world bounds of an object
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        const BoundingBoxF& getBounds(Handle object) const;
+
+        /**
+         * Retrieves the number of objects
+         *
+         * @return the number of objects
+         *
+         */
+        std::size_t getSize() const noexcept;
+
+        /**
+         * Retrieves the number of cells in use, the root included
+         *
+         * @return the number of cells
+         *
+         */
+        std::size_t getCellCount() const noexcept;
+
+        /**
+         * Finds the objects whose bounds overlap a box
+         *
+         * @param box the region to search
+         *
+         * @param results receives the Handles of the objects (appended, in no particular order)
+         *
+         */
+        void query(const BoundingBoxF& box, std::vector<Handle>& results) const;
+
+        /**
+         * Finds the objects whose bounds a Ray enters
+         *
+         * @param ray the Ray to cast
+         *
+         * @param maximum the distance along the Ray beyond which objects are ignored
+         *
+         * @param results receives the hits (appended, nearest first)
+         *
+         */
+        void query(const Ray& ray, float maximum, std::vector<RayHit>& results) const;
+
+        /**
+         * Finds the objects nearest to a point, measuring the distance to their bounds
+         *
+         * @param point the point to search around
+         *
+         * @param count the largest number of objects to find
+         *
+         * @param results receives the Handles of the objects (appended, nearest first)
+         *
+         * @param maximum the distance beyond which objects are ignored
+         *
+         */
+        void nearest(const Point3F& point, std::size_t count, std::vector<Handle>& results,
+                float maximum = std::numeric_limits<float>::infinity()) const;
+
+        /**
+         * Answers a batch of box queries concurrently
+         *
+         * @param boxes the regions to search
+         *
+         * @param results receives the Handles found by every query, one query after the other
+         *
+         * @param offsets receives one more offset than there are queries: the results of query i
+         * are [offsets[i], offsets[i + 1])
+         *
+         */
+        void query(const std::vector<BoundingBoxF>& boxes, std::vector<Handle>& results,
+                std::vector<std::size_t>& offsets) const;
+
+        /**
+         * Answers a batch of ray queries concurrently
+         *
+         * @param rays the Rays to cast
+         *
+         * @param maximum the distance along each Ray beyond which objects are ignored
+         *
+         * @param results receives the hits of every query, one query after the other
+         *
+         * @param offsets receives one more offset than there are queries: the hits of query i are
+         * [offsets[i], offsets[i + 1])
+         *
+         */
+        void query(const std::vector<Ray>& rays, float maximum, std::vector<RayHit>& results,
+                std::vector<std::size_t>& offsets) const;
+
+        /**
+         * Answers a batch of nearest-neighbour queries concurrently
+         *
+         * @param points the points to search around
+         *
+         * @param count the largest number of objects to find around each point
+         *
+         * @param results receives the Handles found by every query, one query after the other
+         *
+         * @param offsets receives one more offset than there are queries: the results of query i
+         * are [offsets[i], offsets[i + 1])
+         *
+         */
+        void nearest(const std::vector<Point3F>& points, std::size_t count, std::vector<Handle>& results,
+                std::vector<std::size_t>& offsets) const;
+
+      private:
+
+        /**
+         * Validates a Handle
+         *
+         * @throws IllegalArgumentException if the Handle is not valid
+         *
+         */
+        void check(Handle object) const;
+
+        /**
+         * Finds the cell an object with the provided bounds belongs to, creating the cells on
+         * the way to it
+         *
+         */
+        std::uint32_t locate(const BoundingBoxF& bounds);
+
+        /**
+         * Queries whether an object with the provided bounds belongs to a cell
+         *
+         */
+        bool belongs(const BoundingBoxF& bounds, const Cell& cell) const noexcept;
+
+        /**
+         * Queries whether the center of non-empty bounds lies within a cell (without its looseness)
+         *
+         */
+        static bool encloses(const Cell& cell, const BoundingBoxF& bounds) noexcept;
+
+        /**
+         * Computes the depth of the cells an object with the provided bounds belongs to
+         *
+         */
+        std::size_t computeDepth(const BoundingBoxF& bounds) const noexcept;
+
+        void link(std::uint32_t object, std::uint32_t cell) noexcept;
+
+        /**
+         * Unlinks an object from its cell, releasing the cells that are left empty
+         *
+         */
+        void unlink(std::uint32_t object) noexcept;
+
+        std::uint32_t createCell(std::uint32_t parent, std::uint8_t octant);
+
+        /**
+         * Computes the region a cell's objects may reach
+         *
+         */
+        BoundingBoxF getLooseBounds(const Cell& cell) const noexcept;
+
+        /**
+         * Computes the squared distance from a point to a box (zero inside of it)
+         *
+         */
+        static float squaredDistance(const Point3F& point, const BoundingBoxF& box) noexcept;
+
+        /**
+         * Runs queries concurrently, gathering their results one query after the other
+         *
+         */
+        template<typename Result, typename F>
+        static void batch(std::size_t count, std::vector<Result>& results, std::vector<std::size_t>& offsets, F query);
+    };
+
+}
+
+#include "LooseOctree.inl"
+
+#endif
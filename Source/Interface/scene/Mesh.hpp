@@ -6,6 +6,7 @@
 #include <tuple>
 #include <vector>
 
+#include "BoundingBox.hpp"
 #include "Vertex.hpp"
 
 #include "Material.hpp"
@@ -14,6 +15,7 @@ namespace midnight
 {
     /// Forward Declaration for our friends
     class Mesh;
+    class MeshOptimizer;
 }
 
 /**
@@ -72,6 +74,9 @@ namespace midnight
         friend std::ostream& operator<<(std::ostream&, Mesh&&);
         friend std::istream& operator>>(std::istream&, Mesh&);
 
+        /// The optimizer reorders the vertices and indices in place
+        friend class MeshOptimizer;
+
       public:
         
         /**
@@ -109,10 +114,18 @@ namespace midnight
         {
             return vertices;
         }
-        const std::vector<Renderable> getMeshes() const noexcept
+        const std::vector<Renderable>& getMeshes() const noexcept
         {
             return meshes;
         }
+
+        /**
+         * Computes the bounds of the vertices of this Mesh
+         * 
+         * @return the smallest BoundingBox that encloses every vertex
+         * 
+         */
+        BoundingBoxF getBounds() const noexcept;
     };
 
 }
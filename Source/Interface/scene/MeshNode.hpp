@@ -2,11 +2,20 @@
 #define MESH_NODE_HPP
 
 #include "AbstractSceneGraphNode.hpp"
+#include "BatchRenderer.hpp"
+#include "FrameUniforms.hpp"
+#include "GeometryArena.hpp"
+#include "IllegalArgumentException.hpp"
 #include "IndexBuffer.hpp"
 #include "VertexBuffer.hpp"
 #include "Mesh.hpp"
+#include "MeshSimplifier.hpp"
 #include "Vertex.hpp"
 #include "Program.hpp"
+#include "ProgramRegistry.hpp"
+#include "RenderQueue.hpp"
+#include "TextureUnits.hpp"
+#include "TriangleBVH.hpp"
 #include "constexpr_math.hpp"
 
 #include <memory>
@@ -21,13 +30,38 @@ namespace midnight
         std::unique_ptr<StaticDrawTriangleBuffer<float>> buffer;
         std::vector<std::pair<std::size_t, std::unique_ptr<StaticDrawIndexBuffer<std::size_t>>>> indexBuffers;
         
-        Program program;
-        const static std::string VERTEX_SHADER_SRC;
-        const static std::string FRAGMENT_SHADER_SRC;
+        /// The shared storage of this MeshNode (if any), in place of the dedicated buffers above
+        std::shared_ptr<GeometryArena> arena;
+        std::vector<GeometryArena::Handle> arenaHandles;
+
+        /// The errors of the levels of detail in the arena (empty without levels), and the
+        /// indices of every level within the mesh of each Renderable, as (first, count)
+        std::vector<float> levelErrors;
+        std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> levelRanges;
+
+        /// The largest error on the screen to accept from a level, as a fraction of its height
+        float detailTolerance;
         
+        std::shared_ptr<Program> program;
+
+        /// The program of the queued draws of an arena mesh, which reads the world transform of
+        /// every draw from a BatchRenderer (null until an arena mesh is first queued on a context
+        /// that supports batching)
+        std::shared_ptr<Program> batchedProgram;
+
+        /// The texture and sampler bound to unit zero (zero if none)
+        GLuint texture;
+        GLuint sampler;
+
+        /// The triangles of every Renderable, one after the other, for picking
+        TriangleBVH triangles;
+
       public:
-        
-        MeshNode(const Mesh& mesh) : mesh(mesh), program(VertexShader(VERTEX_SHADER_SRC), FragmentShader(FRAGMENT_SHADER_SRC))
+
+        /// The default tolerance of the levels of detail: a pixel at 1080 lines
+        static constexpr float DEFAULT_DETAIL_TOLERANCE = 1.0f / 1080.0f;
+
+        MeshNode(const Mesh& mesh) : mesh(mesh), detailTolerance(DEFAULT_DETAIL_TOLERANCE), program(ProgramRegistry::getDefault().acquire(getVertexShaderSource(), getFragmentShaderSource())), texture(0), sampler(0)
         {
             std::vector<float> data;
             
@@ -59,10 +93,151 @@ namespace midnight
             
             buffer->addAttributePointer("position", 3, GL_FLOAT, GL_FALSE, 0, 0);
             buffer->addAttributePointer("uv_in", 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid*>(48 * 6));
+            FrameUniforms::attach(*program);
+            setLocalBounds(mesh.getBounds());
+            triangles = buildTriangles(mesh);
+        }
+
+        /**
+         * Constructs a MeshNode whose geometry lives in the provided GeometryArena
+         * 
+         * @param mesh the Mesh to render
+         * 
+         * @param arena the arena to upload the Renderables of the Mesh into, which share a single
+         * copy of its vertices
+         * 
+         * @throws ResourceException if the arena cannot hold the Mesh
+         * 
+         */
+        MeshNode(const Mesh& mesh, const std::shared_ptr<GeometryArena>& arena) : mesh(mesh), arena(arena), detailTolerance(DEFAULT_DETAIL_TOLERANCE), program(ProgramRegistry::getDefault().acquire(getVertexShaderSource(), getFragmentShaderSource())), texture(0), sampler(0)
+        {
+            /// The Renderables share the vertices of the Mesh, which are uploaded once
+            if(!mesh.getMeshes().empty())
+            {
+                std::vector<std::vector<std::size_t>> indices;
+                for(const Mesh::Renderable& renderable : mesh.getMeshes())
+                {
+                    indices.push_back(renderable.indices);
+                }
+                arenaHandles = arena->allocate(mesh.getVertices(), indices);
+            }
+            try
+            {
+                FrameUniforms::attach(*program);
+                setLocalBounds(mesh.getBounds());
+                triangles = buildTriangles(mesh);
+            }
+            catch(...)
+            {
+                /// The destructor of a partially constructed MeshNode does not run
+                for(GeometryArena::Handle handle : arenaHandles)
+                {
+                    arena->release(handle);
+                }
+                throw;
+            }
+        }
+
+        /**
+         * Constructs a MeshNode that draws levels of detail of its Mesh, chosen by their error on
+         * the screen.  The vertices of the Mesh are stored once for every Renderable and level,
+         * and the indices of each Renderable hold every level, one after the other.
+         * 
+         * @param mesh the Mesh to render
+         * 
+         * @param arena the arena to upload the Renderables of the Mesh into
+         * 
+         * @param levels the levels of detail of the Mesh, as built by MeshSimplifier::simplify
+         * 
+         * @throws IllegalArgumentException if there are no levels, or a level does not match the
+         * Renderables of the Mesh
+         * 
+         * @throws ResourceException if the arena cannot hold the Mesh
+         * 
+         */
+        MeshNode(const Mesh& mesh, const std::shared_ptr<GeometryArena>& arena, const std::vector<MeshSimplifier::Level>& levels) : mesh(mesh), arena(arena), detailTolerance(DEFAULT_DETAIL_TOLERANCE), program(ProgramRegistry::getDefault().acquire(getVertexShaderSource(), getFragmentShaderSource())), texture(0), sampler(0)
+        {
+            if(levels.empty())
+            {
+                throw IllegalArgumentException("A MeshNode requires at least one level of detail");
+            }
+            for(const MeshSimplifier::Level& level : levels)
+            {
+                if(level.indices.size() != mesh.getMeshes().size())
+                {
+                    throw IllegalArgumentException("A level of detail does not match the Renderables of the Mesh");
+                }
+                levelErrors.push_back(level.error);
+            }
+            std::vector<std::vector<std::size_t>> indices(mesh.getMeshes().size());
+            for(std::size_t i = 0; i < mesh.getMeshes().size(); ++i)
+            {
+                std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges;
+                for(const MeshSimplifier::Level& level : levels)
+                {
+                    ranges.push_back(std::make_pair(static_cast<std::uint32_t>(indices[i].size()), static_cast<std::uint32_t>(level.indices[i].size())));
+                    indices[i].insert(indices[i].end(), level.indices[i].begin(), level.indices[i].end());
+                }
+                levelRanges.push_back(std::move(ranges));
+            }
+            if(!indices.empty())
+            {
+                arenaHandles = arena->allocate(mesh.getVertices(), indices);
+            }
+            try
+            {
+                FrameUniforms::attach(*program);
+                setLocalBounds(mesh.getBounds());
+                triangles = buildTriangles(mesh);
+            }
+            catch(...)
+            {
+                /// The destructor of a partially constructed MeshNode does not run
+                for(GeometryArena::Handle handle : arenaHandles)
+                {
+                    arena->release(handle);
+                }
+                throw;
+            }
         }
 
         MeshNode(Mesh&& mesh);
         
+        virtual ~MeshNode()
+        {
+            for(GeometryArena::Handle handle : arenaHandles)
+            {
+                arena->release(handle);
+            }
+        }
+        
+        /**
+         * Sets the texture that this MeshNode samples
+         * 
+         * @param texture the name of the texture (zero if none)
+         * 
+         * @param sampler the name of the sampler (zero to use the parameters of the texture)
+         * 
+         */
+        void setTexture(GLuint texture, GLuint sampler = 0) noexcept
+        {
+            this->texture = texture;
+            this->sampler = sampler;
+        }
+
+        /**
+         * Sets the largest error on the screen to accept from a level of detail.  The errors of
+         * the levels are measured in the units of the Mesh, so scaling transforms are not
+         * accounted for.
+         * 
+         * @param tolerance the error, as a fraction of the height of the screen
+         * 
+         */
+        void setDetailTolerance(float tolerance) noexcept
+        {
+            detailTolerance = tolerance;
+        }
+
         virtual void render(const Camera& camera) override
         {
             /// Render myself
@@ -74,10 +249,72 @@ namespace midnight
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP);*/
         
-		program.bind();
-		program.setUniform("offset", camera.getPosition());
-		program.setMatrixUniform("projection", camera.getProjection());
-		program.setMatrixUniform("orientation", camera.getOrientation());
+        /// Queue the draws of an arena mesh to be sorted by their state, as batched draws where
+        /// the context supports them
+        RenderQueue* queue = RenderQueue::getActive();
+        if(arena && queue != nullptr)
+        {
+            FrameUniforms& uniforms = FrameUniforms::getActive();
+            Program* batched = getBatchedProgram();
+            const Matrix4x4F world = batched != nullptr ? uniforms.getWorldTransform() : Matrix4x4F::IDENTITY();
+            const std::size_t object = batched != nullptr ? 0 : uniforms.writeObject();
+            const float depth = uniforms.computeDepth(getBounds());
+            const std::size_t level = selectLevel(camera, depth);
+            for(std::size_t i = 0; i < arenaHandles.size(); ++i)
+            {
+                std::uint32_t firstIndex = 0;
+                std::uint32_t indexCount = 0;
+                if(!levelRanges.empty())
+                {
+                    if(levelRanges[i][level].second == 0)
+                    {
+                        continue;
+                    }
+                    firstIndex = levelRanges[i][level].first;
+                    indexCount = levelRanges[i][level].second;
+                }
+                const std::uint32_t material = static_cast<std::uint32_t>(mesh.getMeshes()[i].materialIndex);
+                if(batched != nullptr)
+                {
+                    queue->submit(RenderQueue::OPAQUE_LAYER, *batched, material, texture, sampler, *arena, arenaHandles[i], depth, world,
+                            firstIndex, indexCount);
+                }
+                else
+                {
+                    queue->submit(RenderQueue::OPAQUE_LAYER, *program, material, texture, sampler, *arena, arenaHandles[i], depth, object,
+                            firstIndex, indexCount);
+                }
+            }
+            this->AbstractSceneGraphNode::render(camera);
+            return;
+        }
+
+		program->bind();
+		FrameUniforms::getActive().bindObject();
+        if(texture != 0)
+        {
+            TextureUnits::getDefault().bind(0, texture, sampler);
+        }
+        if(arena)
+        {
+            const std::size_t level = selectLevel(camera, FrameUniforms::getActive().computeDepth(getBounds()));
+            arena->bind();
+            for(std::size_t i = 0; i < arenaHandles.size(); ++i)
+            {
+                if(levelRanges.empty())
+                {
+                    arena->draw(arenaHandles[i]);
+                }
+                else if(levelRanges[i][level].second != 0)
+                {
+                    arena->draw(arenaHandles[i], levelRanges[i][level].first, static_cast<GLsizei>(levelRanges[i][level].second));
+                }
+            }
+            arena->unbind();
+            program->unbind();
+            this->AbstractSceneGraphNode::render(camera);
+            return;
+        }
 		buffer->bind();
         glDrawElements(
      GL_TRIANGLES, 
@@ -87,7 +324,7 @@ namespace midnight
         // TODO: Vertex Class with equ-ops
 //		glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh.getMeshes()[0].indices.size()));
 		buffer->unbind();
-		program.unbind();
+		program->unbind();
             
             /// Render my children
             this->AbstractSceneGraphNode::render(camera);
@@ -98,34 +335,124 @@ namespace midnight
         {
             return true;
         }
+
+        /**
+         * Finds the triangle of the Mesh, or of a child, that a Ray crosses first.  Triangles are
+         * numbered across the Renderables of the Mesh, one Renderable after the other.
+         * 
+         */
+        virtual bool intersect(const Ray& ray, float maximum, SurfaceHit& hit) override
+        {
+            bool found = triangles.intersect(ray, maximum, hit);
+            /// The children are rendered in the space of this node
+            if(AbstractSceneGraphNode::intersect(ray, found ? hit.distance : maximum, hit))
+            {
+                found = true;
+            }
+            return found;
+        }
+
+      private:
+
+        /**
+         * Chooses the level of detail to draw at a distance from the viewer
+         * 
+         */
+        std::size_t selectLevel(const Camera& camera, float depth) const noexcept
+        {
+            return levelErrors.empty() ? 0 : MeshSimplifier::selectLevel(levelErrors, depth, camera.getFieldOfView(), detailTolerance);
+        }
+
+        static TriangleBVH buildTriangles(const Mesh& mesh)
+        {
+            std::vector<Point3F> positions;
+            positions.reserve(mesh.getVertices().size());
+            for(const Vertex32F& vertex : mesh.getVertices())
+            {
+                positions.push_back(vertex.getPosition());
+            }
+            std::vector<std::uint32_t> indices;
+            for(const Mesh::Renderable& renderable : mesh.getMeshes())
+            {
+                indices.insert(indices.end(), renderable.indices.begin(), renderable.indices.end());
+            }
+            return TriangleBVH(positions, indices);
+        }
+
+        /**
+         * Retrieves the sources of the shaders, built on first use
+         * 
+         */
+        static const std::string& getVertexShaderSource()
+        {
+            static const std::string source = std::string("#version 150\n") + FrameUniforms::GLSL_BLOCKS +
+                "in vec3 position;\n\
+                in vec2 uv_in;\n\
+                out vec2 uv_out;\n\
+                void main()\n\
+                {\n\
+                    gl_Position = vec4(position, 1.0) * object.model_view_projection;\n\
+                    uv_out = uv_in;\n\
+                }";
+            return source;
+        }
+
+        static const std::string& getFragmentShaderSource()
+        {
+            static const std::string source =
+                "#version 140\n\
+                in vec2 uv_out;\n\
+                uniform sampler2D tex;\n\
+                void main()\n\
+                {\n\
+                    gl_FragColor = texture2D(tex, uv_out);\n\
+                }";
+            return source;
+        }
+
+        /**
+         * Retrieves the program of the queued draws of an arena mesh, which is compiled the first
+         * time it is needed, so that a MeshNode that only draws immediately requires no more
+         * than OpenGL 3.2
+         * 
+         * @return the program, or nullptr if the context cannot submit batched draws
+         * 
+         */
+        Program* getBatchedProgram()
+        {
+            if(!batchedProgram && BatchRenderer::isSupported())
+            {
+                batchedProgram = ProgramRegistry::getDefault().acquire(getBatchedVertexShaderSource(), getFragmentShaderSource());
+                FrameUniforms::attach(*batchedProgram);
+            }
+            return batchedProgram.get();
+        }
+
+        /**
+         * Retrieves the source of the vertex shader of the batched draws, which selects the
+         * world transform of its draw by the draw id that BatchRenderer feeds it
+         * 
+         */
+        static const std::string& getBatchedVertexShaderSource()
+        {
+            static const std::string source = std::string("#version 430\n") + FrameUniforms::GLSL_BLOCKS +
+                "layout(std430, binding = " + std::to_string(BatchRenderer::DRAW_DATA_BINDING) + ") readonly buffer DrawData\n\
+                {\n\
+                    mat4 transforms[];\n\
+                };\n\
+                in vec3 position;\n\
+                in vec2 uv_in;\n\
+                in uint draw_id;\n\
+                out vec2 uv_out;\n\
+                void main()\n\
+                {\n\
+                    gl_Position = vec4(position, 1.0) * transforms[draw_id] * frame.view_projection;\n\
+                    uv_out = uv_in;\n\
+                }";
+            return source;
+        }
     };
     
-    const std::string MeshNode::VERTEX_SHADER_SRC = 
-        "#version 130\n\
-        in vec3 position;\n\
-        in vec2 uv_in;\n\
-        out vec2 uv_out;\n\
-        uniform vec3 offset;\n\
-        uniform mat4 projection;\n\
-        uniform mat4 orientation;\n\
-        void main()\n\
-        {\n\
-            vec4 cameraPos = vec4(position.x, position.y, position.z, 1.0) + vec4(offset.x, offset.y, offset.z, 0.0);\n\
-            cameraPos *= orientation;\n\
-            cameraPos *= projection;\n\
-            gl_Position = cameraPos;\n\
-            uv_out = uv_in;\n\
-        }";
-
-    const std::string MeshNode::FRAGMENT_SHADER_SRC = 
-        "#version 130\n\
-        in vec2 uv_out;\n\
-        uniform sampler2D tex;\n\
-        void main()\n\
-        {\n\
-            gl_FragColor = texture2D(tex, uv_out);\n\
-        }";
-    
 }
 
 #endif
\ No newline at end of file
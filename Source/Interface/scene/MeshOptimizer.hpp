@@ -0,0 +1,185 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.hpp"
+#include "Vertex.hpp"
+
+namespace midnight
+{
+
+    /**
+     * An import-time processing stage that reorders the index and vertex data of a Mesh for the
+     * GPU without altering the rendered result.
+     *
+     * The pipeline consists of three passes:
+     * <ol>
+     *  <li>post-transform vertex cache optimization (Forsyth's linear-speed algorithm)</li>
+     *  <li>overdraw-aware reordering of triangle clusters (Sander, Nehab and Barczak)</li>
+     *  <li>vertex fetch optimization, remapping the vertices into first-use order</li>
+     * </ol>
+     *
+     * The first two passes are independent for every Renderable and are executed concurrently.
+     *
+     */
+    class MeshOptimizer
+    {
+      public:
+
+        /**
+         * The result of simulating a FIFO post-transform vertex cache over a list of triangles
+         *
+         */
+        struct Statistics
+        {
+            /// The number of triangles that were simulated
+            std::size_t triangles;
+
+            /// The number of vertex shader invocations (cache misses)
+            std::size_t transforms;
+
+            /// The number of distinct vertices referenced by the triangles
+            std::size_t vertices;
+
+            Statistics() : triangles(0), transforms(0), vertices(0)
+            {
+
+            }
+
+            /**
+             * Retrieves the average cache miss ratio (transformed vertices per triangle)
+             *
+             * @return the ACMR, ranging from 0.5 (ideal) to 3.0 (no reuse)
+             *
+             */
+            double getACMR() const noexcept
+            {
+                return triangles == 0 ? 0.0 : static_cast<double>(transforms) / static_cast<double>(triangles);
+            }
+
+            /**
+             * Retrieves the average transform to vertex ratio
+             *
+             * @return the ATVR, where 1.0 means every vertex was transformed exactly once
+             *
+             */
+            double getATVR() const noexcept
+            {
+                return vertices == 0 ? 0.0 : static_cast<double>(transforms) / static_cast<double>(vertices);
+            }
+
+            Statistics& operator+=(const Statistics& rhs) noexcept
+            {
+                triangles += rhs.triangles;
+                transforms += rhs.transforms;
+                vertices += rhs.vertices;
+                return *this;
+            }
+        };
+
+        /**
+         * The cache efficiency of a Mesh measured before and after optimization
+         *
+         */
+        struct Report
+        {
+            Statistics before;
+            Statistics after;
+        };
+
+      private:
+
+        /// The size of the vertex cache to optimize for
+        std::size_t cacheSize;
+
+        /// The ACMR degradation that is tolerated in exchange for overdraw reduction
+        float overdrawThreshold;
+
+      public:
+
+        /**
+         * Constructs a MeshOptimizer
+         *
+         * @param cacheSize the number of entries in the post-transform cache to optimize for
+         *
+         * @param overdrawThreshold the tolerated ACMR degradation factor of the overdraw pass
+         * (1.0 keeps the vertex cache order intact, larger values split into more clusters)
+         *
+         * @throws IllegalArgumentException if the cache holds fewer than 4 entries
+         *
+         */
+        explicit MeshOptimizer(std::size_t cacheSize = 32, float overdrawThreshold = 1.05f);
+
+        /**
+         * Runs the full optimization pipeline over the provided Mesh
+         *
+         * @param mesh the Mesh to optimize in place
+         *
+         * @return the cache statistics of the Mesh before and after optimization
+         *
+         * @throws IllegalArgumentException if a Renderable is not a triangle list or references
+         * a vertex that does not exist
+         *
+         */
+        Report optimize(Mesh& mesh) const;
+
+        /**
+         * Simulates a FIFO post-transform vertex cache over the provided triangle list
+         *
+         * @param indices the triangle list to simulate
+         *
+         * @param vertexCount the number of vertices that the indices refer to
+         *
+         * @param cacheSize the number of entries in the simulated cache
+         *
+         * @return the simulated cache statistics
+         *
+         */
+        static Statistics analyze(const std::vector<std::size_t>& indices, std::size_t vertexCount, std::size_t cacheSize);
+
+        /**
+         * Reorders the provided triangle list to improve post-transform vertex cache locality
+         *
+         * @param indices the triangle list to reorder in place
+         *
+         * @param vertexCount the number of vertices that the indices refer to
+         *
+         * @param cacheSize the number of entries in the cache to optimize for
+         *
+         */
+        static void optimizeVertexCache(std::vector<std::size_t>& indices, std::size_t vertexCount, std::size_t cacheSize);
+
+        /**
+         * Reorders clusters of the provided (vertex cache optimized) triangle list so that
+         * outward-facing clusters are drawn first
+         *
+         * @param indices the triangle list to reorder in place
+         *
+         * @param vertices the vertices that the indices refer to
+         *
+         * @param cacheSize the number of entries in the cache to simulate
+         *
+         * @param threshold the tolerated ACMR degradation factor
+         *
+         */
+        static void optimizeOverdraw(std::vector<std::size_t>& indices, const std::vector<Vertex32F>& vertices, std::size_t cacheSize, float threshold);
+
+        /**
+         * Remaps the provided vertices into the order in which the provided Renderables first
+         * reference them.  Vertices that are not referenced are discarded.
+         *
+         * @param vertices the vertices to reorder in place
+         *
+         * @param renderables the Renderables whose indices are rewritten in place
+         *
+         */
+        static void optimizeVertexFetch(std::vector<Vertex32F>& vertices, std::vector<Mesh::Renderable>& renderables);
+    };
+
+}
+
+#include "MeshOptimizer.inl"
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.hpp"
+#include "Vertex.hpp"
+
+namespace midnight
+{
+
+    /**
+     * An import-time (or background) processing stage that builds levels of detail of a Mesh:
+     * a chain of triangle lists of decreasing size over the unchanged vertices of the Mesh, so
+     * that every level is drawn from the same vertex buffer.
+     *
+     * Triangles are removed by half-edge collapses, which move a vertex onto a neighbour and
+     * therefore never create a vertex.  Collapses are ordered by the quadric error metric
+     * (Garland and Heckbert): every vertex accumulates the planes of the triangles around it,
+     * and the cost of a collapse is the area-weighted mean squared distance of its destination
+     * to the planes of both vertices.  Each pass sorts the edges by cost and performs the
+     * cheapest ones that touch no vertex moved in the same pass and flip no triangle.
+     *
+     * Vertices that share a position but differ in their normal or texture coordinate form an
+     * attribute seam.  A seam vertex may only slide along the seam, together with its twin on
+     * the other side, so that neither cracks nor stretched texture coordinates appear.  The
+     * vertices of open borders slide along the border; vertices shared by three or more
+     * attribute sets, by several Renderables or by non-manifold edges never move.  Seams and
+     * borders are held in place by additional planes through their edges, perpendicular to the
+     * surface.
+     *
+     */
+    class MeshSimplifier
+    {
+      public:
+
+        /**
+         * A level of detail: a triangle list for every Renderable of the Mesh
+         *
+         */
+        struct Level
+        {
+            /// The indices of every Renderable, in the order of the Renderables of the Mesh
+            std::vector<std::vector<std::size_t>> indices;
+
+            /// The number of triangles of this level, across the Renderables
+            std::size_t triangles;
+
+            /// An estimate of the distance by which this level deviates from the Mesh (in the units
+            /// of its positions): the root mean square distance of the moved vertices to the planes
+            /// of the triangles they replace, which never decreases along the chain
+            float error;
+        };
+
+      private:
+
+        /// The fraction of the triangles of a level that the next one keeps
+        float ratio;
+
+        /// The largest number of levels, the Mesh itself included
+        std::size_t maximumLevels;
+
+        /// The smallest number of triangles of a level
+        std::size_t minimumTriangles;
+
+        /// The largest error of a level, relative to the radius of the bounds of the Mesh
+        float maximumError;
+
+      public:
+
+        /**
+         * Constructs a MeshSimplifier
+         *
+         * @param ratio the fraction of the triangles of a level that the next one aims to keep
+         *
+         * @param maximumLevels the largest number of levels, the Mesh itself included
+         *
+         * @param minimumTriangles the number of triangles below which no further level is built
+         *
+         * @param maximumError the largest error of a level, relative to the radius of the bounds
+         * of the Mesh
+         *
+         * @throws IllegalArgumentException if the ratio is not within (0, 1), fewer than two
+         * levels are requested, or the maximum error is not positive
+         *
+         */
+        explicit MeshSimplifier(float ratio = 0.5f, std::size_t maximumLevels = 8, std::size_t minimumTriangles = 64,
+                float maximumError = 0.1f);
+
+        /**
+         * Builds the levels of detail of a Mesh
+         *
+         * @param mesh the Mesh to simplify
+         *
+         * @return the levels, starting with the Mesh itself (whose error is zero).  Building
+         * stops early once no collapse remains possible within the maximum error.
+         *
+         * @throws IllegalArgumentException if a Renderable is not a triangle list or references
+         * a vertex that does not exist
+         *
+         */
+        std::vector<Level> simplify(const Mesh& mesh) const;
+
+        /**
+         * Computes the size of an error on the screen
+         *
+         * @param error the error, in world units
+         *
+         * @param distance the distance from the viewer along the view direction
+         *
+         * @param fieldOfView the vertical field of view of the Camera (in degrees)
+         *
+         * @return the error as a fraction of the height of the screen (infinite at or behind the
+         * viewer)
+         *
+         */
+        static float computeScreenError(float error, float distance, float fieldOfView) noexcept;
+
+        /**
+         * Chooses the coarsest level whose error is small enough on the screen
+         *
+         * @param errors the errors of the levels, in the order of the chain
+         *
+         * @param distance the distance from the viewer along the view direction
+         *
+         * @param fieldOfView the vertical field of view of the Camera (in degrees)
+         *
+         * @param tolerance the largest error to accept, as a fraction of the height of the screen
+         *
+         * @return the index of the level to draw
+         *
+         */
+        static std::size_t selectLevel(const std::vector<float>& errors, float distance, float fieldOfView,
+                float tolerance) noexcept;
+    };
+
+}
+
+#include "MeshSimplifier.inl"
+
+#endif
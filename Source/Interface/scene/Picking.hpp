@@ -0,0 +1,115 @@
+#ifndef PICKING_HPP
+#define PICKING_HPP
+
+#include <cstddef>
+
+#include "Matrix.hpp"
+#include "Ray.hpp"
+
+namespace midnight
+{
+
+    class SceneGraphNode;
+
+    /**
+     * Where a Ray crosses the surface of a node
+     *
+     */
+    struct SurfaceHit
+    {
+        /// The distance along the Ray
+        float distance;
+
+        /// The triangle that was hit, numbered as the node lays its triangles out
+        std::size_t primitive;
+
+        /// The descendant that was hit, if not the node that was intersected itself (in which
+        /// case it is left as the caller set it)
+        SceneGraphNode* node;
+    };
+
+    namespace picking
+    {
+
+        /**
+         * Inverts a matrix (Gauss-Jordan elimination with partial pivoting, in double precision)
+         *
+         * @param matrix the matrix to invert
+         *
+         * @param inverse receives the inverse
+         *
+         * @return false if the matrix is singular, in which case the inverse is left untouched
+         *
+         */
+        bool invert(const Matrix4x4F& matrix, Matrix4x4F& inverse) noexcept;
+
+        /**
+         * Builds the Ray that runs from the near to the far plane of a view, through a point of
+         * the screen.  Points are row vectors (p * viewProjection), as in the shaders.
+         *
+         * @param viewProjection the view-projection matrix of the view
+         *
+         * @param x the horizontal position on the screen, from -1 (left) to 1 (right)
+         *
+         * @param y the vertical position on the screen, from -1 (bottom) to 1 (top)
+         *
+         * @param length receives the distance from the near to the far plane along the Ray, whose
+         * direction has unit length (zero if the matrix is singular)
+         *
+         * @return the Ray, starting on the near plane
+         *
+         */
+        Ray unproject(const Matrix4x4F& viewProjection, float x, float y, float& length) noexcept;
+
+        /**
+         * Transforms a Ray by an affine matrix, as the shaders transform points (p * matrix).
+         * The direction is transformed without being normalized, so that distances along the
+         * transformed Ray are those along the original one.
+         *
+         * @param ray the Ray to transform
+         *
+         * @param matrix the matrix to transform the Ray by
+         *
+         * @return the transformed Ray
+         *
+         */
+        Ray transform(const Ray& ray, const Matrix4x4F& matrix) noexcept;
+
+        /**
+         * Casts a Ray against a grid of heights, triangulated as Terrain triangulates its
+         * heightmap, by walking the cells under the Ray in order (a two-dimensional DDA) and
+         * testing the two triangles of each.  The walk stops at the first cell with a hit.
+         *
+         * Sample (i, j) lies at (originX + i, height(i, j), originZ + j).  The triangles of cell
+         * (i, j) are numbered 2 * (i * (rows - 1) + j) and the one after it.
+         *
+         * @param ray the Ray to cast
+         *
+         * @param maximum the distance beyond which hits are ignored
+         *
+         * @param columns the number of samples along x (at least two)
+         *
+         * @param rows the number of samples along z (at least two)
+         *
+         * @param originX the x of the first column
+         *
+         * @param originZ the z of the first row
+         *
+         * @param height a callable that accepts a column and a row, and returns the height there
+         *
+         * @param hit receives the nearest hit
+         *
+         * @return true if the Ray hits the grid no further than the maximum, otherwise false
+         *
+         */
+        template<typename F>
+        bool marchHeightfield(const Ray& ray, float maximum, std::size_t columns, std::size_t rows, float originX,
+                float originZ, F height, SurfaceHit& hit);
+
+    }
+
+}
+
+#include "Picking.inl"
+
+#endif
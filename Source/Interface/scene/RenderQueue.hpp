@@ -0,0 +1,308 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "BatchRenderer.hpp"
+#include "FrameUniforms.hpp"
+#include "GeometryArena.hpp"
+#include "Platform.hpp"
+#include "Program.hpp"
+
+namespace midnight
+{
+
+    /**
+     * Collects the draws of a frame as compact RenderItems, sorts them by their state and submits
+     * them with as few state changes as possible.
+     *
+     * Rather than binding its state as it is traversed, a node submits a RenderItem while the
+     * queue is active (between begin() and flush()).  Each item carries a 64-bit sort key, the
+     * state and mesh to draw, and the offset of an ObjectData that FrameUniforms::writeObject()
+     * already wrote for it.  flush() radix-sorts the items by their keys, from the most to the
+     * least significant bits:
+     * <pre>
+     *  layer (4) | program (12) | material (12) | texture (12) | buffer (8) | depth (16)
+     * </pre>
+     * so that draws sharing a program, then a material and texture, then a buffer are submitted
+     * together, and front to back within those.  The program, texture and buffer of an item are
+     * given small ids in order of first use; ids that exceed their bits wrap around, which only
+     * costs sorting quality, as submission compares the actual state of consecutive items.
+     *
+     * Draws whose program reads its transform from the DrawData storage of a BatchRenderer are
+     * queued with their world transform instead of an ObjectData.  Once sorted, every run of such
+     * draws that share a program, an arena, a texture and a sampler is submitted with a single
+     * glMultiDrawElementsIndirect.
+     *
+     * Every flush counts the program, texture and buffer switches it issued, along with those the
+     * items would have cost in the order they were submitted.
+     *
+     */
+    class RenderQueue
+    {
+      public:
+
+        /// The layer of opaque geometry (lower layers are drawn first)
+        static constexpr std::uint32_t OPAQUE_LAYER = 4;
+
+        /**
+         * A queued draw
+         *
+         */
+        struct RenderItem
+        {
+            std::uint64_t key;
+            Program* program;
+            GeometryArena* arena;
+            GeometryArena::Handle mesh;
+            GLuint texture;
+            GLuint sampler;
+
+            /// The indices of the mesh to draw, relative to its first index (all of them if the
+            /// count is zero)
+            std::uint32_t firstIndex;
+            std::uint32_t indexCount;
+
+            /// The offset of the ObjectData of the draw, as written by FrameUniforms::writeObject
+            std::size_t object;
+
+            /// Whether the draw is submitted through the BatchRenderer, in which case its world
+            /// transform is the transform-th of the frame rather than an ObjectData
+            bool batched;
+            std::uint32_t transform;
+        };
+
+        /**
+         * The state changes of a sequence of draws
+         *
+         */
+        struct Switches
+        {
+            std::size_t programs;
+            std::size_t textures;
+
+            /// Vertex array binds, needed by a change of either the arena or the program
+            std::size_t buffers;
+        };
+
+        /**
+         * The cost of the most recent flush
+         *
+         */
+        struct Statistics
+        {
+            std::size_t items;
+
+            /// The state changes of the items in the order they were submitted
+            Switches unsorted;
+
+            /// The state changes that were issued
+            Switches sorted;
+
+            /// The multi-draw calls that submitted the batched items
+            std::size_t batches;
+        };
+
+      private:
+
+        std::vector<RenderItem> items;
+
+        /// The world transforms of the batched items of the current frame
+        std::vector<Matrix4x4F> transforms;
+
+        /// Submits the batched items, created on first use (the queue may be constructed before a
+        /// context exists)
+        std::unique_ptr<BatchRenderer> batchRenderer;
+
+        /// Scratch storage for sort()
+        std::vector<RenderItem> sortedItems;
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint32_t> order;
+        std::vector<std::uint64_t> scratchKeys;
+        std::vector<std::uint32_t> scratchOrder;
+
+        /// The ids given to the state of the items of the current frame, in order of first use
+        std::unordered_map<const Program*, std::uint32_t> programIds;
+        std::unordered_map<GLuint, std::uint32_t> textureIds;
+        std::unordered_map<const GeometryArena*, std::uint32_t> bufferIds;
+
+        Statistics statistics;
+
+      public:
+
+        /**
+         * Constructs an empty RenderQueue
+         *
+         */
+        RenderQueue();
+
+        RenderQueue(const RenderQueue&) = delete;
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        ~RenderQueue();
+
+        /**
+         * Starts collecting the draws of a frame, and makes this RenderQueue the active one
+         *
+         */
+        void begin();
+
+        /**
+         * Queues a draw
+         *
+         * @param layer the layer of the draw (0 to 15)
+         *
+         * @param program the Program to draw with (must outlive the flush)
+         *
+         * @param material the material of the draw
+         *
+         * @param texture the texture to bind to unit zero (zero if none)
+         *
+         * @param sampler the sampler to bind to unit zero (zero if none)
+         *
+         * @param arena the GeometryArena that holds the mesh (must outlive the flush)
+         *
+         * @param mesh the mesh to draw
+         *
+         * @param depth the distance of the draw from the viewer
+         *
+         * @param object the offset of the ObjectData of the draw
+         *
+         * @param firstIndex the first index of the mesh to draw (e.g. of a level of detail)
+         *
+         * @param indexCount the number of indices to draw (zero to draw the whole mesh)
+         *
+         */
+        void submit(std::uint32_t layer, Program& program, std::uint32_t material, GLuint texture, GLuint sampler,
+                GeometryArena& arena, GeometryArena::Handle mesh, float depth, std::size_t object,
+                std::uint32_t firstIndex = 0, std::uint32_t indexCount = 0);
+
+        /**
+         * Queues a draw whose program reads its world transform from the DrawData storage of a
+         * BatchRenderer (see BatchRenderer), to be submitted along with the draws that share its
+         * state
+         *
+         * @param layer the layer of the draw (0 to 15)
+         *
+         * @param program the Program to draw with (must outlive the flush)
+         *
+         * @param material the material of the draw
+         *
+         * @param texture the texture to bind to unit zero (zero if none)
+         *
+         * @param sampler the sampler to bind to unit zero (zero if none)
+         *
+         * @param arena the GeometryArena that holds the mesh (must outlive the flush)
+         *
+         * @param mesh the mesh to draw
+         *
+         * @param depth the distance of the draw from the viewer
+         *
+         * @param world the transform from the space of the mesh to world space
+         *
+         * @param firstIndex the first index of the mesh to draw (e.g. of a level of detail)
+         *
+         * @param indexCount the number of indices to draw (zero to draw the whole mesh)
+         *
+         */
+        void submit(std::uint32_t layer, Program& program, std::uint32_t material, GLuint texture, GLuint sampler,
+                GeometryArena& arena, GeometryArena::Handle mesh, float depth, const Matrix4x4F& world,
+                std::uint32_t firstIndex = 0, std::uint32_t indexCount = 0);
+
+        /**
+         * Queues a draw whose key was already packed (e.g. by makeKey)
+         *
+         * @param item the draw to queue
+         *
+         */
+        void submit(const RenderItem& item);
+
+        /**
+         * Sorts the queued draws by their keys
+         *
+         */
+        void sort();
+
+        /**
+         * Sorts and submits the queued draws, and deactivates this RenderQueue
+         *
+         * @param uniforms the FrameUniforms that wrote the ObjectData of the draws
+         *
+         * @throws ResourceException if the BatchRenderer fails to grow its storage
+         *
+         */
+        void flush(FrameUniforms& uniforms);
+
+        /**
+         * Retrieves the queued draws (in sorted order after sort())
+         *
+         * @return the RenderItems of the current frame
+         *
+         */
+        const std::vector<RenderItem>& getItems() const noexcept;
+
+        /**
+         * Retrieves the cost of the most recent flush
+         *
+         * @return the Statistics
+         *
+         */
+        const Statistics& getStatistics() const noexcept;
+
+        /**
+         * Packs a sort key
+         *
+         * @param layer the layer (4 bits)
+         *
+         * @param program the id of the program (12 bits)
+         *
+         * @param material the id of the material (12 bits)
+         *
+         * @param texture the id of the texture (12 bits)
+         *
+         * @param buffer the id of the buffer (8 bits)
+         *
+         * @param depth the distance from the viewer, of which the 16 most significant bits are
+         * kept (negative distances sort first)
+         *
+         * @return the key
+         *
+         */
+        static std::uint64_t makeKey(std::uint32_t layer, std::uint32_t program, std::uint32_t material,
+                std::uint32_t texture, std::uint32_t buffer, float depth) noexcept;
+
+        /**
+         * Counts the state changes of a sequence of draws
+         *
+         * @param items the draws, in submission order
+         *
+         * @return the Switches
+         *
+         */
+        static Switches countSwitches(const std::vector<RenderItem>& items) noexcept;
+
+        /**
+         * Retrieves the RenderQueue that is collecting draws
+         *
+         * @return the active RenderQueue, or nullptr if nodes must draw immediately
+         *
+         */
+        static RenderQueue* getActive() noexcept;
+
+      private:
+
+        /**
+         * The storage of the active RenderQueue (render thread only)
+         *
+         */
+        static RenderQueue*& active() noexcept;
+    };
+
+}
+
+#include "RenderQueue.inl"
+
+#endif
@@ -1,38 +1,70 @@
 #ifndef ROTATION_HPP
 #define ROTATION_HPP
 
-#include "SceneGraphNode.hpp"
+#include "AbstractSceneGraphNode.hpp"
+#include "FrameUniforms.hpp"
+#include "Matrix.hpp"
+#include "Quaternion.hpp"
 
 namespace midnight
 {
     template<typename T>
-    class Rotation : public SceneGraphNode
+    class Rotation : public AbstractSceneGraphNode
     {
         Quaternion<T> rotation;
+
+        /// The rotation as a matrix, built once rather than per frame
+        Matrix4x4F transform;
+
+        /// The opposite rotation, which brings picking Rays into the space of the children
+        Matrix4x4F inverse;
         
       public:
           
         Rotation(Radians<T> angle, Vector<T, 3> axis) : 
-            rotation(axis, angle)
+            rotation(axis, angle),
+            transform(),
+            inverse(Matrix4x4F::IDENTITY())
         {
-            
+            const Matrix<T, 4, 4> matrix(rotation);
+            for(std::size_t row = 0; row < 4; ++row)
+            {
+                for(std::size_t column = 0; column < 4; ++column)
+                {
+                    transform(row, column) = static_cast<float>(matrix(row, column));
+                }
+            }
+            /// A rotation is never singular
+            picking::invert(transform, inverse);
         }
             
-        virtual void render(const Camera& camera)
+      protected:
+
+        virtual BoundingBoxF computeBounds() override
         {
-            Camera rotated(camera);
-            rotated.rotate(rotation);
-            for(const auto& child : getChildren())
-            {
-                child->render(rotated);
-            }
+            return AbstractSceneGraphNode::computeBounds().transform(transform);
+        }
+
+      public:
+
+        virtual void render(const Camera& camera) override
+        {
+            FrameUniforms& uniforms = FrameUniforms::getActive();
+            uniforms.pushTransform(transform);
+            this->AbstractSceneGraphNode::render(camera);
+            uniforms.popTransform();
+        }
+
+        virtual bool isPickable() override
+        {
+            return hasPickableChildren();
         }
 
-        virtual bool isPickable()
+        virtual bool intersect(const Ray& ray, float maximum, SurfaceHit& hit) override
         {
-            return false;
+            return AbstractSceneGraphNode::intersect(picking::transform(ray, inverse), maximum, hit);
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,12 +1,24 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "Camera.hpp"
+#include "FrameUniforms.hpp"
+#include "LooseOctree.hpp"
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include "OcclusionBuffer.hpp"
+#include "Picking.hpp"
+#include "Point.hpp"
 #include "Program.hpp"
+#include "RenderQueue.hpp"
 #include "SceneGraphNode.hpp"
+#include "parallel_for.hpp"
 
 namespace midnight
 {
@@ -20,11 +32,66 @@ class Scene
 //    Program program;
     
     Camera camera;
+    
+    /// Created on first use, as the constructor may run before a context exists
+    std::unique_ptr<FrameUniforms> frameUniforms;
+
+    /// The triangles of a Mesh that hides what lies behind it, placed in the world
+    struct Occluder
+    {
+        std::vector<Point3F> positions;
+        std::vector<std::uint32_t> indices;
+        Matrix4x4F world;
+    };
+
+    std::vector<Occluder> occluders;
+
+    /// Rasterized from the occluders at the start of every frame
+    OcclusionBuffer occlusion;
+
+    /// Collects the draws of a frame, so that they are submitted sorted by their state
+    RenderQueue renderQueue;
+
+    /// Indexes the nodes of the scene graph by their world bounds
+    LooseOctree<SceneGraphNode*> spatialIndex;
+
+    /// The handle of each node of the scene graph in the spatial index
+    std::vector<LooseOctree<SceneGraphNode*>::Handle> spatialHandles;
    
   public:
 
-    Scene(const Camera& camera) : 
-        camera(camera)
+    /**
+     * What a pick found under a point of the screen
+     * 
+     */
+    struct PickResult
+    {
+        /// The node that was hit (null if none was)
+        SceneGraphNode* node;
+
+        /// Where the node was hit, in world space
+        Point3F point;
+
+        /// The distance from the near plane to the hit, in world units
+        float distance;
+
+        /// The triangle that was hit, numbered as the node lays its triangles out
+        std::size_t primitive;
+    };
+
+    /**
+     * Constructs a Scene
+     * 
+     * @param camera the Camera of the Scene
+     * 
+     * @param world the region the spatial index subdivides (nodes outside of it are still found,
+     * only less quickly)
+     * 
+     */
+    Scene(const Camera& camera, const BoundingBoxF& world =
+            BoundingBoxF(Point3F(-4096.0f, -4096.0f, -4096.0f), Point3F(4096.0f, 4096.0f, 4096.0f))) : 
+        camera(camera),
+        spatialIndex(world)
     {
         
     }
@@ -32,14 +99,225 @@ class Scene
     void add(std::shared_ptr<SceneGraphNode> node)
     {
         sceneGraph.push_back(node);
+        spatialHandles.push_back(spatialIndex.insert(node->getBounds(), node.get()));
+    }
+
+    /**
+     * Brings the spatial index up to date with the bounds of every node, which render() does at
+     * the start of every frame.  A node whose center stays within its cell is only re-boxed.
+     * 
+     */
+    void updateSpatialIndex()
+    {
+        for(std::size_t i = 0; i < sceneGraph.size(); ++i)
+        {
+            spatialIndex.update(spatialHandles[i], sceneGraph[i]->getBounds());
+        }
+    }
+
+    /**
+     * Retrieves the spatial index of the nodes, whose values are the nodes themselves, for box,
+     * ray and nearest-node queries
+     * 
+     * @return the LooseOctree of this Scene
+     * 
+     */
+    const LooseOctree<SceneGraphNode*>& getSpatialIndex() const noexcept
+    {
+        return spatialIndex;
+    }
+
+    /**
+     * Finds the pickable node under a point of the screen, entirely on the CPU.  The Ray through
+     * the point is cast against the spatial index (as of the last render() or
+     * updateSpatialIndex()) to gather the nodes whose bounds it enters, nearest first, and each
+     * is then intersected with the Ray until the nearest hit lies before the bounds of the next.
+     * Nodes below transforms are found by casting the Ray, transformed, into their space.
+     * 
+     * @param screenX the horizontal position, from 0 (left) to 1 (right)
+     * 
+     * @param screenY the vertical position, from 0 (top) to 1 (bottom)
+     * 
+     * @param camera the Camera the screen is rendered with
+     * 
+     * @return the nearest hit (whose node is null if nothing was hit)
+     * 
+     */
+    PickResult pick(float screenX, float screenY, const Camera& camera) const
+    {
+        const Matrix4x4F viewProjection = FrameUniforms::computeView(camera) * camera.getProjection();
+        return pick(viewProjection, Point2F(screenX, screenY));
+    }
+
+    /**
+     * Picks a batch of points of the screen concurrently, which amortizes the view-projection
+     * and spreads the picks over the job scheduler
+     * 
+     * @param points the positions on the screen, as with pick()
+     * 
+     * @param camera the Camera the screen is rendered with
+     * 
+     * @param results receives the result of every point, in order
+     * 
+     */
+    void pick(const std::vector<Point2F>& points, const Camera& camera, std::vector<PickResult>& results) const
+    {
+        const Matrix4x4F viewProjection = FrameUniforms::computeView(camera) * camera.getProjection();
+        results.resize(points.size());
+        parallel_for(0, points.size(), [&](std::size_t i)
+        {
+            results[i] = pick(viewProjection, points[i]);
+        });
+    }
+
+    /**
+     * Finds the pickable node a Ray hits first
+     * 
+     * @param ray the Ray to cast, in world space
+     * 
+     * @param maximum the distance along the Ray beyond which nodes are ignored
+     * 
+     * @return the nearest hit (whose node is null if nothing was hit)
+     * 
+     */
+    PickResult pick(const Ray& ray, float maximum) const
+    {
+        PickResult result = {nullptr, Point3F(), maximum, 0};
+
+        /// Reused by every pick of a thread, so that picking allocates nothing once warm
+        static thread_local std::vector<typename LooseOctree<SceneGraphNode*>::RayHit> candidates;
+        candidates.clear();
+        spatialIndex.query(ray, maximum, candidates);
+        for(const auto& candidate : candidates)
+        {
+            if(candidate.distance > result.distance)
+            {
+                break;
+            }
+            SceneGraphNode* node = spatialIndex.get(candidate.handle);
+            SurfaceHit hit;
+            hit.node = nullptr;
+            if(node->isPickable() && node->intersect(ray, result.distance, hit))
+            {
+                result.node = hit.node != nullptr ? hit.node : node;
+                result.distance = hit.distance;
+                result.primitive = hit.primitive;
+            }
+        }
+        if(result.node != nullptr)
+        {
+            result.point = ray.getPoint(result.distance);
+        }
+        return result;
+    }
+
+    /**
+     * Adds an occluder: large, solid geometry (e.g. walls or terrain) that is rasterized into an
+     * OcclusionBuffer each frame, so that nodes hidden behind it are culled before they render.
+     * The occluder is not drawn; the nodes that draw it are added as usual.
+     * 
+     * @param mesh the Mesh whose triangles occlude
+     * 
+     * @param world the transform from the Mesh's space to world space
+     * 
+     */
+    void addOccluder(const Mesh& mesh, const Matrix4x4F& world = Matrix4x4F::IDENTITY())
+    {
+        Occluder occluder;
+        occluder.positions.reserve(mesh.getVertices().size());
+        for(const Vertex32F& vertex : mesh.getVertices())
+        {
+            occluder.positions.push_back(vertex.getPosition());
+        }
+        for(const Mesh::Renderable& renderable : mesh.getMeshes())
+        {
+            occluder.indices.insert(occluder.indices.end(), renderable.indices.begin(), renderable.indices.end());
+        }
+        occluder.world = world;
+        occluders.push_back(std::move(occluder));
+    }
+
+    /**
+     * Retrieves the OcclusionBuffer that the occluders are rasterized into
+     * 
+     * @return the OcclusionBuffer of this Scene
+     * 
+     */
+    const OcclusionBuffer& getOcclusionBuffer() const noexcept
+    {
+        return occlusion;
+    }
+
+    /**
+     * Retrieves the RenderQueue that the draws of every frame are sorted through
+     * 
+     * @return the RenderQueue of this Scene
+     * 
+     */
+    const RenderQueue& getRenderQueue() const noexcept
+    {
+        return renderQueue;
+    }
+
+    /**
+     * Retrieves the FrameUniforms that feed the camera and lighting to every node
+     * 
+     * @return the FrameUniforms of this Scene
+     * 
+     */
+    FrameUniforms& getFrameUniforms()
+    {
+        if(!frameUniforms)
+        {
+            frameUniforms.reset(new FrameUniforms());
+        }
+        return *frameUniforms;
     }
 
     void render(const Camera& camera)
     {
+        updateSpatialIndex();
+        FrameUniforms& uniforms = getFrameUniforms();
+        uniforms.begin(camera);
+        if(occluders.empty())
+        {
+            uniforms.setOcclusionBuffer(nullptr);
+        }
+        else
+        {
+            const Matrix4x4F viewProjection = FrameUniforms::computeView(camera) * camera.getProjection();
+            occlusion.clear();
+            for(const Occluder& occluder : occluders)
+            {
+                occlusion.addOccluder(occluder.positions, occluder.indices, occluder.world * viewProjection);
+            }
+            occlusion.rasterize();
+            uniforms.setOcclusionBuffer(&occlusion);
+        }
+        renderQueue.begin();
         for(const auto& node : sceneGraph)
         {
-            node->render(camera);
+            if(uniforms.enter(node->getBounds()))
+            {
+                node->render(camera);
+                uniforms.leave();
+            }
+        }
+        renderQueue.flush(uniforms);
+        uniforms.end();
+    }
+
+  private:
+
+    PickResult pick(const Matrix4x4F& viewProjection, const Point2F& point) const
+    {
+        float length;
+        const Ray ray = picking::unproject(viewProjection, 2.0f * point[0] - 1.0f, 1.0f - 2.0f * point[1], length);
+        if(length == 0.0f)
+        {
+            return PickResult{nullptr, Point3F(), 0.0f, 0};
         }
+        return pick(ray, length);
     }
 };
 
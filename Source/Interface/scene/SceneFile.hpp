@@ -0,0 +1,383 @@
+#ifndef SCENE_FILE_HPP
+#define SCENE_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "FlatSceneGraph.hpp"
+#include "Material.hpp"
+#include "Matrix.hpp"
+#include "Platform.hpp"
+
+namespace midnight
+{
+
+    /**
+     * A read-only view of a binary scene file: a node hierarchy with transforms, bounds, mesh
+     * references and materials, laid out so that it is used in place rather than parsed.
+     *
+     * The file is a Header followed by arrays of fixed-size records.  Every reference within the
+     * file (an array, or a string) is stored as the distance in bytes from the reference to its
+     * target, so the file holds no pointers and means the same wherever it is mapped.  Opening a
+     * file maps it into memory and checks the Header and the extents of the arrays, which costs
+     * the same for any number of nodes; records are only paged in once they are read.  verify()
+     * checks every record, which touches the whole file.
+     *
+     * Nodes are stored in depth-first order, as in a FlatSceneGraph: every parent precedes its
+     * children and every subtree is the contiguous range of its subtreeSize nodes.  Transforms
+     * are local, follow the row-vector convention of the shaders, and are stored in the element
+     * order of Matrix4x4F (column-major); bounds are local as well.
+     *
+     * Records are stored in the byte order of the writer.  A file of the other byte order, or of
+     * another version, is rejected by its magic number and version.
+     *
+     */
+    class SceneFile
+    {
+      public:
+
+        /// Identifies a scene file ("MSCN" in little-endian files)
+        static constexpr std::uint32_t MAGIC = 0x4E43534D;
+
+        /// The version of the layout of the records, changed whenever the layout does
+        static constexpr std::uint32_t VERSION = 1;
+
+        /// Marks a missing parent, mesh or material
+        static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+        /**
+         * An array stored elsewhere in the file
+         *
+         */
+        template<typename T>
+        struct RelativeArray
+        {
+            /// The distance from this RelativeArray to the first element, in bytes
+            std::int64_t offset;
+            std::uint64_t count;
+
+            const T* data() const noexcept
+            {
+                return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) + offset);
+            }
+
+            std::size_t size() const noexcept
+            {
+                return static_cast<std::size_t>(count);
+            }
+
+            bool empty() const noexcept
+            {
+                return count == 0;
+            }
+
+            const T& operator[](std::size_t index) const noexcept
+            {
+                return data()[index];
+            }
+
+            const T* begin() const noexcept
+            {
+                return data();
+            }
+
+            const T* end() const noexcept
+            {
+                return data() + count;
+            }
+        };
+
+        /// A string stored elsewhere in the file: its characters, followed by a terminating null
+        /// character that the count does not include
+        typedef RelativeArray<char> RelativeString;
+
+        /**
+         * A node of the hierarchy
+         *
+         */
+        struct NodeRecord
+        {
+            RelativeString name;
+
+            /// The position of the parent (NONE for roots), which precedes this node
+            std::uint32_t parent;
+
+            /// The number of nodes in the subtree of this node, including the node itself
+            std::uint32_t subtreeSize;
+
+            /// The MeshRecord and MaterialRecord of this node (NONE if none)
+            std::uint32_t mesh;
+            std::uint32_t material;
+
+            float transform[16];
+
+            /// The minimum and the maximum corner of the local bounds
+            float bounds[6];
+
+            Matrix4x4F getTransform() const noexcept;
+            BoundingBoxF getBounds() const noexcept;
+        };
+
+        /**
+         * A reference to a mesh, to be loaded by io::loadMesh
+         *
+         */
+        struct MeshRecord
+        {
+            RelativeString path;
+
+            /// The minimum and the maximum corner of the bounds of the mesh
+            float bounds[6];
+
+            BoundingBoxF getBounds() const noexcept;
+        };
+
+        /**
+         * A Material
+         *
+         */
+        struct MaterialRecord
+        {
+            std::uint32_t lightingMode;
+            std::uint32_t cullingMode;
+            std::uint32_t autoNormalize;
+            std::uint32_t reserved;
+            float ambience[4];
+            float diffusion[4];
+            float emission[4];
+            float specularity[4];
+
+            Material toMaterial() const;
+        };
+
+        /**
+         * The start of a scene file
+         *
+         */
+        struct Header
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+
+            /// The size of the file, in bytes
+            std::uint64_t size;
+
+            RelativeArray<NodeRecord> nodes;
+            RelativeArray<MeshRecord> meshes;
+            RelativeArray<MaterialRecord> materials;
+        };
+
+      private:
+
+        const unsigned char* data;
+        std::size_t size;
+
+        /// The mapping of the file (null for a view of memory)
+        void* mapping;
+
+      public:
+
+        /**
+         * Maps a scene file into memory
+         *
+         * @param path the path of the file
+         *
+         * @throws ResourceException if the file cannot be mapped, or is not a scene file of this
+         * version
+         *
+         */
+        explicit SceneFile(const std::string& path);
+
+        /**
+         * Views a scene file that is already in memory, such as a serialized SceneFileWriter
+         *
+         * @param data the contents of the file, aligned to eight bytes (must outlive the
+         * SceneFile)
+         *
+         * @param size the size of the contents, in bytes
+         *
+         * @throws ResourceException if the contents are not a scene file of this version
+         *
+         */
+        SceneFile(const void* data, std::size_t size);
+
+        SceneFile(const SceneFile&) = delete;
+        SceneFile& operator=(const SceneFile&) = delete;
+
+        /**
+         * Unmaps the file
+         *
+         */
+        ~SceneFile();
+
+        const Header& getHeader() const noexcept;
+
+        /// The records of the file, in place
+        const RelativeArray<NodeRecord>& getNodes() const noexcept;
+        const RelativeArray<MeshRecord>& getMeshes() const noexcept;
+        const RelativeArray<MaterialRecord>& getMaterials() const noexcept;
+
+        /**
+         * Checks every record: the hierarchy is in depth-first order, and every index and string
+         * lies within the file.  This reads the whole file.
+         *
+         * @return true if the records are consistent, otherwise false
+         *
+         */
+        bool verify() const noexcept;
+
+        /**
+         * Creates the nodes of this file in a FlatSceneGraph, with the index of their MeshRecord
+         * as their Renderable
+         *
+         * @param graph the FlatSceneGraph to create the nodes in (as new roots)
+         *
+         * @return the Handles of the nodes, in the order of the file
+         *
+         * @throws ResourceException if a node precedes its parent
+         *
+         */
+        std::vector<FlatSceneGraph::Handle> instantiate(FlatSceneGraph& graph) const;
+
+      private:
+
+        /**
+         * Checks the Header and the extents of its arrays
+         *
+         * @throws ResourceException if they do not describe a scene file of this version
+         *
+         */
+        void validate() const;
+
+        void unmap() noexcept;
+
+        /**
+         * Queries whether an array, whose RelativeArray lies within the file, lies within the file
+         *
+         */
+        template<typename T>
+        bool contains(const RelativeArray<T>& array) const noexcept;
+
+        /**
+         * Queries whether a string, whose RelativeString lies within the file, lies within the
+         * file and is terminated
+         *
+         */
+        bool contains(const RelativeString& string) const noexcept;
+    };
+
+    /**
+     * Builds scene files.  Nodes may be added in any order in which parents precede their
+     * children; the file stores them in depth-first order, the children of every node in the
+     * order they were added.
+     *
+     */
+    class SceneFileWriter
+    {
+        struct Node
+        {
+            std::string name;
+            std::uint32_t parent;
+            std::uint32_t mesh;
+            std::uint32_t material;
+            Matrix4x4F transform;
+            BoundingBoxF bounds;
+        };
+
+        struct MeshReference
+        {
+            std::string path;
+            BoundingBoxF bounds;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<MeshReference> meshes;
+        std::vector<Material> materials;
+
+      public:
+
+        /**
+         * Adds a reference to a mesh
+         *
+         * @param path the path to load the mesh from
+         *
+         * @param bounds the bounds of the mesh
+         *
+         * @return the index of the mesh
+         *
+         */
+        std::uint32_t addMesh(const std::string& path, const BoundingBoxF& bounds = BoundingBoxF());
+
+        /**
+         * Adds a Material
+         *
+         * @param material the Material to add
+         *
+         * @return the index of the Material
+         *
+         */
+        std::uint32_t addMaterial(const Material& material);
+
+        /**
+         * Adds a node
+         *
+         * @param parent the index of the parent, as returned by addNode (SceneFile::NONE for a
+         * root)
+         *
+         * @param transform the transform of the node relative to its parent
+         *
+         * @param bounds the bounds of the node in its own space (empty if none)
+         *
+         * @param mesh the index of the mesh of the node (SceneFile::NONE if none)
+         *
+         * @param material the index of the Material of the node (SceneFile::NONE if none)
+         *
+         * @param name the name of the node
+         *
+         * @return the index of the node, in the order of addition
+         *
+         * @throws IllegalArgumentException if the parent, the mesh or the Material has not been
+         * added
+         *
+         */
+        std::uint32_t addNode(std::uint32_t parent, const Matrix4x4F& transform = Matrix4x4F::IDENTITY(),
+                const BoundingBoxF& bounds = BoundingBoxF(), std::uint32_t mesh = SceneFile::NONE,
+                std::uint32_t material = SceneFile::NONE, const std::string& name = std::string());
+
+        /**
+         * Retrieves the number of nodes added
+         *
+         */
+        std::size_t getNodeCount() const noexcept;
+
+        /**
+         * Lays out the scene file
+         *
+         * @param positions receives the position in the file of every node, in the order of
+         * addition (if not null)
+         *
+         * @return the contents of the file
+         *
+         */
+        std::vector<unsigned char> serialize(std::vector<std::uint32_t>* positions = nullptr) const;
+
+        /**
+         * Writes the scene file, replacing any existing file once it is complete
+         *
+         * @param path the path of the file
+         *
+         * @throws ResourceException if the file cannot be written
+         *
+         */
+        void write(const std::string& path) const;
+    };
+
+}
+
+#include "SceneFile.inl"
+
+#endif
@@ -4,7 +4,10 @@
 #include <memory>
 #include <vector>
 
+#include "BoundingBox.hpp"
 #include "Camera.hpp"
+#include "Picking.hpp"
+#include "Ray.hpp"
 
 namespace midnight
 {
@@ -12,12 +15,27 @@ namespace midnight
     class SceneGraphNode
     {
 
-        
+        /// The nodes that hold this one as a child (not owned), which cache bounds enclosing it
+        std::vector<SceneGraphNode*> parents;
+
+        friend class AbstractSceneGraphNode;
         
       protected:
 
         virtual const std::vector<std::shared_ptr<SceneGraphNode>>& getChildren() const = 0;
 
+        /**
+         * Discards the cached bounds of this node and of its ancestors
+         * 
+         */
+        virtual void invalidateBounds()
+        {
+            for(SceneGraphNode* parent : parents)
+            {
+                parent->invalidateBounds();
+            }
+        }
+
       public:
 
         SceneGraphNode() = default;
@@ -26,8 +44,43 @@ namespace midnight
 
         virtual void add(std::shared_ptr<SceneGraphNode> child) = 0;
 
+        /**
+         * Retrieves the bounds of this node and its descendants, in the space this node is
+         * rendered in.  Nodes whose bounds lie outside of the view are not rendered.
+         * 
+         * @return the bounds (empty if nothing is drawn)
+         * 
+         */
+        virtual const BoundingBoxF& getBounds() = 0;
+
+        /**
+         * Queries whether a Ray may hit this node or one of its descendants
+         * 
+         * @return true if intersect() may find a hit, otherwise false
+         * 
+         */
         virtual bool isPickable() = 0;
 
+        /**
+         * Finds where a Ray crosses what this node or one of its descendants draws, in the space
+         * this node is rendered in.  Picking calls this from several threads at once, so it must
+         * not modify the node.
+         * 
+         * @param ray the Ray to cast
+         * 
+         * @param maximum the distance beyond which hits are ignored
+         * 
+         * @param hit receives the nearest hit, whose node is set only if a descendant was hit
+         * 
+         * @return true if the Ray hits this node no further than the maximum (never, unless the
+         * node overrides this)
+         * 
+         */
+        virtual bool intersect(const Ray&, float, SurfaceHit&)
+        {
+            return false;
+        }
+
         virtual ~SceneGraphNode() = default;
     };
     
@@ -14,10 +14,13 @@
 #ifndef SKYBOX_HPP
 #define SKYBOX_HPP
 
+#include <memory>
 #include <vector>
 
 #include "Program.hpp"
+#include "ProgramRegistry.hpp"
 #include "AbstractSceneGraphNode.hpp"
+#include "FrameUniforms.hpp"
 #include "Texture.hpp"
 #include "VertexBuffer.hpp"
 
@@ -53,10 +56,13 @@ class Skybox : public AbstractSceneGraphNode
     std::shared_ptr<SceneGraphNode> parent;
     
     /// The Program that this Skybox will be rendered by
-    Program program;
+    std::shared_ptr<Program> program;
     
     /// The Texture of this Skybox
     Texture texture;
+
+    /// Filters the Texture without blending across the faces
+    std::shared_ptr<Sampler> sampler;
     
     /// The VertexBuffer object of this Skybox
     midnight::StaticDrawQuadBuffer<T> vbo;
@@ -68,10 +74,10 @@ class Skybox : public AbstractSceneGraphNode
      * 
      * @param parent the parent node of this Skybox
      * 
-     * @param textureFile the image file for the texture of this Skybox
+     * @param texture the texture of this Skybox, which the Skybox takes ownership of
      * 
      */
-    Skybox(std::shared_ptr<SceneGraphNode> parent, const Texture& textureFile);
+    Skybox(std::shared_ptr<SceneGraphNode> parent, Texture texture);
 
     /**
      * Renders this Skybox
@@ -9,8 +9,10 @@
 
 #include "Heightmap.hpp"
 #include "AbstractSceneGraphNode.hpp"
+#include "FrameUniforms.hpp"
 #include "TextureProvider.hpp"
 #include "Program.hpp"
+#include "ProgramRegistry.hpp"
 
 #include "IndexBuffer.hpp"
 #include "VertexBuffer.hpp"
@@ -38,9 +40,12 @@ namespace midnight
         
         /// The texture of this Terrain
         Texture texture;
+
+        /// Filters the texture of this Terrain
+        std::shared_ptr<Sampler> sampler;
         
         /// The Program to render this Terrain with
-        Program program;
+        std::shared_ptr<Program> program;
 
         /// A triangle buffer that holds the vertex data of this Terrain
         std::unique_ptr<StaticDrawTriangleBuffer<T>> vertexData;
@@ -63,6 +68,13 @@ namespace midnight
         const Heightmap& getHeightmap() const;
 
         virtual bool isPickable() override;
+
+        /**
+         * Finds where a Ray crosses the surface of this Terrain, by marching over the cells of
+         * its heightmap.  Triangles are numbered as the index data lays them out.
+         * 
+         */
+        virtual bool intersect(const Ray& ray, float maximum, SurfaceHit& hit) override;
         
         void setAmbience(const AmbientLight<float>& ambience);
         
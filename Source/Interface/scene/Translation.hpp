@@ -1,39 +1,65 @@
 #ifndef TRANSFORMATION_HPP
 #define TRANSFORMATION_HPP
 
-#include "SceneGraphNode.hpp"
+#include "AbstractSceneGraphNode.hpp"
+#include "FrameUniforms.hpp"
+#include "Matrix.hpp"
 #include "Vector.hpp"
 
 namespace midnight
 {
     template<typename T>
-    class Translation : public SceneGraphNode
+    class Translation : public AbstractSceneGraphNode
     {
         Vector<T, 3> translation;
+
+        /// The translation as a row-vector matrix, built once rather than per frame
+        Matrix4x4F transform;
+
+        /// The opposite translation, which brings picking Rays into the space of the children
+        Matrix4x4F inverse;
         
       public:
         
         Translation(T x, T y, T z) : 
-            translation(x, y, z)
+            translation(x, y, z),
+            transform(Matrix4x4F::IDENTITY()),
+            inverse(Matrix4x4F::IDENTITY())
         {
-            
+            for(std::size_t i = 0; i < 3; ++i)
+            {
+                transform(3, i) = static_cast<float>(translation[i]);
+                inverse(3, i) = -static_cast<float>(translation[i]);
+            }
         }
         
-        virtual void render(const Camera& camera)
+      protected:
+
+        virtual BoundingBoxF computeBounds() override
         {
-            Camera translated(camera);
-            translated.translate(translation);
-            for(const auto& child : getChildren())
-            {
-                child->render(translated);
-            }
+            return AbstractSceneGraphNode::computeBounds().transform(transform);
+        }
+
+      public:
+
+        virtual void render(const Camera& camera) override
+        {
+            FrameUniforms& uniforms = FrameUniforms::getActive();
+            uniforms.pushTransform(transform);
+            this->AbstractSceneGraphNode::render(camera);
+            uniforms.popTransform();
+        }
+
+        virtual bool isPickable() override
+        {
+            return hasPickableChildren();
         }
 
-        virtual bool isPickable()
+        virtual bool intersect(const Ray& ray, float maximum, SurfaceHit& hit) override
         {
-            return false;
+            return AbstractSceneGraphNode::intersect(picking::transform(ray, inverse), maximum, hit);
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,123 @@
+#ifndef TRIANGLE_BVH_HPP
+#define TRIANGLE_BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "Picking.hpp"
+#include "Point.hpp"
+#include "Ray.hpp"
+
+namespace midnight
+{
+
+    /**
+     * A bounding volume hierarchy over the triangles of a mesh, which finds the triangle a Ray
+     * crosses first in logarithmic time.
+     *
+     * The hierarchy is built once, by splitting the triangles at the median of their centroids
+     * along the longest axis until at most LEAF_SIZE remain.  The corners of the triangles are
+     * copied in the order of the leaves, so that a traversal reads them sequentially, and nodes
+     * are visited nearest first so that farther subtrees are usually skipped.
+     *
+     * A TriangleBVH is immutable once built, so it may be queried by any number of threads.
+     *
+     */
+    class TriangleBVH
+    {
+      public:
+
+        /// The largest number of triangles in a leaf
+        static constexpr std::size_t LEAF_SIZE = 4;
+
+      private:
+
+        struct Node
+        {
+            BoundingBoxF bounds;
+
+            /// The first triangle of a leaf, or the first of the two adjacent children of a branch
+            std::uint32_t first;
+
+            /// The number of triangles of a leaf (zero for a branch)
+            std::uint32_t count;
+        };
+
+        std::vector<Node> nodes;
+
+        /// The corners of the triangles, three at a time, in the order of the leaves
+        std::vector<Point3F> corners;
+
+        /// The index of each triangle in the mesh it was built from, in the order of the leaves
+        std::vector<std::uint32_t> triangles;
+
+      public:
+
+        /**
+         * Constructs a TriangleBVH without any triangles
+         *
+         */
+        TriangleBVH() = default;
+
+        /**
+         * Constructs a TriangleBVH over the triangles of a mesh
+         *
+         * @param positions the positions of the vertices
+         *
+         * @param indices three indices into the positions for every triangle
+         *
+         * @throws IllegalArgumentException if the number of indices is not a multiple of three, or
+         * an index is out of range
+         *
+         */
+        TriangleBVH(const std::vector<Point3F>& positions, const std::vector<std::uint32_t>& indices);
+
+        /**
+         * Finds the triangle a Ray crosses first, from either side
+         *
+         * @param ray the Ray to cast
+         *
+         * @param maximum the distance beyond which hits are ignored
+         *
+         * @param hit receives the distance and the index of the triangle, as numbered by the
+         * indices the TriangleBVH was built from
+         *
+         * @return true if the Ray crosses a triangle no further than the maximum, otherwise false
+         *
+         */
+        bool intersect(const Ray& ray, float maximum, SurfaceHit& hit) const noexcept;
+
+        /**
+         * Retrieves the number of triangles
+         *
+         * @return the number of triangles
+         *
+         */
+        std::size_t getTriangleCount() const noexcept;
+
+        /**
+         * Retrieves the number of nodes of the hierarchy
+         *
+         * @return the number of nodes
+         *
+         */
+        std::size_t getNodeCount() const noexcept;
+
+      private:
+
+        /**
+         * Builds the subtree of a node out of a range of triangles, reordering the range
+         *
+         */
+        void build(std::size_t node, std::size_t begin, std::size_t end, const std::vector<BoundingBoxF>& bounds,
+                const std::vector<Point3F>& centroids);
+    };
+
+}
+
+#include "TriangleBVH.inl"
+
+#endif
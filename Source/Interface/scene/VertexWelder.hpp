@@ -0,0 +1,142 @@
+#ifndef VERTEX_WELDER_HPP
+#define VERTEX_WELDER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Material.hpp"
+#include "Mesh.hpp"
+#include "Vertex.hpp"
+
+namespace midnight
+{
+
+    /**
+     * Builds indexed geometry out of unindexed triangle lists ("triangle soup") by merging
+     * vertices whose attributes are equal within a set of per-attribute tolerances.
+     *
+     * Every attribute is quantized onto a grid whose cell size is the tolerance of that
+     * attribute, and vertices that fall into the same cell for all attributes are merged.  A
+     * tolerance of zero demands bit-wise equality (with the exception of signed zeros).
+     *
+     * Two interchangeable grouping strategies are available:
+     * <ol>
+     *  <li>an open-addressing hash table, sharded by the upper hash bits so that every shard
+     *  can be filled concurrently</li>
+     *  <li>a parallel LSD radix sort of the hashes, which streams through memory and scales
+     *  better once the tables outgrow the caches</li>
+     * </ol>
+     *
+     * Both produce the same output: unique vertices appear in the order of their first
+     * occurrence in the soup, and the representative of each group is that first occurrence.
+     *
+     */
+    class VertexWelder
+    {
+      public:
+
+        /**
+         * The algorithm used to group equal vertices
+         *
+         */
+        enum class Strategy
+        {
+            /// Chooses HASH or RADIX_SORT based upon the size of the input
+            AUTOMATIC,
+
+            /// Always uses the sharded hash table
+            HASH,
+
+            /// Always uses the radix sort
+            RADIX_SORT
+        };
+
+        /// The input size at which the AUTOMATIC strategy switches to RADIX_SORT
+        static constexpr std::size_t RADIX_SORT_THRESHOLD = std::size_t(1) << 22;
+
+      private:
+
+        /// The quantization step of vertex positions
+        float positionTolerance;
+
+        /// The quantization step of vertex normals
+        float normalTolerance;
+
+        /// The quantization step of vertex texture coordinates
+        float texCoordTolerance;
+
+        /// The algorithm used to group equal vertices
+        Strategy strategy;
+
+      public:
+
+        /**
+         * Constructs a VertexWelder
+         *
+         * @param positionTolerance the quantization step of vertex positions
+         *
+         * @param normalTolerance the quantization step of vertex normals
+         *
+         * @param texCoordTolerance the quantization step of vertex texture coordinates
+         *
+         * @param strategy the algorithm used to group equal vertices
+         *
+         * @throws IllegalArgumentException if any tolerance is negative or not a number
+         *
+         */
+        explicit VertexWelder(float positionTolerance = 1.0e-5f, float normalTolerance = 1.0e-3f, float texCoordTolerance = 1.0e-5f, Strategy strategy = Strategy::AUTOMATIC);
+
+        /**
+         * Merges the equal vertices of the provided soup
+         *
+         * @param soup the vertices to weld
+         *
+         * @param vertices receives the unique vertices, in order of first occurrence
+         *
+         * @return for every vertex of the soup, the index of its unique vertex
+         *
+         * @throws IllegalArgumentException if an attribute cannot be quantized with the
+         * configured tolerance (it is not finite, or too large for the grid)
+         *
+         */
+        std::vector<std::size_t> weld(const std::vector<Vertex32F>& soup, std::vector<Vertex32F>& vertices) const;
+
+        /**
+         * Builds an indexed Mesh out of the provided triangle soup
+         *
+         * @param soup the unindexed triangle list to weld
+         *
+         * @param materials the Materials of the resulting Mesh
+         *
+         * @param materialIndex the Material index of the single Renderable of the resulting Mesh
+         *
+         * @return the resulting Mesh
+         *
+         * @throws IllegalArgumentException if the soup is not a triangle list, or an attribute
+         * cannot be quantized with the configured tolerance
+         *
+         */
+        Mesh createMesh(const std::vector<Vertex32F>& soup, const std::vector<Material>& materials, std::size_t materialIndex = 0) const;
+
+      private:
+
+        /**
+         * Assigns every vertex the index of the first vertex with an equal key using the
+         * sharded hash table
+         *
+         */
+        static void groupByHash(const std::vector<std::uint64_t>& hashes, const std::vector<std::int64_t>& keys, std::vector<std::size_t>& representatives);
+
+        /**
+         * Assigns every vertex the index of the first vertex with an equal key using the
+         * radix sort
+         *
+         */
+        static void groupByRadixSort(const std::vector<std::uint64_t>& hashes, const std::vector<std::int64_t>& keys, std::vector<std::size_t>& representatives);
+    };
+
+}
+
+#include "VertexWelder.inl"
+
+#endif
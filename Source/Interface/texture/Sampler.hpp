@@ -0,0 +1,88 @@
+#ifndef SAMPLER_HPP
+#    define SAMPLER_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <cstdint>
+#    include <memory>
+
+#    include "TextureUnits.hpp"
+
+namespace midnight
+{
+
+/**
+ * A wrapper class for a GL sampler object, which holds the filtering and wrapping of texture
+ * lookups apart from the textures themselves.  The parameters are set once upon construction,
+ * so drawing with a Sampler never touches them again.
+ *
+ * Samplers are shared by their parameters through acquire; any number of Textures may be drawn
+ * with the same Sampler.
+ *
+ * @note Requires OpenGL 3.3 (or ARB_sampler_objects)
+ *
+ */
+class Sampler
+{
+    /// The implementation provided handle to this Sampler
+    GLuint handle;
+
+    GLenum minFilter;
+    GLenum magFilter;
+    GLenum wrap;
+
+  public:
+
+    /**
+     * Constructs a Sampler with the provided parameters
+     *
+     * @param minFilter the minifying filter (GL_NEAREST, GL_LINEAR_MIPMAP_LINEAR...)
+     *
+     * @param magFilter the magnifying filter (GL_NEAREST or GL_LINEAR)
+     *
+     * @param wrap the wrapping of every texture coordinate (GL_CLAMP_TO_EDGE, GL_REPEAT...)
+     *
+     * @throws IllegalArgumentException if the implementation rejects a parameter
+     *
+     * @throws ResourceException if the implementation fails to create this Sampler
+     *
+     */
+    Sampler(GLenum minFilter, GLenum magFilter, GLenum wrap);
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    /**
+     * Deletes this Sampler from the implementation
+     *
+     */
+    ~Sampler();
+
+    /**
+     * Retrieves the implementation provided handle of this Sampler
+     *
+     * @return the GL sampler name
+     *
+     */
+    GLuint getHandle() const noexcept;
+
+    /// The parameters this Sampler was created with
+    GLenum getMinFilter() const noexcept;
+    GLenum getMagFilter() const noexcept;
+    GLenum getWrap() const noexcept;
+
+    /**
+     * Retrieves the shared Sampler of the provided parameters, creating it if no user holds one
+     *
+     * @see Sampler(GLenum, GLenum, GLenum)
+     *
+     */
+    static std::shared_ptr<Sampler> acquire(GLenum minFilter, GLenum magFilter, GLenum wrap);
+};
+
+}
+
+#    include "Sampler.inl"
+
+#endif
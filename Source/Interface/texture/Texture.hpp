@@ -1,38 +1,108 @@
 #ifndef TEXTURE_HPP
 #    define TEXTURE_HPP
 
+#    include "BuildConstraints.hpp"
 #    include "Platform.hpp"
 
+#    include <vector>
+
+#    include "Sampler.hpp"
+#    include "TextureUnits.hpp"
+
 namespace midnight
 {
 
+/**
+ * A wrapper class for an RGBA8 2D texture with immutable storage (glTexStorage2D).  Textures
+ * may not be copied, but may be moved; the GL texture is deleted along with its owner.
+ *
+ * How a Texture is filtered is up to the Sampler it is bound with.
+ *
+ * @note Requires OpenGL 4.2 (or ARB_texture_storage)
+ *
+ */
 class Texture
 {
-    std::vector<unsigned char> data;
+    /// The implementation provided handle to this Texture (zero once moved from)
+    GLuint handle;
+
+    std::size_t width;
+    std::size_t height;
 
   public:
-    GLuint handle;
 
-    Texture(std::size_t width, std::size_t height, const std::vector<unsigned char>& data)
-    {
-        glGenTextures(1, &handle);
-        glBindTexture(GL_TEXTURE_2D, handle);
-        glTexImage2D(GL_TEXTURE_2D, 0, 4, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]);
-    }
-    
-    void bind()
-    {
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, handle);
-    }
-
-    void unbind()
-    {
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glDisable(GL_TEXTURE_2D);
-    }
+    /**
+     * Constructs a Texture from tightly packed RGBA8 rows
+     *
+     * @param width the width of the Texture in texels
+     *
+     * @param height the height of the Texture in texels
+     *
+     * @param data width * height * 4 bytes
+     *
+     * @param levels the number of mipmap levels to allocate and generate from the data
+     *
+     * @throws IllegalArgumentException if a dimension or the number of levels is zero, or if
+     * the data does not hold width * height texels
+     *
+     * @throws ResourceException if the implementation fails to create this Texture
+     *
+     */
+    Texture(std::size_t width, std::size_t height, const std::vector<unsigned char>& data, std::size_t levels = 1);
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    /**
+     * Move-constructs this Texture based on the provided one
+     *
+     * @param other the Texture that is being moved
+     *
+     */
+    Texture(Texture&& other) noexcept;
+
+    /**
+     * Move-assigns this Texture based on the provided one
+     *
+     * @param other the Texture that is being moved
+     *
+     * @return *this
+     *
+     */
+    Texture& operator=(Texture&& other) noexcept;
+
+    /**
+     * Deletes this Texture from the implementation
+     *
+     */
+    ~Texture();
+
+    /**
+     * Binds this Texture and the provided Sampler to a texture unit through the default
+     * TextureUnits, which skips whatever the unit already holds
+     *
+     * @param unit the index of the texture unit
+     *
+     * @param sampler the Sampler to filter this Texture with
+     *
+     */
+    void bind(GLuint unit, const Sampler& sampler) const;
+
+    /**
+     * Retrieves the implementation provided handle of this Texture
+     *
+     * @return the GL texture name
+     *
+     */
+    GLuint getHandle() const noexcept;
+
+    /// The dimensions of this Texture in texels
+    std::size_t getWidth() const noexcept;
+    std::size_t getHeight() const noexcept;
 };
 
 }
 
-#endif
\ No newline at end of file
+#    include "Texture.inl"
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef TEXTURE_UNITS_HPP
+#    define TEXTURE_UNITS_HPP
+
+#    include "BuildConstraints.hpp"
+#    include "Platform.hpp"
+
+#    include <vector>
+
+namespace midnight
+{
+
+/**
+ * Shadows the texture and sampler bound to every texture unit, so that binding what a unit
+ * already holds issues no GL calls at all.  Textures and Samplers bind through the default
+ * TextureUnits, and forget their names when they are deleted.
+ *
+ * Code that binds textures directly must restore the previous binding of the active unit (or
+ * call invalidate) to keep the shadow accurate.
+ *
+ */
+class TextureUnits
+{
+  public:
+
+    /**
+     * Counts the binds requested from a TextureUnits
+     *
+     */
+    struct Statistics
+    {
+        /// The number of texture or sampler binds that reached the implementation
+        std::size_t issued;
+
+        /// The number of binds skipped because the unit already held the object
+        std::size_t skipped;
+
+        Statistics() : issued(0), skipped(0)
+        {
+
+        }
+    };
+
+  private:
+
+    /**
+     * The objects last bound to a unit (or UNKNOWN)
+     *
+     */
+    struct Unit
+    {
+        GLuint texture;
+        GLuint sampler;
+    };
+
+    /// Never returned by the implementation as a name
+    static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+
+    std::vector<Unit> units;
+
+    /// The unit last selected through glActiveTexture (or GL_NONE if unknown)
+    GLenum active;
+
+    Statistics statistics;
+
+  public:
+
+    /**
+     * Constructs TextureUnits that assume nothing about the bound objects
+     *
+     */
+    TextureUnits();
+
+    TextureUnits(const TextureUnits&) = delete;
+    TextureUnits& operator=(const TextureUnits&) = delete;
+
+    /**
+     * Binds a 2D texture and a sampler to a texture unit, skipping whatever the unit already
+     * holds.  Leaves the provided unit active if the texture had to be bound.
+     *
+     * @param unit the index of the texture unit
+     *
+     * @param texture the name of the texture (zero to unbind)
+     *
+     * @param sampler the name of the sampler (zero to use the parameters of the texture)
+     *
+     */
+    void bind(GLuint unit, GLuint texture, GLuint sampler);
+
+    /**
+     * Forgets a deleted texture, which the implementation unbinds implicitly
+     *
+     * @param texture the name of the deleted texture
+     *
+     */
+    void forgetTexture(GLuint texture) noexcept;
+
+    /**
+     * Forgets a deleted sampler, which the implementation unbinds implicitly
+     *
+     * @param sampler the name of the deleted sampler
+     *
+     */
+    void forgetSampler(GLuint sampler) noexcept;
+
+    /**
+     * Discards the shadow, so that the next bind of every unit reaches the implementation
+     *
+     */
+    void invalidate() noexcept;
+
+    /**
+     * Retrieves the binds requested since the last reset
+     *
+     * @return the number of issued and skipped binds
+     *
+     */
+    const Statistics& getStatistics() const noexcept;
+
+    /**
+     * Resets the bind counters, typically once per frame
+     *
+     */
+    void resetStatistics() noexcept;
+
+    /**
+     * Retrieves the TextureUnits of the current context
+     *
+     * @return the default TextureUnits
+     *
+     */
+    static TextureUnits& getDefault();
+};
+
+}
+
+#    include "TextureUnits.inl"
+
+#endif
@@ -0,0 +1,370 @@
+/**
+ * Internal Utility Header:
+ *  The engine's job scheduler.  A fixed set of worker threads execute small jobs that are pushed
+ *  onto per-worker Chase-Lev deques: a worker pushes and pops the bottom of its own deque, while
+ *  idle workers steal from the top of the others.  Threads that are not workers (e.g. the GLUT
+ *  thread) push onto a shared injection queue, and help execute jobs while they wait.
+ *
+ *  Jobs report their completion to a Counter, and a job may be held back until a Counter reaches
+ *  zero, which is how dependencies between jobs are expressed.
+ *
+ */
+#ifndef JOB_SCHEDULER_HPP
+#    define JOB_SCHEDULER_HPP
+
+#    include <algorithm>
+#    include <atomic>
+#    include <condition_variable>
+#    include <cstddef>
+#    include <cstdint>
+#    include <deque>
+#    include <exception>
+#    include <functional>
+#    include <memory>
+#    include <mutex>
+#    include <thread>
+#    include <vector>
+
+namespace midnight
+{
+
+namespace jobs
+{
+
+class Counter;
+
+/**
+ * A unit of work, along with the Counter to signal once it completes
+ *
+ */
+struct Job
+{
+    std::function<void()> work;
+    Counter* signal;
+};
+
+/**
+ * A Chase-Lev work-stealing deque of a fixed capacity.
+ *
+ * The owning thread pushes and pops at the bottom, in last-in first-out order, so that it keeps
+ * working on the data it has just touched; any other thread may steal from the top, taking the
+ * oldest (and usually largest) piece of work.  Only the owning thread may call push() and pop().
+ *
+ */
+class WorkStealingDeque
+{
+    std::vector<std::atomic<Job*>> buffer;
+    std::size_t mask;
+    std::atomic<std::int64_t> top;
+    std::atomic<std::int64_t> bottom;
+
+  public:
+
+    /**
+     * Constructs an empty WorkStealingDeque
+     *
+     * @param capacity the maximum number of jobs held (must be a power of two)
+     *
+     * @throws IllegalArgumentException if the capacity is not a power of two
+     *
+     */
+    explicit WorkStealingDeque(std::size_t capacity);
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * Pushes a job at the bottom (owner only)
+     *
+     * @param job the job to push
+     *
+     * @return false if the deque is full
+     *
+     */
+    bool push(Job* job) noexcept;
+
+    /**
+     * Pops the most recently pushed job (owner only)
+     *
+     * @return the job, or nullptr if the deque is empty
+     *
+     */
+    Job* pop() noexcept;
+
+    /**
+     * Steals the least recently pushed job
+     *
+     * @return the job, or nullptr if the deque is empty or another thread won the job
+     *
+     */
+    Job* steal() noexcept;
+
+    /**
+     * Retrieves the number of jobs held, which is only a snapshot while other threads steal
+     *
+     * @return the number of jobs
+     *
+     */
+    std::size_t size() const noexcept;
+};
+
+/**
+ * Counts the jobs that have been run against it and have not completed yet.
+ *
+ * A Counter is signaled by Scheduler::run() and released by the completion of each job; jobs that
+ * depend on it are held until it reaches zero.  The first exception thrown by one of its jobs is
+ * kept, and re-thrown by Scheduler::wait().  A Counter must outlive its jobs, and every job that
+ * depends on it must have been released before it is destroyed.
+ *
+ */
+class Counter
+{
+    friend class Scheduler;
+
+    std::atomic<std::size_t> value;
+
+    /// Guards the transition to zero, the jobs held back and the failure
+    std::mutex lock;
+    std::vector<Job*> dependents;
+    std::exception_ptr failure;
+
+  public:
+
+    /**
+     * Constructs a Counter at zero
+     *
+     */
+    Counter() noexcept;
+
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    /**
+     * Retrieves the number of jobs that have not completed yet
+     *
+     * @return the count
+     *
+     */
+    std::size_t get() const noexcept;
+};
+
+/**
+ * A pool of worker threads that execute jobs, stealing from each other when they run dry.
+ *
+ * Idle workers spin briefly and then sleep until a job is queued.  A Scheduler with no workers is
+ * valid: its jobs are then executed by the threads that wait for them.
+ *
+ */
+class Scheduler
+{
+  public:
+
+    /// The default capacity of the deque of each worker
+    static constexpr std::size_t DEFAULT_DEQUE_CAPACITY = 4096;
+
+    /// The number of times an idle worker looks for a job before it sleeps
+    static constexpr std::size_t SPIN_COUNT = 64;
+
+  private:
+
+    /**
+     * The scheduler a thread works for, and the index of its deque
+     *
+     */
+    struct Context
+    {
+        const Scheduler* scheduler;
+        std::size_t index;
+    };
+
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::vector<std::thread> workers;
+
+    /// The jobs queued by threads that are not workers, and those that overflowed a deque
+    std::mutex injectionLock;
+    std::deque<Job*> injection;
+
+    /// The number of queued jobs that no thread has taken yet
+    std::atomic<std::size_t> pending;
+    std::atomic<std::size_t> sleeping;
+    std::atomic<bool> stopping;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+  public:
+
+    /**
+     * Constructs a Scheduler and starts its workers
+     *
+     * @param workerCount the number of worker threads
+     *
+     * @param capacity the capacity of the deque of each worker (must be a power of two)
+     *
+     * @throws IllegalArgumentException if the capacity is not a power of two
+     *
+     */
+    explicit Scheduler(std::size_t workerCount, std::size_t capacity = DEFAULT_DEQUE_CAPACITY);
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /**
+     * Executes every queued job, then stops and joins the workers
+     *
+     */
+    ~Scheduler();
+
+    /**
+     * Queues a job
+     *
+     * @param work the work to execute
+     *
+     * @param signal the Counter to signal until the job completes (may be nullptr, in which case
+     * the work must not throw)
+     *
+     * @param dependency a Counter the job is held back by until it reaches zero (may be nullptr)
+     *
+     */
+    void run(std::function<void()> work, Counter* signal = nullptr, Counter* dependency = nullptr);
+
+    /**
+     * Executes queued jobs on the calling thread until the provided Counter reaches zero
+     *
+     * @param counter the Counter to wait for
+     *
+     * @note the first exception thrown by a job of the Counter is re-thrown, and cleared
+     *
+     */
+    void wait(Counter& counter);
+
+    /**
+     * Retrieves the number of worker threads
+     *
+     * @return the number of workers
+     *
+     */
+    std::size_t getWorkerCount() const noexcept;
+
+    /**
+     * Tells whether a worker would likely pick up a job queued now, which is when splitting work
+     * further pays off
+     *
+     * @return true if fewer jobs are queued than there are workers
+     *
+     */
+    bool isHungry() const noexcept;
+
+    /**
+     * Retrieves the Scheduler shared by the engine, whose workers and the calling thread together
+     * occupy every hardware thread
+     *
+     * @return the default Scheduler
+     *
+     */
+    static Scheduler& getDefault();
+
+  private:
+
+    void enqueue(Job* job);
+    Job* find();
+    void execute(Job* job);
+    void complete(Counter& counter);
+    void work(std::size_t index);
+
+    /**
+     * The Context of the calling thread
+     *
+     */
+    static Context& context() noexcept;
+};
+
+/**
+ * Forks jobs for the span of a frame, and joins them when it goes out of scope, the owning thread
+ * helping to execute jobs in the meantime.
+ *
+ * @note the destructor cannot report failures; call wait() to have them re-thrown
+ *
+ */
+class ScopedFrameJobs
+{
+    Scheduler& scheduler;
+    Counter counter;
+
+  public:
+
+    /**
+     * Constructs ScopedFrameJobs
+     *
+     * @param scheduler the Scheduler to run the jobs on
+     *
+     */
+    explicit ScopedFrameJobs(Scheduler& scheduler = Scheduler::getDefault());
+
+    ScopedFrameJobs(const ScopedFrameJobs&) = delete;
+    ScopedFrameJobs& operator=(const ScopedFrameJobs&) = delete;
+
+    /**
+     * Waits for every job
+     *
+     */
+    ~ScopedFrameJobs();
+
+    /**
+     * Queues a job of the frame
+     *
+     * @param work the work to execute
+     *
+     * @param dependency a Counter the job is held back by until it reaches zero (may be nullptr)
+     *
+     */
+    void run(std::function<void()> work, Counter* dependency = nullptr);
+
+    /**
+     * Waits for every job queued so far
+     *
+     * @note the first exception thrown by a job is re-thrown
+     *
+     */
+    void wait();
+
+    /**
+     * Retrieves the Counter of the jobs of the frame, so that later jobs may depend on them
+     *
+     * @return the Counter
+     *
+     */
+    Counter& getCounter() noexcept;
+};
+
+/**
+ * Invokes the provided body for each index in [begin, end) on the workers of a Scheduler.
+ *
+ * Chunking adapts to the load of the Scheduler: the calling thread halves its range and queues one
+ * half for as long as the range exceeds the grain and the Scheduler is hungry, and otherwise works
+ * through the range a grain at a time, checking again between grains.  A busy Scheduler therefore
+ * costs little more than a serial loop, while an idle one is fed ranges that thieves split further.
+ *
+ * @param scheduler the Scheduler to run on
+ *
+ * @param begin the first index
+ *
+ * @param end one past the last index
+ *
+ * @param body a callable that accepts a single std::size_t index
+ *
+ * @param grain the smallest number of indices to queue as a job (zero picks one from the range)
+ *
+ * @note If any invocation throws, the first exception caught is re-thrown on the calling thread
+ * once every job has finished.
+ *
+ */
+template<typename F>
+void parallel_for(Scheduler& scheduler, std::size_t begin, std::size_t end, F body, std::size_t grain = 0);
+
+}
+
+}
+
+#    include "JobScheduler.inl"
+
+#endif
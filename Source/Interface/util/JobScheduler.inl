@@ -0,0 +1,456 @@
+#include "IllegalArgumentException.hpp"
+
+namespace midnight
+{
+
+namespace jobs
+{
+
+inline WorkStealingDeque::WorkStealingDeque(std::size_t capacity) :
+    buffer(capacity),
+    mask(capacity - 1),
+    top(0),
+    bottom(0)
+{
+    if(capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        throw IllegalArgumentException("The capacity of a WorkStealingDeque must be a power of two");
+    }
+}
+
+inline bool WorkStealingDeque::push(Job* job) noexcept
+{
+    const std::int64_t b = bottom.load(std::memory_order_relaxed);
+    const std::int64_t t = top.load(std::memory_order_acquire);
+    if(b - t >= static_cast<std::int64_t>(buffer.size()))
+    {
+        return false;
+    }
+    buffer[static_cast<std::size_t>(b) & mask].store(job, std::memory_order_relaxed);
+
+    /// Publishes the job before the thieves can see the new bottom
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+inline Job* WorkStealingDeque::pop() noexcept
+{
+    /// Reserves the bottom job before looking at the top, so that a thief racing for the last job
+    /// either sees the reservation or is seen by the compare-exchange below
+    const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top.load(std::memory_order_relaxed);
+    if(t > b)
+    {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job* job = buffer[static_cast<std::size_t>(b) & mask].load(std::memory_order_relaxed);
+    if(t == b)
+    {
+        if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+inline Job* WorkStealingDeque::steal() noexcept
+{
+    std::int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t b = bottom.load(std::memory_order_acquire);
+    if(t >= b)
+    {
+        return nullptr;
+    }
+    Job* job = buffer[static_cast<std::size_t>(t) & mask].load(std::memory_order_relaxed);
+    if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+    return job;
+}
+
+inline std::size_t WorkStealingDeque::size() const noexcept
+{
+    const std::int64_t count = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+    return count > 0 ? static_cast<std::size_t>(count) : 0;
+}
+
+inline Counter::Counter() noexcept :
+    value(0)
+{
+
+}
+
+inline std::size_t Counter::get() const noexcept
+{
+    return value.load(std::memory_order_acquire);
+}
+
+inline Scheduler::Scheduler(std::size_t workerCount, std::size_t capacity) :
+    pending(0),
+    sleeping(0),
+    stopping(false)
+{
+    deques.reserve(workerCount);
+    for(std::size_t i = 0; i < workerCount; ++i)
+    {
+        deques.push_back(std::unique_ptr<WorkStealingDeque>(new WorkStealingDeque(capacity)));
+    }
+    workers.reserve(workerCount);
+    for(std::size_t i = 0; i < workerCount; ++i)
+    {
+        workers.push_back(std::thread(&Scheduler::work, this, i));
+    }
+}
+
+inline Scheduler::~Scheduler()
+{
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_all();
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    /// Without workers, the jobs nobody waited for are still queued
+    while(Job* job = find())
+    {
+        execute(job);
+    }
+}
+
+inline void Scheduler::run(std::function<void()> work, Counter* signal, Counter* dependency)
+{
+    Job* job = new Job{std::move(work), signal};
+    if(signal != nullptr)
+    {
+        signal->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    if(dependency != nullptr)
+    {
+        std::lock_guard<std::mutex> guard(dependency->lock);
+        if(dependency->value.load(std::memory_order_acquire) != 0)
+        {
+            dependency->dependents.push_back(job);
+            return;
+        }
+    }
+    enqueue(job);
+}
+
+inline void Scheduler::wait(Counter& counter)
+{
+    while(counter.value.load(std::memory_order_acquire) != 0)
+    {
+        if(Job* job = find())
+        {
+            execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /// The job that released the Counter may still hold its lock
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> guard(counter.lock);
+        std::swap(failure, counter.failure);
+    }
+    if(failure)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+inline std::size_t Scheduler::getWorkerCount() const noexcept
+{
+    return workers.size();
+}
+
+inline bool Scheduler::isHungry() const noexcept
+{
+    return !deques.empty() && pending.load(std::memory_order_relaxed) < deques.size();
+}
+
+inline Scheduler& Scheduler::getDefault()
+{
+    static Scheduler scheduler(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return scheduler;
+}
+
+inline void Scheduler::enqueue(Job* job)
+{
+    /// Counted before it is visible, so that a worker going to sleep cannot miss it
+    pending.fetch_add(1);
+    const Context& self = context();
+    if(self.scheduler != this || !deques[self.index]->push(job))
+    {
+        std::lock_guard<std::mutex> guard(injectionLock);
+        injection.push_back(job);
+    }
+    if(sleeping.load() != 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+        }
+        wake.notify_one();
+    }
+}
+
+inline Job* Scheduler::find()
+{
+    if(pending.load(std::memory_order_relaxed) == 0)
+    {
+        return nullptr;
+    }
+    const Context& self = context();
+    const bool worker = self.scheduler == this;
+    Job* job = worker ? deques[self.index]->pop() : nullptr;
+    if(job == nullptr)
+    {
+        std::lock_guard<std::mutex> guard(injectionLock);
+        if(!injection.empty())
+        {
+            job = injection.front();
+            injection.pop_front();
+        }
+    }
+
+    /// Workers start with their neighbour, so that thieves spread over the victims
+    const std::size_t count = deques.size();
+    const std::size_t first = worker ? self.index + 1 : 0;
+    for(std::size_t i = 0; job == nullptr && i < count; ++i)
+    {
+        const std::size_t victim = (first + i) % count;
+        if(!worker || victim != self.index)
+        {
+            job = deques[victim]->steal();
+        }
+    }
+    if(job != nullptr)
+    {
+        pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+inline void Scheduler::execute(Job* job)
+{
+    Counter* signal = job->signal;
+    try
+    {
+        job->work();
+    }
+    catch(...)
+    {
+        if(signal == nullptr)
+        {
+            /// Nobody could observe the failure, as with an exception escaping a std::thread
+            std::terminate();
+        }
+        std::lock_guard<std::mutex> guard(signal->lock);
+        if(!signal->failure)
+        {
+            signal->failure = std::current_exception();
+        }
+    }
+    delete job;
+    if(signal != nullptr)
+    {
+        complete(*signal);
+    }
+}
+
+inline void Scheduler::complete(Counter& counter)
+{
+    /// Only the transition to zero takes the lock, and wait() takes it once more before it
+    /// returns, so that the Counter is not destroyed while it is being released
+    std::size_t value = counter.value.load(std::memory_order_relaxed);
+    while(value > 1)
+    {
+        if(counter.value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+    std::vector<Job*> released;
+    {
+        std::lock_guard<std::mutex> guard(counter.lock);
+        if(counter.value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            released.swap(counter.dependents);
+        }
+    }
+    for(Job* job : released)
+    {
+        enqueue(job);
+    }
+}
+
+inline void Scheduler::work(std::size_t index)
+{
+    context() = Context{this, index};
+    std::size_t idle = 0;
+    for(;;)
+    {
+        if(Job* job = find())
+        {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        if(stopping.load())
+        {
+            if(pending.load() == 0)
+            {
+                return;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        if(++idle < SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        sleeping.fetch_add(1);
+        wake.wait(guard, [this]
+        {
+            return pending.load() != 0 || stopping.load();
+        });
+        sleeping.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+inline Scheduler::Context& Scheduler::context() noexcept
+{
+    static thread_local Context current = {nullptr, 0};
+    return current;
+}
+
+inline ScopedFrameJobs::ScopedFrameJobs(Scheduler& scheduler) :
+    scheduler(scheduler)
+{
+
+}
+
+inline ScopedFrameJobs::~ScopedFrameJobs()
+{
+    try
+    {
+        scheduler.wait(counter);
+    }
+    catch(...)
+    {
+        /// The jobs have all completed; only their failure is lost
+    }
+}
+
+inline void ScopedFrameJobs::run(std::function<void()> work, Counter* dependency)
+{
+    scheduler.run(std::move(work), &counter, dependency);
+}
+
+inline void ScopedFrameJobs::wait()
+{
+    scheduler.wait(counter);
+}
+
+inline Counter& ScopedFrameJobs::getCounter() noexcept
+{
+    return counter;
+}
+
+namespace detail
+{
+
+/**
+ * Works through [begin, end), queueing its upper half for as long as the range exceeds the grain
+ * and the Scheduler is hungry
+ *
+ */
+template<typename F>
+void split(Scheduler& scheduler, Counter& counter, std::size_t begin, std::size_t end, std::size_t grain, F& body)
+{
+    while(begin < end)
+    {
+        if(end - begin > grain && scheduler.isHungry())
+        {
+            const std::size_t middle = begin + (end - begin) / 2;
+            scheduler.run([&scheduler, &counter, &body, middle, end, grain]
+            {
+                split(scheduler, counter, middle, end, grain, body);
+            }, &counter);
+            end = middle;
+            continue;
+        }
+        const std::size_t last = std::min(end, begin + grain);
+        for(std::size_t i = begin; i < last; ++i)
+        {
+            body(i);
+        }
+        begin = last;
+    }
+}
+
+}
+
+template<typename F>
+inline void parallel_for(Scheduler& scheduler, std::size_t begin, std::size_t end, F body, std::size_t grain)
+{
+    if(end <= begin)
+    {
+        return;
+    }
+    if(grain == 0)
+    {
+        /// A handful of grains per thread leaves the thieves something to balance with
+        grain = std::max<std::size_t>(1, (end - begin) / (8 * (scheduler.getWorkerCount() + 1)));
+    }
+
+    /// The queued halves refer to the counter and the body, so they are waited for even if the
+    /// calling thread's own share throws
+    Counter counter;
+    std::exception_ptr failure;
+    try
+    {
+        detail::split(scheduler, counter, begin, end, grain, body);
+    }
+    catch(...)
+    {
+        failure = std::current_exception();
+    }
+    try
+    {
+        scheduler.wait(counter);
+    }
+    catch(...)
+    {
+        if(!failure)
+        {
+            failure = std::current_exception();
+        }
+    }
+    if(failure)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,57 @@
+/**
+ * Internal Utility Header:
+ *  A fork/join loop used by the CPU-side asset pipelines and the renderer.  The
+ *  body is invoked once for every index in the provided range, on the workers of
+ *  the engine's default job scheduler (see JobScheduler.hpp).
+ *
+ */
+#ifndef PARALLEL_FOR_HPP
+#    define PARALLEL_FOR_HPP
+
+#    include "BuildConstraints.hpp"
+
+#    include <cstdint>
+#    include <thread>
+#    include <utility>
+
+#    include "JobScheduler.hpp"
+
+namespace midnight
+{
+
+/**
+ * Retrieves the number of threads that parallel_for runs on, the calling thread
+ * included
+ *
+ * @return the number of threads (always at least one)
+ *
+ */
+inline std::size_t hardwareConcurrency() noexcept
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : static_cast<std::size_t>(count);
+}
+
+/**
+ * Invokes the provided body for each index in [begin, end) on the default
+ * jobs::Scheduler, the calling thread taking part until every index is done.
+ *
+ * @param begin the first index
+ *
+ * @param end one past the last index
+ *
+ * @param body a callable that accepts a single std::size_t index
+ *
+ * @note If any invocation throws, the first exception caught is re-thrown on the
+ * calling thread once every chunk has finished.
+ *
+ */
+template<typename F>
+void parallel_for(std::size_t begin, std::size_t end, F body)
+{
+    jobs::parallel_for(jobs::Scheduler::getDefault(), begin, end, std::move(body));
+}
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "BoundingBox.hpp"
+
+using namespace midnight;
+
+TEST(BoundingBox, EmptyByDefault)
+{
+	BoundingBoxF box;
+	ASSERT_TRUE(box.isEmpty());
+	ASSERT_FALSE(box.contains(Point3F(0.0f, 0.0f, 0.0f)));
+	ASSERT_FALSE(box.intersects(BoundingBoxF(Point3F(-1.0f, -1.0f, -1.0f), Point3F(1.0f, 1.0f, 1.0f))));
+	ASSERT_TRUE(box.transform(Matrix4x4F::IDENTITY()).isEmpty());
+}
+
+TEST(BoundingBox, MergeGrows)
+{
+	BoundingBoxF box;
+	box.merge(Point3F(1.0f, 2.0f, 3.0f));
+	ASSERT_FALSE(box.isEmpty());
+	ASSERT_FLOAT_EQ(1.0f, box.getMinimum(0));
+	ASSERT_FLOAT_EQ(3.0f, box.getMaximum(2));
+
+	box.merge(BoundingBoxF(Point3F(-1.0f, 0.0f, 0.0f), Point3F(0.0f, 4.0f, 1.0f)));
+	box.merge(BoundingBoxF());
+	ASSERT_FLOAT_EQ(-1.0f, box.getMinimum(0));
+	ASSERT_FLOAT_EQ(0.0f, box.getMinimum(1));
+	ASSERT_FLOAT_EQ(0.0f, box.getMinimum(2));
+	ASSERT_FLOAT_EQ(1.0f, box.getMaximum(0));
+	ASSERT_FLOAT_EQ(4.0f, box.getMaximum(1));
+	ASSERT_FLOAT_EQ(3.0f, box.getMaximum(2));
+	ASSERT_FLOAT_EQ(0.0f, box.getCenter()[0]);
+	ASSERT_FLOAT_EQ(2.0f, box.getExtents()[1]);
+}
+
+TEST(BoundingBox, ContainsAndIntersects)
+{
+	BoundingBoxF box(Point3F(0.0f, 0.0f, 0.0f), Point3F(2.0f, 2.0f, 2.0f));
+	ASSERT_TRUE(box.contains(Point3F(2.0f, 1.0f, 0.0f)));
+	ASSERT_FALSE(box.contains(Point3F(2.5f, 1.0f, 0.0f)));
+	ASSERT_TRUE(box.intersects(BoundingBoxF(Point3F(2.0f, 2.0f, 2.0f), Point3F(3.0f, 3.0f, 3.0f))));
+	ASSERT_FALSE(box.intersects(BoundingBoxF(Point3F(1.0f, 2.5f, 1.0f), Point3F(3.0f, 3.0f, 3.0f))));
+}
+
+TEST(BoundingBox, TransformEnclosesCorners)
+{
+	BoundingBoxF box(Point3F(0.0f, 0.0f, 0.0f), Point3F(2.0f, 1.0f, 1.0f));
+
+	/// A quarter turn about z (x becomes y, y becomes -x) followed by a translation, as row vectors
+	Matrix4x4F transform = Matrix4x4F::IDENTITY();
+	transform(0, 0) = 0.0f;
+	transform(0, 1) = 1.0f;
+	transform(1, 0) = -1.0f;
+	transform(1, 1) = 0.0f;
+	transform(3, 0) = 10.0f;
+	transform(3, 2) = 5.0f;
+
+	BoundingBoxF transformed = box.transform(transform);
+	ASSERT_FLOAT_EQ(9.0f, transformed.getMinimum(0));
+	ASSERT_FLOAT_EQ(10.0f, transformed.getMaximum(0));
+	ASSERT_FLOAT_EQ(0.0f, transformed.getMinimum(1));
+	ASSERT_FLOAT_EQ(2.0f, transformed.getMaximum(1));
+	ASSERT_FLOAT_EQ(5.0f, transformed.getMinimum(2));
+	ASSERT_FLOAT_EQ(6.0f, transformed.getMaximum(2));
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "BuddyAllocator.hpp"
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+
+using namespace midnight;
+
+TEST(BuddyAllocator, RoundsToBlocks)
+{
+	BuddyAllocator allocator(1024, 64);
+	ASSERT_EQ(1024u, allocator.getCapacity());
+	ASSERT_EQ(64u, allocator.getBlockSize(1));
+	ASSERT_EQ(128u, allocator.getBlockSize(65));
+	ASSERT_EQ(0u, allocator.allocate(100));
+	ASSERT_EQ(128u, allocator.getAllocatedSize());
+	ASSERT_EQ(128u, allocator.allocate(10));
+	ASSERT_EQ(192u, allocator.allocate(64));
+	ASSERT_EQ(3u, allocator.getAllocationCount());
+	ASSERT_EQ(512u, allocator.getLargestFreeBlock());
+}
+
+TEST(BuddyAllocator, CoalescesBuddies)
+{
+	BuddyAllocator allocator(256, 16);
+	std::size_t a = allocator.allocate(16);
+	std::size_t b = allocator.allocate(16);
+	std::size_t c = allocator.allocate(32);
+	ASSERT_EQ(128u, allocator.getLargestFreeBlock());
+	allocator.release(b);
+	allocator.release(a);
+	ASSERT_EQ(0u, allocator.allocate(32));
+	allocator.release(c);
+	allocator.release(0);
+	ASSERT_EQ(0u, allocator.getAllocatedSize());
+	ASSERT_EQ(256u, allocator.getLargestFreeBlock());
+}
+
+TEST(BuddyAllocator, ReportsExhaustion)
+{
+	BuddyAllocator allocator(128, 32);
+	allocator.allocate(32);
+	ASSERT_FALSE(allocator.canAllocate(128));
+	ASSERT_TRUE(allocator.canAllocate(64));
+	ASSERT_THROW(allocator.allocate(128), ResourceException);
+	ASSERT_THROW(allocator.allocate(1000), ResourceException);
+	ASSERT_THROW(allocator.release(32), IllegalArgumentException);
+	ASSERT_THROW(allocator.allocate(0), IllegalArgumentException);
+	ASSERT_THROW(BuddyAllocator(100, 10), IllegalArgumentException);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "Frustum.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	BoundingBoxF box(float x0, float y0, float z0, float x1, float y1, float z1)
+	{
+		return BoundingBoxF(Point3F(x0, y0, z0), Point3F(x1, y1, z1));
+	}
+}
+
+TEST(Frustum, ContainsEverythingByDefault)
+{
+	Frustum frustum;
+	ASSERT_TRUE(frustum.intersects(box(1e6f, 1e6f, 1e6f, 2e6f, 2e6f, 2e6f)));
+	ASSERT_FALSE(frustum.intersects(BoundingBoxF()));
+}
+
+TEST(Frustum, ClassifiesAgainstClipVolume)
+{
+	/// With an identity clip transform, the view volume is the cube [-1, 1]
+	Frustum frustum(Matrix4x4F::IDENTITY());
+
+	std::uint32_t mask = Frustum::ALL_PLANES;
+	ASSERT_TRUE(frustum.intersects(box(-0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f), mask));
+	ASSERT_EQ(0u, mask);
+
+	mask = Frustum::ALL_PLANES;
+	ASSERT_FALSE(frustum.intersects(box(1.5f, -0.5f, -0.5f, 2.0f, 0.5f, 0.5f), mask));
+
+	/// Straddling the right plane (x <= 1) keeps only that plane
+	mask = Frustum::ALL_PLANES;
+	ASSERT_TRUE(frustum.intersects(box(0.5f, -0.5f, -0.5f, 1.5f, 0.5f, 0.5f), mask));
+	ASSERT_EQ(0x2u, mask);
+}
+
+TEST(Frustum, SkipsPlanesOutsideOfMask)
+{
+	Frustum frustum(Matrix4x4F::IDENTITY());
+
+	/// Beyond the far plane (z <= 1), which an enclosing box already cleared
+	std::uint32_t mask = Frustum::ALL_PLANES & ~0x20u;
+	ASSERT_TRUE(frustum.intersects(box(-0.5f, -0.5f, 2.0f, 0.5f, 0.5f, 3.0f), mask));
+
+	mask = Frustum::ALL_PLANES;
+	ASSERT_FALSE(frustum.intersects(box(-0.5f, -0.5f, 2.0f, 0.5f, 0.5f, 3.0f), mask));
+}
+
+TEST(Frustum, FollowsRowVectorTransforms)
+{
+	/// Translating by (10, 0, 0) before clipping moves the volume to x in [-11, -9]
+	Matrix4x4F clip = Matrix4x4F::IDENTITY();
+	clip(3, 0) = 10.0f;
+	Frustum frustum(clip);
+	ASSERT_TRUE(frustum.intersects(box(-10.5f, -0.5f, -0.5f, -9.5f, 0.5f, 0.5f)));
+	ASSERT_FALSE(frustum.intersects(box(-0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f)));
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "GeometryArena.hpp"
+#include "IllegalArgumentException.hpp"
+#include "Program.hpp"
+
+using namespace midnight;
+
+typedef std::vector<std::vector<std::size_t>> Ranges;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "GeometryArena";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	std::vector<Vertex32F> vertices(std::size_t count)
+	{
+		std::vector<Vertex32F> rv;
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			rv.push_back(Vertex32F(Point3F(static_cast<float>(i), 0.0f, 0.0f), Vector3F(0.0f, 0.0f, 1.0f), Point2F(0.0f, 0.0f)));
+		}
+		return rv;
+	}
+
+	const std::string FRAGMENT_SOURCE =
+		"#version 330\n"
+		"out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	fragment = vec4(1.0);\n"
+		"}\n";
+
+	/// Whether the vertex array bound along with the program reads the provided attribute
+	bool readsAttribute(Program& program, GeometryArena& arena, GLuint location)
+	{
+		GLint enabled = GL_FALSE;
+		program.bind();
+		arena.bind();
+		glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+		arena.unbind();
+		program.unbind();
+		return enabled == GL_TRUE;
+	}
+
+	/// The vertex array that the arena binds along with the program
+	GLuint vertexArrayOf(Program& program, GeometryArena& arena)
+	{
+		GLint name = 0;
+		program.bind();
+		arena.bind();
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &name);
+		arena.unbind();
+		program.unbind();
+		return static_cast<GLuint>(name);
+	}
+}
+
+TEST(GeometryArena, SharedVerticesAreStoredOnce)
+{
+	createContext();
+	GeometryArena arena(1024, 1024);
+	const Ranges indices = {{0, 1, 2}, {2, 1, 3}, {0, 2, 3}};
+	const std::vector<GeometryArena::Handle> handles = arena.allocate(vertices(4), indices);
+	ASSERT_EQ(3u, handles.size());
+	for(std::size_t i = 0; i < handles.size(); ++i)
+	{
+		ASSERT_EQ(arena.getRange(handles[0]).baseVertex, arena.getRange(handles[i]).baseVertex);
+		ASSERT_EQ(3, arena.getRange(handles[i]).indexCount);
+	}
+
+	GeometryArena::Statistics statistics = arena.getStatistics();
+	ASSERT_EQ(4u, statistics.verticesStored);
+	ASSERT_EQ(64u, statistics.verticesReserved);
+	ASSERT_EQ(9u, statistics.indicesStored);
+	ASSERT_EQ(3u, statistics.allocations);
+
+	/// The vertices go with the last mesh that uses them
+	arena.release(handles[0]);
+	arena.release(handles[2]);
+	ASSERT_EQ(64u, arena.getStatistics().verticesReserved);
+	arena.release(handles[1]);
+	statistics = arena.getStatistics();
+	ASSERT_EQ(0u, statistics.verticesReserved);
+	ASSERT_EQ(0u, statistics.indicesReserved);
+	ASSERT_EQ(0u, statistics.allocations);
+	ASSERT_THROW(arena.allocate(vertices(4), Ranges()), IllegalArgumentException);
+	ASSERT_THROW(arena.allocate(vertices(4), Ranges{{0, 1, 2}, {}}), IllegalArgumentException);
+	ASSERT_THROW(arena.allocate(vertices(4), Ranges{{0, 1, 2}, {1, 2, 4}}), IllegalArgumentException);
+	ASSERT_EQ(0u, arena.getStatistics().indicesReserved);
+}
+
+TEST(GeometryArena, DefragmentMovesSharedVerticesOnce)
+{
+	createContext();
+	GeometryArena arena(1024, 1024);
+	GeometryArena::Handle filler = arena.allocate(vertices(64), std::vector<std::size_t>{0, 1, 2});
+	const std::vector<GeometryArena::Handle> handles = arena.allocate(vertices(64), Ranges{{0, 1, 2}, {3, 4, 5}});
+	arena.release(filler);
+	ASSERT_EQ(64, arena.getRange(handles[0]).baseVertex);
+
+	arena.defragment();
+	GeometryArena::Statistics statistics = arena.getStatistics();
+	ASSERT_EQ(0, arena.getRange(handles[0]).baseVertex);
+	ASSERT_EQ(0, arena.getRange(handles[1]).baseVertex);
+	ASSERT_EQ(64u * GeometryArena::VERTEX_COMPONENTS * sizeof(GLfloat) + 6 * sizeof(GLuint), statistics.bytesCopied);
+	ASSERT_EQ(64u, statistics.verticesStored);
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+
+	arena.release(handles[0]);
+	arena.release(handles[1]);
+	ASSERT_EQ(0u, arena.getStatistics().verticesReserved);
+}
+
+TEST(GeometryArena, VertexArraysGoWithTheirProgram)
+{
+	createContext();
+	GeometryArena arena(1024, 1024);
+	GLuint vertexArray = 0;
+	{
+		Program positions{VertexShader(
+				"#version 330\n"
+				"layout(location = 0) in vec3 position;\n"
+				"void main()\n"
+				"{\n"
+				"	gl_Position = vec4(position, 1.0);\n"
+				"}\n"), FragmentShader(FRAGMENT_SOURCE)};
+		ASSERT_TRUE(readsAttribute(positions, arena, 0));
+		ASSERT_FALSE(readsAttribute(positions, arena, 1));
+		vertexArray = vertexArrayOf(positions, arena);
+		ASSERT_EQ(GL_TRUE, glIsVertexArray(vertexArray));
+	}
+
+	/// The name of a deleted program may be given to the next one, which must not inherit the
+	/// vertex array of the deleted program
+	ASSERT_EQ(GL_FALSE, glIsVertexArray(vertexArray));
+	Program normals{VertexShader(
+			"#version 330\n"
+			"layout(location = 0) in vec3 normal;\n"
+			"layout(location = 1) in vec3 position;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_Position = vec4(position + normal, 1.0);\n"
+			"}\n"), FragmentShader(FRAGMENT_SOURCE)};
+	ASSERT_TRUE(readsAttribute(normals, arena, 0));
+	ASSERT_TRUE(readsAttribute(normals, arena, 1));
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
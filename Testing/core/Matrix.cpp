@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.hpp"
+using namespace midnight;
+TEST(Matrix, IdentityProduct)
+{
+	Matrix4x4F matrix;
+	for(std::size_t row = 0; row < 4; ++row)
+	{
+		for(std::size_t column = 0; column < 4; ++column)
+		{
+			matrix(row, column) = static_cast<float>(row * 4 + column);
+		}
+	}
+	ASSERT_TRUE(matrix == matrix * Matrix4x4F::IDENTITY());
+	ASSERT_TRUE(matrix == Matrix4x4F::IDENTITY() * matrix);
+}
+
+TEST(Matrix, RectangularProduct)
+{
+	Matrix<float, 2, 3> lhs;
+	Matrix<float, 3, 2> rhs;
+	for(std::size_t i = 0; i < 6; ++i)
+	{
+		lhs(i / 3, i % 3) = static_cast<float>(i + 1);
+		rhs(i / 2, i % 2) = static_cast<float>(i + 7);
+	}
+	/// [1 2 3; 4 5 6] * [7 8; 9 10; 11 12]
+	Matrix<float, 2, 2> product = lhs * rhs;
+	ASSERT_FLOAT_EQ(58.0f, product(0, 0));
+	ASSERT_FLOAT_EQ(64.0f, product(0, 1));
+	ASSERT_FLOAT_EQ(139.0f, product(1, 0));
+	ASSERT_FLOAT_EQ(154.0f, product(1, 1));
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "OcclusionBuffer.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// A perspective looking down -z with a near plane at 0.1, as row vectors: w is the distance
+	/// in front of the viewer, and the near plane lies where z equals -w
+	Matrix4x4F perspective()
+	{
+		Matrix4x4F rv = Matrix4x4F::IDENTITY();
+		rv(2, 2) = -1.0f;
+		rv(3, 2) = -0.2f;
+		rv(2, 3) = -1.0f;
+		rv(3, 3) = 0.0f;
+		return rv;
+	}
+
+	BoundingBoxF box(float x0, float y0, float z0, float x1, float y1, float z1)
+	{
+		return BoundingBoxF(Point3F(x0, y0, z0), Point3F(x1, y1, z1));
+	}
+
+	/// Adds a square in the plane z, spanning [-size, size] in x and y
+	void addWall(OcclusionBuffer& buffer, float z, float size, const Matrix4x4F& clip)
+	{
+		const std::vector<Point3F> positions =
+		{
+			Point3F(-size, -size, z), Point3F(size, -size, z), Point3F(size, size, z), Point3F(-size, size, z)
+		};
+		buffer.addOccluder(positions, {0, 1, 2, 0, 2, 3}, clip);
+	}
+}
+
+TEST(OcclusionBuffer, RejectsPartialTiles)
+{
+	ASSERT_THROW(OcclusionBuffer(250, 128), IllegalArgumentException);
+	ASSERT_THROW(OcclusionBuffer(256, 0), IllegalArgumentException);
+}
+
+TEST(OcclusionBuffer, EverythingVisibleWithoutOccluders)
+{
+	OcclusionBuffer buffer;
+	buffer.rasterize();
+	ASSERT_TRUE(buffer.isVisible(box(-1.0f, -1.0f, -20.0f, 1.0f, 1.0f, -19.0f), perspective()));
+	ASSERT_FALSE(buffer.isVisible(BoundingBoxF(), perspective()));
+}
+
+TEST(OcclusionBuffer, HidesBoxesBehindOccluders)
+{
+	OcclusionBuffer buffer;
+	addWall(buffer, -5.0f, 2.0f, perspective());
+	buffer.rasterize();
+	ASSERT_EQ(2u, buffer.getTriangleCount());
+	ASSERT_FLOAT_EQ(0.2f, buffer.getDepth(128, 64));
+
+	/// Behind, in front of, and beside the wall, and straddling its edge
+	ASSERT_FALSE(buffer.isVisible(box(-1.0f, -1.0f, -11.0f, 1.0f, 1.0f, -9.0f), perspective()));
+	ASSERT_TRUE(buffer.isVisible(box(-1.0f, -1.0f, -3.0f, 1.0f, 1.0f, -2.0f), perspective()));
+	ASSERT_TRUE(buffer.isVisible(box(6.0f, -1.0f, -11.0f, 8.0f, 1.0f, -9.0f), perspective()));
+	ASSERT_TRUE(buffer.isVisible(box(3.0f, -1.0f, -11.0f, 5.0f, 1.0f, -9.0f), perspective()));
+
+	/// An occluder does not hide itself
+	ASSERT_TRUE(buffer.isVisible(box(-2.0f, -2.0f, -5.0f, 2.0f, 2.0f, -5.0f), perspective()));
+
+	buffer.clear();
+	buffer.rasterize();
+	ASSERT_TRUE(buffer.isVisible(box(-1.0f, -1.0f, -11.0f, 1.0f, 1.0f, -9.0f), perspective()));
+}
+
+TEST(OcclusionBuffer, ClipsOccludersAgainstNearPlane)
+{
+	/// A floor from behind the viewer into the distance, seen from above
+	OcclusionBuffer buffer;
+	const std::vector<Point3F> floor =
+	{
+		Point3F(-50.0f, -1.0f, 10.0f), Point3F(50.0f, -1.0f, 10.0f), Point3F(50.0f, -1.0f, -100.0f), Point3F(-50.0f, -1.0f, -100.0f)
+	};
+	buffer.addOccluder(floor, {0, 1, 2, 0, 2, 3}, perspective());
+	buffer.rasterize();
+	ASSERT_LE(2u, buffer.getTriangleCount());
+
+	ASSERT_FALSE(buffer.isVisible(box(-1.0f, -5.0f, -12.0f, 1.0f, -3.0f, -10.0f), perspective()));
+	ASSERT_TRUE(buffer.isVisible(box(-1.0f, 0.0f, -12.0f, 1.0f, 1.0f, -10.0f), perspective()));
+
+	/// A box reaching behind the viewer is never hidden
+	ASSERT_TRUE(buffer.isVisible(box(-1.0f, -5.0f, -12.0f, 1.0f, -3.0f, 1.0f), perspective()));
+
+	/// Nor does an occluder behind the viewer hide anything
+	buffer.clear();
+	addWall(buffer, 5.0f, 2.0f, perspective());
+	buffer.rasterize();
+	ASSERT_EQ(0u, buffer.getTriangleCount());
+}
+
+TEST(OcclusionBuffer, RejectsIndicesOutOfRange)
+{
+	OcclusionBuffer buffer;
+	ASSERT_THROW(buffer.addOccluder({Point3F(0.0f, 0.0f, -1.0f)}, {0, 0, 1}, perspective()), IllegalArgumentException);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+#include "UniformRing.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "UniformRing";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	struct Block
+	{
+		float value[4];
+	};
+
+	std::size_t queryAlignment()
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		return static_cast<std::size_t>(alignment);
+	}
+}
+
+TEST(UniformRing, RejectsEmptyRings)
+{
+	/// Both are checked before anything is allocated
+	ASSERT_THROW(UniformRing(0, 3), IllegalArgumentException);
+	ASSERT_THROW(UniformRing(1024, 0), IllegalArgumentException);
+}
+
+TEST(UniformRing, BlocksAreAligned)
+{
+	createContext();
+	const std::size_t alignment = queryAlignment();
+	ASSERT_LT(0u, alignment);
+
+	UniformRing ring(1024, 2);
+	ring.beginFrame();
+	const Block block = {{1.0f, 2.0f, 3.0f, 4.0f}};
+	const std::size_t first = ring.write(block);
+	const std::size_t second = ring.write(block);
+	ring.endFrame();
+
+	ASSERT_EQ(0u, first % alignment);
+	ASSERT_EQ(0u, second % alignment);
+	ASSERT_EQ(std::max(alignment, sizeof(Block)), second - first);
+	ASSERT_EQ(2 * (second - first), ring.getFrameUsage());
+}
+
+TEST(UniformRing, WrapsAcrossTheFramesInFlight)
+{
+	createContext();
+	UniformRing ring(1024, 3);
+	const Block block = {{0.0f, 0.0f, 0.0f, 0.0f}};
+
+	/// Every frame starts a segment of its own, and the fourth frame reuses the first segment
+	std::vector<std::size_t> offsets;
+	for(std::size_t i = 0; i < 7; ++i)
+	{
+		ring.beginFrame();
+		ASSERT_EQ(0u, ring.getFrameUsage());
+		offsets.push_back(ring.write(block));
+		ring.endFrame();
+	}
+	ASSERT_NE(offsets[0], offsets[1]);
+	ASSERT_NE(offsets[1], offsets[2]);
+	ASSERT_NE(offsets[0], offsets[2]);
+	for(std::size_t i = 3; i < offsets.size(); ++i)
+	{
+		ASSERT_EQ(offsets[i - 3], offsets[i]);
+	}
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+TEST(UniformRing, ThrowsWhenAFrameIsExhausted)
+{
+	createContext();
+	const std::size_t stride = std::max(queryAlignment(), sizeof(Block));
+	UniformRing ring(2 * stride, 2);
+	const Block block = {{0.0f, 0.0f, 0.0f, 0.0f}};
+
+	ring.beginFrame();
+	ASSERT_NO_THROW(ring.write(block));
+	ASSERT_NO_THROW(ring.write(block));
+	ASSERT_THROW(ring.write(block), ResourceException);
+	ring.endFrame();
+
+	/// The next frame has its whole capacity again
+	ring.beginFrame();
+	ASSERT_NO_THROW(ring.write(block));
+	ring.endFrame();
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "UploadService.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "UploadService";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	/// Produces a buffer whose every byte depends on its position and the seed
+	UploadService::Producer pattern(std::size_t size, unsigned seed)
+	{
+		return [size, seed]()
+		{
+			std::vector<unsigned char> rv(size);
+			for(std::size_t i = 0; i < size; ++i)
+			{
+				rv[i] = static_cast<unsigned char>(i * 7 + seed);
+			}
+			return rv;
+		};
+	}
+
+	/// The contents of a resident buffer Resource
+	std::vector<unsigned char> readBack(const UploadService::Resource& resource, std::size_t size)
+	{
+		std::vector<unsigned char> rv(size);
+		glBindBuffer(GL_COPY_READ_BUFFER, resource.getName());
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(size), rv.data());
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		return rv;
+	}
+}
+
+TEST(UploadService, RejectsRingsSmallerThanAChunk)
+{
+	/// Both are checked before anything is allocated
+	ASSERT_THROW(UploadService(100, 1 << 20), IllegalArgumentException);
+	ASSERT_THROW(UploadService(1 << 20, 100), IllegalArgumentException);
+}
+
+TEST(UploadService, PumpStaysWithinTheFrameBudget)
+{
+	createContext();
+	const std::size_t budget = 64 << 10;
+	const std::size_t size = 1 << 20;
+	UploadService service(256 << 10, budget);
+	std::shared_ptr<UploadService::Resource> resource = service.uploadBuffer(pattern(size, 3));
+
+	std::size_t frames = 0;
+	while(true)
+	{
+		const UploadService::Statistics& statistics = service.pump();
+		ASSERT_GE(budget, statistics.bytesIssued);
+		frames += statistics.bytesIssued != 0 ? 1 : 0;
+		if(statistics.resourcesPending == 0)
+		{
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	ASSERT_TRUE(resource->isResident());
+	ASSERT_LE(size / budget / 2, frames);
+	ASSERT_EQ(pattern(size, 3)(), readBack(*resource, size));
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+TEST(UploadService, ResourcesCompleteInRequestOrder)
+{
+	createContext();
+	UploadService service(128 << 10, 16 << 10);
+	std::vector<std::shared_ptr<UploadService::Resource>> resources;
+	for(unsigned i = 0; i < 8; ++i)
+	{
+		resources.push_back(service.uploadBuffer(pattern((i % 3 + 1) * (20 << 10), i)));
+	}
+
+	while(service.pump().resourcesPending != 0)
+	{
+		/// A Resource is never resident before those requested earlier
+		for(std::size_t i = 1; i < resources.size(); ++i)
+		{
+			ASSERT_TRUE(!resources[i]->isResident() || resources[i - 1]->isResident()) << i;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	for(std::size_t i = 0; i < resources.size(); ++i)
+	{
+		ASSERT_TRUE(resources[i]->isResident());
+		ASSERT_EQ(pattern((i % 3 + 1) * (20 << 10), static_cast<unsigned>(i))(), readBack(*resources[i], (i % 3 + 1) * (20 << 10)));
+	}
+}
+
+TEST(UploadService, ReleasesTheLastReferenceOnTheRenderThread)
+{
+	createContext();
+	UploadService service(128 << 10, 16 << 10);
+
+	/// The caller drops every Resource at once, so the last references are those of the service
+	std::vector<std::weak_ptr<UploadService::Resource>> resources;
+	for(unsigned i = 0; i < 8; ++i)
+	{
+		resources.push_back(service.uploadBuffer(pattern(40 << 10, i)));
+	}
+
+	std::vector<GLuint> names;
+	while(service.pump().resourcesPending != 0)
+	{
+		for(const std::weak_ptr<UploadService::Resource>& resource : resources)
+		{
+			const std::shared_ptr<UploadService::Resource> locked = resource.lock();
+			if(locked && locked->getName() != 0 && std::find(names.begin(), names.end(), locked->getName()) == names.end())
+			{
+				names.push_back(locked->getName());
+			}
+		}
+		std::this_thread::yield();
+	}
+	service.finish();
+
+	/// Once its copies retire, nothing on the worker thread still holds a Resource, and the GL
+	/// object was deleted with the context current
+	for(const std::weak_ptr<UploadService::Resource>& resource : resources)
+	{
+		ASSERT_TRUE(resource.expired());
+	}
+	ASSERT_FALSE(names.empty());
+	for(GLuint name : names)
+	{
+		ASSERT_EQ(GL_FALSE, glIsBuffer(name));
+	}
+}
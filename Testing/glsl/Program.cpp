@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+#include "Camera.hpp"
+#include "FrameUniforms.hpp"
+#include "Program.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "Program";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	const std::string VERTEX_SOURCE =
+		"#version 140\n"
+		"in vec3 position;\n"
+		"uniform vec4 tint;\n"
+		"uniform mat4 projection;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4(position, 1.0) * projection + tint;\n"
+		"}\n";
+
+	const std::string FRAGMENT_SOURCE =
+		"#version 140\n"
+		"out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	fragment = vec4(1.0);\n"
+		"}\n";
+
+	/// The value of the tint uniform, as the implementation holds it
+	Tuple4F readTint(Program& program)
+	{
+		GLint handle = 0;
+		program.bind();
+		glGetIntegerv(GL_CURRENT_PROGRAM, &handle);
+		GLfloat value[4] = {};
+		glGetUniformfv(static_cast<GLuint>(handle), glGetUniformLocation(static_cast<GLuint>(handle), "tint"), value);
+		program.unbind();
+		return Tuple4F(value[0], value[1], value[2], value[3]);
+	}
+}
+
+TEST(Program, UnchangedUniformsAreSkipped)
+{
+	createContext();
+	Program program{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+
+	program.setUniform("tint", Tuple4F(1.0f, 0.0f, 0.0f, 0.0f));
+	ASSERT_EQ(1u, program.getUniformStatistics().issued);
+	ASSERT_EQ(0u, program.getUniformStatistics().skipped);
+
+	program.setUniform("tint", Tuple4F(1.0f, 0.0f, 0.0f, 0.0f));
+	program.setMatrixUniform("projection", Matrix4x4F::IDENTITY());
+	program.setMatrixUniform("projection", Matrix4x4F::IDENTITY());
+	ASSERT_EQ(2u, program.getUniformStatistics().issued);
+	ASSERT_EQ(2u, program.getUniformStatistics().skipped);
+
+	program.setUniform("tint", Tuple4F(0.0f, 2.0f, 0.0f, 0.0f));
+	ASSERT_EQ(3u, program.getUniformStatistics().issued);
+	ASSERT_TRUE(Tuple4F(0.0f, 2.0f, 0.0f, 0.0f) == readTint(program));
+
+	program.resetUniformStatistics();
+	ASSERT_EQ(0u, program.getUniformStatistics().issued);
+	ASSERT_EQ(0u, program.getUniformStatistics().skipped);
+}
+
+TEST(Program, ShadowsSurviveAMove)
+{
+	createContext();
+	Program program{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	program.setUniform("tint", Tuple4F(0.0f, 0.0f, 3.0f, 0.0f));
+
+	Program moved(std::move(program));
+	moved.setUniform("tint", Tuple4F(0.0f, 0.0f, 3.0f, 0.0f));
+	ASSERT_EQ(1u, moved.getUniformStatistics().issued);
+	ASSERT_EQ(1u, moved.getUniformStatistics().skipped);
+
+	Program assigned{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	assigned = std::move(moved);
+	assigned.setUniform("tint", Tuple4F(0.0f, 0.0f, 3.0f, 0.0f));
+	ASSERT_EQ(2u, assigned.getUniformStatistics().skipped);
+	ASSERT_TRUE(Tuple4F(0.0f, 0.0f, 3.0f, 0.0f) == readTint(assigned));
+}
+
+TEST(Program, SetUniformsRestoresTheBoundProgram)
+{
+	createContext();
+	Program bound{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	Program unbound{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+
+	bound.bind();
+	GLint before = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &before);
+	unbound.setUniforms("tint", Tuple4F(0.0f, 0.0f, 0.0f, 4.0f), "projection", Matrix4x4F::IDENTITY());
+	GLint after = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &after);
+	bound.unbind();
+
+	ASSERT_NE(0, before);
+	ASSERT_EQ(before, after);
+	ASSERT_EQ(2u, unbound.getUniformStatistics().issued);
+	ASSERT_TRUE(Tuple4F(0.0f, 0.0f, 0.0f, 4.0f) == readTint(unbound));
+}
+
+TEST(Program, UniformStatisticsAreCollectedPerFrame)
+{
+	createContext();
+	Program first{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	Program second{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+	FrameUniforms uniforms;
+	auto frame = [&]()
+	{
+		uniforms.begin(camera);
+		first.setUniform("tint", Tuple4F(1.0f, 1.0f, 1.0f, 1.0f));
+		second.setUniform("tint", Tuple4F(1.0f, 1.0f, 1.0f, 1.0f));
+		second.setMatrixUniform("projection", camera.getProjection());
+		uniforms.end();
+	};
+
+	frame();
+	ASSERT_EQ(3u, uniforms.getUniformStatistics().issued);
+	ASSERT_EQ(0u, uniforms.getUniformStatistics().skipped);
+
+	/// Nothing changed, so the second frame skips every update, and counts only its own
+	frame();
+	ASSERT_EQ(0u, uniforms.getUniformStatistics().issued);
+	ASSERT_EQ(3u, uniforms.getUniformStatistics().skipped);
+	ASSERT_EQ(3u, Program::getTotalUniformStatistics().skipped);
+}
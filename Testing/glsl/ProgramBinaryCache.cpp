@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+
+#include "ProgramBinaryCache.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "ProgramBinaryCache";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	/// The paths of the entries of a directory (none if it does not exist)
+	std::vector<std::string> listDirectory(const std::string& directory)
+	{
+		std::vector<std::string> rv;
+		if(DIR* stream = opendir(directory.c_str()))
+		{
+			while(const dirent* entry = readdir(stream))
+			{
+				const std::string name = entry->d_name;
+				if(name != "." && name != "..")
+				{
+					rv.push_back(directory + "/" + name);
+				}
+			}
+			closedir(stream);
+		}
+		return rv;
+	}
+
+	const std::string VERTEX_SOURCE =
+		"#version 140\n"
+		"in vec3 position;\n"
+		"in vec3 normal;\n"
+		"uniform mat4 model_view_projection;\n"
+		"out vec3 n;\n"
+		"void main()\n"
+		"{\n"
+		"#ifdef SCALE\n"
+		"	n = normal * SCALE;\n"
+		"#else\n"
+		"	n = normal;\n"
+		"#endif\n"
+		"	gl_Position = vec4(position, 1.0) * model_view_projection;\n"
+		"}\n";
+
+	const std::string FRAGMENT_SOURCE =
+		"#version 140\n"
+		"in vec3 n;\n"
+		"uniform sampler2D tex;\n"
+		"out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	vec4 color = vec4(0.0);\n"
+		"	for(int i = 0; i < 8; ++i)\n"
+		"	{\n"
+		"		color += texture(tex, n.xy * float(i)) * max(dot(normalize(n), vec3(0.3, 0.5, 0.8)), 0.0);\n"
+		"	}\n"
+		"#ifdef FOG\n"
+		"	color = mix(color, vec4(0.5), 0.3);\n"
+		"#endif\n"
+		"	fragment = color;\n"
+		"}\n";
+
+	/**
+	 * Loads 20 permutations of a lit, textured program through a new cache, as an application
+	 * does at startup
+	 *
+	 * @param statistics receives the hits, misses and rejections of the cache
+	 *
+	 * @return the time taken, in milliseconds
+	 *
+	 */
+	double loadPermutations(const std::string& directory, ProgramBinaryCache::Statistics& statistics)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		const Clock::time_point start = Clock::now();
+		ProgramBinaryCache cache(directory);
+		for(std::size_t i = 0; i < 20; ++i)
+		{
+			std::vector<std::string> defines = {"SCALE " + std::to_string(i + 1) + ".0"};
+			if(i % 2 == 1)
+			{
+				defines.push_back("FOG");
+			}
+			cache.load(VERTEX_SOURCE, FRAGMENT_SOURCE, defines);
+		}
+		glFinish();
+		statistics = cache.getStatistics();
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+}
+
+TEST(ProgramBinaryCache, HashSeparatesInputs)
+{
+	/// The reference values of FNV-1a
+	ASSERT_EQ(14695981039346656037ULL, midnight::detail::fnv1a("", 0));
+	ASSERT_EQ(0xaf63dc4c8601ec8cULL, midnight::detail::fnv1a("a", 1));
+	ASSERT_NE(midnight::detail::fnv1a("ab", 2), midnight::detail::fnv1a("ba", 2));
+}
+
+TEST(ProgramBinaryCache, DISABLED_Benchmarks)
+{
+	createContext();
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if(formats == 0)
+	{
+		std::cout << "The implementation cannot retrieve program binaries, so every start is cold" << std::endl;
+		return;
+	}
+
+	const std::string directory = "ProgramBinaryCache.benchmark";
+	for(const std::string& path : listDirectory(directory))
+	{
+		std::remove(path.c_str());
+	}
+	auto report = [](const char* name, double time, const ProgramBinaryCache::Statistics& statistics)
+	{
+		std::cout << name << ": " << time << " ms (" << statistics.hits << " hits, " << statistics.misses << " misses, "
+				<< statistics.rejected << " rejected)" << std::endl;
+	};
+
+	ProgramBinaryCache::Statistics statistics;
+	double time = loadPermutations(directory, statistics);
+	report("Cold start", time, statistics);
+	ASSERT_EQ(0u, statistics.hits);
+
+	time = loadPermutations(directory, statistics);
+	report("Warm start", time, statistics);
+
+	/// Overwrite the middle of one entry, which the implementation should reject
+	const std::vector<std::string> entries = listDirectory(directory);
+	ASSERT_FALSE(entries.empty());
+	if(std::FILE* file = std::fopen(entries.front().c_str(), "r+b"))
+	{
+		std::fseek(file, 40, SEEK_SET);
+		std::fputs("XXXXXXXXXXXXXXXX", file);
+		std::fclose(file);
+	}
+	time = loadPermutations(directory, statistics);
+	report("One corrupted entry", time, statistics);
+
+	for(const std::string& path : listDirectory(directory))
+	{
+		std::remove(path.c_str());
+	}
+	std::remove(directory.c_str());
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "IllegalArgumentException.hpp"
+#include "ProgramPipelineCache.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "ProgramPipelineCache";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	const std::string VERTEX_SOURCE =
+		"#version 410\n"
+		"layout(location = 0) in vec3 position;\n"
+		"out gl_PerVertex\n"
+		"{\n"
+		"	vec4 gl_Position;\n"
+		"};\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4(position, 1.0);\n"
+		"}\n";
+
+	const std::string WHITE_SOURCE =
+		"#version 410\n"
+		"layout(location = 0) out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	fragment = vec4(1.0);\n"
+		"}\n";
+
+	const std::string BLACK_SOURCE =
+		"#version 410\n"
+		"layout(location = 0) out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	fragment = vec4(0.0, 0.0, 0.0, 1.0);\n"
+		"}\n";
+
+	GLuint queryPipeline()
+	{
+		GLint pipeline = 0;
+		glGetIntegerv(GL_PROGRAM_PIPELINE_BINDING, &pipeline);
+		return static_cast<GLuint>(pipeline);
+	}
+}
+
+TEST(ProgramPipelineCache, StagesAreShared)
+{
+	createContext();
+	ProgramPipelineCache cache;
+	if(!cache.isSupported())
+	{
+		return;
+	}
+	std::shared_ptr<Program> vertex = cache.acquireStage(GL_VERTEX_SHADER, VERTEX_SOURCE);
+	ASSERT_EQ(vertex, cache.acquireStage(GL_VERTEX_SHADER, VERTEX_SOURCE));
+	ASSERT_NE(cache.acquireStage(GL_FRAGMENT_SHADER, WHITE_SOURCE), cache.acquireStage(GL_FRAGMENT_SHADER, BLACK_SOURCE));
+	ASSERT_EQ(3u, cache.getStatistics().stagesCreated);
+	ASSERT_EQ(1u, cache.getStatistics().stagesShared);
+	ASSERT_THROW(cache.acquireStage(GL_NONE, VERTEX_SOURCE), IllegalArgumentException);
+}
+
+TEST(ProgramPipelineCache, CombinationsShareAPipeline)
+{
+	createContext();
+	ProgramPipelineCache cache;
+	if(!cache.isSupported())
+	{
+		return;
+	}
+	std::shared_ptr<Program> vertex = cache.acquireStage(GL_VERTEX_SHADER, VERTEX_SOURCE);
+	std::shared_ptr<Program> white = cache.acquireStage(GL_FRAGMENT_SHADER, WHITE_SOURCE);
+	std::shared_ptr<Program> black = cache.acquireStage(GL_FRAGMENT_SHADER, BLACK_SOURCE);
+
+	/// Binding the same stages again neither assembles nor switches the pipeline
+	cache.bind(vertex, white);
+	const GLuint first = queryPipeline();
+	cache.bind(vertex, white);
+	ASSERT_NE(0u, first);
+	ASSERT_EQ(first, queryPipeline());
+	ASSERT_EQ(1u, cache.getPipelineCount());
+	ASSERT_EQ(1u, cache.getStatistics().pipelinesCreated);
+	ASSERT_EQ(1u, cache.getStatistics().pipelineSwitches);
+
+	/// Another combination of the same vertex stage has a pipeline of its own
+	cache.bind(vertex, black);
+	ASSERT_NE(first, queryPipeline());
+	cache.bind(vertex, white);
+	ASSERT_EQ(first, queryPipeline());
+	ASSERT_EQ(2u, cache.getPipelineCount());
+	ASSERT_EQ(2u, cache.getStatistics().pipelinesCreated);
+	ASSERT_EQ(3u, cache.getStatistics().pipelineSwitches);
+
+	cache.unbind();
+	ASSERT_EQ(0u, queryPipeline());
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+TEST(ProgramPipelineCache, CollectsThePipelinesOfReleasedStages)
+{
+	createContext();
+	ProgramPipelineCache cache;
+	if(!cache.isSupported())
+	{
+		return;
+	}
+	std::shared_ptr<Program> vertex = cache.acquireStage(GL_VERTEX_SHADER, VERTEX_SOURCE);
+	std::shared_ptr<Program> white = cache.acquireStage(GL_FRAGMENT_SHADER, WHITE_SOURCE);
+	std::shared_ptr<Program> black = cache.acquireStage(GL_FRAGMENT_SHADER, BLACK_SOURCE);
+	cache.bind(vertex, white);
+	cache.bind(vertex, black);
+	ASSERT_EQ(0u, cache.collect());
+
+	/// Releasing the bound stage deletes its pipeline, and unbinds it
+	black.reset();
+	ASSERT_EQ(1u, cache.collect());
+	ASSERT_EQ(1u, cache.getPipelineCount());
+	ASSERT_EQ(0u, queryPipeline());
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+TEST(ProgramPipelineCache, RejectsForeignStages)
+{
+	createContext();
+	ProgramPipelineCache cache;
+	ProgramPipelineCache other;
+	if(!cache.isSupported())
+	{
+		return;
+	}
+	std::shared_ptr<Program> vertex = cache.acquireStage(GL_VERTEX_SHADER, VERTEX_SOURCE);
+	std::shared_ptr<Program> white = other.acquireStage(GL_FRAGMENT_SHADER, WHITE_SOURCE);
+	ASSERT_THROW(cache.bind(vertex, white), IllegalArgumentException);
+	ASSERT_EQ(0u, cache.getPipelineCount());
+}
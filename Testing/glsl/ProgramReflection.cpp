@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+#include "Program.hpp"
+#include "UniformMismatchException.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "ProgramReflection";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	const std::string VERTEX_SOURCE =
+		"#version 140\n"
+		"in vec3 position;\n"
+		"in vec2 texcoord;\n"
+		"out vec2 coordinate;\n"
+		"layout(std140) uniform Material\n"
+		"{\n"
+		"	vec4 diffuse;\n"
+		"	float shininess;\n"
+		"	mat4 transform;\n"
+		"};\n"
+		"void main()\n"
+		"{\n"
+		"	coordinate = texcoord * shininess;\n"
+		"	gl_Position = vec4(position, 1.0) * transform;\n"
+		"}\n";
+
+	const std::string FRAGMENT_SOURCE =
+		"#version 140\n"
+		"in vec2 coordinate;\n"
+		"out vec4 fragment;\n"
+		"layout(std140) uniform Material\n"
+		"{\n"
+		"	vec4 diffuse;\n"
+		"	float shininess;\n"
+		"	mat4 transform;\n"
+		"};\n"
+		"uniform vec3 light_direction;\n"
+		"uniform float weights[4];\n"
+		"uniform sampler2D albedo;\n"
+		"void main()\n"
+		"{\n"
+		"	float weight = weights[0] + weights[1] + weights[2] + weights[3];\n"
+		"	fragment = texture(albedo, coordinate) * diffuse * dot(light_direction, vec3(weight));\n"
+		"}\n";
+
+	/// The Material block as laid out by std140
+	struct MaterialData
+	{
+		float diffuse[4];
+		float shininess;
+		float padding[3];
+		float transform[16];
+	};
+}
+
+TEST(ProgramReflection, ReflectsUniformsAndAttributes)
+{
+	createContext();
+	Program program{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	const ProgramReflection& reflection = program.getReflection();
+
+	const ProgramReflection::Uniform* light = reflection.findUniform("light_direction");
+	ASSERT_NE(nullptr, light);
+	ASSERT_EQ(static_cast<GLenum>(GL_FLOAT_VEC3), light->type);
+	ASSERT_EQ(1, light->size);
+	ASSERT_LE(0, light->location);
+	ASSERT_EQ(-1, light->blockIndex);
+
+	/// Arrays are found with and without their first subscript
+	const ProgramReflection::Uniform* weights = reflection.findUniform("weights");
+	ASSERT_NE(nullptr, weights);
+	ASSERT_EQ(weights, reflection.findUniform("weights[0]"));
+	ASSERT_EQ(static_cast<GLenum>(GL_FLOAT), weights->type);
+	ASSERT_EQ(4, weights->size);
+
+	ASSERT_EQ(1u, reflection.getSamplers().size());
+	ASSERT_EQ(reflection.findUniform("albedo"), reflection.getSamplers()[0]);
+	ASSERT_TRUE(ProgramReflection::isSampler(reflection.findUniform("albedo")->type));
+	ASSERT_EQ(nullptr, reflection.findUniform("missing"));
+
+	ASSERT_EQ(2u, reflection.getAttributes().size());
+	ASSERT_NE(nullptr, reflection.findAttribute("position"));
+	ASSERT_EQ(static_cast<GLenum>(GL_FLOAT_VEC3), reflection.findAttribute("position")->type);
+	ASSERT_NE(nullptr, reflection.findAttribute("texcoord"));
+	ASSERT_EQ(static_cast<GLenum>(GL_FLOAT_VEC2), reflection.findAttribute("texcoord")->type);
+	ASSERT_EQ(nullptr, reflection.findAttribute("normal"));
+}
+
+TEST(ProgramReflection, ReflectsUniformBlocks)
+{
+	createContext();
+	Program program{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	const ProgramReflection& reflection = program.getReflection();
+
+	ASSERT_EQ(1u, reflection.getUniformBlocks().size());
+	const ProgramReflection::UniformBlock* block = reflection.findUniformBlock("Material");
+	ASSERT_NE(nullptr, block);
+	ASSERT_EQ(static_cast<GLint>(sizeof(MaterialData)), block->dataSize);
+	ASSERT_EQ(3u, block->members.size());
+	ASSERT_EQ(nullptr, reflection.findUniformBlock("Missing"));
+
+	/// Members of blocks have offsets rather than locations
+	for(std::size_t member : block->members)
+	{
+		const ProgramReflection::Uniform& uniform = reflection.getUniforms()[member];
+		ASSERT_EQ(static_cast<GLint>(block->index), uniform.blockIndex);
+		ASSERT_EQ(-1, uniform.location);
+	}
+	const ProgramReflection::Uniform* transform = reflection.findUniform("transform");
+	ASSERT_NE(nullptr, transform);
+	ASSERT_EQ(static_cast<GLenum>(GL_FLOAT_MAT4), transform->type);
+	ASSERT_EQ(static_cast<GLint>(offsetof(MaterialData, transform)), transform->offset);
+	ASSERT_EQ(16, transform->matrixStride);
+}
+
+TEST(ProgramReflection, VerifiesBlockLayouts)
+{
+	createContext();
+	Program program{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+	const ProgramReflection& reflection = program.getReflection();
+
+	ASSERT_TRUE(reflection.verifyBlock("Material", sizeof(MaterialData), {{"diffuse", offsetof(MaterialData, diffuse)},
+			{"shininess", offsetof(MaterialData, shininess)}, {"transform", offsetof(MaterialData, transform)}}));
+	ASSERT_FALSE(reflection.verifyBlock("Missing", sizeof(MaterialData), {}));
+
+	/// A member at the wrong offset, a member the block lacks, and a struct too small for the block
+	ASSERT_THROW(reflection.verifyBlock("Material", sizeof(MaterialData), {{"transform", offsetof(MaterialData, padding)}}),
+			glsl::UniformMismatchException);
+	ASSERT_THROW(reflection.verifyBlock("Material", sizeof(MaterialData), {{"specular", offsetof(MaterialData, padding)}}),
+			glsl::UniformMismatchException);
+	ASSERT_THROW(reflection.verifyBlock("Material", offsetof(MaterialData, transform), {}), glsl::UniformMismatchException);
+}
+
+TEST(ProgramReflection, ComparesTypes)
+{
+	ASSERT_TRUE(ProgramReflection::isCompatible(GL_FLOAT_VEC3, GL_FLOAT_VEC3));
+	ASSERT_FALSE(ProgramReflection::isCompatible(GL_FLOAT_VEC3, GL_FLOAT_VEC4));
+	ASSERT_FALSE(ProgramReflection::isCompatible(GL_FLOAT_MAT4, GL_FLOAT_VEC4));
+	ASSERT_TRUE(ProgramReflection::isCompatible(GL_SAMPLER_2D, GL_INT));
+	ASSERT_FALSE(ProgramReflection::isCompatible(GL_SAMPLER_2D, GL_FLOAT));
+	ASSERT_EQ(std::string("vec3"), ProgramReflection::getTypeName(GL_FLOAT_VEC3));
+}
+
+#if defined(MIDNIGHT_UNIFORM_VALIDATION)
+
+TEST(ProgramReflection, MismatchedUniformsAreRejected)
+{
+	createContext();
+	Program program{VertexShader(VERTEX_SOURCE), FragmentShader(FRAGMENT_SOURCE)};
+
+	ASSERT_NO_THROW(program.setUniform("light_direction", Tuple3F(0.0f, 0.0f, 1.0f)));
+	ASSERT_THROW(program.setUniform("light_direction", Tuple4F(0.0f, 0.0f, 1.0f, 0.0f)), glsl::UniformMismatchException);
+	ASSERT_THROW(program.setMatrixUniform("light_direction", Matrix4x4F::IDENTITY()), glsl::UniformMismatchException);
+	ASSERT_THROW(program.setUniform("albedo", Tuple1F(0.0f)), glsl::UniformMismatchException);
+
+	/// Arrays take up to their declared number of elements, from any element on
+	ASSERT_NO_THROW(program.setUniform("weights", Tuple1F(1.0f), Tuple1F(2.0f), Tuple1F(3.0f), Tuple1F(4.0f)));
+	ASSERT_NO_THROW(program.setUniform("weights[2]", Tuple1F(3.0f), Tuple1F(4.0f)));
+	ASSERT_THROW(program.setUniform("weights[2]", Tuple1F(3.0f), Tuple1F(4.0f), Tuple1F(5.0f)), glsl::UniformMismatchException);
+
+	/// A rejected update is never sent
+	ASSERT_EQ(3u, program.getUniformStatistics().issued);
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+#endif
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "ProgramRegistry.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "ProgramRegistry";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	const std::string VERTEX_SOURCE =
+		"#version 140\n"
+		"in vec3 position;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4(position, 1.0);\n"
+		"}\n";
+
+	const std::string WHITE_SOURCE =
+		"#version 140\n"
+		"out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	fragment = vec4(1.0);\n"
+		"}\n";
+
+	const std::string BLACK_SOURCE =
+		"#version 140\n"
+		"out vec4 fragment;\n"
+		"void main()\n"
+		"{\n"
+		"	fragment = vec4(0.0, 0.0, 0.0, 1.0);\n"
+		"}\n";
+}
+
+TEST(ProgramRegistry, IdenticalSourcesShareAProgram)
+{
+	createContext();
+	ProgramRegistry registry;
+	std::shared_ptr<Program> first = registry.acquire(VERTEX_SOURCE, WHITE_SOURCE);
+	std::shared_ptr<Program> second = registry.acquire(VERTEX_SOURCE, WHITE_SOURCE);
+	std::shared_ptr<Program> third = registry.acquire({{GL_VERTEX_SHADER, VERTEX_SOURCE}, {GL_FRAGMENT_SHADER, WHITE_SOURCE}});
+
+	ASSERT_EQ(first, second);
+	ASSERT_EQ(first, third);
+	ASSERT_EQ(1u, registry.getLiveCount());
+	ASSERT_EQ(1u, registry.getStatistics().created);
+	ASSERT_EQ(2u, registry.getStatistics().shared);
+}
+
+TEST(ProgramRegistry, DifferentSourcesGetProgramsOfTheirOwn)
+{
+	createContext();
+	ProgramRegistry registry;
+	std::shared_ptr<Program> white = registry.acquire(VERTEX_SOURCE, WHITE_SOURCE);
+	std::shared_ptr<Program> black = registry.acquire(VERTEX_SOURCE, BLACK_SOURCE);
+
+	/// The same sources in other stages are other Programs, too
+	std::shared_ptr<Program> swapped = registry.acquire({{GL_FRAGMENT_SHADER, WHITE_SOURCE}, {GL_VERTEX_SHADER, VERTEX_SOURCE}});
+
+	ASSERT_NE(white, black);
+	ASSERT_NE(white, swapped);
+	ASSERT_EQ(3u, registry.getLiveCount());
+	ASSERT_EQ(3u, registry.getStatistics().created);
+	ASSERT_EQ(0u, registry.getStatistics().shared);
+}
+
+TEST(ProgramRegistry, ReleasedProgramsAreEvicted)
+{
+	createContext();
+	ProgramRegistry registry;
+	std::shared_ptr<Program> white = registry.acquire(VERTEX_SOURCE, WHITE_SOURCE);
+	std::shared_ptr<Program> black = registry.acquire(VERTEX_SOURCE, BLACK_SOURCE);
+	std::weak_ptr<Program> released = white;
+	std::shared_ptr<Program> shared = registry.acquire(VERTEX_SOURCE, WHITE_SOURCE);
+
+	/// The registry holds no reference of its own, so the Program goes with its last user
+	white.reset();
+	ASSERT_FALSE(released.expired());
+	ASSERT_EQ(2u, registry.getLiveCount());
+	shared.reset();
+	ASSERT_TRUE(released.expired());
+	ASSERT_EQ(1u, registry.getLiveCount());
+
+	/// The next acquire creates the Program anew rather than reviving the evicted one
+	white = registry.acquire(VERTEX_SOURCE, WHITE_SOURCE);
+	ASSERT_EQ(2u, registry.getLiveCount());
+	ASSERT_EQ(3u, registry.getStatistics().created);
+	ASSERT_EQ(1u, registry.getStatistics().shared);
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+
+#include "IllegalArgumentException.hpp"
+#include "ProgramVariants.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "ProgramVariants";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	/// Removes a directory and its entries, if it exists
+	void removeDirectory(const std::string& directory)
+	{
+		if(DIR* stream = opendir(directory.c_str()))
+		{
+			while(const dirent* entry = readdir(stream))
+			{
+				const std::string name = entry->d_name;
+				if(name != "." && name != "..")
+				{
+					std::remove((directory + "/" + name).c_str());
+				}
+			}
+			closedir(stream);
+		}
+		std::remove(directory.c_str());
+	}
+
+	enum Lighting
+	{
+		UNLIT,
+		LIT
+	};
+
+	/// The feature flags of the variants
+	const std::uint32_t FOG = 1;
+	const std::uint32_t TINT = 2;
+
+	/// Every definition adds a uniform of its own, so that the reflection of a variant tells
+	/// which definitions it was built with
+	std::vector<ProgramBinaryCache::Stage> stages()
+	{
+		const std::string vertex =
+			"#version 150\n"
+			"in vec3 position;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_Position = vec4(position, 1.0);\n"
+			"}\n";
+		const std::string fragment =
+			"#version 150\n"
+			"out vec4 fragment;\n"
+			"#ifdef LIT\n"
+			"uniform vec3 light_direction;\n"
+			"#endif\n"
+			"#ifdef FOG\n"
+			"uniform float fog_density;\n"
+			"#endif\n"
+			"#ifdef TINT\n"
+			"uniform vec4 tint;\n"
+			"#endif\n"
+			"void main()\n"
+			"{\n"
+			"	vec4 color = vec4(1.0);\n"
+			"#ifdef LIT\n"
+			"	color.rgb *= max(dot(normalize(light_direction), vec3(0.0, 0.0, 1.0)), 0.0);\n"
+			"#endif\n"
+			"#ifdef FOG\n"
+			"	color = mix(color, vec4(0.5), fog_density);\n"
+			"#endif\n"
+			"#ifdef TINT\n"
+			"	color *= tint;\n"
+			"#endif\n"
+			"	fragment = color;\n"
+			"}\n";
+		return {{GL_VERTEX_SHADER, vertex}, {GL_FRAGMENT_SHADER, fragment}};
+	}
+
+	bool declares(Program& program, const std::string& uniform)
+	{
+		return program.getReflection().findUniform(uniform) != nullptr;
+	}
+}
+
+TEST(ProgramVariants, VariantsAreBuiltOnRequest)
+{
+	createContext();
+	ProgramVariants variants(stages(), {"UNLIT", "LIT"}, {"FOG", "TINT"});
+	ASSERT_EQ(0u, variants.getPendingCount());
+
+	Program* program = variants.request(LIT, FOG);
+	if(program == nullptr)
+	{
+		ASSERT_EQ(1u, variants.getPendingCount());
+		for(std::size_t i = 0; i < 10000 && variants.getPendingCount() != 0; ++i)
+		{
+			variants.update();
+		}
+		program = variants.request(LIT, FOG);
+	}
+	ASSERT_NE(nullptr, program);
+	ASSERT_EQ(0u, variants.getPendingCount());
+
+	/// Only the requested variant was built
+	ASSERT_EQ(program, variants.request(LIT, FOG));
+	ASSERT_EQ(nullptr, variants.request(UNLIT));
+	ASSERT_EQ(1u, variants.getPendingCount());
+}
+
+TEST(ProgramVariants, VariantsAreSelectedByTheirDefinitions)
+{
+	createContext();
+	ProgramVariants variants(stages(), {"UNLIT", "LIT"}, {"FOG", "TINT"});
+
+	Program& unlit = variants.require(UNLIT);
+	ASSERT_FALSE(declares(unlit, "light_direction"));
+	ASSERT_FALSE(declares(unlit, "fog_density"));
+	ASSERT_FALSE(declares(unlit, "tint"));
+
+	Program& litTinted = variants.require(LIT, TINT);
+	ASSERT_TRUE(declares(litTinted, "light_direction"));
+	ASSERT_FALSE(declares(litTinted, "fog_density"));
+	ASSERT_TRUE(declares(litTinted, "tint"));
+
+	Program& unlitFoggedTinted = variants.require(UNLIT, FOG | TINT);
+	ASSERT_FALSE(declares(unlitFoggedTinted, "light_direction"));
+	ASSERT_TRUE(declares(unlitFoggedTinted, "fog_density"));
+	ASSERT_TRUE(declares(unlitFoggedTinted, "tint"));
+
+	ASSERT_NE(&unlit, &litTinted);
+	ASSERT_NE(&litTinted, &unlitFoggedTinted);
+	ASSERT_EQ(&litTinted, &variants.require(LIT, TINT));
+}
+
+TEST(ProgramVariants, EveryVariantIsBuiltOnce)
+{
+	createContext();
+	const std::string directory = "ProgramVariants.test";
+	removeDirectory(directory);
+	{
+		ProgramBinaryCache cache(directory);
+		ProgramVariants variants(stages(), {"UNLIT", "LIT"}, {"FOG", "TINT"}, &cache);
+
+		/// Every variant is requested three times, but looked up in the cache (and built) once
+		std::vector<Program*> programs;
+		for(std::size_t pass = 0; pass < 3; ++pass)
+		{
+			for(std::uint32_t i = 0; i < 8; ++i)
+			{
+				Program& program = variants.require(static_cast<Lighting>(i >> 2 & 1), i & 3);
+				if(pass == 0)
+				{
+					programs.push_back(&program);
+				}
+				ASSERT_EQ(programs[i], &program);
+			}
+		}
+		const ProgramBinaryCache::Statistics& statistics = cache.getStatistics();
+		ASSERT_EQ(8u, statistics.hits + statistics.misses + statistics.rejected);
+	}
+	removeDirectory(directory);
+}
+
+TEST(ProgramVariants, RejectsUndefinedModesAndFeatures)
+{
+	createContext();
+	ProgramVariants variants(stages(), {"UNLIT", "LIT"}, {"FOG", "TINT"});
+	ASSERT_THROW(variants.request(2), IllegalArgumentException);
+	ASSERT_THROW(variants.request(UNLIT, 4), IllegalArgumentException);
+	ASSERT_EQ(0u, variants.getPendingCount());
+	ASSERT_THROW(ProgramVariants(std::vector<ProgramBinaryCache::Stage>(), {}, {}), IllegalArgumentException);
+}
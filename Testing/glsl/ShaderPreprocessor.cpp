@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "ShaderPreprocessor.hpp"
+#include "CompilationError.hpp"
+#include "ResourceException.hpp"
+
+TEST(ShaderPreprocessor, DefinesFollowVersion)
+{
+	std::string source = "#version 140\nvoid main()\n{\n}";
+	std::string defined = midnight::detail::injectDefines(source, {"USE_FOG", "LIGHTS 4"});
+	ASSERT_EQ("#version 140\n#define USE_FOG\n#define LIGHTS 4\nvoid main()\n{\n}", defined);
+	ASSERT_EQ(source, midnight::detail::injectDefines(source, {}));
+	ASSERT_EQ("#define A\nvoid main(){}", midnight::detail::injectDefines("void main(){}", {"A"}));
+}
+
+TEST(ShaderPreprocessor, IncludesOnce)
+{
+	midnight::ShaderPreprocessor preprocessor;
+	preprocessor.addSource("common.glsl", "#include \"constants.glsl\"\nfloat twice(float x) { return x * TWO; }\n");
+	preprocessor.addSource("constants.glsl", "#define TWO 2.0");
+	std::string processed = preprocessor.process("#version 330\n#include \"common.glsl\"\n  #  include <constants.glsl>\nvoid main() {}\n");
+	ASSERT_EQ("#version 330\n"
+			"#line 1 1\n"
+			"#line 1 2\n"
+			"#define TWO 2.0\n"
+			"#line 2 1\n"
+			"float twice(float x) { return x * TWO; }\n"
+			"#line 3 0\n"
+			"\n"
+			"void main() {}\n", processed);
+	ASSERT_EQ("common.glsl", preprocessor.getFileName(1));
+	ASSERT_EQ("constants.glsl", preprocessor.getFileName(2));
+	ASSERT_EQ("", preprocessor.getFileName(3));
+}
+
+TEST(ShaderPreprocessor, InjectsDefinesAfterIncludes)
+{
+	midnight::ShaderPreprocessor preprocessor;
+	preprocessor.addSource("a.glsl", "A");
+	ASSERT_EQ("#version 330\n#define FOG\n#line 1 1\nA\n#line 3 0\nB\n", preprocessor.process("#version 330\n#include \"a.glsl\"\nB", {"FOG"}));
+}
+
+TEST(ShaderPreprocessor, ReportsBadIncludes)
+{
+	midnight::ShaderPreprocessor preprocessor;
+	ASSERT_THROW(preprocessor.process("#include \"missing.glsl\"\n"), midnight::ResourceException);
+	ASSERT_THROW(preprocessor.process("#include missing.glsl\n"), midnight::glsl::CompilationError);
+	ASSERT_THROW(preprocessor.process("#include \"unterminated.glsl\n"), midnight::glsl::CompilationError);
+}
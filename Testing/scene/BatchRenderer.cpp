@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "BatchRenderer.hpp"
+#include "MeshNode.hpp"
+#include "RenderQueue.hpp"
+#include "Translation.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "BatchRenderer";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	Mesh quad()
+	{
+		std::vector<Vertex32F> vertices;
+		for(std::size_t i = 0; i < 4; ++i)
+		{
+			vertices.push_back(Vertex32F(Point3F(static_cast<float>(i & 1), static_cast<float>(i >> 1), 0.0f),
+					Vector3F(0.0f, 0.0f, 1.0f), Point2F(0.0f, 0.0f)));
+		}
+		std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+		renderables[0].indices = {0, 1, 2, 2, 1, 3};
+		return Mesh(vertices, std::vector<Material>(), renderables);
+	}
+
+	/// A grid of quads in front of the camera, each below its own Translation
+	std::vector<std::shared_ptr<SceneGraphNode>> grid(const Mesh& mesh, const std::shared_ptr<GeometryArena>& arena, std::size_t side,
+			float spacing, float distance)
+	{
+		std::vector<std::shared_ptr<SceneGraphNode>> rv;
+		for(std::size_t i = 0; i < side * side; ++i)
+		{
+			std::shared_ptr<Translation<float>> node = std::make_shared<Translation<float>>((static_cast<float>(i % side) - side / 2.0f) * spacing,
+					(static_cast<float>(i / side) - side / 2.0f) * spacing, -distance);
+			node->add(std::make_shared<MeshNode>(mesh, arena));
+			rv.push_back(node);
+		}
+		return rv;
+	}
+
+	/// Renders a frame as Scene does, through the RenderQueue if one is provided and otherwise
+	/// with a draw per node
+	void renderFrame(const std::vector<std::shared_ptr<SceneGraphNode>>& nodes, const Camera& camera, FrameUniforms& uniforms,
+			RenderQueue* queue)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		uniforms.begin(camera);
+		if(queue != nullptr)
+		{
+			queue->begin();
+		}
+		for(const std::shared_ptr<SceneGraphNode>& node : nodes)
+		{
+			if(uniforms.enter(node->getBounds()))
+			{
+				node->render(camera);
+				uniforms.leave();
+			}
+		}
+		if(queue != nullptr)
+		{
+			queue->flush(uniforms);
+		}
+		uniforms.end();
+	}
+
+	std::vector<unsigned char> readPixels()
+	{
+		std::vector<unsigned char> rv(320 * 320 * 4);
+		glReadPixels(0, 0, 320, 320, GL_RGBA, GL_UNSIGNED_BYTE, &rv[0]);
+		return rv;
+	}
+}
+
+TEST(BatchRenderer, QueuedDrawsMatchSeparateDraws)
+{
+	createContext();
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+	const Mesh mesh = quad();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+	std::shared_ptr<GeometryArena> arena = std::make_shared<GeometryArena>(64 * 25, 64 * 25);
+	const std::vector<std::shared_ptr<SceneGraphNode>> nodes = grid(mesh, arena, 5, 2.0f, 20.0f);
+	FrameUniforms uniforms;
+	RenderQueue queue;
+
+	renderFrame(nodes, camera, uniforms, &queue);
+	const std::vector<unsigned char> batched = readPixels();
+	ASSERT_EQ(25u, queue.getStatistics().items);
+	ASSERT_EQ(1u, queue.getStatistics().batches);
+
+	renderFrame(nodes, camera, uniforms, nullptr);
+	const std::vector<unsigned char> separate = readPixels();
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+
+	std::size_t covered = 0;
+	for(std::size_t i = 0; i < separate.size(); i += 4)
+	{
+		covered += separate[i] == 0 ? 1 : 0;
+	}
+	ASSERT_LT(0u, covered);
+	ASSERT_EQ(separate, batched);
+}
+
+TEST(BatchRenderer, DISABLED_Benchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto elapsed = [](Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	};
+
+	createContext();
+	const Mesh mesh = quad();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+
+	/// 10,000 quads, drawn through the RenderQueue in one multi-draw and then with a draw each
+	const std::size_t side = 100;
+	std::shared_ptr<GeometryArena> arena = std::make_shared<GeometryArena>(64 * side * side, 64 * side * side);
+	const std::vector<std::shared_ptr<SceneGraphNode>> nodes = grid(mesh, arena, side, 1.5f, 150.0f);
+	FrameUniforms uniforms(nodes.size());
+	RenderQueue queue;
+
+	const std::size_t frames = 8;
+	for(RenderQueue* path : {&queue, static_cast<RenderQueue*>(nullptr)})
+	{
+		renderFrame(nodes, camera, uniforms, path);
+		glFinish();
+		double submission = 0.0;
+		const Clock::time_point start = Clock::now();
+		for(std::size_t i = 0; i < frames; ++i)
+		{
+			const Clock::time_point frame = Clock::now();
+			renderFrame(nodes, camera, uniforms, path);
+			submission += elapsed(frame);
+		}
+		glFinish();
+		const double total = elapsed(start);
+		ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+		std::cout << nodes.size() << " draws " << (path != nullptr ? "batched" : "separately") << ": " << submission / frames
+				<< " ms of submission per frame, " << total / frames << " ms per frame until finished" << std::endl;
+	}
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CommandLists.hpp"
+#include "IllegalArgumentException.hpp"
+
+using namespace midnight;
+
+TEST(CommandLists, ReplaysListsInOrder)
+{
+	CommandLists<int> lists(3);
+	ASSERT_EQ(3u, lists.getListCount());
+	lists.getList(2).push_back(5);
+	lists.getList(0).push_back(1);
+	lists.getList(0).push_back(2);
+	lists.getList(1).push_back(3);
+	ASSERT_EQ(4u, lists.getCommandCount());
+
+	std::vector<int> replayed;
+	lists.replay([&replayed](int command)
+	{
+		replayed.push_back(command);
+	});
+	ASSERT_EQ((std::vector<int>{1, 2, 3, 5}), replayed);
+
+	lists.clear();
+	ASSERT_EQ(0u, lists.getCommandCount());
+	ASSERT_EQ(3u, lists.getListCount());
+}
+
+TEST(CommandLists, RequiresAList)
+{
+	ASSERT_THROW(CommandLists<int>(0), IllegalArgumentException);
+}
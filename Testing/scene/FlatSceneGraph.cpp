@@ -0,0 +1,456 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "FlatSceneGraph.hpp"
+#include "IllegalArgumentException.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	Matrix4x4F translation(float x, float y, float z)
+	{
+		Matrix4x4F rv = Matrix4x4F::IDENTITY();
+		rv(3, 0) = x;
+		rv(3, 1) = y;
+		rv(3, 2) = z;
+		return rv;
+	}
+
+	std::vector<FlatSceneGraph::Renderable> visitAll(const FlatSceneGraph& graph)
+	{
+		std::vector<FlatSceneGraph::Renderable> rv;
+		graph.traverse([&rv](FlatSceneGraph::Renderable renderable, const Matrix4x4F&, const BoundingBoxF&)
+		{
+			rv.push_back(renderable);
+			return true;
+		});
+		return rv;
+	}
+
+	/**
+	 * The pointer-based hierarchy that FlatSceneGraph replaces: every node owns its children
+	 * through shared pointers, and is updated and traversed through virtual calls
+	 *
+	 */
+	class PointerNode
+	{
+		Matrix4x4F localTransform;
+		Matrix4x4F worldTransform;
+		BoundingBoxF localBounds;
+		BoundingBoxF worldBounds;
+		FlatSceneGraph::Renderable renderable;
+		std::vector<std::shared_ptr<PointerNode>> children;
+
+	  public:
+
+		PointerNode(const Matrix4x4F& localTransform, const BoundingBoxF& localBounds, FlatSceneGraph::Renderable renderable) :
+			localTransform(localTransform),
+			localBounds(localBounds),
+			renderable(renderable)
+		{
+
+		}
+
+		virtual ~PointerNode() = default;
+
+		PointerNode& add(const std::shared_ptr<PointerNode>& child)
+		{
+			children.push_back(child);
+			return *child;
+		}
+
+		virtual void update(const Matrix4x4F& parentTransform)
+		{
+			worldTransform = localTransform * parentTransform;
+			worldBounds = localBounds.transform(worldTransform);
+			for(const std::shared_ptr<PointerNode>& child : children)
+			{
+				child->update(worldTransform);
+			}
+		}
+
+		virtual void traverse(std::vector<FlatSceneGraph::Renderable>& visited) const
+		{
+			visited.push_back(renderable);
+			for(const std::shared_ptr<PointerNode>& child : children)
+			{
+				child->traverse(visited);
+			}
+		}
+	};
+}
+
+TEST(FlatSceneGraph, DepthFirstOrder)
+{
+	FlatSceneGraph graph;
+	const Matrix4x4F identity = Matrix4x4F::IDENTITY();
+	auto a = graph.create(FlatSceneGraph::Handle(), identity, BoundingBoxF(), 0);
+	auto b = graph.create(FlatSceneGraph::Handle(), identity, BoundingBoxF(), 1);
+	auto c = graph.create(a, identity, BoundingBoxF(), 2);
+	graph.create(c, identity, BoundingBoxF(), 3);
+	graph.create(a, identity, BoundingBoxF(), 4);
+
+	ASSERT_EQ(5u, graph.getNodeCount());
+	ASSERT_EQ((std::vector<FlatSceneGraph::Renderable>{0, 2, 3, 4, 1}), visitAll(graph));
+	ASSERT_TRUE(graph.getParent(c) == a);
+	ASSERT_TRUE(graph.getParent(b) == FlatSceneGraph::Handle());
+}
+
+TEST(FlatSceneGraph, DestroyRemovesSubtree)
+{
+	FlatSceneGraph graph;
+	const Matrix4x4F identity = Matrix4x4F::IDENTITY();
+	auto a = graph.create(FlatSceneGraph::Handle(), identity, BoundingBoxF(), 0);
+	auto b = graph.create(a, identity, BoundingBoxF(), 1);
+	auto c = graph.create(b, identity, BoundingBoxF(), 2);
+	auto d = graph.create(a, identity, BoundingBoxF(), 3);
+
+	graph.destroy(b);
+	ASSERT_FALSE(graph.isValid(b));
+	ASSERT_FALSE(graph.isValid(c));
+	ASSERT_TRUE(graph.isValid(d));
+	ASSERT_TRUE(graph.getParent(d) == a);
+	ASSERT_EQ((std::vector<FlatSceneGraph::Renderable>{0, 3}), visitAll(graph));
+	ASSERT_THROW(graph.destroy(c), IllegalArgumentException);
+	ASSERT_THROW(graph.create(b), IllegalArgumentException);
+
+	/// Released handles are reused under a new generation
+	auto e = graph.create(d, identity, BoundingBoxF(), 4);
+	ASSERT_TRUE(graph.isValid(e));
+	ASSERT_FALSE(graph.isValid(b));
+	ASSERT_FALSE(graph.isValid(c));
+	ASSERT_EQ(4u, graph.getRenderable(e));
+	ASSERT_EQ((std::vector<FlatSceneGraph::Renderable>{0, 3, 4}), visitAll(graph));
+}
+
+TEST(FlatSceneGraph, UpdatePropagatesTransforms)
+{
+	FlatSceneGraph graph;
+	const BoundingBoxF unit(Point3F(-1.0f, -1.0f, -1.0f), Point3F(1.0f, 1.0f, 1.0f));
+	auto root = graph.create(FlatSceneGraph::Handle(), translation(10.0f, 0.0f, 0.0f));
+	auto child = graph.create(root, translation(0.0f, 5.0f, 0.0f), unit);
+	auto sibling = graph.create(FlatSceneGraph::Handle(), translation(0.0f, 0.0f, 1.0f), unit);
+	graph.update();
+
+	ASSERT_FLOAT_EQ(10.0f, graph.getWorldTransform(child)(3, 0));
+	ASSERT_FLOAT_EQ(5.0f, graph.getWorldTransform(child)(3, 1));
+	ASSERT_FLOAT_EQ(9.0f, graph.getWorldBounds(child).getMinimum(0));
+	ASSERT_FLOAT_EQ(6.0f, graph.getWorldBounds(child).getMaximum(1));
+	ASSERT_TRUE(graph.getWorldBounds(root).isEmpty());
+
+	graph.setLocalTransform(root, translation(-10.0f, 0.0f, 0.0f));
+	graph.update();
+	ASSERT_FLOAT_EQ(-10.0f, graph.getWorldTransform(child)(3, 0));
+	ASSERT_FLOAT_EQ(1.0f, graph.getWorldTransform(sibling)(3, 2));
+}
+
+TEST(FlatSceneGraph, TraverseSkipsSubtrees)
+{
+	FlatSceneGraph graph;
+	const Matrix4x4F identity = Matrix4x4F::IDENTITY();
+	auto a = graph.create(FlatSceneGraph::Handle(), identity, BoundingBoxF(), 0);
+	auto b = graph.create(a, identity, BoundingBoxF(), 1);
+	graph.create(b, identity, BoundingBoxF(), 2);
+	graph.create(a, identity, BoundingBoxF(), 3);
+	graph.create(FlatSceneGraph::Handle(), identity, BoundingBoxF(), 4);
+
+	std::vector<FlatSceneGraph::Renderable> visited;
+	graph.traverse([&visited](FlatSceneGraph::Renderable renderable, const Matrix4x4F&, const BoundingBoxF&)
+	{
+		visited.push_back(renderable);
+		return renderable != 1;
+	});
+	ASSERT_EQ((std::vector<FlatSceneGraph::Renderable>{0, 1, 3, 4}), visited);
+}
+
+TEST(FlatSceneGraph, UpdateRecomputesOnlyDirtySubtrees)
+{
+	FlatSceneGraph graph;
+	auto a = graph.create(FlatSceneGraph::Handle(), translation(1.0f, 0.0f, 0.0f));
+	auto b = graph.create(a, translation(1.0f, 0.0f, 0.0f));
+	auto c = graph.create(b, translation(1.0f, 0.0f, 0.0f));
+	auto d = graph.create(FlatSceneGraph::Handle(), translation(0.0f, 1.0f, 0.0f));
+	ASSERT_EQ(4u, graph.update());
+	ASSERT_EQ(0u, graph.update());
+
+	/// Both b and c are dirty, but c lies in the subtree of b
+	graph.setLocalTransform(c, translation(2.0f, 0.0f, 0.0f));
+	graph.setLocalTransform(b, translation(2.0f, 0.0f, 0.0f));
+	ASSERT_EQ(2u, graph.update());
+	ASSERT_FLOAT_EQ(5.0f, graph.getWorldTransform(c)(3, 0));
+	ASSERT_FLOAT_EQ(1.0f, graph.getWorldTransform(d)(3, 1));
+
+	/// A new child only computes itself, and destroyed nodes are not revisited
+	auto e = graph.create(d, translation(0.0f, 1.0f, 0.0f));
+	graph.setLocalTransform(c, translation(3.0f, 0.0f, 0.0f));
+	graph.destroy(c);
+	ASSERT_EQ(1u, graph.update());
+	ASSERT_FLOAT_EQ(2.0f, graph.getWorldTransform(e)(3, 1));
+}
+
+TEST(FlatSceneGraph, SubtreeBoundsFollowChanges)
+{
+	FlatSceneGraph graph;
+	const BoundingBoxF unit(Point3F(-1.0f, -1.0f, -1.0f), Point3F(1.0f, 1.0f, 1.0f));
+	auto root = graph.create(FlatSceneGraph::Handle(), Matrix4x4F::IDENTITY(), unit);
+	auto near = graph.create(root, translation(2.0f, 0.0f, 0.0f), unit);
+	auto far = graph.create(root, translation(10.0f, 0.0f, 0.0f), unit);
+	graph.update();
+	ASSERT_FLOAT_EQ(11.0f, graph.getSubtreeBounds(root).getMaximum(0));
+	ASSERT_FLOAT_EQ(3.0f, graph.getSubtreeBounds(near).getMaximum(0));
+
+	graph.setLocalTransform(near, translation(-5.0f, 0.0f, 0.0f));
+	graph.update();
+	ASSERT_FLOAT_EQ(-6.0f, graph.getSubtreeBounds(root).getMinimum(0));
+
+	graph.destroy(far);
+	graph.update();
+	ASSERT_FLOAT_EQ(1.0f, graph.getSubtreeBounds(root).getMaximum(0));
+}
+
+TEST(FlatSceneGraph, TraverseCullsAgainstFrustum)
+{
+	FlatSceneGraph graph;
+	const BoundingBoxF small(Point3F(-0.1f, -0.1f, -0.1f), Point3F(0.1f, 0.1f, 0.1f));
+	auto visible = graph.create(FlatSceneGraph::Handle(), Matrix4x4F::IDENTITY(), small, 0);
+	graph.create(visible, translation(0.5f, 0.0f, 0.0f), small, 1);
+	graph.create(visible, translation(5.0f, 0.0f, 0.0f), small, 2);
+	auto hidden = graph.create(FlatSceneGraph::Handle(), translation(0.0f, 5.0f, 0.0f), small, 3);
+	graph.create(hidden, Matrix4x4F::IDENTITY(), small, 4);
+	graph.update();
+
+	/// The cube [-1, 1]
+	std::vector<FlatSceneGraph::Renderable> drawn;
+	CullingStatistics statistics = graph.traverse(Frustum(Matrix4x4F::IDENTITY()),
+			[&drawn](FlatSceneGraph::Renderable renderable, const Matrix4x4F&)
+	{
+		drawn.push_back(renderable);
+	});
+	ASSERT_EQ((std::vector<FlatSceneGraph::Renderable>{0, 1}), drawn);
+	ASSERT_EQ(2u, statistics.drawn);
+	ASSERT_EQ(3u, statistics.culled);
+}
+
+TEST(FlatSceneGraph, ParallelTraverseMatchesSerial)
+{
+	/// Chains and fans of nodes on a line through the cube [-1, 1], the outermost entirely outside of it
+	FlatSceneGraph graph;
+	const BoundingBoxF small(Point3F(-0.01f, -0.01f, -0.01f), Point3F(0.01f, 0.01f, 0.01f));
+	FlatSceneGraph::Renderable next = 0;
+	for(int root = 0; root < 6; ++root)
+	{
+		auto parent = graph.create(FlatSceneGraph::Handle(), translation(root * 0.6f - 1.5f, 0.0f, 0.0f), small, next++);
+		for(int depth = 0; depth < 20; ++depth)
+		{
+			auto child = graph.create(parent, translation(0.02f, 0.0f, 0.0f), small, next++);
+			graph.create(parent, translation(0.0f, 0.05f * depth, 0.0f), small, next++);
+			parent = child;
+		}
+	}
+	graph.update();
+
+	const Frustum frustum(Matrix4x4F::IDENTITY());
+	std::vector<FlatSceneGraph::Renderable> serial;
+	CullingStatistics expected = graph.traverse(frustum, [&serial](FlatSceneGraph::Renderable renderable, const Matrix4x4F&)
+	{
+		serial.push_back(renderable);
+	});
+	ASSERT_LT(0u, expected.drawn);
+	ASSERT_LT(0u, expected.culled);
+
+	for(std::size_t count = 1; count <= 9; ++count)
+	{
+		CommandLists<FlatSceneGraph::Renderable> lists(count);
+		CullingStatistics statistics = graph.traverse(frustum, lists,
+				[](FlatSceneGraph::Renderable renderable, const Matrix4x4F&, std::vector<FlatSceneGraph::Renderable>& list)
+		{
+			list.push_back(renderable);
+		});
+		std::vector<FlatSceneGraph::Renderable> merged;
+		lists.replay([&merged](FlatSceneGraph::Renderable renderable)
+		{
+			merged.push_back(renderable);
+		});
+		ASSERT_EQ(serial, merged);
+		ASSERT_EQ(expected.drawn, statistics.drawn);
+		ASSERT_EQ(expected.culled, statistics.culled);
+	}
+}
+
+TEST(FlatSceneGraph, DISABLED_TraversalBenchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto elapsed = [](Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	};
+
+	/// 1,001,000 nodes: 1000 roots of 10 groups of 99 leaves, built as both hierarchies
+	const BoundingBoxF unit(Point3F(-1.0f, -1.0f, -1.0f), Point3F(1.0f, 1.0f, 1.0f));
+	FlatSceneGraph graph;
+	graph.reserve(1001000);
+	std::vector<FlatSceneGraph::Handle> roots;
+	std::vector<std::shared_ptr<PointerNode>> pointerRoots;
+	FlatSceneGraph::Renderable next = 0;
+	for(int root = 0; root < 1000; ++root)
+	{
+		const Matrix4x4F rootTransform = translation(root * 10.0f, 0.0f, 0.0f);
+		roots.push_back(graph.create(FlatSceneGraph::Handle(), rootTransform, BoundingBoxF(), next));
+		pointerRoots.push_back(std::make_shared<PointerNode>(rootTransform, BoundingBoxF(), next++));
+		for(int group = 0; group < 10; ++group)
+		{
+			const Matrix4x4F groupTransform = translation(0.0f, group * 2.0f, 0.0f);
+			const FlatSceneGraph::Handle groupNode = graph.create(roots.back(), groupTransform, BoundingBoxF(), next);
+			PointerNode& pointerGroup = pointerRoots.back()->add(std::make_shared<PointerNode>(groupTransform, BoundingBoxF(), next++));
+			for(int leaf = 0; leaf < 99; ++leaf)
+			{
+				const Matrix4x4F leafTransform = translation(0.0f, 0.0f, leaf * 0.1f);
+				graph.create(groupNode, leafTransform, unit, next);
+				pointerGroup.add(std::make_shared<PointerNode>(leafTransform, unit, next++));
+			}
+		}
+	}
+	graph.update();
+
+	/// Moving every root dirties every node
+	Clock::time_point start = Clock::now();
+	for(std::size_t i = 0; i < roots.size(); ++i)
+	{
+		graph.setLocalTransform(roots[i], translation(i * 10.0f, 1.0f, 0.0f));
+	}
+	const std::size_t updated = graph.update();
+	const double flatUpdate = elapsed(start);
+
+	std::vector<FlatSceneGraph::Renderable> visited;
+	visited.reserve(graph.getNodeCount());
+	start = Clock::now();
+	graph.traverse([&visited](FlatSceneGraph::Renderable renderable, const Matrix4x4F&, const BoundingBoxF&)
+	{
+		visited.push_back(renderable);
+		return true;
+	});
+	const double flatTraverse = elapsed(start);
+	ASSERT_EQ(graph.getNodeCount(), updated);
+	ASSERT_EQ(graph.getNodeCount(), visited.size());
+
+	start = Clock::now();
+	for(const std::shared_ptr<PointerNode>& root : pointerRoots)
+	{
+		root->update(Matrix4x4F::IDENTITY());
+	}
+	const double pointerUpdate = elapsed(start);
+
+	const std::vector<FlatSceneGraph::Renderable> flatOrder = std::move(visited);
+	visited.clear();
+	visited.reserve(flatOrder.size());
+	start = Clock::now();
+	for(const std::shared_ptr<PointerNode>& root : pointerRoots)
+	{
+		root->traverse(visited);
+	}
+	const double pointerTraverse = elapsed(start);
+	ASSERT_EQ(flatOrder, visited);
+
+	std::cout << graph.getNodeCount() << " nodes" << std::endl;
+	std::cout << "  flat:     update " << flatUpdate << " ms, traverse " << flatTraverse << " ms" << std::endl;
+	std::cout << "  pointers: update " << pointerUpdate << " ms, traverse " << pointerTraverse << " ms" << std::endl;
+}
+
+TEST(FlatSceneGraph, DISABLED_DeepHierarchyBenchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto elapsed = [](Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	};
+
+	/// A chain 100,000 nodes deep
+	const std::size_t depth = 100000;
+	FlatSceneGraph graph;
+	graph.reserve(depth);
+	std::vector<FlatSceneGraph::Handle> chain;
+	chain.push_back(graph.create(FlatSceneGraph::Handle(), translation(0.0f, 0.0f, 0.0f)));
+	for(std::size_t i = 1; i < depth; ++i)
+	{
+		chain.push_back(graph.create(chain.back(), translation(0.001f, 0.0f, 0.0f)));
+	}
+
+	Clock::time_point start = Clock::now();
+	const std::size_t full = graph.update();
+	const double fullTime = elapsed(start);
+
+	start = Clock::now();
+	const std::size_t clean = graph.update();
+	const double cleanTime = elapsed(start);
+
+	/// Only the last 1000 nodes lie below the moved node
+	graph.setLocalTransform(chain[depth - 1000], translation(0.002f, 0.0f, 0.0f));
+	start = Clock::now();
+	const std::size_t dirty = graph.update();
+	const double dirtyTime = elapsed(start);
+
+	ASSERT_EQ(depth, full);
+	ASSERT_EQ(0u, clean);
+	ASSERT_EQ(1000u, dirty);
+	std::cout << "chain of " << depth << " nodes" << std::endl;
+	std::cout << "  full update: " << fullTime << " ms" << std::endl;
+	std::cout << "  clean update: " << cleanTime << " ms" << std::endl;
+	std::cout << "  node 1000 levels above the leaf moved: " << dirtyTime << " ms" << std::endl;
+}
+
+TEST(FlatSceneGraph, DISABLED_ParallelTraversalBenchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	/// 133,000 nodes: 1000 roots of 12 groups of 10 leaves, on a line through the cube [-1, 1]
+	const BoundingBoxF small(Point3F(-0.001f, -0.001f, -0.001f), Point3F(0.001f, 0.001f, 0.001f));
+	FlatSceneGraph graph;
+	graph.reserve(133000);
+	FlatSceneGraph::Renderable next = 0;
+	for(int root = 0; root < 1000; ++root)
+	{
+		const FlatSceneGraph::Handle rootNode = graph.create(FlatSceneGraph::Handle(), translation(root * 0.003f - 1.5f, 0.0f, 0.0f), small, next++);
+		for(int group = 0; group < 12; ++group)
+		{
+			const FlatSceneGraph::Handle groupNode = graph.create(rootNode, translation(0.0f, group * 0.05f, 0.0f), small, next++);
+			for(int leaf = 0; leaf < 10; ++leaf)
+			{
+				graph.create(groupNode, translation(0.0f, 0.0f, leaf * 0.05f), small, next++);
+			}
+		}
+	}
+	graph.update();
+
+	/// Every visible node records the clip matrix of its draw, as a renderer would
+	const Matrix4x4F viewProjection = Matrix4x4F::PERSPECTIVE(60.0f, 1.0f, 1000.0f);
+	const Frustum frustum(Matrix4x4F::IDENTITY());
+	auto generator = [&viewProjection](FlatSceneGraph::Renderable, const Matrix4x4F& worldTransform, std::vector<Matrix4x4F>& list)
+	{
+		list.push_back(worldTransform * viewProjection);
+	};
+
+	std::cout << graph.getNodeCount() << " nodes, " << jobs::Scheduler::getDefault().getWorkerCount() << " workers" << std::endl;
+	for(std::size_t count = 1; count <= 16; count *= 2)
+	{
+		/// The first frame grows the lists
+		CommandLists<Matrix4x4F> lists(count);
+		graph.traverse(frustum, lists, generator);
+
+		const std::size_t frames = 16;
+		CullingStatistics statistics;
+		const Clock::time_point start = Clock::now();
+		for(std::size_t i = 0; i < frames; ++i)
+		{
+			statistics = graph.traverse(frustum, lists, generator);
+		}
+		const double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+		ASSERT_EQ(statistics.drawn, lists.getCommandCount());
+		std::cout << "  " << count << " lists: " << time << " ms per frame (" << statistics.drawn << " drawn, "
+				<< statistics.culled << " culled)" << std::endl;
+	}
+}
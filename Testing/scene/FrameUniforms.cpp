@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "FrameUniforms.hpp"
+#include "ResourceException.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "FrameUniforms";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	Matrix4x4F translation(float x, float y, float z)
+	{
+		Matrix4x4F rv = Matrix4x4F::IDENTITY();
+		rv(3, 0) = x;
+		rv(3, 1) = y;
+		rv(3, 2) = z;
+		return rv;
+	}
+
+	BoundingBoxF box(float x, float y, float z, float half)
+	{
+		return BoundingBoxF(Point3F(x - half, y - half, z - half), Point3F(x + half, y + half, z + half));
+	}
+
+	/// The ObjectData bound to OBJECT_BINDING, as the GPU reads it
+	ObjectData readObject()
+	{
+		GLint buffer = 0;
+		GLint64 offset = 0;
+		glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, FrameUniforms::OBJECT_BINDING, &buffer);
+		glGetInteger64i_v(GL_UNIFORM_BUFFER_START, FrameUniforms::OBJECT_BINDING, &offset);
+		ObjectData rv;
+		glBindBuffer(GL_UNIFORM_BUFFER, static_cast<GLuint>(buffer));
+		glGetBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset), sizeof(rv), &rv);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		return rv;
+	}
+
+	/// The ObjectData of a draw with the provided world transform
+	ObjectData expectObject(const Matrix4x4F& world, const Camera& camera)
+	{
+		const Matrix4x4F view = FrameUniforms::computeView(camera);
+		ObjectData rv;
+		rv.modelView = world * view;
+		rv.modelViewProjection = world * (view * camera.getProjection());
+		return rv;
+	}
+
+	bool operator==(const ObjectData& lhs, const ObjectData& rhs)
+	{
+		return std::memcmp(&lhs, &rhs, sizeof(ObjectData)) == 0;
+	}
+}
+
+TEST(FrameUniforms, TransformsNest)
+{
+	createContext();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+	FrameUniforms uniforms;
+	uniforms.begin(camera);
+	ASSERT_TRUE(Matrix4x4F::IDENTITY() == uniforms.getWorldTransform());
+
+	uniforms.pushTransform(translation(1.0f, 0.0f, 0.0f));
+	uniforms.pushTransform(translation(0.0f, 2.0f, 0.0f));
+	ASSERT_TRUE(translation(1.0f, 2.0f, 0.0f) == uniforms.getWorldTransform());
+	uniforms.popTransform();
+	ASSERT_TRUE(translation(1.0f, 0.0f, 0.0f) == uniforms.getWorldTransform());
+	uniforms.popTransform();
+	ASSERT_TRUE(Matrix4x4F::IDENTITY() == uniforms.getWorldTransform());
+	uniforms.end();
+}
+
+TEST(FrameUniforms, DerivedObjectsFollowTheTransformStack)
+{
+	createContext();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+	FrameUniforms uniforms;
+	uniforms.begin(camera);
+
+	uniforms.bindObject();
+	ASSERT_TRUE(expectObject(Matrix4x4F::IDENTITY(), camera) == readObject());
+
+	/// The ObjectData of a transform is derived once, and shared by the draws after it
+	const Matrix4x4F outer = translation(0.0f, 0.0f, -50.0f);
+	uniforms.pushTransform(outer);
+	uniforms.bindObject();
+	ASSERT_TRUE(expectObject(outer, camera) == readObject());
+	uniforms.bindObject();
+	ASSERT_TRUE(expectObject(outer, camera) == readObject());
+
+	/// A nested transform derives its own, and leaves that of the outer transform intact
+	const Matrix4x4F inner = translation(3.0f, 0.0f, 0.0f);
+	uniforms.pushTransform(inner);
+	uniforms.bindObject();
+	ASSERT_TRUE(expectObject(inner * outer, camera) == readObject());
+	uniforms.popTransform();
+	uniforms.bindObject();
+	ASSERT_TRUE(expectObject(outer, camera) == readObject());
+
+	/// A sibling replaces the popped transform rather than reusing its ObjectData
+	uniforms.pushTransform(translation(-3.0f, 0.0f, 0.0f));
+	uniforms.bindObject();
+	ASSERT_TRUE(expectObject(translation(-3.0f, 0.0f, 0.0f) * outer, camera) == readObject());
+	uniforms.popTransform();
+	uniforms.popTransform();
+	uniforms.end();
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+TEST(FrameUniforms, ThrowsWhenAFrameRunsOutOfObjects)
+{
+	createContext();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+	FrameUniforms uniforms(4, 2);
+
+	/// Every frame holds at least the requested objects, and runs out eventually
+	for(std::size_t frame = 0; frame < 3; ++frame)
+	{
+		uniforms.begin(camera);
+		for(std::size_t i = 0; i < 4; ++i)
+		{
+			ASSERT_NO_THROW(uniforms.bindObject());
+		}
+		ASSERT_THROW(
+		{
+			for(std::size_t i = 0; i < 64; ++i)
+			{
+				uniforms.writeObject();
+			}
+		}, ResourceException);
+		uniforms.end();
+	}
+}
+
+TEST(FrameUniforms, EnteredNodesNarrowThePlanesOfTheirDescendants)
+{
+	createContext();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+	FrameUniforms uniforms;
+	uniforms.begin(camera);
+
+	const BoundingBoxF inside = box(0.0f, 0.0f, -100.0f, 1.0f);
+	const BoundingBoxF behind = box(0.0f, 0.0f, 100.0f, 1.0f);
+	const BoundingBoxF straddling = box(0.0f, 0.0f, 0.0f, 50.0f);
+	ASSERT_FALSE(uniforms.enter(behind));
+
+	/// Below a node that lies inside every plane, no plane is tested again
+	ASSERT_TRUE(uniforms.enter(inside));
+	ASSERT_TRUE(uniforms.enter(behind));
+	uniforms.leave();
+	uniforms.leave();
+
+	/// Below a node that crosses the near plane, that plane is still tested
+	ASSERT_TRUE(uniforms.enter(straddling));
+	ASSERT_FALSE(uniforms.enter(behind));
+	ASSERT_TRUE(uniforms.enter(inside));
+	uniforms.leave();
+	uniforms.leave();
+
+	/// Transforms move the view volume into their space
+	uniforms.pushTransform(translation(0.0f, 0.0f, 200.0f));
+	ASSERT_FALSE(uniforms.enter(inside));
+	ASSERT_TRUE(uniforms.enter(box(0.0f, 0.0f, -300.0f, 1.0f)));
+	uniforms.leave();
+	uniforms.popTransform();
+
+	const CullingStatistics& statistics = uniforms.getCullingStatistics();
+	ASSERT_EQ(5u, statistics.drawn);
+	ASSERT_EQ(3u, statistics.culled);
+	ASSERT_EQ(0u, statistics.occluded);
+	uniforms.end();
+
+	/// The next frame starts counting anew
+	uniforms.begin(camera);
+	ASSERT_EQ(0u, uniforms.getCullingStatistics().drawn);
+	uniforms.end();
+}
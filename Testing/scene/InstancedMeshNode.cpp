@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "InstancedMeshNode.hpp"
+#include "MeshNode.hpp"
+#include "RenderQueue.hpp"
+#include "Translation.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "InstancedMeshNode";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	Mesh quad()
+	{
+		std::vector<Vertex32F> vertices;
+		for(std::size_t i = 0; i < 4; ++i)
+		{
+			vertices.push_back(Vertex32F(Point3F(static_cast<float>(i & 1), static_cast<float>(i >> 1), 0.0f),
+					Vector3F(0.0f, 0.0f, 1.0f), Point2F(0.0f, 0.0f)));
+		}
+		std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+		renderables[0].indices = {0, 1, 2, 2, 1, 3};
+		return Mesh(vertices, std::vector<Material>(), renderables);
+	}
+
+	Matrix4x4F translation(float x, float y, float z)
+	{
+		Matrix4x4F rv = Matrix4x4F::IDENTITY();
+		rv(3, 0) = x;
+		rv(3, 1) = y;
+		rv(3, 2) = z;
+		return rv;
+	}
+
+	/**
+	 * The average time of a frame, in milliseconds, once the nodes are warm.  The frames are
+	 * rendered as Scene does, with room for a draw per node.
+	 *
+	 */
+	double timeFrames(const std::vector<std::shared_ptr<SceneGraphNode>>& nodes, const Camera& camera)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		FrameUniforms uniforms(nodes.size());
+		RenderQueue queue;
+		auto frame = [&]()
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			uniforms.begin(camera);
+			queue.begin();
+			for(const std::shared_ptr<SceneGraphNode>& node : nodes)
+			{
+				if(uniforms.enter(node->getBounds()))
+				{
+					node->render(camera);
+					uniforms.leave();
+				}
+			}
+			queue.flush(uniforms);
+			uniforms.end();
+		};
+
+		frame();
+		glFinish();
+		const std::size_t frames = 8;
+		const Clock::time_point start = Clock::now();
+		for(std::size_t i = 0; i < frames; ++i)
+		{
+			frame();
+		}
+		glFinish();
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+	}
+}
+
+TEST(InstancedMeshNode, DISABLED_Benchmarks)
+{
+	createContext();
+	const Mesh mesh = quad();
+	const Camera camera(60.0f, 1.0f, 1.0f, 1000.0f);
+
+	/// 50k quads in a grid in front of the camera, drawn once as instances and once as nodes
+	const std::size_t count = 50000;
+	const std::size_t side = 250;
+	auto position = [&](std::size_t i)
+	{
+		return translation(static_cast<float>(i % side) - side / 2.0f, static_cast<float>(i / side) - side / 2.0f, -300.0f);
+	};
+
+	std::shared_ptr<InstancedMeshNode> instances = std::make_shared<InstancedMeshNode>(mesh, count);
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		instances->addInstance(position(i));
+	}
+
+	std::vector<std::shared_ptr<SceneGraphNode>> nodes;
+	/// Every quad takes a whole block of 64 vertices and 64 indices
+	std::shared_ptr<GeometryArena> arena = std::make_shared<GeometryArena>(64 * count, 64 * count);
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		const Matrix4x4F transform = position(i);
+		std::shared_ptr<Translation<float>> node = std::make_shared<Translation<float>>(transform(3, 0), transform(3, 1), transform(3, 2));
+		node->add(std::make_shared<MeshNode>(mesh, arena));
+		nodes.push_back(node);
+	}
+
+	const double instancedTime = timeFrames(std::vector<std::shared_ptr<SceneGraphNode>>(1, instances), camera);
+	const double separateTime = timeFrames(nodes, camera);
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+	std::cout << count << " quads: " << instancedTime << " ms per frame as instances of one InstancedMeshNode, "
+			<< separateTime << " ms as MeshNodes" << std::endl;
+}
@@ -0,0 +1,364 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "LooseOctree.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	typedef LooseOctree<int> Octree;
+
+	const BoundingBoxF WORLD(Point3F(-100.0f, -100.0f, -100.0f), Point3F(100.0f, 100.0f, 100.0f));
+
+	/// Boxes of every size, some of them straddling or outside of the world
+	BoundingBoxF randomBox(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+		std::uniform_real_distribution<float> exponent(-3.0f, 5.0f);
+		const float size = std::pow(2.0f, exponent(random));
+		const Point3F center(position(random), position(random), position(random));
+		return BoundingBoxF(Point3F(center[0] - size, center[1] - size, center[2] - size),
+				Point3F(center[0] + size, center[1] + size, center[2] + size));
+	}
+
+	std::vector<int> values(const Octree& octree, const std::vector<Octree::Handle>& handles)
+	{
+		std::vector<int> rv;
+		for(Octree::Handle handle : handles)
+		{
+			rv.push_back(octree.get(handle));
+		}
+		std::sort(rv.begin(), rv.end());
+		return rv;
+	}
+
+	float squaredDistance(const Point3F& point, const BoundingBoxF& box)
+	{
+		float rv = 0.0f;
+		for(std::size_t i = 0; i < 3; ++i)
+		{
+			const float outside = std::max(std::max(box.getMinimum(i) - point[i], point[i] - box.getMaximum(i)), 0.0f);
+			rv += outside * outside;
+		}
+		return rv;
+	}
+
+	/// The objects of an Octree, kept alongside it to answer queries by brute force
+	struct Population
+	{
+		Octree octree;
+		std::vector<Octree::Handle> handles;
+		std::vector<BoundingBoxF> bounds;
+
+		Population(std::mt19937& random, std::size_t count) : octree(WORLD, 6)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				bounds.push_back(i % 100 == 0 ? BoundingBoxF() : randomBox(random));
+				handles.push_back(octree.insert(bounds.back(), static_cast<int>(i)));
+			}
+		}
+
+		std::vector<int> overlapping(const BoundingBoxF& box) const
+		{
+			std::vector<int> rv;
+			for(std::size_t i = 0; i < bounds.size(); ++i)
+			{
+				if(octree.isValid(handles[i]) && bounds[i].intersects(box))
+				{
+					rv.push_back(static_cast<int>(i));
+				}
+			}
+			return rv;
+		}
+	};
+}
+
+TEST(LooseOctree, BoxQueriesMatchBruteForce)
+{
+	std::mt19937 random(7);
+	Population population(random, 3000);
+	ASSERT_EQ(3000u, population.octree.getSize());
+	for(int i = 0; i < 200; ++i)
+	{
+		const BoundingBoxF box = randomBox(random);
+		std::vector<Octree::Handle> found;
+		population.octree.query(box, found);
+		ASSERT_EQ(population.overlapping(box), values(population.octree, found));
+	}
+}
+
+TEST(LooseOctree, UpdatesAndRemovalsKeepQueriesExact)
+{
+	std::mt19937 random(11);
+	Population population(random, 2000);
+	std::uniform_real_distribution<float> step(-4.0f, 4.0f);
+	for(int round = 0; round < 10; ++round)
+	{
+		for(std::size_t i = 0; i < population.bounds.size(); ++i)
+		{
+			/// Small steps mostly stay in their cell, and the occasional jump leaves it
+			BoundingBoxF& bounds = population.bounds[i];
+			if(i % 100 == 0)
+			{
+				continue;
+			}
+			const float jump = i % 7 == 0 ? 50.0f : 1.0f;
+			const Point3F offset(step(random) * jump, step(random) * jump, step(random) * jump);
+			bounds = BoundingBoxF(Point3F(bounds.getMinimum(0) + offset[0], bounds.getMinimum(1) + offset[1], bounds.getMinimum(2) + offset[2]),
+					Point3F(bounds.getMaximum(0) + offset[0], bounds.getMaximum(1) + offset[1], bounds.getMaximum(2) + offset[2]));
+			population.octree.update(population.handles[i], bounds);
+		}
+		for(int i = 0; i < 20; ++i)
+		{
+			const BoundingBoxF box = randomBox(random);
+			std::vector<Octree::Handle> found;
+			population.octree.query(box, found);
+			ASSERT_EQ(population.overlapping(box), values(population.octree, found));
+		}
+	}
+
+	const Octree::Handle removed = population.handles[5];
+	population.octree.remove(removed);
+	ASSERT_FALSE(population.octree.isValid(removed));
+	ASSERT_THROW(population.octree.update(removed, WORLD), IllegalArgumentException);
+	ASSERT_THROW(population.octree.get(Octree::Handle()), IllegalArgumentException);
+
+	/// The slot is reused under a new generation
+	const Octree::Handle reused = population.octree.insert(WORLD, -1);
+	ASSERT_EQ(removed.index, reused.index);
+	ASSERT_FALSE(population.octree.isValid(removed));
+
+	/// Cells are released once they hold nothing
+	for(std::size_t i = 0; i < population.handles.size(); ++i)
+	{
+		if(i != 5)
+		{
+			population.octree.remove(population.handles[i]);
+		}
+	}
+	population.octree.remove(reused);
+	ASSERT_EQ(0u, population.octree.getSize());
+	ASSERT_EQ(1u, population.octree.getCellCount());
+
+	ASSERT_THROW(Octree octree(BoundingBoxF{}), IllegalArgumentException);
+	ASSERT_THROW(Octree octree(WORLD, 21), IllegalArgumentException);
+}
+
+TEST(LooseOctree, RayQueriesAreSortedAndMatchBruteForce)
+{
+	std::mt19937 random(13);
+	Population population(random, 3000);
+	std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+	for(int i = 0; i < 100; ++i)
+	{
+		const Ray ray(Point3F(coordinate(random) * 150.0f, coordinate(random) * 150.0f, coordinate(random) * 150.0f),
+				Vector3F(coordinate(random), coordinate(random), i % 10 == 0 ? 0.0f : coordinate(random)));
+		const float maximum = 300.0f;
+		std::vector<Octree::RayHit> hits;
+		population.octree.query(ray, maximum, hits);
+
+		std::vector<int> expected;
+		for(std::size_t j = 0; j < population.bounds.size(); ++j)
+		{
+			float distance;
+			if(ray.intersects(population.bounds[j], distance, maximum))
+			{
+				expected.push_back(static_cast<int>(j));
+			}
+		}
+		std::vector<Octree::Handle> handles;
+		for(std::size_t j = 0; j < hits.size(); ++j)
+		{
+			handles.push_back(hits[j].handle);
+			if(j != 0)
+			{
+				ASSERT_LE(hits[j - 1].distance, hits[j].distance);
+			}
+		}
+		ASSERT_EQ(expected, values(population.octree, handles));
+	}
+}
+
+TEST(LooseOctree, NearestQueriesMatchBruteForce)
+{
+	std::mt19937 random(17);
+	Population population(random, 3000);
+	std::uniform_real_distribution<float> coordinate(-130.0f, 130.0f);
+	for(int i = 0; i < 100; ++i)
+	{
+		const Point3F point(coordinate(random), coordinate(random), coordinate(random));
+		std::vector<Octree::Handle> found;
+		population.octree.nearest(point, 10, found);
+
+		std::vector<float> expected;
+		for(const BoundingBoxF& bounds : population.bounds)
+		{
+			if(!bounds.isEmpty())
+			{
+				expected.push_back(squaredDistance(point, bounds));
+			}
+		}
+		std::sort(expected.begin(), expected.end());
+		expected.resize(10);
+
+		ASSERT_EQ(10u, found.size());
+		for(std::size_t j = 0; j < found.size(); ++j)
+		{
+			ASSERT_EQ(expected[j], squaredDistance(point, population.octree.getBounds(found[j])));
+		}
+	}
+
+	/// The maximum distance excludes what lies beyond it
+	std::vector<Octree::Handle> found;
+	population.octree.nearest(Point3F(1000.0f, 1000.0f, 1000.0f), 10, found, 1.0f);
+	ASSERT_TRUE(found.empty());
+}
+
+TEST(LooseOctree, BatchedQueriesMatchSingleQueries)
+{
+	std::mt19937 random(19);
+	Population population(random, 2000);
+	std::vector<BoundingBoxF> boxes;
+	std::vector<Point3F> points;
+	std::vector<Ray> rays;
+	for(int i = 0; i < 50; ++i)
+	{
+		boxes.push_back(randomBox(random));
+		points.push_back(boxes.back().getCenter());
+		rays.push_back(Ray(boxes.back().getCenter(), Vector3F(1.0f, 0.5f, -0.25f)));
+	}
+
+	std::vector<Octree::Handle> results;
+	std::vector<std::size_t> offsets;
+	population.octree.query(boxes, results, offsets);
+	ASSERT_EQ(boxes.size() + 1, offsets.size());
+	for(std::size_t i = 0; i < boxes.size(); ++i)
+	{
+		std::vector<Octree::Handle> single;
+		population.octree.query(boxes[i], single);
+		ASSERT_EQ(values(population.octree, single),
+				values(population.octree, std::vector<Octree::Handle>(results.begin() + offsets[i], results.begin() + offsets[i + 1])));
+	}
+
+	population.octree.nearest(points, 5, results, offsets);
+	for(std::size_t i = 0; i < points.size(); ++i)
+	{
+		std::vector<Octree::Handle> single;
+		population.octree.nearest(points[i], 5, single);
+		ASSERT_TRUE(std::equal(single.begin(), single.end(), results.begin() + offsets[i]));
+	}
+
+	std::vector<Octree::RayHit> hits;
+	population.octree.query(rays, 100.0f, hits, offsets);
+	for(std::size_t i = 0; i < rays.size(); ++i)
+	{
+		std::vector<Octree::RayHit> single;
+		population.octree.query(rays[i], 100.0f, single);
+		ASSERT_EQ(single.size(), offsets[i + 1] - offsets[i]);
+	}
+}
+
+/**
+ * Query and update costs at a million moving objects; run with --gtest_also_run_disabled_tests
+ *
+ */
+TEST(LooseOctree, DISABLED_Benchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto elapsed = [](Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	};
+
+	const std::size_t count = 1000000;
+	const BoundingBoxF world(Point3F(-2048.0f, -2048.0f, -2048.0f), Point3F(2048.0f, 2048.0f, 2048.0f));
+	std::mt19937 random(23);
+	std::uniform_real_distribution<float> position(-2048.0f, 2048.0f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+
+	std::vector<Point3F> centers;
+	std::vector<float> sizes;
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		centers.push_back(Point3F(position(random), position(random), position(random)));
+		sizes.push_back(size(random));
+	}
+	auto boundsOf = [&](std::size_t i)
+	{
+		const Point3F& c = centers[i];
+		const float s = sizes[i];
+		return BoundingBoxF(Point3F(c[0] - s, c[1] - s, c[2] - s), Point3F(c[0] + s, c[1] + s, c[2] + s));
+	};
+
+	LooseOctree<std::uint32_t> octree(world);
+	std::vector<LooseOctree<std::uint32_t>::Handle> handles;
+	handles.reserve(count);
+	Clock::time_point start = Clock::now();
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		handles.push_back(octree.insert(boundsOf(i), static_cast<std::uint32_t>(i)));
+	}
+	std::cout << "insert: " << elapsed(start) * 1e6 / count << " ns/object, " << octree.getCellCount() << " cells" << std::endl;
+
+	for(std::size_t frame = 0; frame < 3; ++frame)
+	{
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			centers[i] = Point3F(centers[i][0] + step(random), centers[i][1] + step(random), centers[i][2] + step(random));
+		}
+		start = Clock::now();
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			octree.update(handles[i], boundsOf(i));
+		}
+		std::cout << "update (every object moves): " << elapsed(start) << " ms/frame, "
+				<< elapsed(start) * 1e6 / count << " ns/object" << std::endl;
+	}
+
+	std::vector<BoundingBoxF> boxes;
+	std::vector<Point3F> points;
+	std::vector<Ray> rays;
+	for(std::size_t i = 0; i < 1000; ++i)
+	{
+		const Point3F center(position(random), position(random), position(random));
+		boxes.push_back(BoundingBoxF(Point3F(center[0] - 32.0f, center[1] - 32.0f, center[2] - 32.0f),
+				Point3F(center[0] + 32.0f, center[1] + 32.0f, center[2] + 32.0f)));
+		points.push_back(center);
+		rays.push_back(Ray(center, Vector3F(step(random), step(random), step(random))));
+	}
+
+	std::vector<LooseOctree<std::uint32_t>::Handle> results;
+	std::vector<LooseOctree<std::uint32_t>::RayHit> hits;
+	std::vector<std::size_t> offsets;
+	start = Clock::now();
+	octree.query(boxes, results, offsets);
+	std::cout << "box query (64^3): " << elapsed(start) * 1000.0 / boxes.size() << " us/query, "
+			<< results.size() / boxes.size() << " objects/query" << std::endl;
+	start = Clock::now();
+	octree.query(rays, 512.0f, hits, offsets);
+	std::cout << "ray query (512 long): " << elapsed(start) * 1000.0 / rays.size() << " us/query" << std::endl;
+	start = Clock::now();
+	octree.nearest(points, 16, results, offsets);
+	std::cout << "16 nearest: " << elapsed(start) * 1000.0 / points.size() << " us/query" << std::endl;
+
+	start = Clock::now();
+	std::size_t bruteForce = 0;
+	for(std::size_t i = 0; i < 10; ++i)
+	{
+		for(std::size_t j = 0; j < count; ++j)
+		{
+			bruteForce += octree.getBounds(handles[j]).intersects(boxes[i]);
+		}
+	}
+	std::cout << "box query by brute force: " << elapsed(start) * 100.0 << " us/query (" << bruteForce / 10 << " objects/query)" << std::endl;
+}
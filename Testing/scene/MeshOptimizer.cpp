@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "MeshOptimizer.hpp"
+#include "MeshProvider.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	const std::size_t GRID = 64;
+
+	std::vector<Vertex32F> gridVertices()
+	{
+		std::vector<Vertex32F> vertices;
+		for(std::size_t y = 0; y < GRID; ++y)
+		{
+			for(std::size_t x = 0; x < GRID; ++x)
+			{
+				vertices.push_back(Vertex32F(Point3F(static_cast<float>(x), 0.0f, static_cast<float>(y)), Vector3F(0.0f, 1.0f, 0.0f), Point2F(0.0f, 0.0f)));
+			}
+		}
+		return vertices;
+	}
+
+	/// A grid whose triangles are emitted in a random order
+	std::vector<std::size_t> shuffledGridIndices(unsigned int seed)
+	{
+		std::vector<std::array<std::size_t, 3>> triangles;
+		for(std::size_t y = 0; y + 1 < GRID; ++y)
+		{
+			for(std::size_t x = 0; x + 1 < GRID; ++x)
+			{
+				std::size_t i = y * GRID + x;
+				triangles.push_back({{i, i + GRID, i + 1}});
+				triangles.push_back({{i + 1, i + GRID, i + GRID + 1}});
+			}
+		}
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+		std::vector<std::size_t> indices;
+		for(const auto& triangle : triangles)
+		{
+			indices.insert(indices.end(), triangle.begin(), triangle.end());
+		}
+		return indices;
+	}
+
+	/// Rotates each triangle so its smallest id leads (preserving winding) and sorts the list
+	std::vector<std::array<std::size_t, 3>> canonical(const std::vector<std::size_t>& ids)
+	{
+		std::vector<std::array<std::size_t, 3>> triangles;
+		for(std::size_t i = 0; i < ids.size(); i += 3)
+		{
+			std::array<std::size_t, 3> t = {{ids[i], ids[i + 1], ids[i + 2]}};
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			triangles.push_back(t);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	/// Maps the indices of a (possibly reordered) grid back to the original grid vertex ids
+	std::vector<std::size_t> gridIds(const Mesh& mesh, const std::vector<std::size_t>& indices)
+	{
+		std::vector<std::size_t> ids;
+		for(std::size_t index : indices)
+		{
+			const Point3F& position = mesh.getVertices()[index].getPosition();
+			ids.push_back(static_cast<std::size_t>(position[2]) * GRID + static_cast<std::size_t>(position[0]));
+		}
+		return ids;
+	}
+}
+
+TEST(MeshOptimizer, VertexCacheReducesACMR)
+{
+	std::vector<std::size_t> indices = shuffledGridIndices(1);
+	MeshOptimizer::Statistics before = MeshOptimizer::analyze(indices, GRID * GRID, 32);
+	MeshOptimizer::optimizeVertexCache(indices, GRID * GRID, 32);
+	MeshOptimizer::Statistics after = MeshOptimizer::analyze(indices, GRID * GRID, 32);
+	ASSERT_EQ(before.triangles, after.triangles);
+	ASSERT_EQ(before.vertices, after.vertices);
+	ASSERT_GT(before.getACMR(), 2.0);
+	ASSERT_LT(after.getACMR(), 0.8);
+	ASSERT_LT(after.getATVR(), before.getATVR());
+}
+
+TEST(MeshOptimizer, VertexCachePreservesTriangles)
+{
+	std::vector<std::size_t> original = shuffledGridIndices(2);
+	std::vector<std::size_t> indices = original;
+	MeshOptimizer::optimizeVertexCache(indices, GRID * GRID, 16);
+	ASSERT_EQ(canonical(original), canonical(indices));
+}
+
+TEST(MeshOptimizer, VertexFetchFirstUseOrder)
+{
+	std::vector<Vertex32F> vertices = gridVertices();
+	std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+	renderables[0].indices = {5, 3, 5, 9, 3, 7};
+	MeshOptimizer::optimizeVertexFetch(vertices, renderables);
+	ASSERT_EQ(4u, vertices.size());
+	ASSERT_EQ((std::vector<std::size_t>{0, 1, 0, 2, 1, 3}), renderables[0].indices);
+	ASSERT_FLOAT_EQ(9.0f, vertices[2].getPosition()[0]);
+}
+
+TEST(MeshOptimizer, PipelinePreservesGeometry)
+{
+	std::vector<Mesh::Renderable> renderables;
+	std::vector<std::vector<std::size_t>> originals;
+	for(unsigned int seed = 0; seed < 4; ++seed)
+	{
+		renderables.push_back(Mesh::Renderable(seed));
+		renderables.back().indices = shuffledGridIndices(seed + 10);
+		originals.push_back(renderables.back().indices);
+	}
+	Mesh mesh(gridVertices(), std::vector<Material>(), renderables);
+	MeshOptimizer::Report report = MeshOptimizer().optimize(mesh);
+
+	ASSERT_EQ(report.before.triangles, report.after.triangles);
+	ASSERT_LT(report.after.getACMR(), report.before.getACMR());
+	ASSERT_EQ(4u, mesh.getMeshes().size());
+	for(std::size_t i = 0; i < originals.size(); ++i)
+	{
+		ASSERT_EQ(i, mesh.getMeshes()[i].materialIndex);
+		ASSERT_EQ(canonical(originals[i]), canonical(gridIds(mesh, mesh.getMeshes()[i].indices)));
+	}
+}
+
+TEST(MeshOptimizer, RejectsMalformedIndices)
+{
+	std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+	renderables[0].indices = {0, 1};
+	Mesh partial(gridVertices(), std::vector<Material>(), renderables);
+	ASSERT_THROW(MeshOptimizer().optimize(partial), IllegalArgumentException);
+
+	renderables[0].indices = {0, 1, GRID * GRID};
+	Mesh outOfRange(gridVertices(), std::vector<Material>(), renderables);
+	ASSERT_THROW(MeshOptimizer().optimize(outOfRange), IllegalArgumentException);
+}
+
+TEST(MeshOptimizer, LoadedMeshesReportTheirOptimization)
+{
+	/// Serves a shuffled grid for any file of its extension
+	class GridProvider : public spi::MeshProvider
+	{
+	  public:
+		bool isLoadableExtension(const std::string& extension) const noexcept override
+		{
+			return extension == ".grid";
+		}
+
+		Mesh loadMesh(const std::string&) override
+		{
+			std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+			renderables[0].indices = shuffledGridIndices(3);
+			return Mesh(gridVertices(), std::vector<Material>(), renderables);
+		}
+	};
+	spi::meshProviders.push_back(std::make_shared<GridProvider>());
+
+	MeshOptimizer::Report report;
+	const Mesh mesh = io::loadMesh("terrain.grid", &report);
+	ASSERT_EQ(2 * (GRID - 1) * (GRID - 1), report.before.triangles);
+	ASSERT_EQ(report.before.triangles, report.after.triangles);
+	ASSERT_LT(report.after.getACMR(), report.before.getACMR());
+
+	/// The report is optional, but the Mesh is optimized either way
+	const Mesh unreported = io::loadMesh("terrain.grid");
+	ASSERT_EQ(mesh.getMeshes()[0].indices, unreported.getMeshes()[0].indices);
+	ASSERT_EQ(report.after.transforms, MeshOptimizer::analyze(unreported.getMeshes()[0].indices, GRID * GRID, 32).transforms);
+	spi::meshProviders.clear();
+}
@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "MeshSimplifier.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// A latitude-longitude sphere, whose texture coordinates wrap around at a seam
+	Mesh sphere(std::size_t rings, std::size_t segments, float radius, bool split = false)
+	{
+		const float pi = 3.14159265f;
+		std::vector<Vertex32F> vertices;
+		auto add = [&](float theta, float phi, float u, float v)
+		{
+			const Vector3F normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			vertices.push_back(Vertex32F(Point3F(normal[0] * radius, normal[1] * radius, normal[2] * radius), normal, Point2F(u, v)));
+		};
+		add(0.0f, 0.0f, 0.5f, 0.0f);
+		add(pi, 0.0f, 0.5f, 1.0f);
+		for(std::size_t ring = 1; ring < rings; ++ring)
+		{
+			const float theta = pi * static_cast<float>(ring) / static_cast<float>(rings);
+			for(std::size_t segment = 0; segment <= segments; ++segment)
+			{
+				/// The last column repeats the first, with another texture coordinate
+				const float phi = 2.0f * pi * static_cast<float>(segment % segments) / static_cast<float>(segments);
+				add(theta, phi, static_cast<float>(segment) / static_cast<float>(segments), static_cast<float>(ring) / static_cast<float>(rings));
+			}
+		}
+
+		std::vector<Mesh::Renderable> renderables(split ? 2 : 1, Mesh::Renderable(0));
+		auto vertex = [&](std::size_t ring, std::size_t segment) -> std::size_t
+		{
+			return ring == 0 ? 0 : ring == rings ? 1 : 2 + (ring - 1) * (segments + 1) + segment;
+		};
+		for(std::size_t ring = 0; ring < rings; ++ring)
+		{
+			std::vector<std::size_t>& indices = renderables[split && ring >= rings / 2 ? 1 : 0].indices;
+			for(std::size_t segment = 0; segment < segments; ++segment)
+			{
+				const std::size_t a = vertex(ring, segment);
+				const std::size_t b = vertex(ring + 1, segment);
+				const std::size_t c = vertex(ring, segment + 1);
+				const std::size_t d = vertex(ring + 1, segment + 1);
+				if(ring != 0)
+				{
+					indices.insert(indices.end(), {a, c, b});
+				}
+				if(ring != rings - 1)
+				{
+					indices.insert(indices.end(), {c, d, b});
+				}
+			}
+		}
+		return Mesh(vertices, std::vector<Material>(), renderables);
+	}
+
+	/// A square grid in the plane y = 0, made of two texture islands that meet at x = 0
+	Mesh islands(std::size_t size)
+	{
+		std::vector<Vertex32F> vertices;
+		std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+		for(int island = 0; island < 2; ++island)
+		{
+			const std::size_t first = vertices.size();
+			for(std::size_t z = 0; z <= size; ++z)
+			{
+				for(std::size_t x = 0; x <= size; ++x)
+				{
+					const float px = island == 0 ? -static_cast<float>(x) : static_cast<float>(x);
+					vertices.push_back(Vertex32F(Point3F(px, 0.0f, static_cast<float>(z)), Vector3F(0.0f, 1.0f, 0.0f),
+							Point2F(static_cast<float>(island), static_cast<float>(z))));
+				}
+			}
+			for(std::size_t z = 0; z < size; ++z)
+			{
+				for(std::size_t x = 0; x < size; ++x)
+				{
+					std::size_t a = first + z * (size + 1) + x;
+					std::size_t b = a + size + 1;
+
+					/// Both islands face up
+					if(island == 0)
+					{
+						std::swap(a, b);
+					}
+					renderables[0].indices.insert(renderables[0].indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+				}
+			}
+		}
+		return Mesh(vertices, std::vector<Material>(), renderables);
+	}
+
+	/// The signed area of a triangle projected onto the plane y = 0 (positive facing up)
+	float area(const Mesh& mesh, std::size_t a, std::size_t b, std::size_t c)
+	{
+		const Point3F& p = mesh.getVertices()[a].getPosition();
+		const Point3F& q = mesh.getVertices()[b].getPosition();
+		const Point3F& r = mesh.getVertices()[c].getPosition();
+		return 0.5f * ((r[0] - p[0]) * (q[2] - p[2]) - (q[0] - p[0]) * (r[2] - p[2]));
+	}
+
+	/// The number of triangles along every edge, once vertices are matched by position
+	std::map<std::pair<std::size_t, std::size_t>, int> weldedEdges(const Mesh& mesh, const std::vector<std::size_t>& indices)
+	{
+		std::map<std::vector<float>, std::size_t> positions;
+		std::vector<std::size_t> welded;
+		for(const Vertex32F& vertex : mesh.getVertices())
+		{
+			const Point3F& position = vertex.getPosition();
+			welded.push_back(positions.insert(std::make_pair(std::vector<float>{position[0], position[1], position[2]}, positions.size())).first->second);
+		}
+		std::map<std::pair<std::size_t, std::size_t>, int> edges;
+		for(std::size_t i = 0; i < indices.size(); i += 3)
+		{
+			for(std::size_t k = 0; k < 3; ++k)
+			{
+				const std::size_t a = welded[indices[i + k]];
+				const std::size_t b = welded[indices[i + (k + 1) % 3]];
+				++edges[std::make_pair(std::min(a, b), std::max(a, b))];
+			}
+		}
+		return edges;
+	}
+
+	/**
+	 * Computes how far the centers of triangles lie inside of the sphere of radius two
+	 *
+	 */
+	float deviation(const Mesh& mesh, const std::vector<std::size_t>& indices)
+	{
+		float deviation = 0.0f;
+		for(std::size_t t = 0; t < indices.size(); t += 3)
+		{
+			float center[3] = {0.0f, 0.0f, 0.0f};
+			for(std::size_t k = 0; k < 3; ++k)
+			{
+				const Point3F& position = mesh.getVertices()[indices[t + k]].getPosition();
+				for(std::size_t axis = 0; axis < 3; ++axis)
+				{
+					center[axis] += position[axis] / 3.0f;
+				}
+			}
+			deviation = std::max(deviation, 2.0f - std::sqrt(center[0] * center[0] + center[1] * center[1] + center[2] * center[2]));
+		}
+		return deviation;
+	}
+}
+
+TEST(MeshSimplifier, BuildsAChainOfShrinkingLevels)
+{
+	const Mesh mesh = sphere(48, 96, 2.0f);
+	const std::vector<MeshSimplifier::Level> levels = MeshSimplifier(0.5f, 6).simplify(mesh);
+	ASSERT_EQ(6u, levels.size());
+	ASSERT_EQ(mesh.getMeshes()[0].indices, levels[0].indices[0]);
+	ASSERT_EQ(0.0f, levels[0].error);
+	for(std::size_t i = 1; i < levels.size(); ++i)
+	{
+		const MeshSimplifier::Level& level = levels[i];
+		ASSERT_EQ(3 * level.triangles, level.indices[0].size());
+		ASSERT_LT(level.triangles, levels[i - 1].triangles);
+		ASSERT_LE(level.triangles, levels[i - 1].triangles * 0.6);
+		ASSERT_GE(level.error, levels[i - 1].error);
+
+		/// The sphere stays closed: the seam has not opened, and no hole appeared
+		for(const auto& edge : weldedEdges(mesh, level.indices[0]))
+		{
+			ASSERT_EQ(2, edge.second);
+		}
+
+		/// The centers of the triangles stay near the surface.  The error is a root mean square
+		/// distance, which the farthest triangles exceed by a small factor.
+		ASSERT_LE(deviation(mesh, level.indices[0]), deviation(mesh, levels[0].indices[0]) + 4.0f * level.error);
+	}
+	ASSERT_LT(levels.back().error, 0.2f);
+}
+
+TEST(MeshSimplifier, KeepsSeamsAndBorders)
+{
+	const std::size_t size = 32;
+	const Mesh mesh = islands(size);
+	const std::size_t islandVertices = (size + 1) * (size + 1);
+	const std::vector<MeshSimplifier::Level> levels = MeshSimplifier(0.25f, 4, 8).simplify(mesh);
+	ASSERT_GE(levels.size(), 3u);
+	ASSERT_LT(levels.back().triangles, levels[0].triangles / 16);
+
+	/// A flat surface simplifies without error
+	ASSERT_NEAR(0.0f, levels.back().error, 1e-4f);
+	for(const MeshSimplifier::Level& level : levels)
+	{
+		const std::vector<std::size_t>& indices = level.indices[0];
+		float areas[2] = {0.0f, 0.0f};
+		for(std::size_t t = 0; t < indices.size(); t += 3)
+		{
+			const std::size_t island = indices[t] / islandVertices;
+			ASSERT_EQ(island, indices[t + 1] / islandVertices);
+			ASSERT_EQ(island, indices[t + 2] / islandVertices);
+			const float triangle = area(mesh, indices[t], indices[t + 1], indices[t + 2]);
+			ASSERT_GT(triangle, 0.0f);
+			areas[island] += triangle;
+		}
+
+		/// Both islands still cover their squares, so neither border nor seam has moved
+		ASSERT_NEAR(static_cast<float>(size * size), areas[0], 1e-2f);
+		ASSERT_NEAR(static_cast<float>(size * size), areas[1], 1e-2f);
+		for(const auto& edge : weldedEdges(mesh, indices))
+		{
+			ASSERT_LE(edge.second, 2);
+		}
+	}
+}
+
+TEST(MeshSimplifier, SimplifiesEveryRenderable)
+{
+	const Mesh mesh = sphere(32, 64, 1.0f, true);
+	const std::vector<MeshSimplifier::Level> levels = MeshSimplifier(0.5f, 4).simplify(mesh);
+	ASSERT_EQ(4u, levels.size());
+	for(const MeshSimplifier::Level& level : levels)
+	{
+		ASSERT_EQ(2u, level.indices.size());
+		ASSERT_EQ(3 * level.triangles, level.indices[0].size() + level.indices[1].size());
+		ASSERT_FALSE(level.indices[0].empty());
+		ASSERT_FALSE(level.indices[1].empty());
+
+		/// The boundary between the Renderables is shared, so the sphere stays closed
+		std::vector<std::size_t> all(level.indices[0]);
+		all.insert(all.end(), level.indices[1].begin(), level.indices[1].end());
+		for(const auto& edge : weldedEdges(mesh, all))
+		{
+			ASSERT_EQ(2, edge.second);
+		}
+	}
+
+	ASSERT_THROW(MeshSimplifier(1.0f), IllegalArgumentException);
+	ASSERT_THROW(MeshSimplifier(0.5f, 1), IllegalArgumentException);
+	ASSERT_THROW(MeshSimplifier(0.5f, 4, 64, 0.0f), IllegalArgumentException);
+	std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+	renderables[0].indices = {0, 1};
+	ASSERT_THROW(MeshSimplifier().simplify(Mesh(mesh.getVertices(), std::vector<Material>(), renderables)), IllegalArgumentException);
+}
+
+TEST(MeshSimplifier, SelectsLevelsByScreenError)
+{
+	const std::vector<float> errors = {0.0f, 0.01f, 0.04f, 0.16f};
+
+	/// At a distance of 1 with a field of view of 90 degrees, the screen is 2 units high
+	ASSERT_NEAR(0.25f, MeshSimplifier::computeScreenError(0.5f, 1.0f, 90.0f), 1e-5f);
+	ASSERT_EQ(0u, MeshSimplifier::selectLevel(errors, 0.1f, 90.0f, 0.001f));
+	ASSERT_EQ(0u, MeshSimplifier::selectLevel(errors, -1.0f, 90.0f, 0.001f));
+	ASSERT_EQ(1u, MeshSimplifier::selectLevel(errors, 5.0f, 90.0f, 0.001f));
+	ASSERT_EQ(2u, MeshSimplifier::selectLevel(errors, 20.0f, 90.0f, 0.001f));
+	ASSERT_EQ(3u, MeshSimplifier::selectLevel(errors, 80.0f, 90.0f, 0.001f));
+
+	/// A narrower field of view magnifies, and keeps finer levels
+	ASSERT_EQ(2u, MeshSimplifier::selectLevel(errors, 40.0f, 90.0f, 0.001f));
+	ASSERT_EQ(1u, MeshSimplifier::selectLevel(errors, 40.0f, 20.0f, 0.001f));
+}
+
+/**
+ * Simplifier benchmarks; run with --gtest_also_run_disabled_tests
+ *
+ */
+TEST(MeshSimplifier, DISABLED_Benchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	const Mesh mesh = sphere(512, 1024, 1.0f);
+	Clock::time_point start = Clock::now();
+	const std::vector<MeshSimplifier::Level> levels = MeshSimplifier(0.5f, 16).simplify(mesh);
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	std::cout << "simplified " << levels[0].triangles << " triangles into " << levels.size() << " levels in "
+			<< seconds * 1000.0 << " ms (" << levels[0].triangles / seconds / 1e6 << " M triangles/s)" << std::endl;
+	std::vector<float> errors;
+	for(const MeshSimplifier::Level& level : levels)
+	{
+		std::cout << "  " << level.triangles << " triangles, error " << level.error << std::endl;
+		errors.push_back(level.error);
+	}
+
+	/// A field of such spheres, one unit apart in depth, seen with a 60 degree field of view and
+	/// a one pixel tolerance at 1080 lines
+	std::size_t full = 0;
+	std::size_t reduced = 0;
+	std::vector<std::size_t> histogram(levels.size(), 0);
+	for(int row = 1; row <= 1000; ++row)
+	{
+		const std::size_t level = MeshSimplifier::selectLevel(errors, static_cast<float>(row), 60.0f, 1.0f / 1080.0f);
+		++histogram[level];
+		full += levels[0].triangles;
+		reduced += levels[level].triangles;
+	}
+	std::cout << "scene of 1000 spheres: " << full << " triangles at full detail, " << reduced << " with levels ("
+			<< 100.0 * (1.0 - static_cast<double>(reduced) / static_cast<double>(full)) << "% saved)" << std::endl;
+	for(std::size_t i = 0; i < histogram.size(); ++i)
+	{
+		std::cout << "  level " << i << ": " << histogram[i] << " spheres" << std::endl;
+	}
+}
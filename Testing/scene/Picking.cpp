@@ -0,0 +1,375 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "MeshNode.hpp"
+#include "Picking.hpp"
+#include "Rotation.hpp"
+#include "Scene.hpp"
+#include "Translation.hpp"
+#include "TriangleBVH.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "Picking";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	/// The nearest triangle a Ray crosses, by testing every one of them
+	bool bruteForce(const Ray& ray, const std::vector<Point3F>& positions, const std::vector<std::uint32_t>& indices,
+			SurfaceHit& hit)
+	{
+		bool found = false;
+		float best = std::numeric_limits<float>::infinity();
+		for(std::size_t i = 0; i < indices.size() / 3; ++i)
+		{
+			float distance;
+			if(ray.intersects(positions[indices[3 * i]], positions[indices[3 * i + 1]], positions[indices[3 * i + 2]], distance, best))
+			{
+				best = distance;
+				hit.distance = distance;
+				hit.primitive = i;
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	Ray randomRay(std::mt19937& random, float extent)
+	{
+		std::uniform_real_distribution<float> position(-extent, extent);
+		std::normal_distribution<float> direction;
+		return Ray(Point3F(position(random), position(random), position(random)),
+				Vector3F(direction(random), direction(random), direction(random)));
+	}
+
+	/// Transforms a point as the shaders do: as a row vector, followed by the perspective divide
+	Point3F project(const Point3F& point, const Matrix4x4F& matrix)
+	{
+		float clip[4];
+		for(std::size_t column = 0; column < 4; ++column)
+		{
+			clip[column] = point[0] * matrix(0, column) + point[1] * matrix(1, column) + point[2] * matrix(2, column) + matrix(3, column);
+		}
+		return Point3F(clip[0] / clip[3], clip[1] / clip[3], clip[2] / clip[3]);
+	}
+}
+
+TEST(Picking, RayCrossesTrianglesFromEitherSide)
+{
+	const Point3F a(0.0f, 0.0f, 0.0f);
+	const Point3F b(1.0f, 0.0f, 0.0f);
+	const Point3F c(0.0f, 1.0f, 0.0f);
+	float distance = -1.0f;
+
+	ASSERT_TRUE(Ray(Point3F(0.25f, 0.25f, 2.0f), Vector3F(0.0f, 0.0f, -1.0f)).intersects(a, b, c, distance));
+	ASSERT_FLOAT_EQ(2.0f, distance);
+	ASSERT_TRUE(Ray(Point3F(0.25f, 0.25f, -4.0f), Vector3F(0.0f, 0.0f, 2.0f)).intersects(a, b, c, distance));
+	ASSERT_FLOAT_EQ(2.0f, distance);
+
+	/// Beyond the maximum, behind the origin, beside the triangle and parallel to it
+	ASSERT_FALSE(Ray(Point3F(0.25f, 0.25f, 2.0f), Vector3F(0.0f, 0.0f, -1.0f)).intersects(a, b, c, distance, 1.5f));
+	ASSERT_FALSE(Ray(Point3F(0.25f, 0.25f, 2.0f), Vector3F(0.0f, 0.0f, 1.0f)).intersects(a, b, c, distance));
+	ASSERT_FALSE(Ray(Point3F(0.75f, 0.75f, 2.0f), Vector3F(0.0f, 0.0f, -1.0f)).intersects(a, b, c, distance));
+	ASSERT_FALSE(Ray(Point3F(-1.0f, 0.25f, 0.0f), Vector3F(1.0f, 0.0f, 0.0f)).intersects(a, b, c, distance));
+}
+
+TEST(Picking, TriangleBVHMatchesBruteForce)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+
+	/// Small triangles scattered through a volume, which share some of their vertices
+	std::vector<Point3F> positions;
+	std::vector<std::uint32_t> indices;
+	for(std::uint32_t i = 0; i < 5000; ++i)
+	{
+		const Point3F center(position(random), position(random), position(random));
+		for(int corner = 0; corner < 3; ++corner)
+		{
+			positions.push_back(Point3F(center[0] + offset(random), center[1] + offset(random), center[2] + offset(random)));
+		}
+		indices.push_back(3 * i);
+		indices.push_back(3 * i + 1);
+		indices.push_back(i % 2 == 0 ? 3 * i + 2 : 3 * (i / 2));
+	}
+	const TriangleBVH bvh(positions, indices);
+	ASSERT_EQ(5000u, bvh.getTriangleCount());
+	ASSERT_GT(bvh.getNodeCount(), 5000u / TriangleBVH::LEAF_SIZE);
+
+	std::size_t hits = 0;
+	for(int i = 0; i < 2000; ++i)
+	{
+		const Ray ray = randomRay(random, 60.0f);
+		SurfaceHit expected;
+		SurfaceHit actual;
+		const bool found = bruteForce(ray, positions, indices, expected);
+		ASSERT_EQ(found, bvh.intersect(ray, std::numeric_limits<float>::infinity(), actual));
+		if(found)
+		{
+			ASSERT_EQ(expected.primitive, actual.primitive);
+			ASSERT_FLOAT_EQ(expected.distance, actual.distance);
+			ASSERT_FALSE(bvh.intersect(ray, expected.distance * 0.99f, actual));
+			++hits;
+		}
+	}
+	ASSERT_GT(hits, 100u);
+
+	SurfaceHit hit;
+	ASSERT_FALSE(TriangleBVH().intersect(randomRay(random, 1.0f), 1.0f, hit));
+	ASSERT_THROW(TriangleBVH(positions, std::vector<std::uint32_t>{0, 1}), IllegalArgumentException);
+	ASSERT_THROW(TriangleBVH(positions, std::vector<std::uint32_t>{0, 1, 15000}), IllegalArgumentException);
+}
+
+TEST(Picking, HeightfieldMarchMatchesBruteForce)
+{
+	const std::size_t columns = 37;
+	const std::size_t rows = 23;
+	const float originX = -18.0f;
+	const float originZ = -11.0f;
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> elevation(-4.0f, 4.0f);
+	std::vector<float> heights(columns * rows);
+	for(float& height : heights)
+	{
+		height = elevation(random);
+	}
+	auto height = [&heights](std::size_t i, std::size_t j)
+	{
+		return heights[j * columns + i];
+	};
+
+	/// The grid triangulated and numbered as Terrain does it
+	std::vector<Point3F> positions;
+	for(std::size_t j = 0; j < rows; ++j)
+	{
+		for(std::size_t i = 0; i < columns; ++i)
+		{
+			positions.push_back(Point3F(originX + static_cast<float>(i), height(i, j), originZ + static_cast<float>(j)));
+		}
+	}
+	std::vector<std::uint32_t> indices;
+	for(std::size_t i = 0; i < columns - 1; ++i)
+	{
+		for(std::size_t j = 0; j < rows - 1; ++j)
+		{
+			for(std::size_t corner : {j * columns + i, (j + 1) * columns + i, j * columns + i + 1,
+					j * columns + i + 1, (j + 1) * columns + i, (j + 1) * columns + i + 1})
+			{
+				indices.push_back(static_cast<std::uint32_t>(corner));
+			}
+		}
+	}
+
+	std::size_t hits = 0;
+	for(int i = 0; i < 5000; ++i)
+	{
+		/// Mostly downward Rays from above, and some grazing ones from within the relief
+		const Ray ray = i % 2 == 0 ? randomRay(random, 25.0f)
+				: Ray(Point3F(elevation(random) * 5.0f, 10.0f, elevation(random) * 3.0f),
+						Vector3F(elevation(random), -4.0f, elevation(random)));
+		SurfaceHit expected;
+		SurfaceHit actual;
+		const bool found = bruteForce(ray, positions, indices, expected);
+		ASSERT_EQ(found, picking::marchHeightfield(ray, std::numeric_limits<float>::infinity(), columns, rows,
+				originX, originZ, height, actual));
+		if(found)
+		{
+			ASSERT_EQ(expected.primitive, actual.primitive);
+			ASSERT_FLOAT_EQ(expected.distance, actual.distance);
+			++hits;
+		}
+	}
+	ASSERT_GT(hits, 1000u);
+
+	/// A vertical Ray, and one that misses the footprint
+	SurfaceHit hit;
+	ASSERT_TRUE(picking::marchHeightfield(Ray(Point3F(0.3f, 10.0f, 0.6f), Vector3F(0.0f, -1.0f, 0.0f)),
+			100.0f, columns, rows, originX, originZ, height, hit));
+	ASSERT_FALSE(picking::marchHeightfield(Ray(Point3F(-30.0f, 10.0f, 0.0f), Vector3F(0.0f, -1.0f, 0.0f)),
+			100.0f, columns, rows, originX, originZ, height, hit));
+}
+
+TEST(Picking, UnprojectInvertsTheViewProjection)
+{
+	Matrix4x4F view = Matrix4x4F::IDENTITY();
+	view(3, 0) = 3.0f;
+	view(3, 1) = -2.0f;
+	view(3, 2) = -10.0f;
+	const Matrix4x4F viewProjection = view * Matrix4x4F::PERSPECTIVE(60.0f, 0.1f, 100.0f);
+
+	Matrix4x4F inverse;
+	ASSERT_TRUE(picking::invert(viewProjection, inverse));
+	const Matrix4x4F identity = viewProjection * inverse;
+	for(std::size_t row = 0; row < 4; ++row)
+	{
+		for(std::size_t column = 0; column < 4; ++column)
+		{
+			ASSERT_NEAR(row == column ? 1.0f : 0.0f, identity(row, column), 1e-5f);
+		}
+	}
+	ASSERT_FALSE(picking::invert(Matrix4x4F(), inverse));
+
+	/// The Ray through the projection of a point passes through the point
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+	for(int i = 0; i < 100; ++i)
+	{
+		const Point3F point(position(random), position(random), position(random));
+		const Point3F screen = project(point, viewProjection);
+		float length;
+		const Ray ray = picking::unproject(viewProjection, screen[0], screen[1], length);
+		ASSERT_GT(length, 0.0f);
+		ASSERT_NEAR(-1.0f, project(ray.getOrigin(), viewProjection)[2], 1e-3f);
+		ASSERT_NEAR(1.0f, project(ray.getPoint(length), viewProjection)[2], 1e-3f);
+
+		const Vector3F toPoint(point - ray.getOrigin());
+		const float along = toPoint[0] * ray.getDirection()[0] + toPoint[1] * ray.getDirection()[1] + toPoint[2] * ray.getDirection()[2];
+		const Point3F closest = ray.getPoint(along);
+		for(std::size_t axis = 0; axis < 3; ++axis)
+		{
+			ASSERT_NEAR(point[axis], closest[axis], 1e-3f);
+		}
+	}
+}
+
+TEST(Picking, FindsNodesBelowTransforms)
+{
+	createContext();
+
+	/// A unit quad in the plane z = 0, centered on the origin
+	std::vector<Vertex32F> vertices;
+	for(std::size_t i = 0; i < 4; ++i)
+	{
+		vertices.push_back(Vertex32F(Point3F(static_cast<float>(i & 1) - 0.5f, static_cast<float>(i >> 1) - 0.5f, 0.0f),
+				Vector3F(0.0f, 0.0f, 1.0f), Point2F(0.0f, 0.0f)));
+	}
+	std::vector<Mesh::Renderable> renderables(1, Mesh::Renderable(0));
+	renderables[0].indices = {0, 1, 2, 2, 1, 3};
+	const Mesh mesh(vertices, std::vector<Material>(), renderables);
+
+	/// One quad moved to x = 5, and one moved to x = -5 and turned into the plane x = -5
+	Scene<float> scene(Camera(60.0f, 1.0f, 1.0f, 1000.0f));
+	std::shared_ptr<MeshNode> moved = std::make_shared<MeshNode>(mesh);
+	std::shared_ptr<Translation<float>> translation = std::make_shared<Translation<float>>(5.0f, 0.0f, 0.0f);
+	translation->add(moved);
+	scene.add(translation);
+	std::shared_ptr<MeshNode> turned = std::make_shared<MeshNode>(mesh);
+	std::shared_ptr<Rotation<float>> rotation = std::make_shared<Rotation<float>>(Radians<float>(1.5707964f), Vector3F(0.0f, 1.0f, 0.0f));
+	rotation->add(turned);
+	std::shared_ptr<Translation<float>> outer = std::make_shared<Translation<float>>(-5.0f, 0.0f, 0.0f);
+	outer->add(rotation);
+	scene.add(outer);
+	ASSERT_TRUE(translation->isPickable());
+	ASSERT_TRUE(outer->isPickable());
+
+	Scene<float>::PickResult result = scene.pick(Ray(Point3F(5.25f, 0.25f, 10.0f), Vector3F(0.0f, 0.0f, -1.0f)), 100.0f);
+	ASSERT_EQ(moved.get(), result.node);
+	ASSERT_NEAR(10.0f, result.distance, 1e-4f);
+	ASSERT_NEAR(0.0f, result.point[2], 1e-4f);
+
+	/// Distances stay in multiples of the direction in world space
+	result = scene.pick(Ray(Point3F(-20.0f, 0.1f, 0.1f), Vector3F(2.0f, 0.0f, 0.0f)), 100.0f);
+	ASSERT_EQ(turned.get(), result.node);
+	ASSERT_NEAR(7.5f, result.distance, 1e-4f);
+	ASSERT_NEAR(-5.0f, result.point[0], 1e-4f);
+
+	/// Where the quads would lie without their transforms
+	result = scene.pick(Ray(Point3F(0.25f, 0.25f, 10.0f), Vector3F(0.0f, 0.0f, -1.0f)), 100.0f);
+	ASSERT_EQ(nullptr, result.node);
+}
+
+/**
+ * Picking benchmarks; run with --gtest_also_run_disabled_tests
+ *
+ */
+TEST(Picking, DISABLED_Benchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	/// A 1000 x 1000 heightfield, as a BVH and as a grid
+	const std::size_t size = 1000;
+	std::vector<float> heights(size * size);
+	for(std::size_t j = 0; j < size; ++j)
+	{
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			heights[j * size + i] = 20.0f * std::sin(i * 0.05f) * std::cos(j * 0.03f);
+		}
+	}
+	auto height = [&heights](std::size_t i, std::size_t j)
+	{
+		return heights[j * size + i];
+	};
+	std::vector<Point3F> positions;
+	for(std::size_t j = 0; j < size; ++j)
+	{
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			positions.push_back(Point3F(static_cast<float>(i), height(i, j), static_cast<float>(j)));
+		}
+	}
+	std::vector<std::uint32_t> indices;
+	for(std::size_t i = 0; i < size - 1; ++i)
+	{
+		for(std::size_t j = 0; j < size - 1; ++j)
+		{
+			for(std::size_t corner : {j * size + i, (j + 1) * size + i, j * size + i + 1,
+					j * size + i + 1, (j + 1) * size + i, (j + 1) * size + i + 1})
+			{
+				indices.push_back(static_cast<std::uint32_t>(corner));
+			}
+		}
+	}
+	Clock::time_point start = Clock::now();
+	const TriangleBVH bvh(positions, indices);
+	std::cout << "BVH build (" << bvh.getTriangleCount() << " triangles): "
+			<< std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms" << std::endl;
+
+	/// Oblique Rays from a camera above the field, as picks through a screen would be
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> target(0.0f, static_cast<float>(size));
+	std::vector<Ray> rays;
+	for(int i = 0; i < 100000; ++i)
+	{
+		const Point3F eye(500.0f, 200.0f, -100.0f);
+		rays.push_back(Ray(eye, Vector3F(target(random) - eye[0], -200.0f, target(random) - eye[2])));
+	}
+	for(int method = 0; method < 2; ++method)
+	{
+		std::size_t hits = 0;
+		start = Clock::now();
+		for(const Ray& ray : rays)
+		{
+			SurfaceHit hit;
+			hits += method == 0 ? bvh.intersect(ray, std::numeric_limits<float>::infinity(), hit)
+					: picking::marchHeightfield(ray, std::numeric_limits<float>::infinity(), size, size, 0.0f, 0.0f, height, hit);
+		}
+		const double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		std::cout << (method == 0 ? "BVH" : "heightfield march") << ": " << elapsed / rays.size() << " us per pick, "
+				<< hits << " hits" << std::endl;
+	}
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "RenderQueue.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Stand-ins for state that is compared, but never touched, without a context
+	char programs[2];
+	char arenas[2];
+
+	RenderQueue::RenderItem item(std::uint64_t key, int program, int arena, GLuint texture, std::size_t object)
+	{
+		RenderQueue::RenderItem rv = RenderQueue::RenderItem();
+		rv.key = key;
+		rv.program = reinterpret_cast<Program*>(&programs[program]);
+		rv.arena = reinterpret_cast<GeometryArena*>(&arenas[arena]);
+		rv.texture = texture;
+		rv.object = object;
+		return rv;
+	}
+}
+
+TEST(RenderQueue, KeysOrderStateBeforeDepth)
+{
+	ASSERT_LT(RenderQueue::makeKey(0, 9, 9, 9, 9, 1000.0f), RenderQueue::makeKey(1, 0, 0, 0, 0, 0.0f));
+	ASSERT_LT(RenderQueue::makeKey(1, 0, 9, 9, 9, 1000.0f), RenderQueue::makeKey(1, 1, 0, 0, 0, 0.0f));
+	ASSERT_LT(RenderQueue::makeKey(1, 1, 1, 0, 9, 1000.0f), RenderQueue::makeKey(1, 1, 1, 1, 0, 0.0f));
+
+	/// Nearer draws first, and anything behind the viewer before them
+	ASSERT_LT(RenderQueue::makeKey(1, 1, 1, 1, 1, 2.0f), RenderQueue::makeKey(1, 1, 1, 1, 1, 3.0f));
+	ASSERT_LT(RenderQueue::makeKey(1, 1, 1, 1, 1, 0.5f), RenderQueue::makeKey(1, 1, 1, 1, 1, 500.0f));
+	ASSERT_EQ(RenderQueue::makeKey(1, 1, 1, 1, 1, -5.0f), RenderQueue::makeKey(1, 1, 1, 1, 1, 0.0f));
+
+	/// Ids wrap around within their bits
+	ASSERT_EQ(RenderQueue::makeKey(1, 0x1001, 1, 1, 1, 1.0f), RenderQueue::makeKey(1, 1, 1, 1, 1, 1.0f));
+}
+
+TEST(RenderQueue, SortsStablyByKey)
+{
+	RenderQueue queue;
+	const std::uint64_t keys[] = {0x5000000000000002ull, 0x1000000000000300ull, 0x5000000000000001ull,
+			0x1000000000000300ull, 0x0000000000040000ull, 0xF000000000000000ull};
+	for(std::size_t i = 0; i < 6; ++i)
+	{
+		queue.submit(item(keys[i], 0, 0, 0, i));
+	}
+	queue.sort();
+
+	std::vector<std::size_t> objects;
+	for(const RenderQueue::RenderItem& sorted : queue.getItems())
+	{
+		objects.push_back(sorted.object);
+	}
+	ASSERT_EQ((std::vector<std::size_t>{4, 1, 3, 2, 0, 5}), objects);
+}
+
+TEST(RenderQueue, CountsSwitches)
+{
+	std::vector<RenderQueue::RenderItem> items =
+	{
+		item(0, 0, 0, 1, 0),
+		item(0, 1, 0, 1, 0),
+		item(0, 0, 0, 2, 0),
+		item(0, 0, 1, 2, 0),
+		item(0, 0, 1, 2, 0)
+	};
+	RenderQueue::Switches switches = RenderQueue::countSwitches(items);
+	ASSERT_EQ(3u, switches.programs);
+	ASSERT_EQ(2u, switches.textures);
+	ASSERT_EQ(4u, switches.buffers);
+	ASSERT_EQ(0u, RenderQueue::countSwitches(std::vector<RenderQueue::RenderItem>()).programs);
+}
+
+TEST(RenderQueue, StateIdsStartAnewEveryFrame)
+{
+	RenderQueue queue;
+	Program& first = *reinterpret_cast<Program*>(&programs[0]);
+	Program& second = *reinterpret_cast<Program*>(&programs[1]);
+	GeometryArena& arena = *reinterpret_cast<GeometryArena*>(&arenas[0]);
+	auto programId = [&queue]()
+	{
+		return queue.getItems().back().key >> 48 & 0xFFF;
+	};
+
+	queue.begin();
+	queue.submit(0, first, 0, 7, 0, arena, GeometryArena::Handle(), 1.0f, 0);
+	queue.submit(0, second, 0, 7, 0, arena, GeometryArena::Handle(), 1.0f, 0);
+	ASSERT_EQ(1u, programId());
+
+	/// A state first used in a later frame gets the first id of that frame, whatever came before
+	queue.begin();
+	queue.submit(0, second, 0, 8, 0, arena, GeometryArena::Handle(), 1.0f, 0);
+	ASSERT_EQ(0u, programId());
+	ASSERT_EQ(RenderQueue::makeKey(0, 0, 0, 0, 0, 1.0f), queue.getItems().back().key);
+}
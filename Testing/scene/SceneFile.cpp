@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "ResourceException.hpp"
+#include "SceneFile.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	Matrix4x4F translation(float x, float y, float z)
+	{
+		Matrix4x4F rv = Matrix4x4F::IDENTITY();
+		rv(3, 0) = x;
+		rv(3, 1) = y;
+		rv(3, 2) = z;
+		return rv;
+	}
+
+	BoundingBoxF unitBox()
+	{
+		return BoundingBoxF(Point3F(-1.0f, -1.0f, -1.0f), Point3F(1.0f, 1.0f, 1.0f));
+	}
+
+	/**
+	 * A scene whose nodes are added breadth-first:
+	 * <pre>
+	 *  root -- a -- c
+	 *       |    `- d
+	 *       `- b
+	 *  other
+	 * </pre>
+	 *
+	 */
+	SceneFileWriter smallScene()
+	{
+		SceneFileWriter writer;
+		const std::uint32_t mesh = writer.addMesh("meshes/crate.obj", unitBox());
+		const std::uint32_t material = writer.addMaterial(Material(DIFFUSE, CULL_BACK_FACES, false,
+				Color<float, 4>(0.1f, 0.2f, 0.3f, 1.0f), Color<float, 4>(0.4f, 0.5f, 0.6f, 1.0f)));
+		const std::uint32_t root = writer.addNode(SceneFile::NONE, Matrix4x4F::IDENTITY(), BoundingBoxF(), SceneFile::NONE,
+				SceneFile::NONE, "root");
+		const std::uint32_t a = writer.addNode(root, translation(1.0f, 0.0f, 0.0f), BoundingBoxF(), SceneFile::NONE,
+				SceneFile::NONE, "a");
+		writer.addNode(root, translation(0.0f, 2.0f, 0.0f), unitBox(), mesh, material, "b");
+		writer.addNode(SceneFile::NONE, Matrix4x4F::IDENTITY(), BoundingBoxF(), SceneFile::NONE, SceneFile::NONE, "other");
+		writer.addNode(a, translation(0.0f, 0.0f, 3.0f), unitBox(), mesh, material, "c");
+		writer.addNode(a, Matrix4x4F::IDENTITY(), unitBox(), mesh, SceneFile::NONE, "d");
+		return writer;
+	}
+
+	std::vector<std::string> names(const SceneFile& file)
+	{
+		std::vector<std::string> rv;
+		for(const SceneFile::NodeRecord& node : file.getNodes())
+		{
+			rv.push_back(std::string(node.name.data(), node.name.size()));
+		}
+		return rv;
+	}
+}
+
+TEST(SceneFile, StoresTheHierarchyDepthFirst)
+{
+	std::vector<std::uint32_t> positions;
+	const std::vector<unsigned char> bytes = smallScene().serialize(&positions);
+	const SceneFile file(bytes.data(), bytes.size());
+	ASSERT_TRUE(file.verify());
+	ASSERT_TRUE(file.getHeader().version == SceneFile::VERSION);
+	ASSERT_EQ(std::vector<std::string>({"root", "a", "c", "d", "b", "other"}), names(file));
+	ASSERT_EQ(std::vector<std::uint32_t>({0, 1, 4, 5, 2, 3}), positions);
+
+	const SceneFile::RelativeArray<SceneFile::NodeRecord>& nodes = file.getNodes();
+	const std::uint32_t parents[] = {SceneFile::NONE, 0, 1, 1, 0, SceneFile::NONE};
+	const std::uint32_t sizes[] = {5, 3, 1, 1, 1, 1};
+	for(std::size_t i = 0; i < nodes.size(); ++i)
+	{
+		ASSERT_EQ(parents[i], nodes[i].parent);
+		ASSERT_EQ(sizes[i], nodes[i].subtreeSize);
+	}
+	ASSERT_FLOAT_EQ(3.0f, nodes[2].getTransform()(3, 2));
+	ASSERT_FLOAT_EQ(1.0f, nodes[2].getTransform()(2, 2));
+	ASSERT_TRUE(nodes[0].getBounds().isEmpty());
+	ASSERT_EQ(1.0f, nodes[4].getBounds().getMaximum(1));
+	ASSERT_EQ(0u, nodes[3].mesh);
+	ASSERT_TRUE(nodes[3].material == SceneFile::NONE);
+
+	ASSERT_EQ(1u, file.getMeshes().size());
+	ASSERT_STREQ("meshes/crate.obj", file.getMeshes()[0].path.data());
+	ASSERT_EQ(-1.0f, file.getMeshes()[0].getBounds().getMinimum(2));
+
+	ASSERT_EQ(1u, file.getMaterials().size());
+	const Material material = file.getMaterials()[0].toMaterial();
+	ASSERT_EQ(DIFFUSE, material.getLightingMode());
+	ASSERT_EQ(CULL_BACK_FACES, material.getCullingMode());
+	ASSERT_FALSE(material.autoNormalizes());
+	ASSERT_EQ(0.5f, material.getDiffusion()[1]);
+}
+
+TEST(SceneFile, IsUsedWhereverItIsMapped)
+{
+	const SceneFileWriter writer = smallScene();
+	const std::vector<unsigned char> bytes = writer.serialize();
+
+	/// The same bytes at another address
+	std::vector<std::uint64_t> moved(bytes.size() / sizeof(std::uint64_t) + 1);
+	std::memcpy(moved.data(), bytes.data(), bytes.size());
+	const SceneFile copy(moved.data(), bytes.size());
+	ASSERT_TRUE(copy.verify());
+	ASSERT_EQ(names(SceneFile(bytes.data(), bytes.size())), names(copy));
+
+	const std::string path = "SceneFile.test.mscn";
+	writer.write(path);
+	{
+		const SceneFile file(path);
+		ASSERT_TRUE(file.verify());
+		ASSERT_EQ(names(copy), names(file));
+		ASSERT_STREQ("meshes/crate.obj", file.getMeshes()[0].path.data());
+	}
+	std::remove(path.c_str());
+	ASSERT_THROW(SceneFile("SceneFile.missing.mscn"), ResourceException);
+}
+
+TEST(SceneFile, RejectsInvalidFiles)
+{
+	const std::vector<unsigned char> bytes = smallScene().serialize();
+	auto open = [](const std::vector<unsigned char>& contents, std::size_t size)
+	{
+		SceneFile file(contents.data(), size);
+	};
+	ASSERT_NO_THROW(open(bytes, bytes.size()));
+	ASSERT_THROW(open(bytes, sizeof(SceneFile::Header) - 1), ResourceException);
+	ASSERT_THROW(open(bytes, bytes.size() - 8), ResourceException);
+
+	std::vector<unsigned char> corrupt = bytes;
+	reinterpret_cast<SceneFile::Header*>(corrupt.data())->magic ^= 0xFF;
+	ASSERT_THROW(open(corrupt, corrupt.size()), ResourceException);
+
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::Header*>(corrupt.data())->version = SceneFile::VERSION + 1;
+	ASSERT_THROW(open(corrupt, corrupt.size()), ResourceException);
+
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::Header*>(corrupt.data())->nodes.count = 1000;
+	ASSERT_THROW(open(corrupt, corrupt.size()), ResourceException);
+
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::Header*>(corrupt.data())->meshes.offset = -1000;
+	ASSERT_THROW(open(corrupt, corrupt.size()), ResourceException);
+
+	/// Records are only checked by verify()
+	const std::size_t nodes = sizeof(SceneFile::Header);
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::NodeRecord*>(corrupt.data() + nodes)[2].parent = 0;
+	ASSERT_FALSE(SceneFile(corrupt.data(), corrupt.size()).verify());
+
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::NodeRecord*>(corrupt.data() + nodes)[1].subtreeSize = 5;
+	ASSERT_FALSE(SceneFile(corrupt.data(), corrupt.size()).verify());
+
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::NodeRecord*>(corrupt.data() + nodes)[4].mesh = 1;
+	ASSERT_FALSE(SceneFile(corrupt.data(), corrupt.size()).verify());
+
+	corrupt = bytes;
+	reinterpret_cast<SceneFile::NodeRecord*>(corrupt.data() + nodes)[5].name.offset = 1 << 20;
+	ASSERT_FALSE(SceneFile(corrupt.data(), corrupt.size()).verify());
+
+	/// An unterminated string
+	SceneFileWriter writer;
+	writer.addMesh("m");
+	corrupt = writer.serialize();
+	const char* path = SceneFile(corrupt.data(), corrupt.size()).getMeshes()[0].path.data();
+	corrupt[path + 1 - reinterpret_cast<const char*>(corrupt.data())] = 'x';
+	ASSERT_FALSE(SceneFile(corrupt.data(), corrupt.size()).verify());
+}
+
+TEST(SceneFile, RejectsUnknownReferences)
+{
+	SceneFileWriter writer;
+	ASSERT_THROW(writer.addNode(0), IllegalArgumentException);
+	const std::uint32_t root = writer.addNode(SceneFile::NONE);
+	ASSERT_THROW(writer.addNode(root, Matrix4x4F::IDENTITY(), BoundingBoxF(), 0), IllegalArgumentException);
+	ASSERT_THROW(writer.addNode(root, Matrix4x4F::IDENTITY(), BoundingBoxF(), SceneFile::NONE, 0), IllegalArgumentException);
+	ASSERT_EQ(1u, writer.getNodeCount());
+
+	const std::vector<unsigned char> bytes = SceneFileWriter().serialize();
+	const SceneFile empty(bytes.data(), bytes.size());
+	ASSERT_TRUE(empty.verify());
+	ASSERT_TRUE(empty.getNodes().empty());
+}
+
+TEST(SceneFile, InstantiatesAFlatSceneGraph)
+{
+	const std::vector<unsigned char> bytes = smallScene().serialize();
+	const SceneFile file(bytes.data(), bytes.size());
+	FlatSceneGraph graph;
+	const std::vector<FlatSceneGraph::Handle> handles = file.instantiate(graph);
+	ASSERT_EQ(file.getNodes().size(), handles.size());
+	ASSERT_EQ(6u, graph.getNodeCount());
+	graph.update();
+
+	ASSERT_TRUE(graph.getParent(handles[4]) == handles[0]);
+	ASSERT_EQ(0u, graph.getRenderable(handles[2]));
+	ASSERT_TRUE(graph.getRenderable(handles[1]) == FlatSceneGraph::NO_RENDERABLE);
+
+	/// c lies at (1, 0, 3) through a
+	const BoundingBoxF& bounds = graph.getWorldBounds(handles[2]);
+	ASSERT_FLOAT_EQ(0.0f, bounds.getMinimum(0));
+	ASSERT_FLOAT_EQ(2.0f, bounds.getMinimum(2));
+	ASSERT_FLOAT_EQ(4.0f, bounds.getMaximum(2));
+}
+
+TEST(SceneFile, RejectsParentsThatFollowTheirChildren)
+{
+	std::vector<unsigned char> bytes = smallScene().serialize();
+	SceneFile::NodeRecord* nodes = reinterpret_cast<SceneFile::NodeRecord*>(bytes.data() + sizeof(SceneFile::Header));
+	nodes[3].parent = 3;
+
+	const SceneFile file(bytes.data(), bytes.size());
+	FlatSceneGraph graph;
+	ASSERT_THROW(file.instantiate(graph), ResourceException);
+
+	nodes[3].parent = 1 << 20;
+	ASSERT_THROW(file.instantiate(graph), ResourceException);
+}
+
+TEST(SceneFile, DISABLED_Benchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	/// 100k nodes: 100 rooms of 10 shelves of 99 props
+	SceneFileWriter writer;
+	std::vector<std::uint32_t> meshes;
+	for(int i = 0; i < 64; ++i)
+	{
+		meshes.push_back(writer.addMesh("meshes/prop" + std::to_string(i) + ".obj", unitBox()));
+	}
+	const std::uint32_t material = writer.addMaterial(Material());
+	for(int room = 0; room < 100; ++room)
+	{
+		const std::uint32_t roomNode = writer.addNode(SceneFile::NONE, translation(room * 20.0f, 0.0f, 0.0f), BoundingBoxF(),
+				SceneFile::NONE, SceneFile::NONE, "room" + std::to_string(room));
+		for(int shelf = 0; shelf < 10; ++shelf)
+		{
+			const std::uint32_t shelfNode = writer.addNode(roomNode, translation(0.0f, 0.0f, shelf * 2.0f), unitBox(),
+					meshes[shelf], material, "shelf" + std::to_string(shelf));
+			for(int prop = 0; prop < 99; ++prop)
+			{
+				writer.addNode(shelfNode, translation(prop * 0.1f, 1.0f, 0.0f), unitBox(), meshes[prop % meshes.size()], material,
+						"prop" + std::to_string(prop));
+			}
+		}
+	}
+	const std::string path = "SceneFile.benchmark.mscn";
+	writer.write(path);
+
+	/// Opening, then reading every record in place
+	Clock::time_point start = Clock::now();
+	const SceneFile file(path);
+	const double open = std::chrono::duration<double>(Clock::now() - start).count();
+	float sum = 0.0f;
+	for(const SceneFile::NodeRecord& node : file.getNodes())
+	{
+		sum += node.transform[12] + static_cast<float>(node.subtreeSize);
+	}
+	const double read = std::chrono::duration<double>(Clock::now() - start).count();
+	ASSERT_TRUE(file.verify());
+	const double verified = std::chrono::duration<double>(Clock::now() - start).count();
+
+	/// Building the same hierarchy from objects
+	start = Clock::now();
+	FlatSceneGraph graph;
+	file.instantiate(graph);
+	graph.update();
+	const double instantiated = std::chrono::duration<double>(Clock::now() - start).count();
+	std::remove(path.c_str());
+
+	std::cout << file.getNodes().size() << " nodes, " << file.getHeader().size / 1024 << " KiB (" << sum << ")" << std::endl;
+	std::cout << "  open: " << open * 1e3 << " ms" << std::endl;
+	std::cout << "  open and read every node in place: " << read * 1e3 << " ms" << std::endl;
+	std::cout << "  open, read and verify: " << verified * 1e3 << " ms" << std::endl;
+	std::cout << "  instantiate into a FlatSceneGraph and update: " << instantiated * 1e3 << " ms" << std::endl;
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "VertexWelder.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	Vertex32F vertex(float x, float y, float z, float nx = 0.0f, float ny = 0.0f, float nz = 1.0f, float u = 0.0f, float v = 0.0f)
+	{
+		return Vertex32F(Point3F(x, y, z), Vector3F(nx, ny, nz), Point2F(u, v));
+	}
+
+	/// A soup drawn from a small pool of vertices, so that most entries are duplicates
+	std::vector<Vertex32F> randomSoup(std::size_t size, std::size_t pool)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+		std::vector<Vertex32F> unique;
+		for(std::size_t i = 0; i < pool; ++i)
+		{
+			unique.push_back(vertex(coordinate(random), coordinate(random), coordinate(random), 0.0f, 1.0f, 0.0f, coordinate(random), coordinate(random)));
+		}
+		std::uniform_int_distribution<std::size_t> pick(0, pool - 1);
+		std::vector<Vertex32F> soup;
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			soup.push_back(unique[pick(random)]);
+		}
+		return soup;
+	}
+}
+
+TEST(VertexWelder, MergesWithinTolerance)
+{
+	std::vector<Vertex32F> soup = {
+		vertex(0.0f, 0.0f, 0.0f),
+		vertex(1.0f, 0.0f, 0.0f),
+		vertex(0.000001f, 0.0f, 0.0f),
+		vertex(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+		vertex(-0.0f, 0.0f, 0.0f)
+	};
+	std::vector<Vertex32F> vertices;
+	std::vector<std::size_t> remap = VertexWelder().weld(soup, vertices);
+	ASSERT_EQ((std::vector<std::size_t>{0, 1, 0, 2, 0}), remap);
+	ASSERT_EQ(3u, vertices.size());
+	ASSERT_FLOAT_EQ(1.0f, vertices[2].getNormal()[1]);
+
+	/// Exact welding still treats signed zeros as equal
+	remap = VertexWelder(0.0f, 0.0f, 0.0f).weld(soup, vertices);
+	ASSERT_EQ((std::vector<std::size_t>{0, 1, 2, 3, 0}), remap);
+}
+
+TEST(VertexWelder, StrategiesAgree)
+{
+	std::vector<Vertex32F> soup = randomSoup(300000, 5000);
+	std::vector<Vertex32F> hashed;
+	std::vector<Vertex32F> sorted;
+	std::vector<std::size_t> hashRemap = VertexWelder(1.0e-5f, 1.0e-3f, 1.0e-5f, VertexWelder::Strategy::HASH).weld(soup, hashed);
+	std::vector<std::size_t> sortRemap = VertexWelder(1.0e-5f, 1.0e-3f, 1.0e-5f, VertexWelder::Strategy::RADIX_SORT).weld(soup, sorted);
+	ASSERT_EQ(hashRemap, sortRemap);
+	ASSERT_EQ(5000u, hashed.size());
+	ASSERT_EQ(hashed.size(), sorted.size());
+	for(std::size_t i = 0; i < soup.size(); ++i)
+	{
+		ASSERT_TRUE(soup[i] == hashed[hashRemap[i]]);
+	}
+}
+
+TEST(VertexWelder, CreatesIndexedMesh)
+{
+	/// A quad made of two triangles sharing an edge
+	std::vector<Vertex32F> soup = {
+		vertex(0.0f, 0.0f, 0.0f), vertex(1.0f, 0.0f, 0.0f), vertex(1.0f, 1.0f, 0.0f),
+		vertex(0.0f, 0.0f, 0.0f), vertex(1.0f, 1.0f, 0.0f), vertex(0.0f, 1.0f, 0.0f)
+	};
+	Mesh mesh = VertexWelder().createMesh(soup, std::vector<Material>(), 0);
+	ASSERT_EQ(4u, mesh.getVertices().size());
+	ASSERT_EQ(1u, mesh.getMeshes().size());
+	ASSERT_EQ((std::vector<std::size_t>{0, 1, 2, 0, 2, 3}), mesh.getMeshes()[0].indices);
+
+	soup.pop_back();
+	ASSERT_THROW(VertexWelder().createMesh(soup, std::vector<Material>(), 0), IllegalArgumentException);
+}
+
+TEST(VertexWelder, RejectsInvalidTolerances)
+{
+	ASSERT_THROW(VertexWelder(-1.0f), IllegalArgumentException);
+	std::vector<Vertex32F> vertices;
+	ASSERT_THROW(VertexWelder().weld(std::vector<Vertex32F>(1, vertex(std::numeric_limits<float>::infinity(), 0.0f, 0.0f)), vertices), IllegalArgumentException);
+}
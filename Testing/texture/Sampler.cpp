@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "IllegalArgumentException.hpp"
+#include "Sampler.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "Sampler";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+}
+
+TEST(Sampler, IdenticalParametersShareASampler)
+{
+	createContext();
+	std::shared_ptr<Sampler> first = Sampler::acquire(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT);
+	std::shared_ptr<Sampler> second = Sampler::acquire(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT);
+	ASSERT_EQ(first, second);
+	ASSERT_EQ(static_cast<GLenum>(GL_LINEAR_MIPMAP_LINEAR), first->getMinFilter());
+	ASSERT_EQ(static_cast<GLenum>(GL_LINEAR), first->getMagFilter());
+	ASSERT_EQ(static_cast<GLenum>(GL_REPEAT), first->getWrap());
+
+	/// Any differing parameter makes another Sampler
+	std::shared_ptr<Sampler> nearest = Sampler::acquire(GL_NEAREST, GL_LINEAR, GL_REPEAT);
+	std::shared_ptr<Sampler> magnified = Sampler::acquire(GL_LINEAR_MIPMAP_LINEAR, GL_NEAREST, GL_REPEAT);
+	std::shared_ptr<Sampler> clamped = Sampler::acquire(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+	ASSERT_NE(first, nearest);
+	ASSERT_NE(first, magnified);
+	ASSERT_NE(first, clamped);
+	ASSERT_NE(first->getHandle(), clamped->getHandle());
+
+	GLint wrap = 0;
+	glGetSamplerParameteriv(clamped->getHandle(), GL_TEXTURE_WRAP_T, &wrap);
+	ASSERT_EQ(GL_CLAMP_TO_EDGE, wrap);
+}
+
+TEST(Sampler, ReleasedSamplersAreDeleted)
+{
+	createContext();
+	std::shared_ptr<Sampler> sampler = Sampler::acquire(GL_NEAREST, GL_NEAREST, GL_MIRRORED_REPEAT);
+	std::weak_ptr<Sampler> released = sampler;
+	const GLuint handle = sampler->getHandle();
+	ASSERT_EQ(GL_TRUE, glIsSampler(handle));
+
+	/// The registry holds no reference of its own
+	sampler.reset();
+	ASSERT_TRUE(released.expired());
+	ASSERT_EQ(GL_FALSE, glIsSampler(handle));
+
+	sampler = Sampler::acquire(GL_NEAREST, GL_NEAREST, GL_MIRRORED_REPEAT);
+	ASSERT_EQ(GL_TRUE, glIsSampler(sampler->getHandle()));
+}
+
+TEST(Sampler, RejectsInvalidParameters)
+{
+	createContext();
+	ASSERT_THROW(Sampler(GL_REPEAT, GL_LINEAR, GL_REPEAT), IllegalArgumentException);
+	ASSERT_THROW(Sampler::acquire(GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR, GL_REPEAT), IllegalArgumentException);
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "TextureUnits.hpp"
+
+using namespace midnight;
+
+namespace
+{
+	/// Opens a window, and with it a context, unless another test already has (without a current
+	/// context, there is no version to query)
+	void createContext()
+	{
+		if(glGetString(GL_VERSION) == nullptr)
+		{
+			char name[] = "TextureUnits";
+			char* argv[] = {name, nullptr};
+			int argc = 1;
+			glutInit(&argc, argv);
+			glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+			glutInitWindowSize(320, 320);
+			glutCreateWindow("");
+			glewInit();
+		}
+	}
+
+	/// The 2D texture bound to a unit, as the implementation holds it
+	GLuint queryTexture(GLuint unit)
+	{
+		GLint active = 0;
+		GLint texture = 0;
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+		glActiveTexture(static_cast<GLenum>(active));
+		return static_cast<GLuint>(texture);
+	}
+
+	GLuint querySampler(GLuint unit)
+	{
+		GLint active = 0;
+		GLint sampler = 0;
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glGetIntegerv(GL_SAMPLER_BINDING, &sampler);
+		glActiveTexture(static_cast<GLenum>(active));
+		return static_cast<GLuint>(sampler);
+	}
+}
+
+TEST(TextureUnits, RedundantBindsAreSkipped)
+{
+	createContext();
+	GLuint textures[2];
+	GLuint samplers[2];
+	glGenTextures(2, textures);
+	glGenSamplers(2, samplers);
+	TextureUnits units;
+
+	/// Nothing is known about a unit at first, so both of its objects are bound
+	units.bind(0, textures[0], samplers[0]);
+	ASSERT_EQ(2u, units.getStatistics().issued);
+	ASSERT_EQ(0u, units.getStatistics().skipped);
+	ASSERT_EQ(textures[0], queryTexture(0));
+	ASSERT_EQ(samplers[0], querySampler(0));
+
+	units.bind(0, textures[0], samplers[0]);
+	ASSERT_EQ(2u, units.getStatistics().issued);
+	ASSERT_EQ(2u, units.getStatistics().skipped);
+
+	/// Only what changed is bound, and other units are tracked apart
+	units.bind(0, textures[0], samplers[1]);
+	units.bind(1, textures[0], samplers[1]);
+	units.bind(1, textures[1], samplers[1]);
+	ASSERT_EQ(6u, units.getStatistics().issued);
+	ASSERT_EQ(4u, units.getStatistics().skipped);
+	ASSERT_EQ(textures[0], queryTexture(0));
+	ASSERT_EQ(samplers[1], querySampler(0));
+	ASSERT_EQ(textures[1], queryTexture(1));
+	ASSERT_EQ(samplers[1], querySampler(1));
+
+	units.resetStatistics();
+	ASSERT_EQ(0u, units.getStatistics().issued);
+	ASSERT_EQ(0u, units.getStatistics().skipped);
+
+	glDeleteSamplers(2, samplers);
+	glDeleteTextures(2, textures);
+	ASSERT_EQ(static_cast<GLenum>(GL_NO_ERROR), glGetError());
+}
+
+TEST(TextureUnits, ForgottenObjectsAreBoundAgain)
+{
+	createContext();
+	GLuint texture = 0;
+	GLuint sampler = 0;
+	glGenTextures(1, &texture);
+	glGenSamplers(1, &sampler);
+	TextureUnits units;
+	units.bind(0, texture, sampler);
+	units.bind(1, texture, sampler);
+	units.resetStatistics();
+
+	/// A deleted name may be reused by the next object, so it must never be skipped
+	units.forgetTexture(texture);
+	units.bind(0, texture, sampler);
+	units.bind(1, texture, sampler);
+	ASSERT_EQ(2u, units.getStatistics().issued);
+	ASSERT_EQ(2u, units.getStatistics().skipped);
+
+	units.forgetSampler(sampler);
+	units.bind(0, texture, sampler);
+	ASSERT_EQ(3u, units.getStatistics().issued);
+	ASSERT_EQ(3u, units.getStatistics().skipped);
+
+	/// After invalidate, every unit is bound anew
+	units.invalidate();
+	units.bind(0, texture, sampler);
+	units.bind(1, texture, sampler);
+	ASSERT_EQ(7u, units.getStatistics().issued);
+	ASSERT_EQ(3u, units.getStatistics().skipped);
+
+	units.bind(0, 0, 0);
+	units.bind(1, 0, 0);
+	glDeleteSamplers(1, &sampler);
+	glDeleteTextures(1, &texture);
+}
@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "IllegalArgumentException.hpp"
+#include "JobScheduler.hpp"
+
+using namespace midnight;
+using namespace midnight::jobs;
+
+TEST(JobScheduler, DequePopsNewestAndStealsOldest)
+{
+	Job jobs[4] = {};
+	WorkStealingDeque deque(4);
+	for(Job& job : jobs)
+	{
+		ASSERT_TRUE(deque.push(&job));
+	}
+	ASSERT_FALSE(deque.push(&jobs[0]));
+	ASSERT_EQ(4u, deque.size());
+
+	ASSERT_EQ(&jobs[3], deque.pop());
+	ASSERT_EQ(&jobs[0], deque.steal());
+	ASSERT_EQ(&jobs[1], deque.steal());
+	ASSERT_EQ(&jobs[2], deque.pop());
+	ASSERT_EQ(nullptr, deque.pop());
+	ASSERT_EQ(nullptr, deque.steal());
+
+	ASSERT_THROW(WorkStealingDeque(6), IllegalArgumentException);
+}
+
+TEST(JobScheduler, WaitsForEveryJob)
+{
+	for(std::size_t workers : {0u, 3u})
+	{
+		Scheduler scheduler(workers, 16);
+		Counter counter;
+		std::atomic<int> total(0);
+
+		/// More jobs than a deque holds, some of them queued by the jobs themselves
+		for(int i = 0; i < 100; ++i)
+		{
+			scheduler.run([&]
+			{
+				total += 1;
+				scheduler.run([&total]
+				{
+					total += 2;
+				}, &counter);
+			}, &counter);
+		}
+		scheduler.wait(counter);
+		ASSERT_EQ(300, total.load());
+		ASSERT_EQ(0u, counter.get());
+	}
+}
+
+TEST(JobScheduler, DependentJobsRunAfterTheirCounter)
+{
+	Scheduler scheduler(2);
+	Counter first;
+	Counter second;
+	std::atomic<int> done(0);
+	bool ordered = false;
+
+	for(int i = 0; i < 64; ++i)
+	{
+		scheduler.run([&done]
+		{
+			std::this_thread::yield();
+			++done;
+		}, &first);
+	}
+	scheduler.run([&]
+	{
+		ordered = done.load() == 64;
+	}, &second, &first);
+	scheduler.wait(second);
+	ASSERT_TRUE(ordered);
+
+	/// A Counter at zero holds nothing back
+	scheduler.run([&ordered]
+	{
+		ordered = false;
+	}, &second, &first);
+	scheduler.wait(second);
+	ASSERT_FALSE(ordered);
+}
+
+TEST(JobScheduler, ParallelForVisitsEveryIndexOnce)
+{
+	for(std::size_t workers : {0u, 3u})
+	{
+		Scheduler scheduler(workers);
+		std::vector<int> visits(10007, 0);
+		parallel_for(scheduler, 0, visits.size(), [&](std::size_t i)
+		{
+			++visits[i];
+		});
+		ASSERT_EQ(std::vector<int>(visits.size(), 1), visits);
+
+		/// Nested loops wait by executing jobs instead of blocking a worker
+		std::vector<std::atomic<int>> rows(64);
+		parallel_for(scheduler, 0, rows.size(), [&](std::size_t row)
+		{
+			parallel_for(scheduler, 0, 100, [&rows, row](std::size_t)
+			{
+				++rows[row];
+			}, 7);
+		}, 1);
+		for(std::atomic<int>& row : rows)
+		{
+			ASSERT_EQ(100, row.load());
+		}
+	}
+}
+
+TEST(JobScheduler, FailuresAreRethrownByWait)
+{
+	Scheduler scheduler(2);
+	std::atomic<std::size_t> visited(0);
+	ASSERT_THROW(parallel_for(scheduler, 0, 1000, [&visited](std::size_t i)
+	{
+		++visited;
+		if(i == 500)
+		{
+			throw std::runtime_error("failure");
+		}
+	}, 10), std::runtime_error);
+	ASSERT_GT(visited.load(), 0u);
+
+	{
+		ScopedFrameJobs frame(scheduler);
+		frame.run([]
+		{
+			throw std::runtime_error("failure");
+		});
+		ASSERT_THROW(frame.wait(), std::runtime_error);
+
+		/// The failure was cleared
+		frame.run([] { });
+		frame.wait();
+	}
+}
+
+TEST(JobScheduler, ScopedFrameJobsJoinWhenDestroyed)
+{
+	Scheduler scheduler(3);
+	std::vector<int> results(32, 0);
+	int sum = 0;
+	{
+		ScopedFrameJobs frame(scheduler);
+		for(std::size_t i = 0; i < results.size(); ++i)
+		{
+			frame.run([&results, i]
+			{
+				results[i] = static_cast<int>(i);
+			});
+		}
+
+		/// A second stage of the frame, which depends on the first
+		Counter reduced;
+		scheduler.run([&]
+		{
+			for(int result : results)
+			{
+				sum += result;
+			}
+		}, &reduced, &frame.getCounter());
+		scheduler.wait(reduced);
+	}
+	ASSERT_EQ(31 * 32 / 2, sum);
+}
+
+/**
+ * Scheduler microbenchmarks; run with --gtest_also_run_disabled_tests
+ *
+ */
+TEST(JobScheduler, DISABLED_Microbenchmarks)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto elapsed = [](Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	};
+
+	Scheduler& scheduler = Scheduler::getDefault();
+	std::cout << "workers: " << scheduler.getWorkerCount() << std::endl;
+
+	/// The cost of queueing, executing and waiting for an empty job
+	const int jobCount = 100000;
+	Counter counter;
+	Clock::time_point start = Clock::now();
+	for(int i = 0; i < jobCount; ++i)
+	{
+		scheduler.run([] { }, &counter);
+	}
+	scheduler.wait(counter);
+	std::cout << "empty job: " << elapsed(start) * 1000.0 / jobCount << " ns" << std::endl;
+
+	/// The cost of a fork/join with little work in it
+	const int frameCount = 10000;
+	start = Clock::now();
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		ScopedFrameJobs jobs(scheduler);
+		for(int i = 0; i < 8; ++i)
+		{
+			jobs.run([] { });
+		}
+	}
+	std::cout << "fork/join of 8 jobs: " << elapsed(start) / frameCount << " us" << std::endl;
+
+	/// parallel_for against a serial loop
+	std::vector<float> values(1 << 22);
+	for(std::size_t grain : {0u, 1024u, 65536u})
+	{
+		start = Clock::now();
+		parallel_for(scheduler, 0, values.size(), [&values](std::size_t i)
+		{
+			values[i] = std::sqrt(static_cast<float>(i));
+		}, grain);
+		std::cout << "parallel_for (grain " << grain << "): " << elapsed(start) / 1000.0 << " ms" << std::endl;
+	}
+	start = Clock::now();
+	for(std::size_t i = 0; i < values.size(); ++i)
+	{
+		values[i] = std::sqrt(static_cast<float>(i)) + values[i] * 0.0f;
+	}
+	std::cout << "serial loop: " << elapsed(start) / 1000.0 << " ms" << std::endl;
+}
@@ -43,14 +43,17 @@ TESTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}/tests
 # Test Files
 TESTFILES= \
 	${TESTDIR}/TestFiles/f1 \
-	${TESTDIR}/TestFiles/f2
+	${TESTDIR}/TestFiles/f2 \
+	${TESTDIR}/TestFiles/f3 \
+	${TESTDIR}/TestFiles/f4 \
+	${TESTDIR}/TestFiles/f5
 
 # C Compiler Flags
 CFLAGS=
 
 # CC Compiler Flags
-CCFLAGS=
-CXXFLAGS=
+CCFLAGS=-DNDEBUG
+CXXFLAGS=-DNDEBUG
 
 # Fortran Compiler Flags
 FFLAGS=
@@ -79,14 +82,26 @@ ${OBJECTDIR}/main.o: main.cpp
 
 # Build Test Targets
 .build-tests-conf: .build-conf ${TESTFILES}
-${TESTDIR}/TestFiles/f1: ${TESTDIR}/Testing/core/Color.o ${TESTDIR}/Testing/core/Point.o ${TESTDIR}/Testing/core/Tuple.o ${TESTDIR}/Testing/core/Vector.o ${OBJECTFILES:%.o=%_nomain.o}
+${TESTDIR}/TestFiles/f1: ${TESTDIR}/Testing/core/Color.o ${TESTDIR}/Testing/core/Point.o ${TESTDIR}/Testing/core/Tuple.o ${TESTDIR}/Testing/core/Vector.o ${TESTDIR}/Testing/core/BuddyAllocator.o ${TESTDIR}/Testing/core/Matrix.o ${TESTDIR}/Testing/core/BoundingBox.o ${TESTDIR}/Testing/core/Frustum.o ${TESTDIR}/Testing/core/OcclusionBuffer.o ${TESTDIR}/Testing/core/GeometryArena.o ${TESTDIR}/Testing/core/UploadService.o ${TESTDIR}/Testing/core/UniformRing.o ${OBJECTFILES:%.o=%_nomain.o}
 	${MKDIR} -p ${TESTDIR}/TestFiles
 	${LINK.cc}   -o ${TESTDIR}/TestFiles/f1 $^ ${LDLIBSOPTIONS} 
 
-${TESTDIR}/TestFiles/f2: ${TESTDIR}/Testing/glsl/Shader.o ${OBJECTFILES:%.o=%_nomain.o}
+${TESTDIR}/TestFiles/f2: ${TESTDIR}/Testing/glsl/Shader.o ${TESTDIR}/Testing/glsl/ProgramBinaryCache.o ${TESTDIR}/Testing/glsl/ShaderPreprocessor.o ${TESTDIR}/Testing/glsl/Program.o ${TESTDIR}/Testing/glsl/ProgramVariants.o ${TESTDIR}/Testing/glsl/ProgramRegistry.o ${TESTDIR}/Testing/glsl/ProgramReflection.o ${TESTDIR}/Testing/glsl/ProgramPipelineCache.o ${OBJECTFILES:%.o=%_nomain.o}
 	${MKDIR} -p ${TESTDIR}/TestFiles
 	${LINK.cc}   -o ${TESTDIR}/TestFiles/f2 $^ ${LDLIBSOPTIONS} 
 
+${TESTDIR}/TestFiles/f3: ${TESTDIR}/Testing/scene/MeshOptimizer.o ${TESTDIR}/Testing/scene/VertexWelder.o ${TESTDIR}/Testing/scene/FlatSceneGraph.o ${TESTDIR}/Testing/scene/RenderQueue.o ${TESTDIR}/Testing/scene/CommandLists.o ${TESTDIR}/Testing/scene/LooseOctree.o ${TESTDIR}/Testing/scene/Picking.o ${TESTDIR}/Testing/scene/MeshSimplifier.o ${TESTDIR}/Testing/scene/SceneFile.o ${TESTDIR}/Testing/scene/InstancedMeshNode.o ${TESTDIR}/Testing/scene/BatchRenderer.o ${TESTDIR}/Testing/scene/FrameUniforms.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc}   -o ${TESTDIR}/TestFiles/f3 $^ ${LDLIBSOPTIONS} 
+
+${TESTDIR}/TestFiles/f4: ${TESTDIR}/Testing/util/JobScheduler.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc}   -o ${TESTDIR}/TestFiles/f4 $^ ${LDLIBSOPTIONS} 
+
+${TESTDIR}/TestFiles/f5: ${TESTDIR}/Testing/texture/Sampler.o ${TESTDIR}/Testing/texture/TextureUnits.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc}   -o ${TESTDIR}/TestFiles/f5 $^ ${LDLIBSOPTIONS} 
+
 
 ${TESTDIR}/Testing/core/Color.o: Testing/core/Color.cpp 
 	${MKDIR} -p ${TESTDIR}/Testing/core
@@ -118,6 +133,186 @@ ${TESTDIR}/Testing/glsl/Shader.o: Testing/glsl/Shader.cpp
 	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/Shader.o Testing/glsl/Shader.cpp
 
 
+${TESTDIR}/Testing/scene/MeshOptimizer.o: Testing/scene/MeshOptimizer.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/MeshOptimizer.o Testing/scene/MeshOptimizer.cpp
+
+
+${TESTDIR}/Testing/scene/VertexWelder.o: Testing/scene/VertexWelder.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/VertexWelder.o Testing/scene/VertexWelder.cpp
+
+
+${TESTDIR}/Testing/core/BuddyAllocator.o: Testing/core/BuddyAllocator.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/BuddyAllocator.o Testing/core/BuddyAllocator.cpp
+
+
+${TESTDIR}/Testing/core/Matrix.o: Testing/core/Matrix.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/Matrix.o Testing/core/Matrix.cpp
+
+
+${TESTDIR}/Testing/glsl/ProgramBinaryCache.o: Testing/glsl/ProgramBinaryCache.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/ProgramBinaryCache.o Testing/glsl/ProgramBinaryCache.cpp
+
+
+${TESTDIR}/Testing/glsl/ShaderPreprocessor.o: Testing/glsl/ShaderPreprocessor.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/ShaderPreprocessor.o Testing/glsl/ShaderPreprocessor.cpp
+
+
+${TESTDIR}/Testing/core/BoundingBox.o: Testing/core/BoundingBox.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/BoundingBox.o Testing/core/BoundingBox.cpp
+
+
+${TESTDIR}/Testing/scene/FlatSceneGraph.o: Testing/scene/FlatSceneGraph.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/FlatSceneGraph.o Testing/scene/FlatSceneGraph.cpp
+
+
+${TESTDIR}/Testing/core/Frustum.o: Testing/core/Frustum.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/Frustum.o Testing/core/Frustum.cpp
+
+
+${TESTDIR}/Testing/core/OcclusionBuffer.o: Testing/core/OcclusionBuffer.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/OcclusionBuffer.o Testing/core/OcclusionBuffer.cpp
+
+
+${TESTDIR}/Testing/scene/RenderQueue.o: Testing/scene/RenderQueue.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/RenderQueue.o Testing/scene/RenderQueue.cpp
+
+
+${TESTDIR}/Testing/scene/CommandLists.o: Testing/scene/CommandLists.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/CommandLists.o Testing/scene/CommandLists.cpp
+
+
+${TESTDIR}/Testing/util/JobScheduler.o: Testing/util/JobScheduler.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/util
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/util/JobScheduler.o Testing/util/JobScheduler.cpp
+
+
+${TESTDIR}/Testing/scene/LooseOctree.o: Testing/scene/LooseOctree.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/LooseOctree.o Testing/scene/LooseOctree.cpp
+
+
+${TESTDIR}/Testing/scene/Picking.o: Testing/scene/Picking.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/Picking.o Testing/scene/Picking.cpp
+
+
+${TESTDIR}/Testing/scene/MeshSimplifier.o: Testing/scene/MeshSimplifier.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/MeshSimplifier.o Testing/scene/MeshSimplifier.cpp
+
+
+${TESTDIR}/Testing/scene/SceneFile.o: Testing/scene/SceneFile.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/SceneFile.o Testing/scene/SceneFile.cpp
+
+
+${TESTDIR}/Testing/scene/InstancedMeshNode.o: Testing/scene/InstancedMeshNode.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/InstancedMeshNode.o Testing/scene/InstancedMeshNode.cpp
+
+
+${TESTDIR}/Testing/core/GeometryArena.o: Testing/core/GeometryArena.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/GeometryArena.o Testing/core/GeometryArena.cpp
+
+
+${TESTDIR}/Testing/scene/BatchRenderer.o: Testing/scene/BatchRenderer.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/BatchRenderer.o Testing/scene/BatchRenderer.cpp
+
+
+${TESTDIR}/Testing/glsl/Program.o: Testing/glsl/Program.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/Program.o Testing/glsl/Program.cpp
+
+
+${TESTDIR}/Testing/core/UploadService.o: Testing/core/UploadService.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/UploadService.o Testing/core/UploadService.cpp
+
+
+${TESTDIR}/Testing/core/UniformRing.o: Testing/core/UniformRing.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/core
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/core/UniformRing.o Testing/core/UniformRing.cpp
+
+
+${TESTDIR}/Testing/scene/FrameUniforms.o: Testing/scene/FrameUniforms.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/scene
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/scene/FrameUniforms.o Testing/scene/FrameUniforms.cpp
+
+
+${TESTDIR}/Testing/glsl/ProgramVariants.o: Testing/glsl/ProgramVariants.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/ProgramVariants.o Testing/glsl/ProgramVariants.cpp
+
+
+${TESTDIR}/Testing/glsl/ProgramRegistry.o: Testing/glsl/ProgramRegistry.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/ProgramRegistry.o Testing/glsl/ProgramRegistry.cpp
+
+
+${TESTDIR}/Testing/glsl/ProgramReflection.o: Testing/glsl/ProgramReflection.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/ProgramReflection.o Testing/glsl/ProgramReflection.cpp
+
+
+${TESTDIR}/Testing/glsl/ProgramPipelineCache.o: Testing/glsl/ProgramPipelineCache.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/glsl
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/glsl/ProgramPipelineCache.o Testing/glsl/ProgramPipelineCache.cpp
+
+
+${TESTDIR}/Testing/texture/Sampler.o: Testing/texture/Sampler.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/texture
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/texture/Sampler.o Testing/texture/Sampler.cpp
+
+
+${TESTDIR}/Testing/texture/TextureUnits.o: Testing/texture/TextureUnits.cpp 
+	${MKDIR} -p ${TESTDIR}/Testing/texture
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I. -MMD -MP -MF "$@.d" -o ${TESTDIR}/Testing/texture/TextureUnits.o Testing/texture/TextureUnits.cpp
+
+
 ${OBJECTDIR}/main_nomain.o: ${OBJECTDIR}/main.o main.cpp 
 	${MKDIR} -p ${OBJECTDIR}
 	@NMOUTPUT=`${NM} ${OBJECTDIR}/main.o`; \
@@ -137,6 +332,9 @@ ${OBJECTDIR}/main_nomain.o: ${OBJECTDIR}/main.o main.cpp
 	then  \
 	    ${TESTDIR}/TestFiles/f1 || true; \
 	    ${TESTDIR}/TestFiles/f2 || true; \
+	    ${TESTDIR}/TestFiles/f3 || true; \
+	    ${TESTDIR}/TestFiles/f4 || true; \
+	    ${TESTDIR}/TestFiles/f5 || true; \
 	else  \
 	    ./${TEST} || true; \
 	fi